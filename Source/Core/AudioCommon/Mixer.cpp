@@ -12,10 +12,17 @@
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
+#include "Common/Metrics.h"
 #include "Common/Swap.h"
 #include "Core/Config/MainSettings.h"
 #include "Core/ConfigManager.h"
 
+static Common::Metrics::Counter s_mixed_samples_metric(Common::Metrics::Thread::Audio,
+                                                       "mixed_samples");
+// Samples which were missing from the DMA audio, and were filled in by repeating the last one.
+static Common::Metrics::Counter s_underrun_samples_metric(Common::Metrics::Thread::Audio,
+                                                          "underrun_samples");
+
 static u32 DPL2QualityToFrameBlockSize(AudioCommon::DPL2Quality quality)
 {
   switch (quality)
@@ -170,12 +177,14 @@ unsigned int Mixer::Mix(short* samples, unsigned int num_samples)
   }
   else
   {
-    m_dma_mixer.Mix(samples, num_samples, true);
+    const unsigned int dma_samples = m_dma_mixer.Mix(samples, num_samples, true);
+    s_underrun_samples_metric.Add(num_samples - dma_samples);
     m_streaming_mixer.Mix(samples, num_samples, true);
     m_wiimote_speaker_mixer.Mix(samples, num_samples, true);
     m_is_stretching = false;
   }
 
+  s_mixed_samples_metric.Add(num_samples);
   return num_samples;
 }
 
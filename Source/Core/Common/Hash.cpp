@@ -11,6 +11,19 @@
 #include "Common/CommonFuncs.h"
 #include "Common/Intrinsics.h"
 
+#define XXH_STATIC_LINKING_ONLY
+#define XXH_INLINE_ALL
+#if defined(_M_X86_64)
+// Also build the AVX2 variant of the XXH3 accumulation loop, so it can be selected at runtime.
+// The default build only uses SSE2, which every x86-64 CPU supports.
+#define XXH_X86DISPATCH
+#define XXH_DISPATCH_AVX2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define XXH_TARGET_AVX2 __attribute__((__target__("avx2")))
+#endif
+#endif
+#include <xxhash.h>
+
 #ifdef _M_ARM_64
 #ifdef _MSC_VER
 #include <intrin.h>
@@ -22,6 +35,8 @@
 namespace Common
 {
 static u64 (*ptrHashFunction)(const u8* src, u32 len, u32 samples) = nullptr;
+static u64 (*ptrSampledHashFunction)(const u8* src, u32 len, u32 samples) = nullptr;
+static u64 (*ptrXXH3Function)(const u8* src, size_t len) = nullptr;
 
 // uint32_t
 // WARNING - may read one more byte!
@@ -505,14 +520,53 @@ static u64 GetMurmurHash3(const u8* src, u32 len, u32 samples)
 }
 #endif
 
+static u64 GetXXH3(const u8* src, size_t len)
+{
+  return XXH3_64bits(src, len);
+}
+
+#if defined(_M_X86_64)
+XXH_TARGET_AVX2
+static u64 GetXXH3_AVX2(const u8* src, size_t len)
+{
+  // Short inputs do not use the accumulation loop, so there is nothing to gain from AVX2 there.
+  if (len <= XXH3_MIDSIZE_MAX)
+    return XXH3_64bits(src, len);
+
+  return XXH3_hashLong_64b_internal(src, len, XXH3_kSecret, sizeof(XXH3_kSecret),
+                                    XXH3_accumulate_avx2, XXH3_scrambleAcc_avx2);
+}
+#endif
+
+static u64 GetXXH3Hash64(const u8* src, u32 len, u32 samples)
+{
+  // XXH3 always reads the whole buffer. When the caller asks for a sample that actually skips
+  // data, defer to the sampling hash so the speed/accuracy tradeoff stays the user's choice.
+  if (samples != 0 && len / 8 / samples > 1)
+    return ptrSampledHashFunction(src, len, samples);
+
+  return ptrXXH3Function(src, len);
+}
+
 u64 GetHash64(const u8* src, u32 len, u32 samples)
 {
   return ptrHashFunction(src, len, samples);
 }
 
+u64 GetStableHash64(const u8* src, size_t len)
+{
+  return XXH64(src, len, 0);
+}
+
 // sets the hash function used for the texture cache
-void SetHash64Function()
+void SetHash64Function(Hash64Function function)
 {
+#if defined(_M_X86_64)
+  ptrXXH3Function = cpu_info.bAVX2 ? &GetXXH3_AVX2 : &GetXXH3;
+#else
+  ptrXXH3Function = &GetXXH3;
+#endif
+
 #if defined(_M_X86_64) || defined(_M_X86)
   if (cpu_info.bSSE4_2)  // sse crc32 version
   {
@@ -529,5 +583,9 @@ void SetHash64Function()
   {
     ptrHashFunction = &GetMurmurHash3;
   }
+
+  ptrSampledHashFunction = ptrHashFunction;
+  if (function == Hash64Function::XXH3)
+    ptrHashFunction = &GetXXH3Hash64;
 }
 }  // namespace Common
@@ -10,9 +10,22 @@
 
 namespace Common
 {
+// Hash functions that GetHash64 can use. Hashes from different functions (or from different CPUs,
+// for Legacy) are not comparable, so they must only be compared within a single session.
+enum class Hash64Function
+{
+  Legacy,  // CRC32 when available, MurmurHash3 otherwise. Supports sampling.
+  XXH3,    // xxHash3, vectorized. Sampled requests still use the legacy hash.
+};
+
 u32 HashFletcher(const u8* data_u8, size_t length);  // FAST. Length & 1 == 0.
 u32 HashAdler32(const u8* data, size_t len);         // Fairly accurate, slightly slower
 u32 HashEctor(const u8* ptr, size_t length);         // JUNK. DO NOT USE FOR NEW THINGS
 u64 GetHash64(const u8* src, u32 len, u32 samples);
-void SetHash64Function();
+void SetHash64Function(Hash64Function function = Hash64Function::Legacy);
+
+// XXH64 with a zero seed. Unlike GetHash64, the result is the same on every CPU and build, so it
+// is suitable for names that are saved to disk, such as dumped and custom texture file names.
+// Never change this function: doing so would break every existing texture pack.
+u64 GetStableHash64(const u8* src, size_t len);
 }  // namespace Common
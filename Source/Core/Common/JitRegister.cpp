@@ -8,10 +8,13 @@
 #include <cstdio>
 #include <cstdlib>
 #include <fstream>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <fmt/format.h>
 
+#include "Common/Align.h"
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
 #include "Common/StringUtil.h"
@@ -22,6 +25,12 @@
 #include <unistd.h>
 #endif
 
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
 #if defined USE_OPROFILE && USE_OPROFILE
 #include <opagent.h>
 #endif
@@ -41,6 +50,192 @@ namespace JitRegister
 {
 static bool s_is_enabled = false;
 
+#ifdef __linux__
+// The jitdump format of Linux perf, which unlike the map file also holds the generated code and
+// line tables. Use it with perf record -k mono and perf inject --jit.
+namespace JitDump
+{
+constexpr u32 MAGIC = 0x4A695444;
+constexpr u32 VERSION = 1;
+constexpr u32 JIT_CODE_LOAD = 0;
+constexpr u32 JIT_CODE_DEBUG_INFO = 2;
+
+#if defined(_M_X86_64)
+constexpr u32 ELF_MACHINE = 62;  // EM_X86_64
+#elif defined(_M_ARM_64)
+constexpr u32 ELF_MACHINE = 183;  // EM_AARCH64
+#else
+constexpr u32 ELF_MACHINE = 0;
+#endif
+
+struct Header
+{
+  u32 magic;
+  u32 version;
+  u32 total_size;
+  u32 elf_mach;
+  u32 pad1;
+  u32 pid;
+  u64 timestamp;
+  u64 flags;
+};
+
+struct RecordHeader
+{
+  u32 id;
+  u32 total_size;
+  u64 timestamp;
+};
+
+// Followed by the null-terminated name of the symbol and the code.
+struct CodeLoad
+{
+  RecordHeader header;
+  u32 pid;
+  u32 tid;
+  u64 vma;
+  u64 code_addr;
+  u64 code_size;
+  u64 code_index;
+};
+
+// Followed by the entries.
+struct DebugInfo
+{
+  RecordHeader header;
+  u64 code_addr;
+  u64 nr_entry;
+};
+
+// Followed by the null-terminated source file name.
+struct DebugEntry
+{
+  u64 code_addr;
+  u32 line;
+  u32 discrim;
+};
+}  // namespace JitDump
+
+static File::IOFile s_jit_dump_file;
+static void* s_jit_dump_marker = nullptr;
+static size_t s_jit_dump_marker_size = 0;
+static u64 s_jit_dump_code_index = 0;
+// The JITs of the CPU thread and the vertex loaders of the GPU thread register code concurrently,
+// and each record has to be written in one piece.
+static std::mutex s_jit_dump_mutex;
+
+static u64 GetJitDumpTimestamp()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<u64>(ts.tv_sec) * 1000000000 + static_cast<u64>(ts.tv_nsec);
+}
+
+template <typename T>
+static void AppendBytes(std::vector<u8>* buffer, const T& value)
+{
+  const u8* bytes = reinterpret_cast<const u8*>(&value);
+  buffer->insert(buffer->end(), bytes, bytes + sizeof(T));
+}
+
+static void AppendString(std::vector<u8>* buffer, const std::string& string)
+{
+  buffer->insert(buffer->end(), string.begin(), string.end());
+  buffer->push_back(0);
+}
+
+static void OpenJitDump(const std::string& dir)
+{
+  const std::string filename = fmt::format("{}/jit-{}.dump", dir, getpid());
+  if (!s_jit_dump_file.Open(filename, "w+b"))
+    return;
+  std::setvbuf(s_jit_dump_file.GetHandle(), nullptr, _IONBF, 0);
+
+  JitDump::Header header{};
+  header.magic = JitDump::MAGIC;
+  header.version = JitDump::VERSION;
+  header.total_size = sizeof(header);
+  header.elf_mach = JitDump::ELF_MACHINE;
+  header.pid = static_cast<u32>(getpid());
+  header.timestamp = GetJitDumpTimestamp();
+  s_jit_dump_file.WriteBytes(&header, sizeof(header));
+
+  // perf finds the file through this executable mapping of it.
+  s_jit_dump_marker_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  s_jit_dump_marker = mmap(nullptr, s_jit_dump_marker_size, PROT_READ | PROT_EXEC, MAP_PRIVATE,
+                           fileno(s_jit_dump_file.GetHandle()), 0);
+  if (s_jit_dump_marker == MAP_FAILED)
+  {
+    s_jit_dump_marker = nullptr;
+    s_jit_dump_file.Close();
+  }
+}
+
+static void CloseJitDump()
+{
+  if (s_jit_dump_marker)
+  {
+    munmap(s_jit_dump_marker, s_jit_dump_marker_size);
+    s_jit_dump_marker = nullptr;
+  }
+  s_jit_dump_file.Close();
+  s_jit_dump_code_index = 0;
+}
+
+static void WriteJitDump(const void* base_address, u32 code_size, const SourceLines* lines,
+                         const std::string& symbol_name)
+{
+  std::lock_guard lock(s_jit_dump_mutex);
+  if (!s_jit_dump_file.IsOpen())
+    return;
+
+  const u64 timestamp = GetJitDumpTimestamp();
+  const u64 code_address = reinterpret_cast<u64>(base_address);
+  std::vector<u8> buffer;
+
+  // The line table of the code has to come before the code.
+  if (lines && !lines->empty())
+  {
+    JitDump::DebugInfo info{};
+    info.header.id = JitDump::JIT_CODE_DEBUG_INFO;
+    info.header.timestamp = timestamp;
+    info.code_addr = code_address;
+    info.nr_entry = lines->size();
+    AppendBytes(&buffer, info);
+    for (const SourceLine& line : *lines)
+    {
+      JitDump::DebugEntry entry{};
+      entry.code_addr = reinterpret_cast<u64>(line.host_address);
+      entry.line = line.guest_address;
+      AppendBytes(&buffer, entry);
+      AppendString(&buffer, symbol_name);
+    }
+    buffer.resize(Common::AlignUp(buffer.size(), sizeof(u64)));
+    reinterpret_cast<JitDump::DebugInfo*>(buffer.data())->header.total_size =
+        static_cast<u32>(buffer.size());
+  }
+
+  const size_t load_offset = buffer.size();
+  JitDump::CodeLoad load{};
+  load.header.id = JitDump::JIT_CODE_LOAD;
+  load.header.timestamp = timestamp;
+  load.pid = static_cast<u32>(getpid());
+  load.tid = static_cast<u32>(syscall(SYS_gettid));
+  load.vma = code_address;
+  load.code_addr = code_address;
+  load.code_size = code_size;
+  load.code_index = s_jit_dump_code_index++;
+  AppendBytes(&buffer, load);
+  AppendString(&buffer, symbol_name);
+  const u8* code = static_cast<const u8*>(base_address);
+  buffer.insert(buffer.end(), code, code + code_size);
+  reinterpret_cast<JitDump::CodeLoad*>(buffer.data() + load_offset)->header.total_size =
+      static_cast<u32>(buffer.size() - load_offset);
+
+  s_jit_dump_file.WriteBytes(buffer.data(), buffer.size());
+}
+#endif
+
 void Init(const std::string& perf_dir)
 {
 #if defined USE_OPROFILE && USE_OPROFILE
@@ -56,6 +251,9 @@ void Init(const std::string& perf_dir)
     // Disable buffering in order to avoid missing some mappings
     // if the event of a crash:
     std::setvbuf(s_perf_map_file.GetHandle(), nullptr, _IONBF, 0);
+#ifdef __linux__
+    OpenJitDump(dir);
+#endif
     s_is_enabled = true;
   }
 }
@@ -74,6 +272,10 @@ void Shutdown()
   if (s_perf_map_file.IsOpen())
     s_perf_map_file.Close();
 
+#ifdef __linux__
+  CloseJitDump();
+#endif
+
   s_is_enabled = false;
 }
 
@@ -82,7 +284,8 @@ bool IsEnabled()
   return s_is_enabled;
 }
 
-void RegisterV(const void* base_address, u32 code_size, const char* format, va_list args)
+void RegisterV(const void* base_address, u32 code_size, const SourceLines* lines,
+               const char* format, va_list args)
 {
 #if !(defined USE_OPROFILE && USE_OPROFILE) && !defined(USE_VTUNE)
   if (!s_perf_map_file.IsOpen())
@@ -110,5 +313,9 @@ void RegisterV(const void* base_address, u32 code_size, const char* format, va_l
 
   const auto entry = fmt::format("{} {:x} {}\n", fmt::ptr(base_address), code_size, symbol_name);
   s_perf_map_file.WriteBytes(entry.data(), entry.size());
+
+#ifdef __linux__
+  WriteJitDump(base_address, code_size, lines, symbol_name);
+#endif
 }
 }  // namespace JitRegister
@@ -5,20 +5,33 @@
 #pragma once
 #include <stdarg.h>
 #include <string>
+#include <vector>
 #include "Common/CommonTypes.h"
 
 namespace JitRegister
 {
+// The host code starting at host_address was generated for the guest instruction at
+// guest_address, up to the next line.
+struct SourceLine
+{
+  const void* host_address;
+  u32 guest_address;
+};
+using SourceLines = std::vector<SourceLine>;
+
 void Init(const std::string& perf_dir);
 void Shutdown();
-void RegisterV(const void* base_address, u32 code_size, const char* format, va_list args);
+// If lines isn't null, the jitdump file also gets a line table for the code, which maps the host
+// code back to the guest addresses. The name of the symbol is used as the source file name.
+void RegisterV(const void* base_address, u32 code_size, const SourceLines* lines,
+               const char* format, va_list args);
 bool IsEnabled();
 
 inline void Register(const void* base_address, u32 code_size, const char* format, ...)
 {
   va_list args;
   va_start(args, format);
-  RegisterV(base_address, code_size, format, args);
+  RegisterV(base_address, code_size, nullptr, format, args);
   va_end(args);
 }
 
@@ -27,7 +40,17 @@ inline void Register(const void* start, const void* end, const char* format, ...
   va_list args;
   va_start(args, format);
   u32 code_size = (u32)((const char*)end - (const char*)start);
-  RegisterV(start, code_size, format, args);
+  RegisterV(start, code_size, nullptr, format, args);
+  va_end(args);
+}
+
+inline void RegisterWithLines(const void* start, const void* end, const SourceLines& lines,
+                              const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  u32 code_size = (u32)((const char*)end - (const char*)start);
+  RegisterV(start, code_size, &lines, format, args);
   va_end(args);
 }
 }  // namespace JitRegister
@@ -0,0 +1,190 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/Metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "Common/BitUtils.h"
+#include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
+#include "Common/Thread.h"
+#include "Common/Timer.h"
+
+namespace Common::Metrics
+{
+namespace
+{
+struct Registry
+{
+  std::mutex mutex;
+  std::vector<Metric*> metrics;
+};
+
+// Metrics are often static objects, so the registry has to be constructed by the first one.
+Registry& GetRegistry()
+{
+  static Registry registry;
+  return registry;
+}
+
+const char* GetThreadName(Thread thread)
+{
+  switch (thread)
+  {
+  case Thread::CPU:
+    return "cpu";
+  case Thread::GPU:
+    return "gpu";
+  case Thread::DVD:
+    return "dvd";
+  case Thread::Audio:
+    return "audio";
+  }
+  return "unknown";
+}
+}  // namespace
+
+Metric::Metric(Thread thread, std::string name, Type type)
+    : m_thread(thread), m_type(type), m_name(fmt::format("{}.{}", GetThreadName(thread), name))
+{
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  registry.metrics.push_back(this);
+}
+
+Metric::~Metric()
+{
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  registry.metrics.erase(std::find(registry.metrics.begin(), registry.metrics.end(), this));
+}
+
+void Counter::WriteJSON(std::string* out) const
+{
+  *out += fmt::format("{}", GetValue());
+}
+
+void Gauge::WriteJSON(std::string* out) const
+{
+  // JSON has no representation for infinities and NaN.
+  const double value = GetValue();
+  *out += std::isfinite(value) ? fmt::format("{}", value) : "null";
+}
+
+void Histogram::Record(u64 value)
+{
+  const size_t bucket =
+      std::min<size_t>(value == 0 ? 0 : 64 - Common::CountLeadingZeros(value), NUM_BUCKETS - 1);
+  Increase(&m_buckets[bucket], 1);
+  Increase(&m_sum, value);
+  Increase(&m_count, 1);
+}
+
+Histogram::Snapshot Histogram::GetSnapshot() const
+{
+  Snapshot snapshot;
+  snapshot.count = m_count.load(std::memory_order_relaxed);
+  snapshot.sum = m_sum.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < NUM_BUCKETS; ++i)
+    snapshot.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+void Histogram::WriteJSON(std::string* out) const
+{
+  const Snapshot snapshot = GetSnapshot();
+
+  // Most of the buckets at the end are usually empty.
+  size_t num_buckets = NUM_BUCKETS;
+  while (num_buckets > 0 && snapshot.buckets[num_buckets - 1] == 0)
+    --num_buckets;
+
+  *out += fmt::format("{{\"count\":{},\"sum\":{},\"buckets\":[{}]}}", snapshot.count,
+                      snapshot.sum,
+                      fmt::join(snapshot.buckets.begin(), snapshot.buckets.begin() + num_buckets,
+                                ","));
+}
+
+ScopedTimer::ScopedTimer(Histogram* histogram)
+    : m_histogram(histogram), m_start(Common::Timer::GetTimeUs())
+{
+}
+
+ScopedTimer::~ScopedTimer()
+{
+  m_histogram->Record(Common::Timer::GetTimeUs() - m_start);
+}
+
+void ForEachMetric(const std::function<void(const Metric&)>& function)
+{
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  for (const Metric* metric : registry.metrics)
+    function(*metric);
+}
+
+Exporter::~Exporter()
+{
+  Stop();
+}
+
+bool Exporter::Start(const std::string& path, std::chrono::milliseconds interval)
+{
+  Stop();
+
+  if (!m_file.Open(path, "wb"))
+  {
+    ERROR_LOG_FMT(COMMON, "Could not open {} to export metrics", path);
+    return false;
+  }
+
+  m_start_time = Common::Timer::GetTimeUs();
+  m_stop_event.Reset();
+  m_thread = std::thread(&Exporter::ThreadFunc, this, interval);
+  return true;
+}
+
+void Exporter::Stop()
+{
+  if (!m_thread.joinable())
+    return;
+
+  m_stop_event.Set();
+  m_thread.join();
+
+  WriteSample();
+  m_file.Close();
+}
+
+void Exporter::ThreadFunc(std::chrono::milliseconds interval)
+{
+  Common::SetCurrentThreadName("Metrics exporter");
+
+  while (!m_stop_event.WaitFor(interval))
+    WriteSample();
+}
+
+void Exporter::WriteSample()
+{
+  std::string line =
+      fmt::format("{{\"time_us\":{},\"metrics\":{{", Common::Timer::GetTimeUs() - m_start_time);
+
+  bool first = true;
+  ForEachMetric([&](const Metric& metric) {
+    line += fmt::format("{}\"{}\":", first ? "" : ",", metric.GetName());
+    metric.WriteJSON(&line);
+    first = false;
+  });
+
+  line += "}}\n";
+  m_file.WriteString(line);
+  m_file.Flush();
+}
+}  // namespace Common::Metrics
@@ -0,0 +1,185 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "Common/CommonTypes.h"
+#include "Common/Event.h"
+#include "Common/File.h"
+
+// Counters, gauges and histograms which describe how well the emulator runs, for example its
+// speed, its frame times and how long its threads wait for each other.
+//
+// Metrics are usually static objects, which register themselves when they are constructed. Each
+// one belongs to the emulator thread whose work it measures, and must only be updated by one
+// thread at a time. Updating a metric is a few relaxed atomic loads and stores, without locks or
+// read-modify-write operations, so metrics can be updated in hot paths. Any thread can read them
+// at any time, for example to export them to a file with Exporter.
+//
+// Counters and histograms are cumulative: they are never reset while Dolphin is running.
+namespace Common::Metrics
+{
+enum class Thread
+{
+  CPU,
+  GPU,
+  DVD,
+  Audio,
+};
+
+class Metric
+{
+public:
+  enum class Type
+  {
+    Counter,
+    Gauge,
+    Histogram,
+  };
+
+  Metric(Thread thread, std::string name, Type type);
+  virtual ~Metric();
+
+  Metric(const Metric&) = delete;
+  Metric& operator=(const Metric&) = delete;
+
+  Thread GetThread() const { return m_thread; }
+  Type GetType() const { return m_type; }
+  // The name of the thread followed by the name of the metric, for example "gpu.frame_time_us".
+  const std::string& GetName() const { return m_name; }
+
+  // Appends the current value as JSON.
+  virtual void WriteJSON(std::string* out) const = 0;
+
+private:
+  Thread m_thread;
+  Type m_type;
+  std::string m_name;
+};
+
+class Counter final : public Metric
+{
+public:
+  Counter(Thread thread, std::string name) : Metric(thread, std::move(name), Type::Counter) {}
+
+  void Add(u64 value)
+  {
+    m_value.store(m_value.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+  void Increment() { Add(1); }
+
+  u64 GetValue() const { return m_value.load(std::memory_order_relaxed); }
+
+  void WriteJSON(std::string* out) const override;
+
+private:
+  std::atomic<u64> m_value{0};
+};
+
+class Gauge final : public Metric
+{
+public:
+  Gauge(Thread thread, std::string name) : Metric(thread, std::move(name), Type::Gauge) {}
+
+  void Set(double value) { m_value.store(value, std::memory_order_relaxed); }
+
+  double GetValue() const { return m_value.load(std::memory_order_relaxed); }
+
+  void WriteJSON(std::string* out) const override;
+
+private:
+  std::atomic<double> m_value{0.0};
+};
+
+class Histogram final : public Metric
+{
+public:
+  // Bucket 0 counts zeros, and bucket i counts the values in [2^(i-1), 2^i). The last bucket also
+  // counts all values larger than that.
+  static constexpr size_t NUM_BUCKETS = 32;
+
+  struct Snapshot
+  {
+    u64 count;
+    u64 sum;
+    std::array<u64, NUM_BUCKETS> buckets;
+  };
+
+  Histogram(Thread thread, std::string name) : Metric(thread, std::move(name), Type::Histogram)
+  {
+  }
+
+  void Record(u64 value);
+
+  // The count, sum and buckets are read one after the other, so they may be slightly out of sync
+  // while the histogram is being updated.
+  Snapshot GetSnapshot() const;
+
+  void WriteJSON(std::string* out) const override;
+
+private:
+  static void Increase(std::atomic<u64>* value, u64 amount)
+  {
+    value->store(value->load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+  }
+
+  std::atomic<u64> m_count{0};
+  std::atomic<u64> m_sum{0};
+  std::array<std::atomic<u64>, NUM_BUCKETS> m_buckets{};
+};
+
+// Records the time between its construction and its destruction in a histogram, in microseconds.
+class ScopedTimer
+{
+public:
+  explicit ScopedTimer(Histogram* histogram);
+  ~ScopedTimer();
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+  Histogram* m_histogram;
+  u64 m_start;
+};
+
+// Calls the function for each metric, in the order they were registered in. Metrics can't be
+// registered or unregistered until it returns.
+void ForEachMetric(const std::function<void(const Metric&)>& function);
+
+// Periodically appends a line to a file, which holds a JSON object with the time since the export
+// was started and the value of each metric.
+class Exporter
+{
+public:
+  Exporter() = default;
+  ~Exporter();
+
+  Exporter(const Exporter&) = delete;
+  Exporter& operator=(const Exporter&) = delete;
+
+  bool Start(const std::string& path, std::chrono::milliseconds interval);
+  // Writes one more line and closes the file.
+  void Stop();
+
+  bool IsRunning() const { return m_thread.joinable(); }
+
+private:
+  void ThreadFunc(std::chrono::milliseconds interval);
+  void WriteSample();
+
+  File::IOFile m_file;
+  u64 m_start_time = 0;
+  std::thread m_thread;
+  Common::Event m_stop_event;
+};
+}  // namespace Common::Metrics
@@ -2956,6 +2956,14 @@ void XEmitter::VSQRTSD(X64Reg regOp1, X64Reg regOp2, const OpArg& arg)
 {
   WriteAVXOp(0xF2, sseSQRT, regOp1, regOp2, arg);
 }
+void XEmitter::VCVTSD2SS(X64Reg regOp1, X64Reg regOp2, const OpArg& arg)
+{
+  WriteAVXOp(0xF2, 0x5A, regOp1, regOp2, arg);
+}
+void XEmitter::VCVTSS2SD(X64Reg regOp1, X64Reg regOp2, const OpArg& arg)
+{
+  WriteAVXOp(0xF3, 0x5A, regOp1, regOp2, arg);
+}
 void XEmitter::VCMPPD(X64Reg regOp1, X64Reg regOp2, const OpArg& arg, u8 compare)
 {
   WriteAVXOp(0x66, sseCMP, regOp1, regOp2, arg, 0, 1);
@@ -65,6 +65,7 @@ extern const Info<bool> MAIN_WIIMOTE_ENABLE_SPEAKER;
 extern const Info<bool> MAIN_RUN_COMPARE_SERVER;
 extern const Info<bool> MAIN_RUN_COMPARE_CLIENT;
 extern const Info<bool> MAIN_MMU;
+extern const Info<bool> MAIN_MMU_TRANSLATION_CACHE;
 extern const Info<int> MAIN_BB_DUMP_PORT;
 extern const Info<bool> MAIN_SYNC_GPU;
 extern const Info<int> MAIN_SYNC_GPU_MAX_DISTANCE;
@@ -121,6 +122,8 @@ extern const Info<std::string> MAIN_LOAD_PATH;
 extern const Info<std::string> MAIN_RESOURCEPACK_PATH;
 extern const Info<std::string> MAIN_FS_PATH;
 extern const Info<std::string> MAIN_SD_PATH;
+extern const Info<bool> MAIN_EXPORT_METRICS;
+extern const Info<int> MAIN_METRICS_EXPORT_INTERVAL;
 
 // Main.Network
 
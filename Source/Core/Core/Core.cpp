@@ -6,7 +6,9 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstring>
+#include <ctime>
 #include <mutex>
 #include <queue>
 #include <utility>
@@ -29,6 +31,7 @@
 #include "Common/Flag.h"
 #include "Common/Logging/Log.h"
 #include "Common/MemoryUtil.h"
+#include "Common/Metrics.h"
 #include "Common/MsgHandler.h"
 #include "Common/ScopeGuard.h"
 #include "Common/StringUtil.h"
@@ -39,6 +42,8 @@
 #include "Core/Analytics.h"
 #include "Core/Boot/Boot.h"
 #include "Core/BootManager.h"
+#include "Core/Config/GraphicsSettings.h"
+#include "Core/Config/MainSettings.h"
 #include "Core/ConfigManager.h"
 #include "Core/CoreTiming.h"
 #include "Core/DSPEmulator.h"
@@ -54,6 +59,7 @@
 #include "Core/HW/SystemTimers.h"
 #include "Core/HW/VideoInterface.h"
 #include "Core/HW/Wiimote.h"
+#include "Core/HW/WriteTracker.h"
 #include "Core/Host.h"
 #include "Core/IOS/IOS.h"
 #include "Core/MemTools.h"
@@ -98,6 +104,10 @@ static Common::Timer s_timer;
 static std::atomic<u32> s_drawn_frame;
 static std::atomic<u32> s_drawn_video;
 
+static Common::Metrics::Counter s_vi_fields_metric(Common::Metrics::Thread::CPU, "vi_fields");
+static Common::Metrics::Gauge s_emulation_speed_metric(Common::Metrics::Thread::CPU,
+                                                       "emulation_speed_percent");
+
 static bool s_is_stopping = false;
 static bool s_hardware_initialized = false;
 static bool s_is_started = false;
@@ -338,8 +348,14 @@ static void CpuThread(const std::optional<std::string>& savestate_path, bool del
   static_cast<void>(IDCache::GetEnvForThread());
 #endif
 
-  if (_CoreParameter.bFastmem)
+  // Texture cache write tracking relies on the exception handler as well.
+  const bool use_exception_handler =
+      _CoreParameter.bFastmem || Config::Get(Config::GFX_TEXTURE_CACHE_WRITE_TRACKING);
+  if (use_exception_handler)
+  {
     EMM::InstallExceptionHandler();  // Let's run under memory watch
+    WriteTracker::SetExceptionHandlerInstalled(true);
+  }
 
 #ifdef USE_MEMORYWATCHER
   s_memory_watcher = std::make_unique<MemoryWatcher>();
@@ -381,8 +397,11 @@ static void CpuThread(const std::optional<std::string>& savestate_path, bool del
 
   s_is_started = false;
 
-  if (_CoreParameter.bFastmem)
+  if (use_exception_handler)
+  {
+    WriteTracker::SetExceptionHandlerInstalled(false);
     EMM::UninstallExceptionHandler();
+  }
 }
 
 static void FifoPlayerThread(const std::optional<std::string>& savestate_path,
@@ -418,6 +437,20 @@ static void FifoPlayerThread(const std::optional<std::string>& savestate_path,
   }
 }
 
+static void StartMetricsExport(Common::Metrics::Exporter* exporter)
+{
+  const std::time_t time = std::time(nullptr);
+  const std::string path =
+      fmt::format("{}Metrics" DIR_SEP "{}_{:%Y-%m-%d_%H-%M-%S}.jsonl",
+                  File::GetUserPath(D_LOGS_IDX), SConfig::GetInstance().GetGameID(),
+                  *std::localtime(&time));
+  File::CreateFullPath(path);
+
+  const int interval = std::max(Config::Get(Config::MAIN_METRICS_EXPORT_INTERVAL), 10);
+  if (exporter->Start(path, std::chrono::milliseconds(interval)))
+    NOTICE_LOG_FMT(CORE, "Exporting metrics to {}", path);
+}
+
 // Initialize and create emulation thread
 // Call browser: Init():s_emu_thread().
 // See the BootManager.cpp file description for a complete call schedule.
@@ -588,6 +621,11 @@ static void EmuThread(std::unique_ptr<BootParameters> boot, WindowSystemInfo wsi
   if (!CBoot::BootUp(std::move(boot)))
     return;
 
+  // Stopped after the CPU and GPU threads, so that the last values are exported.
+  Common::Metrics::Exporter metrics_exporter;
+  if (Config::Get(Config::MAIN_EXPORT_METRICS))
+    StartMetricsExport(&metrics_exporter);
+
   // Initialise Wii filesystem contents.
   // This is done here after Boot and not in HW to ensure that we operate
   // with the correct title context since save copying requires title directories to exist.
@@ -867,6 +905,7 @@ void VideoThrottle()
   }
 
   s_drawn_video++;
+  s_vi_fields_metric.Increment();
 }
 
 // --- Callbacks for backends / engine ---
@@ -914,6 +953,7 @@ void UpdateTitle()
   float VPS = (float)(s_drawn_video.load() * 1000.0 / ElapseTime);
   float Speed = (float)(s_drawn_video.load() * (100 * 1000.0) /
                         (VideoInterface::GetTargetRefreshRate() * ElapseTime));
+  s_emulation_speed_metric.Set(Speed);
 
   // Settings are shown the same for both extended and summary info
   const std::string SSettings =
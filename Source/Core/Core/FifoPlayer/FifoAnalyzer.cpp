@@ -10,6 +10,7 @@
 #include "Common/MsgHandler.h"
 #include "Common/Swap.h"
 
+#include "Core/FifoPlayer/FifoDataFile.h"
 #include "Core/FifoPlayer/FifoRecordAnalyzer.h"
 
 #include "VideoCommon/OpcodeDecoding.h"
@@ -155,7 +156,7 @@ std::array<int, 21> CalculateVertexElementSizes(int vatIndex, const CPMemory& cp
 bool s_DrawingObject;
 FifoAnalyzer::CPMemory s_CpMem;
 
-u32 AnalyzeCommand(const u8* data, DecodeMode mode)
+static u32 AnalyzeCommand(const u8* data, DecodeMode mode, CPMemory& cpMem, bool& drawingObject)
 {
   const u8* dataStart = data;
 
@@ -170,17 +171,17 @@ u32 AnalyzeCommand(const u8* data, DecodeMode mode)
 
   case OpcodeDecoder::GX_LOAD_CP_REG:
   {
-    s_DrawingObject = false;
+    drawingObject = false;
 
     u32 cmd2 = ReadFifo8(data);
     u32 value = ReadFifo32(data);
-    LoadCPReg(cmd2, value, s_CpMem);
+    LoadCPReg(cmd2, value, cpMem);
     break;
   }
 
   case OpcodeDecoder::GX_LOAD_XF_REG:
   {
-    s_DrawingObject = false;
+    drawingObject = false;
 
     u32 cmd2 = ReadFifo32(data);
     u8 streamSize = ((cmd2 >> 16) & 15) + 1;
@@ -194,7 +195,7 @@ u32 AnalyzeCommand(const u8* data, DecodeMode mode)
   case OpcodeDecoder::GX_LOAD_INDX_C:
   case OpcodeDecoder::GX_LOAD_INDX_D:
   {
-    s_DrawingObject = false;
+    drawingObject = false;
 
     int array = 0xc + (cmd - OpcodeDecoder::GX_LOAD_INDX_A) / 8;
     u32 value = ReadFifo32(data);
@@ -214,7 +215,7 @@ u32 AnalyzeCommand(const u8* data, DecodeMode mode)
 
   case OpcodeDecoder::GX_LOAD_BP_REG:
   {
-    s_DrawingObject = false;
+    drawingObject = false;
     ReadFifo32(data);
     break;
   }
@@ -222,10 +223,10 @@ u32 AnalyzeCommand(const u8* data, DecodeMode mode)
   default:
     if (cmd & 0x80)
     {
-      s_DrawingObject = true;
+      drawingObject = true;
 
       const std::array<int, 21> sizes =
-          CalculateVertexElementSizes(cmd & OpcodeDecoder::GX_VAT_MASK, s_CpMem);
+          CalculateVertexElementSizes(cmd & OpcodeDecoder::GX_VAT_MASK, cpMem);
 
       // Determine offset of each element that might be a vertex array
       // The first 9 elements are never vertex arrays so we just accumulate their sizes.
@@ -253,7 +254,6 @@ u32 AnalyzeCommand(const u8* data, DecodeMode mode)
     }
     else
     {
-      PanicAlertFmt("FifoPlayer: Unknown Opcode ({:#x}).\n", cmd);
       return 0;
     }
     break;
@@ -262,6 +262,19 @@ u32 AnalyzeCommand(const u8* data, DecodeMode mode)
   return (u32)(data - dataStart);
 }
 
+u32 AnalyzeCommand(const u8* data, DecodeMode mode)
+{
+  const u32 size = AnalyzeCommand(data, mode, s_CpMem, s_DrawingObject);
+  if (size == 0)
+    PanicAlertFmt("FifoPlayer: Unknown Opcode ({:#x}).\n", data[0]);
+  return size;
+}
+
+u32 AnalyzePlaybackCommand(const u8* data, CPMemory& cpMem, bool& drawingObject)
+{
+  return AnalyzeCommand(data, DecodeMode::Playback, cpMem, drawingObject);
+}
+
 void LoadCPReg(u32 subCmd, u32 value, CPMemory& cpMem)
 {
   switch (subCmd & 0xF0)
@@ -300,4 +313,30 @@ void LoadCPReg(u32 subCmd, u32 value, CPMemory& cpMem)
     break;
   }
 }
+
+std::vector<u32> GetVertexRegs(const CPMemory& cpMem)
+{
+  std::vector<u32> regs(FifoFrameInfo::NUM_VERTEX_REGS);
+  regs[0] = static_cast<u32>(cpMem.vtxDesc.Hex & 0x1FFFF);
+  regs[1] = static_cast<u32>(cpMem.vtxDesc.Hex >> 17);
+  for (size_t i = 0; i < cpMem.vtxAttr.size(); ++i)
+  {
+    regs[2 + i] = cpMem.vtxAttr[i].g0.Hex;
+    regs[10 + i] = cpMem.vtxAttr[i].g1.Hex;
+    regs[18 + i] = cpMem.vtxAttr[i].g2.Hex;
+  }
+  return regs;
+}
+
+void LoadVertexRegs(const std::vector<u32>& regs, CPMemory& cpMem)
+{
+  LoadCPReg(0x50, regs[0], cpMem);
+  LoadCPReg(0x60, regs[1], cpMem);
+  for (u32 i = 0; i < 8; ++i)
+  {
+    LoadCPReg(0x70 + i, regs[2 + i], cpMem);
+    LoadCPReg(0x80 + i, regs[10 + i], cpMem);
+    LoadCPReg(0x90 + i, regs[18 + i], cpMem);
+  }
+}
 }  // namespace FifoAnalyzer
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "VideoCommon/CPMemory.h"
@@ -17,8 +18,6 @@ enum class DecodeMode
   Playback,
 };
 
-u32 AnalyzeCommand(const u8* data, DecodeMode mode);
-
 struct CPMemory
 {
   TVtxDesc vtxDesc;
@@ -27,8 +26,19 @@ struct CPMemory
   std::array<u32, 16> arrayStrides;
 };
 
+u32 AnalyzeCommand(const u8* data, DecodeMode mode);
+
+// Analyzes a command for playback with the given state rather than s_CpMem and s_DrawingObject, so
+// that several threads can analyze commands at the same time. Returns 0 for unknown commands,
+// without raising an alert.
+u32 AnalyzePlaybackCommand(const u8* data, CPMemory& cpMem, bool& drawingObject);
+
 void LoadCPReg(u32 subCmd, u32 value, CPMemory& cpMem);
 
+// Converts between CPMemory and FifoFrameInfo::vertexRegs.
+std::vector<u32> GetVertexRegs(const CPMemory& cpMem);
+void LoadVertexRegs(const std::vector<u32>& regs, CPMemory& cpMem);
+
 extern bool s_DrawingObject;
 extern FifoAnalyzer::CPMemory s_CpMem;
 }  // namespace FifoAnalyzer
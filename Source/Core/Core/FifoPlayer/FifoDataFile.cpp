@@ -6,25 +6,40 @@
 
 #include <algorithm>
 #include <cstring>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include <zstd.h>
+
 #include "Common/File.h"
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Core/Config/MainSettings.h"
 #include "Core/HW/Memmap.h"
 
+// Since version 6, frames are compressed and only read from the file when they are needed.
+// Each frame is one zstd compressed block at fifoDataOffset, holding its FIFO data followed by
+// its FileMemoryUpdate list. The data of a memory update is a u32 compressed size followed by the
+// compressed data, and memory updates with the same data share it. Since version 7, the block
+// ends with the frame's vertex registers.
 enum
 {
   FILE_ID = 0x0d01f1f0,
-  VERSION_NUMBER = 5,
-  MIN_LOADER_VERSION = 1,
-  // This value is only used if the DFF file was created with overridden RAM sizes.
-  // If the MIN_LOADER_VERSION ever exceeds this, it's alright to remove it.
-  MIN_LOADER_VERSION_FOR_RAM_OVERRIDE = 5,
+  VERSION_NUMBER = 7,
+  MIN_LOADER_VERSION = 7,
+  MIN_VERSION_FOR_COMPRESSION = 6,
 };
 
+// Lazily read frames are released again once they use more memory than this.
+constexpr size_t MAX_LOADED_FRAMES_SIZE = 256 * 1024 * 1024;
+constexpr size_t MAX_DATA_CACHE_SIZE = 64 * 1024 * 1024;
+
 #pragma pack(push, 1)
 
 struct FileHeader
@@ -61,7 +76,11 @@ struct FileFrameInfo
   u32 fifoEnd;
   u64 memoryUpdatesOffset;
   u32 numMemoryUpdates;
-  u8 reserved[32];
+  // Only used since version 6, where memoryUpdatesOffset is not.
+  u32 compressedSize;
+  // Only used since version 7.
+  u32 numVertexRegs;
+  u8 reserved[24];
 };
 static_assert(sizeof(FileFrameInfo) == 64, "FileFrameInfo should be 64 bytes");
 
@@ -102,9 +121,74 @@ bool FifoDataFile::GetIsWii() const
   return GetFlag(FLAG_IS_WII);
 }
 
+static size_t GetFrameSize(const FifoFrameInfo& frame)
+{
+  size_t size = frame.fifoData.size();
+  for (const MemoryUpdate& update : frame.memoryUpdates)
+    size += update.data.size();
+  return size;
+}
+
+static std::vector<u8> Compress(const u8* data, size_t size)
+{
+  std::vector<u8> compressed(ZSTD_compressBound(size));
+  const size_t compressed_size =
+      ZSTD_compress(compressed.data(), compressed.size(), data, size, ZSTD_CLEVEL_DEFAULT);
+  if (ZSTD_isError(compressed_size))
+    return {};
+
+  compressed.resize(compressed_size);
+  return compressed;
+}
+
+static bool Decompress(const std::vector<u8>& compressed, u8* data, size_t size)
+{
+  const size_t decompressed_size =
+      ZSTD_decompress(data, size, compressed.data(), compressed.size());
+  return !ZSTD_isError(decompressed_size) && decompressed_size == size;
+}
+
 void FifoDataFile::AddFrame(const FifoFrameInfo& frameInfo)
 {
-  m_Frames.push_back(frameInfo);
+  m_Frames.push_back(std::make_shared<const FifoFrameInfo>(frameInfo));
+}
+
+std::shared_ptr<const FifoFrameInfo> FifoDataFile::GetFrame(u32 frame) const
+{
+  if (!m_file)
+    return m_Frames[frame];
+
+  {
+    std::lock_guard<std::mutex> guard(m_file_lock);
+    if (m_Frames[frame])
+      return m_Frames[frame];
+  }
+
+  auto frame_info = std::make_shared<FifoFrameInfo>();
+  if (!ReadStoredFrame(frame, frame_info.get()))
+  {
+    ERROR_LOG_FMT(COMMON, "Failed to read frame {} of the FIFO log", frame);
+    return std::make_shared<const FifoFrameInfo>();
+  }
+
+  std::lock_guard<std::mutex> guard(m_file_lock);
+  // Another thread may have read the same frame in the meantime.
+  if (m_Frames[frame])
+    return m_Frames[frame];
+
+  // Frames are mostly read in order, so release the ones which were loaded first.
+  const size_t size = GetFrameSize(*frame_info);
+  while (!m_loaded_frames.empty() && m_loaded_frames_size + size > MAX_LOADED_FRAMES_SIZE)
+  {
+    m_loaded_frames_size -= GetFrameSize(*m_Frames[m_loaded_frames.front()]);
+    m_Frames[m_loaded_frames.front()].reset();
+    m_loaded_frames.pop_front();
+  }
+
+  m_Frames[frame] = frame_info;
+  m_loaded_frames.push_back(frame);
+  m_loaded_frames_size += size;
+  return frame_info;
 }
 
 bool FifoDataFile::Save(const std::string& filename)
@@ -117,8 +201,9 @@ bool FifoDataFile::Save(const std::string& filename)
   PadFile(sizeof(FileHeader), file);
 
   // Add space for frame list
+  const u32 frameCount = GetFrameCount();
   u64 frameListOffset = file.Tell();
-  PadFile(m_Frames.size() * sizeof(FileFrameInfo), file);
+  PadFile(frameCount * sizeof(FileFrameInfo), file);
 
   u64 bpMemOffset = file.Tell();
   file.WriteArray(m_BPMem, BP_MEM_SIZE);
@@ -135,15 +220,75 @@ bool FifoDataFile::Save(const std::string& filename)
   u64 texMemOffset = file.Tell();
   file.WriteArray(m_TexMem, TEX_MEM_SIZE);
 
+  // Write frames. Memory updates are identified by the hash and size of their data, so that data
+  // which is uploaded again and again is only stored once.
+  std::map<std::pair<u64, u32>, u64> dataOffsets;
+  std::vector<FileFrameInfo> frameList(frameCount);
+  for (u32 i = 0; i < frameCount; ++i)
+  {
+    const std::shared_ptr<const FifoFrameInfo> srcFrame = GetFrame(i);
+    const size_t fifoDataSize = srcFrame->fifoData.size();
+
+    const size_t updatesSize = srcFrame->memoryUpdates.size() * sizeof(FileMemoryUpdate);
+    std::vector<u8> block(fifoDataSize + updatesSize + srcFrame->vertexRegs.size() * sizeof(u32));
+    std::copy(srcFrame->fifoData.begin(), srcFrame->fifoData.end(), block.begin());
+    if (!srcFrame->vertexRegs.empty())
+    {
+      std::memcpy(&block[fifoDataSize + updatesSize], srcFrame->vertexRegs.data(),
+                  srcFrame->vertexRegs.size() * sizeof(u32));
+    }
+
+    for (size_t j = 0; j < srcFrame->memoryUpdates.size(); ++j)
+    {
+      const MemoryUpdate& srcUpdate = srcFrame->memoryUpdates[j];
+      const u32 dataSize = static_cast<u32>(srcUpdate.data.size());
+      const std::pair<u64, u32> key{
+          Common::GetStableHash64(srcUpdate.data.data(), srcUpdate.data.size()), dataSize};
+
+      auto dataOffset = dataOffsets.find(key);
+      if (dataOffset == dataOffsets.end())
+      {
+        const std::vector<u8> compressed = Compress(srcUpdate.data.data(), srcUpdate.data.size());
+        if (compressed.empty())
+          return false;
+
+        const u32 compressedSize = static_cast<u32>(compressed.size());
+        dataOffset = dataOffsets.emplace(key, file.Tell()).first;
+        file.WriteArray(&compressedSize, 1);
+        file.WriteBytes(compressed.data(), compressed.size());
+      }
+
+      FileMemoryUpdate dstUpdate{};
+      dstUpdate.address = srcUpdate.address;
+      dstUpdate.dataOffset = dataOffset->second;
+      dstUpdate.dataSize = dataSize;
+      dstUpdate.fifoPosition = srcUpdate.fifoPosition;
+      dstUpdate.type = srcUpdate.type;
+      std::memcpy(&block[fifoDataSize + j * sizeof(FileMemoryUpdate)], &dstUpdate,
+                  sizeof(FileMemoryUpdate));
+    }
+
+    const std::vector<u8> compressed = Compress(block.data(), block.size());
+    if (compressed.empty())
+      return false;
+
+    FileFrameInfo& dstFrame = frameList[i];
+    dstFrame = {};
+    dstFrame.fifoDataOffset = file.Tell();
+    dstFrame.fifoDataSize = static_cast<u32>(fifoDataSize);
+    dstFrame.fifoStart = srcFrame->fifoStart;
+    dstFrame.fifoEnd = srcFrame->fifoEnd;
+    dstFrame.numMemoryUpdates = static_cast<u32>(srcFrame->memoryUpdates.size());
+    dstFrame.compressedSize = static_cast<u32>(compressed.size());
+    dstFrame.numVertexRegs = static_cast<u32>(srcFrame->vertexRegs.size());
+    file.WriteBytes(compressed.data(), compressed.size());
+  }
+
   // Write header
-  FileHeader header;
+  FileHeader header{};
   header.fileId = FILE_ID;
   header.file_version = VERSION_NUMBER;
-  // Maintain backwards compatability so long as the RAM sizes aren't overridden.
-  if (Config::Get(Config::MAIN_RAM_OVERRIDE_ENABLE))
-    header.min_loader_version = MIN_LOADER_VERSION_FOR_RAM_OVERRIDE;
-  else
-    header.min_loader_version = MIN_LOADER_VERSION;
+  header.min_loader_version = MIN_LOADER_VERSION;
 
   header.bpMemOffset = bpMemOffset;
   header.bpMemSize = BP_MEM_SIZE;
@@ -161,7 +306,7 @@ bool FifoDataFile::Save(const std::string& filename)
   header.texMemSize = TEX_MEM_SIZE;
 
   header.frameListOffset = frameListOffset;
-  header.frameCount = (u32)m_Frames.size();
+  header.frameCount = frameCount;
 
   header.flags = m_Flags;
 
@@ -172,30 +317,8 @@ bool FifoDataFile::Save(const std::string& filename)
   file.WriteBytes(&header, sizeof(FileHeader));
 
   // Write frames list
-  for (unsigned int i = 0; i < m_Frames.size(); ++i)
-  {
-    const FifoFrameInfo& srcFrame = m_Frames[i];
-
-    // Write FIFO data
-    file.Seek(0, SEEK_END);
-    u64 dataOffset = file.Tell();
-    file.WriteBytes(srcFrame.fifoData.data(), srcFrame.fifoData.size());
-
-    u64 memoryUpdatesOffset = WriteMemoryUpdates(srcFrame.memoryUpdates, file);
-
-    FileFrameInfo dstFrame;
-    dstFrame.fifoDataSize = static_cast<u32>(srcFrame.fifoData.size());
-    dstFrame.fifoDataOffset = dataOffset;
-    dstFrame.fifoStart = srcFrame.fifoStart;
-    dstFrame.fifoEnd = srcFrame.fifoEnd;
-    dstFrame.memoryUpdatesOffset = memoryUpdatesOffset;
-    dstFrame.numMemoryUpdates = static_cast<u32>(srcFrame.memoryUpdates.size());
-
-    // Write frame info
-    u64 frameOffset = frameListOffset + (i * sizeof(FileFrameInfo));
-    file.Seek(frameOffset, SEEK_SET);
-    file.WriteBytes(&dstFrame, sizeof(FileFrameInfo));
-  }
+  file.Seek(frameListOffset, SEEK_SET);
+  file.WriteArray(frameList.data(), frameList.size());
 
   if (!file.Close())
     return false;
@@ -297,6 +420,38 @@ std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bo
   dataFile->m_ram_size_real = header.mem1_size;
   dataFile->m_exram_size_real = header.mem2_size;
 
+  if (dataFile->m_Version >= MIN_VERSION_FOR_COMPRESSION)
+  {
+    // Only read the frame list. Frames are read when they are needed.
+    std::vector<FileFrameInfo> frameList(header.frameCount);
+    file.Seek(header.frameListOffset, SEEK_SET);
+    if (!file.ReadArray(frameList.data(), frameList.size()))
+      return nullptr;
+
+    dataFile->m_stored_frames.reserve(frameList.size());
+    for (const FileFrameInfo& srcFrame : frameList)
+    {
+      const u32 numVertexRegs = dataFile->m_Version >= 7 ? srcFrame.numVertexRegs : 0;
+      if (numVertexRegs != 0 && numVertexRegs != FifoFrameInfo::NUM_VERTEX_REGS)
+        return nullptr;
+
+      dataFile->m_stored_frames.push_back({srcFrame.fifoDataOffset, srcFrame.compressedSize,
+                                           srcFrame.fifoDataSize, srcFrame.fifoStart,
+                                           srcFrame.fifoEnd, srcFrame.numMemoryUpdates,
+                                           numVertexRegs});
+    }
+
+    // The frame list holds the size of every compressed frame, so together with the header it
+    // practically identifies the recording.
+    dataFile->m_file_hash =
+        Common::GetStableHash64(reinterpret_cast<const u8*>(&header), sizeof(header)) ^
+        Common::GetStableHash64(reinterpret_cast<const u8*>(frameList.data()),
+                                frameList.size() * sizeof(FileFrameInfo));
+    dataFile->m_Frames.resize(frameList.size());
+    dataFile->m_file = std::make_unique<File::IOFile>(std::move(file));
+    return dataFile;
+  }
+
   // Read frames
   for (u32 i = 0; i < header.frameCount; ++i)
   {
@@ -343,37 +498,6 @@ bool FifoDataFile::GetFlag(u32 flag) const
   return !!(m_Flags & flag);
 }
 
-u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates,
-                                     File::IOFile& file)
-{
-  // Add space for memory update list
-  u64 updateListOffset = file.Tell();
-  PadFile(memUpdates.size() * sizeof(FileMemoryUpdate), file);
-
-  for (unsigned int i = 0; i < memUpdates.size(); ++i)
-  {
-    const MemoryUpdate& srcUpdate = memUpdates[i];
-
-    // Write memory
-    file.Seek(0, SEEK_END);
-    u64 dataOffset = file.Tell();
-    file.WriteBytes(srcUpdate.data.data(), srcUpdate.data.size());
-
-    FileMemoryUpdate dstUpdate;
-    dstUpdate.address = srcUpdate.address;
-    dstUpdate.dataOffset = dataOffset;
-    dstUpdate.dataSize = static_cast<u32>(srcUpdate.data.size());
-    dstUpdate.fifoPosition = srcUpdate.fifoPosition;
-    dstUpdate.type = srcUpdate.type;
-
-    u64 updateOffset = updateListOffset + (i * sizeof(FileMemoryUpdate));
-    file.Seek(updateOffset, SEEK_SET);
-    file.WriteBytes(&dstUpdate, sizeof(FileMemoryUpdate));
-  }
-
-  return updateListOffset;
-}
-
 void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
                                      std::vector<MemoryUpdate>& memUpdates, File::IOFile& file)
 {
@@ -396,3 +520,89 @@ void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
     file.ReadBytes(dstUpdate.data.data(), srcUpdate.dataSize);
   }
 }
+
+bool FifoDataFile::ReadFromFile(u64 offset, void* data, size_t size) const
+{
+  std::lock_guard<std::mutex> guard(m_file_lock);
+  return m_file->Seek(offset, SEEK_SET) && m_file->ReadBytes(data, size);
+}
+
+bool FifoDataFile::ReadStoredFrame(u32 frame, FifoFrameInfo* frame_info) const
+{
+  const StoredFrame& stored = m_stored_frames[frame];
+  std::vector<u8> compressed(stored.compressed_size);
+  if (!ReadFromFile(stored.offset, compressed.data(), compressed.size()))
+    return false;
+
+  const size_t updates_size = stored.num_memory_updates * sizeof(FileMemoryUpdate);
+  std::vector<u8> block(stored.fifo_data_size + updates_size +
+                        stored.num_vertex_regs * sizeof(u32));
+  if (!Decompress(compressed, block.data(), block.size()))
+    return false;
+
+  frame_info->fifoData.assign(block.begin(), block.begin() + stored.fifo_data_size);
+  frame_info->fifoStart = stored.fifo_start;
+  frame_info->fifoEnd = stored.fifo_end;
+
+  frame_info->vertexRegs.resize(stored.num_vertex_regs);
+  if (stored.num_vertex_regs != 0)
+  {
+    std::memcpy(frame_info->vertexRegs.data(), &block[stored.fifo_data_size + updates_size],
+                stored.num_vertex_regs * sizeof(u32));
+  }
+
+  frame_info->memoryUpdates.resize(stored.num_memory_updates);
+  for (u32 i = 0; i < stored.num_memory_updates; ++i)
+  {
+    FileMemoryUpdate srcUpdate;
+    std::memcpy(&srcUpdate, &block[stored.fifo_data_size + i * sizeof(FileMemoryUpdate)],
+                sizeof(FileMemoryUpdate));
+
+    MemoryUpdate& dstUpdate = frame_info->memoryUpdates[i];
+    dstUpdate.address = srcUpdate.address;
+    dstUpdate.fifoPosition = srcUpdate.fifoPosition;
+    dstUpdate.type = static_cast<MemoryUpdate::Type>(srcUpdate.type);
+    if (!ReadMemoryUpdateData(srcUpdate.dataOffset, srcUpdate.dataSize, &dstUpdate.data))
+      return false;
+  }
+
+  return true;
+}
+
+bool FifoDataFile::ReadMemoryUpdateData(u64 offset, u32 size, std::vector<u8>* data) const
+{
+  {
+    std::lock_guard<std::mutex> guard(m_file_lock);
+    const auto cached = m_data_cache.find(offset);
+    if (cached != m_data_cache.end())
+    {
+      *data = cached->second;
+      return true;
+    }
+  }
+
+  u32 compressedSize;
+  if (!ReadFromFile(offset, &compressedSize, sizeof(compressedSize)))
+    return false;
+
+  std::vector<u8> compressed(compressedSize);
+  data->resize(size);
+  if (!ReadFromFile(offset + sizeof(compressedSize), compressed.data(), compressed.size()) ||
+      !Decompress(compressed, data->data(), data->size()))
+  {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> guard(m_file_lock);
+  if (m_data_cache.count(offset) != 0)
+    return true;
+
+  if (m_data_cache_size + size > MAX_DATA_CACHE_SIZE)
+  {
+    m_data_cache.clear();
+    m_data_cache_size = 0;
+  }
+  m_data_cache.emplace(offset, *data);
+  m_data_cache_size += size;
+  return true;
+}
@@ -4,8 +4,12 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -34,6 +38,8 @@ struct MemoryUpdate
 
 struct FifoFrameInfo
 {
+  static constexpr u32 NUM_VERTEX_REGS = 26;
+
   std::vector<u8> fifoData;
 
   u32 fifoStart;
@@ -41,6 +47,12 @@ struct FifoFrameInfo
 
   // Must be sorted by fifoPosition
   std::vector<MemoryUpdate> memoryUpdates;
+
+  // The CP registers which the size of vertices depends on, as they were at the start of the
+  // frame: VCD_LO, VCD_HI, then the VAT_A, VAT_B and VAT_C registers of each vertex format. With
+  // these, frames can be analyzed independently of each other. Either NUM_VERTEX_REGS long, or
+  // empty for frames recorded before version 7.
+  std::vector<u32> vertexRegs;
 };
 
 class FifoDataFile
@@ -73,8 +85,12 @@ public:
   u32 GetExRamSizeReal() { return m_exram_size_real; }
 
   void AddFrame(const FifoFrameInfo& frameInfo);
-  const FifoFrameInfo& GetFrame(u32 frame) const { return m_Frames[frame]; }
+  // Frames of a loaded file may be read from the file, so keep the returned pointer for as long
+  // as the frame is used. Can be called from any thread.
+  std::shared_ptr<const FifoFrameInfo> GetFrame(u32 frame) const;
   u32 GetFrameCount() const { return static_cast<u32>(m_Frames.size()); }
+  // Identifies the recording of a file which is read lazily, for caching what is derived from it.
+  std::optional<u64> GetFileHash() const { return m_file_hash; }
   bool Save(const std::string& filename);
 
   static std::unique_ptr<FifoDataFile> Load(const std::string& filename, bool flagsOnly);
@@ -85,15 +101,30 @@ private:
     FLAG_IS_WII = 1
   };
 
+  // Where a frame is stored in a file which is read lazily.
+  struct StoredFrame
+  {
+    u64 offset;
+    u32 compressed_size;
+    u32 fifo_data_size;
+    u32 fifo_start;
+    u32 fifo_end;
+    u32 num_memory_updates;
+    u32 num_vertex_regs;
+  };
+
   void PadFile(size_t numBytes, File::IOFile& file);
 
   void SetFlag(u32 flag, bool set);
   bool GetFlag(u32 flag) const;
 
-  u64 WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
   static void ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
                                 std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
 
+  bool ReadFromFile(u64 offset, void* data, size_t size) const;
+  bool ReadStoredFrame(u32 frame, FifoFrameInfo* frame_info) const;
+  bool ReadMemoryUpdateData(u64 offset, u32 size, std::vector<u8>* data) const;
+
   u32 m_BPMem[BP_MEM_SIZE];
   u32 m_CPMem[CP_MEM_SIZE];
   u32 m_XFMem[XF_MEM_SIZE];
@@ -105,5 +136,20 @@ private:
   u32 m_Flags = 0;
   u32 m_Version = 0;
 
-  std::vector<FifoFrameInfo> m_Frames;
+  // Frames which are in memory. These are all of them, unless the file is read lazily, in which
+  // case frames are loaded by GetFrame and the oldest loaded ones are released again.
+  mutable std::vector<std::shared_ptr<const FifoFrameInfo>> m_Frames;
+
+  // Only used when the file is read lazily. Guarded by m_file_lock, as is m_Frames then. Frames
+  // are decompressed without holding the lock, so that several threads can read frames at once.
+  std::vector<StoredFrame> m_stored_frames;
+  std::optional<u64> m_file_hash;
+  std::unique_ptr<File::IOFile> m_file;
+  mutable std::mutex m_file_lock;
+  mutable std::deque<u32> m_loaded_frames;
+  mutable size_t m_loaded_frames_size = 0;
+  // Data which many memory updates share, such as textures uploaded every frame, is only stored
+  // once in the file, so it is also only decompressed once.
+  mutable std::unordered_map<u64, std::vector<u8>> m_data_cache;
+  mutable size_t m_data_cache_size = 0;
 };
@@ -4,9 +4,22 @@
 
 #include "Core/FifoPlayer/FifoPlaybackAnalyzer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
 #include <vector>
 
+#include <fmt/format.h>
+
+#include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Common/MsgHandler.h"
 #include "Core/FifoPlayer/FifoAnalyzer.h"
 #include "Core/FifoPlayer/FifoDataFile.h"
 
@@ -21,82 +34,228 @@ struct CmdData
   const u8* ptr;
 };
 
-void FifoPlaybackAnalyzer::AnalyzeFrames(FifoDataFile* file,
-                                         std::vector<AnalyzedFrameInfo>& frameInfo)
+namespace
 {
-  u32* cpMem = file->GetCPMem();
-  FifoAnalyzer::LoadCPReg(0x50, cpMem[0x50], s_CpMem);
-  FifoAnalyzer::LoadCPReg(0x60, cpMem[0x60], s_CpMem);
+constexpr u32 CACHE_FILE_ID = 0x46494641;  // "AFIF"
+constexpr u32 CACHE_VERSION = 1;
 
-  for (int i = 0; i < 8; ++i)
+struct CacheHeader
+{
+  u32 id;
+  u32 version;
+  u64 file_hash;
+  u32 frame_count;
+  u32 reserved;
+};
+
+struct FrameState
+{
+  bool analyzed = false;
+  // The offset of the command which could not be analyzed, if any.
+  std::optional<u32> error_offset;
+  // The state at the end of the frame, where the next frame starts.
+  CPMemory cp_mem;
+};
+}  // namespace
+
+static std::string GetCachePath(u64 file_hash)
+{
+  return File::GetUserPath(D_CACHE_IDX) + fmt::format("{:016x}.fifoanalysis", file_hash);
+}
+
+static bool LoadCachedAnalysis(u64 file_hash, u32 frame_count,
+                               std::vector<AnalyzedFrameInfo>& frameInfo)
+{
+  File::IOFile file(GetCachePath(file_hash), "rb");
+  CacheHeader header;
+  if (!file || !file.ReadArray(&header, 1) || header.id != CACHE_FILE_ID ||
+      header.version != CACHE_VERSION || header.file_hash != file_hash ||
+      header.frame_count != frame_count)
   {
-    FifoAnalyzer::LoadCPReg(0x70 + i, cpMem[0x70 + i], s_CpMem);
-    FifoAnalyzer::LoadCPReg(0x80 + i, cpMem[0x80 + i], s_CpMem);
-    FifoAnalyzer::LoadCPReg(0x90 + i, cpMem[0x90 + i], s_CpMem);
+    return false;
   }
 
-  frameInfo.clear();
-  frameInfo.resize(file->GetFrameCount());
+  std::vector<u32> sizes(frame_count * 2);
+  if (!file.ReadArray(sizes.data(), sizes.size()))
+    return false;
 
-  for (u32 frameIdx = 0; frameIdx < file->GetFrameCount(); ++frameIdx)
+  std::vector<AnalyzedFrameInfo> cached(frame_count);
+  for (u32 i = 0; i < frame_count; ++i)
   {
-    const FifoFrameInfo& frame = file->GetFrame(frameIdx);
-    AnalyzedFrameInfo& analyzed = frameInfo[frameIdx];
+    cached[i].objectStarts.resize(sizes[i * 2]);
+    cached[i].objectEnds.resize(sizes[i * 2 + 1]);
+    if (!file.ReadArray(cached[i].objectStarts.data(), cached[i].objectStarts.size()) ||
+        !file.ReadArray(cached[i].objectEnds.data(), cached[i].objectEnds.size()))
+    {
+      return false;
+    }
+  }
 
-    s_DrawingObject = false;
+  frameInfo = std::move(cached);
+  return true;
+}
 
-    u32 cmdStart = 0;
-    u32 nextMemUpdate = 0;
+static void SaveCachedAnalysis(u64 file_hash, const std::vector<AnalyzedFrameInfo>& frameInfo)
+{
+  const std::string path = GetCachePath(file_hash);
+  File::CreateFullPath(path);
+  File::IOFile file(path, "wb");
+  if (!file)
+    return;
+
+  const CacheHeader header{CACHE_FILE_ID, CACHE_VERSION, file_hash,
+                           static_cast<u32>(frameInfo.size()), 0};
+  std::vector<u32> sizes;
+  sizes.reserve(frameInfo.size() * 2);
+  for (const AnalyzedFrameInfo& analyzed : frameInfo)
+  {
+    sizes.push_back(static_cast<u32>(analyzed.objectStarts.size()));
+    sizes.push_back(static_cast<u32>(analyzed.objectEnds.size()));
+  }
+
+  bool success = file.WriteArray(&header, 1) && file.WriteArray(sizes.data(), sizes.size());
+  for (const AnalyzedFrameInfo& analyzed : frameInfo)
+  {
+    success = success &&
+              file.WriteArray(analyzed.objectStarts.data(), analyzed.objectStarts.size()) &&
+              file.WriteArray(analyzed.objectEnds.data(), analyzed.objectEnds.size());
+  }
+
+  // Don't leave a partial file behind, e.g. if the disk is full.
+  if (!file.Close() || !success)
+  {
+    WARN_LOG_FMT(COMMON, "Failed to write the FIFO analysis cache {}", path);
+    File::Delete(path);
+  }
+}
+
+static void AnalyzeFrame(const FifoFrameInfo& frame, FrameState& state,
+                         AnalyzedFrameInfo& analyzed)
+{
+  bool drawingObject = false;
+
+  u32 cmdStart = 0;
 
 #if LOG_FIFO_CMDS
-    // Debugging
-    std::vector<CmdData> prevCmds;
+  // Debugging
+  std::vector<CmdData> prevCmds;
 #endif
 
-    while (cmdStart < frame.fifoData.size())
-    {
-      // Add memory updates that have occurred before this point in the frame
-      while (nextMemUpdate < frame.memoryUpdates.size() &&
-             frame.memoryUpdates[nextMemUpdate].fifoPosition <= cmdStart)
-      {
-        analyzed.memoryUpdates.push_back(frame.memoryUpdates[nextMemUpdate]);
-        ++nextMemUpdate;
-      }
-
-      const bool wasDrawing = s_DrawingObject;
-      const u32 cmdSize =
-          FifoAnalyzer::AnalyzeCommand(&frame.fifoData[cmdStart], DecodeMode::Playback);
+  while (cmdStart < frame.fifoData.size())
+  {
+    const bool wasDrawing = drawingObject;
+    const u32 cmdSize = FifoAnalyzer::AnalyzePlaybackCommand(&frame.fifoData[cmdStart],
+                                                             state.cp_mem, drawingObject);
 
 #if LOG_FIFO_CMDS
-      CmdData cmdData;
-      cmdData.offset = cmdStart;
-      cmdData.ptr = &frame.fifoData[cmdStart];
-      cmdData.size = cmdSize;
-      prevCmds.push_back(cmdData);
+    CmdData cmdData;
+    cmdData.offset = cmdStart;
+    cmdData.ptr = &frame.fifoData[cmdStart];
+    cmdData.size = cmdSize;
+    prevCmds.push_back(cmdData);
 #endif
 
-      // Check for error
-      if (cmdSize == 0)
-      {
-        // Clean up frame analysis
-        analyzed.objectStarts.clear();
-        analyzed.objectEnds.clear();
-
-        return;
-      }
-
-      if (wasDrawing != s_DrawingObject)
-      {
-        if (s_DrawingObject)
-          analyzed.objectStarts.push_back(cmdStart);
-        else
-          analyzed.objectEnds.push_back(cmdStart);
-      }
-
-      cmdStart += cmdSize;
+    // Check for error
+    if (cmdSize == 0)
+    {
+      // Clean up frame analysis
+      analyzed.objectStarts.clear();
+      analyzed.objectEnds.clear();
+      state.error_offset = cmdStart;
+      break;
+    }
+
+    if (wasDrawing != drawingObject)
+    {
+      if (drawingObject)
+        analyzed.objectStarts.push_back(cmdStart);
+      else
+        analyzed.objectEnds.push_back(cmdStart);
+    }
+
+    cmdStart += cmdSize;
+  }
+
+  if (analyzed.objectEnds.size() < analyzed.objectStarts.size())
+    analyzed.objectEnds.push_back(cmdStart);
+
+  state.analyzed = true;
+}
+
+void FifoPlaybackAnalyzer::AnalyzeFrames(FifoDataFile* file,
+                                         std::vector<AnalyzedFrameInfo>& frameInfo)
+{
+  const u32 frameCount = file->GetFrameCount();
+  const std::optional<u64> fileHash = file->GetFileHash();
+  if (fileHash && LoadCachedAnalysis(*fileHash, frameCount, frameInfo))
+    return;
+
+  CPMemory initialCpMem{};
+  u32* cpMem = file->GetCPMem();
+  FifoAnalyzer::LoadCPReg(0x50, cpMem[0x50], initialCpMem);
+  FifoAnalyzer::LoadCPReg(0x60, cpMem[0x60], initialCpMem);
+
+  for (int i = 0; i < 8; ++i)
+  {
+    FifoAnalyzer::LoadCPReg(0x70 + i, cpMem[0x70 + i], initialCpMem);
+    FifoAnalyzer::LoadCPReg(0x80 + i, cpMem[0x80 + i], initialCpMem);
+    FifoAnalyzer::LoadCPReg(0x90 + i, cpMem[0x90 + i], initialCpMem);
+  }
+
+  frameInfo.clear();
+  frameInfo.resize(frameCount);
+  std::vector<FrameState> states(frameCount);
+
+  // Frames which were recorded along with the state they start with are analyzed by the workers,
+  // in any order. The first frame starts with the state saved in the file.
+  std::atomic<u32> nextFrame{0};
+  std::atomic<bool> failed{false};
+  const auto analyze_independent_frames = [&] {
+    for (u32 i = nextFrame++; i < frameCount && !failed; i = nextFrame++)
+    {
+      const std::shared_ptr<const FifoFrameInfo> frame = file->GetFrame(i);
+      if (frame->vertexRegs.empty() && i != 0)
+        continue;
+
+      states[i].cp_mem = initialCpMem;
+      if (!frame->vertexRegs.empty())
+        FifoAnalyzer::LoadVertexRegs(frame->vertexRegs, states[i].cp_mem);
+      AnalyzeFrame(*frame, states[i], frameInfo[i]);
+      if (states[i].error_offset)
+        failed = true;
     }
+  };
 
-    if (analyzed.objectEnds.size() < analyzed.objectStarts.size())
-      analyzed.objectEnds.push_back(cmdStart);
+  const u32 numWorkers =
+      std::clamp(std::thread::hardware_concurrency(), 1u, std::max(frameCount, 1u));
+  std::vector<std::thread> workers;
+  for (u32 i = 1; i < numWorkers; ++i)
+    workers.emplace_back(analyze_independent_frames);
+  analyze_independent_frames();
+  for (std::thread& worker : workers)
+    worker.join();
+
+  // Older recordings don't have the state, so their frames continue from the end of the previous
+  // frame instead. Analysis stops at the first frame with an unknown command. The workers stop
+  // early if they find one, so even the first frame may not have been analyzed yet.
+  for (u32 i = 0; i < frameCount; ++i)
+  {
+    FrameState& state = states[i];
+    if (!state.analyzed)
+    {
+      state.cp_mem = i == 0 ? initialCpMem : states[i - 1].cp_mem;
+      AnalyzeFrame(*file->GetFrame(i), state, frameInfo[i]);
+    }
+
+    if (state.error_offset)
+    {
+      PanicAlertFmt("FifoPlayer: Unknown Opcode ({:#x}).\n",
+                    file->GetFrame(i)->fifoData[*state.error_offset]);
+      std::fill(frameInfo.begin() + i + 1, frameInfo.end(), AnalyzedFrameInfo{});
+      return;
+    }
   }
+
+  if (fileHash)
+    SaveCachedAnalysis(*fileHash, frameInfo);
 }
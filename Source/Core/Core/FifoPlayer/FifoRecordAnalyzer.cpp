@@ -19,7 +19,11 @@ void FifoRecordAnalyzer::Initialize(const u32* cpMem)
   FifoAnalyzer::LoadCPReg(0x50, *(cpMem + 0x50), s_CpMem);
   FifoAnalyzer::LoadCPReg(0x60, *(cpMem + 0x60), s_CpMem);
   for (int i = 0; i < 8; ++i)
+  {
     FifoAnalyzer::LoadCPReg(0x70 + i, *(cpMem + 0x70 + i), s_CpMem);
+    FifoAnalyzer::LoadCPReg(0x80 + i, *(cpMem + 0x80 + i), s_CpMem);
+    FifoAnalyzer::LoadCPReg(0x90 + i, *(cpMem + 0x90 + i), s_CpMem);
+  }
 
   const u32* const bases_start = cpMem + 0xA0;
   const u32* const bases_end = bases_start + s_CpMem.arrayBases.size();
@@ -108,6 +108,8 @@ void FifoRecorder::WriteGPCommand(const u8* data, u32 size)
     }
 
     m_CurrentFrame.memoryUpdates.clear();
+    // The next frame starts with the state left behind by the commands of this one.
+    m_CurrentFrame.vertexRegs = FifoAnalyzer::GetVertexRegs(FifoAnalyzer::s_CpMem);
     m_FifoData.clear();
     m_FrameEnded = false;
   }
@@ -213,6 +215,7 @@ void FifoRecorder::SetVideoMemory(const u32* bpMem, const u32* cpMem, const u32*
   }
 
   FifoRecordAnalyzer::Initialize(cpMem);
+  m_CurrentFrame.vertexRegs = FifoAnalyzer::GetVertexRegs(FifoAnalyzer::s_CpMem);
 }
 
 bool FifoRecorder::IsRecording() const
@@ -17,6 +17,7 @@
 #include "Common/Event.h"
 #include "Common/Flag.h"
 #include "Common/Logging/Log.h"
+#include "Common/Metrics.h"
 #include "Common/MsgHandler.h"
 #include "Common/SPSCQueue.h"
 #include "Common/Thread.h"
@@ -88,6 +89,9 @@ static std::map<u64, ReadResult> s_result_map;
 
 static std::unique_ptr<DiscIO::Volume> s_disc;
 
+static Common::Metrics::Histogram s_read_time_metric(Common::Metrics::Thread::DVD, "read_time_us");
+static Common::Metrics::Counter s_bytes_read_metric(Common::Metrics::Thread::DVD, "bytes_read");
+
 void Start()
 {
   s_finish_read = CoreTiming::RegisterEvent("FinishReadDVDThread", FinishRead);
@@ -379,8 +383,12 @@ static void DVDThread()
       FileMonitor::Log(*s_disc, request.partition, request.dvd_offset);
 
       std::vector<u8> buffer(request.length);
-      if (!s_disc->Read(request.dvd_offset, request.length, buffer.data(), request.partition))
-        buffer.resize(0);
+      {
+        Common::Metrics::ScopedTimer timer(&s_read_time_metric);
+        if (!s_disc->Read(request.dvd_offset, request.length, buffer.data(), request.partition))
+          buffer.resize(0);
+      }
+      s_bytes_read_metric.Add(buffer.size());
 
       request.realtime_done_us = Common::Timer::GetTimeUs();
 
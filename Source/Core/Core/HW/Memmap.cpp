@@ -12,12 +12,18 @@
 #include <algorithm>
 #include <array>
 #include <cstring>
+#include <map>
 #include <memory>
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Common/MemArena.h"
+#include "Common/MemoryUtil.h"
 #include "Common/Swap.h"
 #include "Core/Config/MainSettings.h"
 #include "Core/ConfigManager.h"
@@ -30,6 +36,7 @@
 #include "Core/HW/ProcessorInterface.h"
 #include "Core/HW/SI/SI.h"
 #include "Core/HW/VideoInterface.h"
+#include "Core/HW/WriteTracker.h"
 #include "Core/HW/WII_IPC.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
 #include "Core/PowerPC/PowerPC.h"
@@ -180,6 +187,7 @@ struct LogicalMemoryView
 {
   void* mapped_pointer;
   u32 mapped_size;
+  u32 physical_address;
 };
 
 // Dolphin allocates memory to represent four regions:
@@ -207,7 +215,9 @@ struct LogicalMemoryView
 //
 // The 4GB starting at logical_base represents access from the CPU
 // with address translation turned on.  This mapping is computed based
-// on the BAT registers.
+// on the BAT registers. Pages which the MMU translates through the page
+// table are mapped one by one on top of that, if the host can map views
+// of that size.
 //
 // Each of these 4GB regions is followed by 4GB of empty space so overflows
 // in address computation in the JIT don't access the wrong memory.
@@ -226,6 +236,57 @@ static std::array<PhysicalMemoryRegion, 4> physical_regions;
 
 static std::vector<LogicalMemoryView> logical_mapped_entries;
 
+struct PageTableMapping
+{
+  LogicalMemoryView view;
+  // Pages whose C bit is clear are mapped read-only, so that the first write takes the slow path,
+  // which sets the bit.
+  bool writable;
+};
+
+// Indexed by the logical address.
+static std::map<u32, PageTableMapping> page_table_mapped_entries;
+static bool can_map_page_table_entries = false;
+
+static bool CanMapSinglePages()
+{
+#ifdef _WIN32
+  // Views have to be aligned to the allocation granularity, which is larger than a page.
+  return false;
+#else
+  return sysconf(_SC_PAGESIZE) == PAGE_TABLE_PAGE_SIZE;
+#endif
+}
+
+static void ReleasePageTableMapping(u32 logical_address)
+{
+  const auto it = page_table_mapped_entries.find(logical_address);
+  if (it == page_table_mapped_entries.end())
+    return;
+
+  g_arena.ReleaseView(it->second.view.mapped_pointer, it->second.view.mapped_size);
+  page_table_mapped_entries.erase(it);
+}
+
+static void ReleasePageTableMappings(u32 logical_address, u32 size)
+{
+  const u64 end_address = u64{logical_address} + size;
+  const auto begin = page_table_mapped_entries.lower_bound(logical_address);
+  const auto end = end_address > 0xFFFFFFFF ?
+                       page_table_mapped_entries.end() :
+                       page_table_mapped_entries.lower_bound(static_cast<u32>(end_address));
+  for (auto it = begin; it != end; ++it)
+    g_arena.ReleaseView(it->second.view.mapped_pointer, it->second.view.mapped_size);
+  page_table_mapped_entries.erase(begin, end);
+}
+
+static void ReleasePageTableMappings()
+{
+  for (auto& entry : page_table_mapped_entries)
+    g_arena.ReleaseView(entry.second.view.mapped_pointer, entry.second.view.mapped_size);
+  page_table_mapped_entries.clear();
+}
+
 static u32 GetFlags()
 {
   bool wii = SConfig::GetInstance().bWii;
@@ -310,6 +371,7 @@ void Init()
     mmio_mapping = InitMMIO();
 
   Clear();
+  WriteTracker::Init();
 
   INFO_LOG_FMT(MEMMAP, "Memory system initialized. RAM at {}", fmt::ptr(m_pRAM));
   m_IsInitialized = true;
@@ -317,6 +379,8 @@ void Init()
 
 bool InitFastmemArena()
 {
+  WriteTracker::ScopedViewChange view_change;
+
   u32 flags = GetFlags();
   physical_base = Common::MemArena::FindMemoryBase();
 
@@ -335,10 +399,12 @@ bool InitFastmemArena()
     {
       return false;
     }
+    view_change.ViewCreated(region.physical_address, region.size);
   }
 
 #ifndef _ARCH_32
   logical_base = physical_base + 0x200000000;
+  can_map_page_table_entries = CanMapSinglePages();
 #endif
 
   is_fastmem_arena_initialized = true;
@@ -350,6 +416,10 @@ void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
   if (!is_fastmem_arena_initialized)
     return;
 
+  WriteTracker::ScopedViewChange view_change;
+
+  // The page table mappings depend on the BATs. The MMU maps pages again as it translates them.
+  ReleasePageTableMappings();
   for (auto& entry : logical_mapped_entries)
   {
     g_arena.ReleaseView(entry.mapped_pointer, entry.mapped_size);
@@ -382,13 +452,91 @@ void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
             PanicAlertFmt("MemoryMap_Setup: Failed finding a memory base.");
             exit(0);
           }
-          logical_mapped_entries.push_back({mapped_pointer, mapped_size});
+          logical_mapped_entries.push_back({mapped_pointer, mapped_size, intersection_start});
+          view_change.ViewCreated(intersection_start, mapped_size);
         }
       }
     }
   }
 }
 
+bool CanMapPageTableEntries()
+{
+  return is_fastmem_arena_initialized && can_map_page_table_entries;
+}
+
+void MapPageTableEntry(u32 logical_address, u32 physical_address, bool writable)
+{
+  if (!CanMapPageTableEntries())
+    return;
+
+  const auto existing = page_table_mapped_entries.find(logical_address);
+  if (existing != page_table_mapped_entries.end() &&
+      existing->second.view.physical_address == physical_address &&
+      existing->second.writable == writable)
+  {
+    return;
+  }
+
+  WriteTracker::ScopedViewChange view_change;
+
+  ReleasePageTableMapping(logical_address);
+
+  const u32 flags = GetFlags();
+  for (const PhysicalMemoryRegion& region : physical_regions)
+  {
+    if ((flags & region.flags) != region.flags || physical_address < region.physical_address ||
+        physical_address - region.physical_address >= region.size)
+    {
+      continue;
+    }
+
+    const u32 position = region.shm_position + physical_address - region.physical_address;
+    void* mapped_pointer =
+        g_arena.CreateView(position, PAGE_TABLE_PAGE_SIZE, logical_base + logical_address);
+    if (!mapped_pointer)
+    {
+      PanicAlertFmt("Failed to map logical address {:#010x}", logical_address);
+      return;
+    }
+    if (!writable)
+      Common::WriteProtectMemory(mapped_pointer, PAGE_TABLE_PAGE_SIZE);
+    page_table_mapped_entries.emplace(
+        logical_address,
+        PageTableMapping{{mapped_pointer, PAGE_TABLE_PAGE_SIZE, physical_address}, writable});
+    view_change.ViewCreated(physical_address, PAGE_TABLE_PAGE_SIZE);
+    return;
+  }
+}
+
+void UnmapPageTableEntry(u32 logical_address)
+{
+  if (page_table_mapped_entries.count(logical_address) == 0)
+    return;
+
+  const WriteTracker::ScopedViewChange view_change;
+  ReleasePageTableMapping(logical_address);
+}
+
+void UnmapPageTableEntries()
+{
+  if (page_table_mapped_entries.empty())
+    return;
+
+  const WriteTracker::ScopedViewChange view_change;
+  ReleasePageTableMappings();
+}
+
+void UnmapPageTableEntries(u32 logical_address, u32 size)
+{
+  const auto it = page_table_mapped_entries.lower_bound(logical_address);
+  if (it == page_table_mapped_entries.end() || u64{it->first} >= u64{logical_address} + size)
+    return;
+
+  const WriteTracker::ScopedViewChange view_change;
+  ReleasePageTableMappings(logical_address, size);
+}
+
 void DoState(PointerWrap& p)
 {
   bool wii = SConfig::GetInstance().bWii;
@@ -405,6 +553,7 @@ void DoState(PointerWrap& p)
 
 void Shutdown()
 {
+  WriteTracker::Shutdown();
   ShutdownFastmemArena();
 
   m_IsInitialized = false;
@@ -426,6 +575,8 @@ void ShutdownFastmemArena()
   if (!is_fastmem_arena_initialized)
     return;
 
+  const WriteTracker::ScopedViewChange view_change;
+
   u32 flags = GetFlags();
   for (PhysicalMemoryRegion& region : physical_regions)
   {
@@ -436,6 +587,7 @@ void ShutdownFastmemArena()
     g_arena.ReleaseView(base, region.size);
   }
 
+  ReleasePageTableMappings();
   for (auto& entry : logical_mapped_entries)
   {
     g_arena.ReleaseView(entry.mapped_pointer, entry.mapped_size);
@@ -460,6 +612,87 @@ void Clear()
     memset(m_pEXRAM, 0, GetExRamSize());
 }
 
+void SetWriteProtection(u32 physical_address, u32 size, bool write_protect)
+{
+  const auto set_protection = [write_protect](u8* pointer, u32 length) {
+    if (write_protect)
+      Common::WriteProtectMemory(pointer, length);
+    else
+      Common::UnWriteProtectMemory(pointer, length);
+  };
+
+  const u32 flags = GetFlags();
+  for (const PhysicalMemoryRegion& region : physical_regions)
+  {
+    if ((flags & region.flags) != region.flags || physical_address < region.physical_address ||
+        physical_address - region.physical_address + size > region.size)
+    {
+      continue;
+    }
+
+    set_protection(*region.out_pointer + (physical_address - region.physical_address), size);
+    if (is_fastmem_arena_initialized)
+      set_protection(physical_base + physical_address, size);
+  }
+
+  const auto protect_view = [&](const LogicalMemoryView& entry) {
+    const u32 start = std::max(physical_address, entry.physical_address);
+    const u32 end = std::min(physical_address + size, entry.physical_address + entry.mapped_size);
+    if (start < end)
+      set_protection(static_cast<u8*>(entry.mapped_pointer) + (start - entry.physical_address),
+                     end - start);
+  };
+  for (const LogicalMemoryView& entry : logical_mapped_entries)
+    protect_view(entry);
+  for (const auto& entry : page_table_mapped_entries)
+  {
+    // Read-only pages stay read-only until the MMU maps them again with their C bit set.
+    if (write_protect || entry.second.writable)
+      protect_view(entry.second.view);
+  }
+}
+
+std::optional<u32> HostAddressToPhysicalAddress(uintptr_t host_address)
+{
+  const u32 flags = GetFlags();
+  for (const PhysicalMemoryRegion& region : physical_regions)
+  {
+    if ((flags & region.flags) != region.flags || !*region.out_pointer)
+      continue;
+
+    const uintptr_t base = reinterpret_cast<uintptr_t>(*region.out_pointer);
+    if (host_address >= base && host_address - base < region.size)
+      return region.physical_address + static_cast<u32>(host_address - base);
+  }
+
+  if (!is_fastmem_arena_initialized)
+    return std::nullopt;
+
+  const uintptr_t physical = reinterpret_cast<uintptr_t>(physical_base);
+  if (host_address >= physical && host_address - physical < 0x100000000ULL)
+    return static_cast<u32>(host_address - physical);
+
+  for (const LogicalMemoryView& entry : logical_mapped_entries)
+  {
+    const uintptr_t base = reinterpret_cast<uintptr_t>(entry.mapped_pointer);
+    if (host_address >= base && host_address - base < entry.mapped_size)
+      return entry.physical_address + static_cast<u32>(host_address - base);
+  }
+
+  const uintptr_t logical = reinterpret_cast<uintptr_t>(logical_base);
+  if (host_address >= logical && host_address - logical < 0x100000000ULL)
+  {
+    const u32 logical_address = static_cast<u32>(host_address - logical);
+    // Writes to read-only pages fault because of the MMU rather than write tracking, so those
+    // faults are left to the JIT.
+    const auto it = page_table_mapped_entries.find(logical_address & ~(PAGE_TABLE_PAGE_SIZE - 1));
+    if (it != page_table_mapped_entries.end() && it->second.writable)
+      return it->second.view.physical_address + (logical_address & (PAGE_TABLE_PAGE_SIZE - 1));
+  }
+
+  return std::nullopt;
+}
+
 static inline u8* GetPointerForRange(u32 address, size_t size)
 {
   // Make sure we don't have a range spanning 2 separate banks
@@ -499,6 +732,7 @@ void CopyToEmu(u32 address, const void* data, size_t size)
     PanicAlertFmt("Invalid range in CopyToEmu. {:x} bytes to {:#010x}", size, address);
     return;
   }
+  const WriteTracker::ScopedExternalWrite tracked_write(address, size);
   memcpy(pointer, data, size);
 }
 
@@ -513,6 +747,7 @@ void Memset(u32 address, u8 value, size_t size)
     PanicAlertFmt("Invalid range in Memset. {:x} bytes at {:#010x}", size, address);
     return;
   }
+  const WriteTracker::ScopedExternalWrite tracked_write(address, size);
   memset(pointer, value, size);
 }
 
@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "Common/CommonTypes.h"
@@ -69,8 +71,25 @@ void DoState(PointerWrap& p);
 
 void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table);
 
+// Maps single pages of the logical arena which the MMU translates through the page table.
+// UpdateLogicalMemory removes all of them, since the BATs take priority over the page table.
+constexpr u32 PAGE_TABLE_PAGE_SIZE = 0x1000;
+// Returns false if the fastmem arena isn't set up, or if the host can't map views this small.
+bool CanMapPageTableEntries();
+void MapPageTableEntry(u32 logical_address, u32 physical_address, bool writable);
+void UnmapPageTableEntry(u32 logical_address);
+void UnmapPageTableEntries();
+void UnmapPageTableEntries(u32 logical_address, u32 size);
+
 void Clear();
 
+// Write-protects (or makes writable again) every host view of a range of physical memory: the
+// m_pRAM/m_pEXRAM views and, when the fastmem arena is set up, the physical and logical views.
+// The range must be page aligned and must not span several regions. Used by WriteTracker.
+void SetWriteProtection(u32 physical_address, u32 size, bool write_protect);
+// Returns the physical address that a host address inside one of the views above maps to.
+std::optional<u32> HostAddressToPhysicalAddress(uintptr_t host_address);
+
 // Routines to access physically addressed memory, designed for use by
 // emulated hardware outside the CPU. Use "Device_" prefix.
 std::string GetString(u32 em_address, size_t size = 0);
@@ -0,0 +1,405 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/HW/WriteTracker.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "Common/Assert.h"
+#include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
+#include "Common/MathUtil.h"
+#include "Core/HW/Memmap.h"
+
+namespace WriteTracker
+{
+// Mirrors the platforms on which EMM::InstallExceptionHandler catches faults from every thread.
+// The Mach exception handler only covers the thread that installed it.
+#if defined(_WIN32) ||                                                                             \
+    (defined(_POSIX_VERSION) && !defined(_M_GENERIC) &&                                            \
+     !(defined(__APPLE__) && !defined(USE_SIGACTION_ON_APPLE)))
+constexpr bool PLATFORM_SUPPORTED = true;
+#else
+constexpr bool PLATFORM_SUPPORTED = false;
+#endif
+
+namespace
+{
+struct Page
+{
+  // Clock value at which the page was write-protected, or 0 while it is writable.
+  std::atomic<u64> protected_since{0};
+  // Number of ScopedExternalWrites covering this page. Only accessed with s_lock held.
+  u32 external_writes = 0;
+};
+
+struct Region
+{
+  u32 physical_address = 0;
+  u32 size = 0;
+  std::unique_ptr<Page[]> pages;
+};
+
+struct PageRange
+{
+  Region* region;
+  u32 first;
+  u32 last;
+};
+
+// HandleFault runs in a signal handler, where a std::mutex must not be locked. The lock is only
+// held briefly, and never while writing to emulated memory, so the thread holding it cannot fault
+// on a protected page and wait for itself.
+class SpinLock
+{
+public:
+  void lock()
+  {
+    while (m_flag.test_and_set(std::memory_order_acquire))
+    {
+    }
+  }
+  void unlock() { m_flag.clear(std::memory_order_release); }
+
+private:
+  std::atomic_flag m_flag = ATOMIC_FLAG_INIT;
+};
+
+SpinLock s_lock;
+std::atomic<bool> s_enabled{false};
+std::atomic<bool> s_handler_installed{false};
+// Set once protection has been applied, so faults from unrelated code (e.g. fastmem accesses to
+// MMIO) do not have to look up the tracker state when tracking was never used.
+std::atomic<bool> s_used{false};
+std::array<Region, 2> s_regions;
+u32 s_page_shift = 12;
+u64 s_clock = 0;
+// Incremented whenever protection is removed from pages.
+u64 s_unprotect_count = 0;
+}  // namespace
+
+static u32 GetHostPageSize()
+{
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwPageSize;
+#else
+  return static_cast<u32>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+// Uses the same mirroring as Memory::GetPointer.
+static std::optional<PageRange> FindPages(u32 address, u32 size)
+{
+  if (size == 0)
+    return std::nullopt;
+
+  address &= 0x3FFFFFFF;
+  for (Region& region : s_regions)
+  {
+    if (!region.pages || address < region.physical_address)
+      continue;
+
+    const u32 offset = address - region.physical_address;
+    if (offset >= region.size || region.size - offset < size)
+      continue;
+
+    return PageRange{&region, offset >> s_page_shift, (offset + size - 1) >> s_page_shift};
+  }
+
+  return std::nullopt;
+}
+
+static void SetPageProtection(const Region& region, u32 first, u32 end, bool write_protect)
+{
+  if (!write_protect)
+    s_unprotect_count++;
+  Memory::SetWriteProtection(region.physical_address + (first << s_page_shift),
+                             (end - first) << s_page_shift, write_protect);
+}
+
+static void ProtectPages(Region& region, u32 first, u32 end)
+{
+  SetPageProtection(region, first, end, true);
+  for (u32 i = first; i < end; i++)
+    region.pages[i].protected_since.store(++s_clock, std::memory_order_release);
+}
+
+// Calls the function for each run of consecutive pages in [first, last] matching the predicate.
+template <typename Predicate, typename Function>
+static void ForEachRun(const Region& region, u32 first, u32 last, Predicate predicate,
+                       Function function)
+{
+  u32 run_start = first;
+  bool in_run = false;
+  for (u32 i = first; i <= last; i++)
+  {
+    const bool matches = predicate(region.pages[i]);
+    if (matches && !in_run)
+    {
+      run_start = i;
+      in_run = true;
+    }
+    else if (!matches && in_run)
+    {
+      function(run_start, i);
+      in_run = false;
+    }
+  }
+  if (in_run)
+    function(run_start, last + 1);
+}
+
+static bool IsProtected(const Page& page)
+{
+  return page.protected_since.load(std::memory_order_relaxed) != 0;
+}
+
+static void UnprotectAll()
+{
+  for (Region& region : s_regions)
+  {
+    if (!region.pages)
+      continue;
+
+    const u32 last = (region.size >> s_page_shift) - 1;
+    ForEachRun(region, 0, last, IsProtected, [&region](u32 first, u32 end) {
+      SetPageProtection(region, first, end, false);
+      for (u32 i = first; i < end; i++)
+        region.pages[i].protected_since.store(0, std::memory_order_release);
+    });
+  }
+}
+
+void Init()
+{
+  std::lock_guard lock(s_lock);
+
+  s_page_shift = static_cast<u32>(IntLog2(GetHostPageSize()));
+  s_clock = 0;
+  s_used = false;
+
+  s_regions[0] = {0x00000000, Memory::GetRamSize(), nullptr};
+  s_regions[1] = {0x10000000, Memory::m_pEXRAM ? Memory::GetExRamSize() : 0, nullptr};
+  for (Region& region : s_regions)
+  {
+    if (region.size != 0)
+      region.pages = std::make_unique<Page[]>(region.size >> s_page_shift);
+  }
+}
+
+void Shutdown()
+{
+  std::lock_guard lock(s_lock);
+
+  UnprotectAll();
+  for (Region& region : s_regions)
+    region = {};
+}
+
+void SetEnabled(bool enabled)
+{
+  std::lock_guard lock(s_lock);
+
+  if (enabled && !PLATFORM_SUPPORTED)
+  {
+    WARN_LOG_FMT(VIDEO, "Write tracking is not supported on this platform");
+    return;
+  }
+
+  s_enabled = enabled;
+  if (!enabled)
+    UnprotectAll();
+}
+
+bool IsEnabled()
+{
+  return s_enabled && s_handler_installed;
+}
+
+void SetExceptionHandlerInstalled(bool installed)
+{
+  std::lock_guard lock(s_lock);
+
+  s_handler_installed = installed && PLATFORM_SUPPORTED;
+  if (!installed)
+    UnprotectAll();
+}
+
+u64 Protect(u32 address, u32 size)
+{
+  if (!IsEnabled())
+    return 0;
+
+  const std::optional<PageRange> range = FindPages(address, size);
+  if (!range)
+    return 0;
+
+  std::lock_guard lock(s_lock);
+
+  // Recheck now that we hold the lock, as tracking may have been disabled in the meantime.
+  if (!IsEnabled() || !range->region->pages)
+    return 0;
+
+  s_used = true;
+  Region& region = *range->region;
+  ForEachRun(
+      region, range->first, range->last,
+      [](const Page& page) { return !IsProtected(page) && page.external_writes == 0; },
+      [&region](u32 first, u32 end) { ProtectPages(region, first, end); });
+
+  return ++s_clock;
+}
+
+bool IsUnmodified(u32 address, u32 size, u64 stamp)
+{
+  if (stamp == 0)
+    return false;
+
+  const std::optional<PageRange> range = FindPages(address, size);
+  if (!range)
+    return false;
+
+  // A page that is still protected, and was protected before the stamp was taken, cannot have
+  // been written since: the first write would have removed the protection.
+  for (u32 i = range->first; i <= range->last; i++)
+  {
+    const u64 protected_since =
+        range->region->pages[i].protected_since.load(std::memory_order_acquire);
+    if (protected_since == 0 || protected_since > stamp)
+      return false;
+  }
+
+  return true;
+}
+
+bool HandleFault(uintptr_t access_address)
+{
+  if (!s_used)
+    return false;
+
+  // The access that was last retried by this thread without lifting any protection, and the
+  // value of s_unprotect_count at that time.
+  static thread_local std::pair<uintptr_t, u64> s_retried_access{0, 0};
+
+  // The views are only changed with the lock held, so they have to be looked up with it held.
+  std::lock_guard lock(s_lock);
+
+  const std::optional<u32> physical_address = Memory::HostAddressToPhysicalAddress(access_address);
+  if (!physical_address)
+    return false;
+
+  const std::optional<PageRange> range = FindPages(*physical_address, 1);
+  if (!range || !range->region->pages)
+    return false;
+
+  Page& page = range->region->pages[range->first];
+  if (IsProtected(page))
+  {
+    // Mark the page as written before it becomes writable again.
+    page.protected_since.store(0, std::memory_order_release);
+    SetPageProtection(*range->region, range->first, range->first + 1, false);
+    return true;
+  }
+
+  // Another thread may have lifted the protection between the fault and us taking the lock, in
+  // which case retrying the access succeeds. If the same access faults again before any more
+  // protection is lifted, the page is protected for some other reason, and the fault isn't ours.
+  const std::pair<uintptr_t, u64> access{access_address, s_unprotect_count};
+  if (s_retried_access == access)
+    return false;
+  s_retried_access = access;
+  return true;
+}
+
+ScopedExternalWrite::ScopedExternalWrite(u32 address, size_t size)
+    : m_address(address), m_size(static_cast<u32>(size)), m_active(false)
+{
+  if (!s_used)
+    return;
+
+  const std::optional<PageRange> range = FindPages(address, m_size);
+  if (!range)
+    return;
+
+  std::lock_guard lock(s_lock);
+
+  if (!range->region->pages)
+    return;
+
+  m_active = true;
+  Region& region = *range->region;
+  for (u32 i = range->first; i <= range->last; i++)
+    region.pages[i].external_writes++;
+
+  ForEachRun(region, range->first, range->last, IsProtected, [&region](u32 first, u32 end) {
+    for (u32 i = first; i < end; i++)
+      region.pages[i].protected_since.store(0, std::memory_order_release);
+    SetPageProtection(region, first, end, false);
+  });
+}
+
+ScopedExternalWrite::~ScopedExternalWrite()
+{
+  if (!m_active)
+    return;
+
+  const std::optional<PageRange> range = FindPages(m_address, m_size);
+  std::lock_guard lock(s_lock);
+
+  if (!range || !range->region->pages)
+    return;
+
+  for (u32 i = range->first; i <= range->last; i++)
+  {
+    DEBUG_ASSERT(range->region->pages[i].external_writes != 0);
+    range->region->pages[i].external_writes--;
+  }
+}
+
+ScopedViewChange::ScopedViewChange()
+{
+  s_lock.lock();
+}
+
+ScopedViewChange::~ScopedViewChange()
+{
+  s_lock.unlock();
+}
+
+void ScopedViewChange::ViewCreated(u32 physical_address, u32 size)
+{
+  if (!s_used)
+    return;
+
+  const u64 end = u64{physical_address} + size;
+  for (Region& region : s_regions)
+  {
+    const u64 region_end = u64{region.physical_address} + region.size;
+    if (!region.pages || physical_address >= region_end || end <= region.physical_address)
+      continue;
+
+    const u32 start = std::max(physical_address, region.physical_address);
+    const u32 last = static_cast<u32>(std::min(end, region_end) - 1);
+    ForEachRun(region, (start - region.physical_address) >> s_page_shift,
+               (last - region.physical_address) >> s_page_shift, IsProtected,
+               [&region](u32 first, u32 end_page) {
+                 SetPageProtection(region, first, end_page, true);
+               });
+  }
+}
+}  // namespace WriteTracker
@@ -0,0 +1,71 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Common/CommonTypes.h"
+
+// Detects writes to emulated RAM by write-protecting the host pages that back it, so consumers
+// (such as the texture cache) only need to rehash memory that was actually written.
+//
+// Protect() write-protects a range in every host view of the memory (including the fastmem
+// views) and returns a stamp. The first write to a protected page faults, and the fault handler in
+// MemTools lifts the protection again. IsUnmodified() then reports whether any page of a range has
+// lost its protection since the stamp was taken.
+//
+// Writes which the host kernel performs on our behalf (e.g. read() or recv() directly into
+// emulated memory) do not raise a fault, they fail instead. Such writes, and bulk copies which
+// would otherwise fault once per page, must be wrapped in a ScopedExternalWrite.
+namespace WriteTracker
+{
+void Init();
+void Shutdown();
+
+// Tracking is off by default, and only active while the exception handler from MemTools is
+// installed. Disabling it, or removing the handler, removes all protection.
+void SetEnabled(bool enabled);
+void SetExceptionHandlerInstalled(bool installed);
+bool IsEnabled();
+
+// Returns 0 if the range cannot be tracked (tracking disabled, or not in RAM/EXRAM).
+u64 Protect(u32 address, u32 size);
+// Returns true if no part of the range has been written since Protect() returned the stamp.
+bool IsUnmodified(u32 address, u32 size, u64 stamp);
+
+// Called by the exception handler. Returns true if the fault was caused by write tracking.
+bool HandleFault(uintptr_t access_address);
+
+// Keeps the range unprotected for the lifetime of the object.
+class ScopedExternalWrite final
+{
+public:
+  ScopedExternalWrite(u32 address, size_t size);
+  ~ScopedExternalWrite();
+
+  ScopedExternalWrite(const ScopedExternalWrite&) = delete;
+  ScopedExternalWrite& operator=(const ScopedExternalWrite&) = delete;
+
+private:
+  u32 m_address;
+  u32 m_size;
+  bool m_active;
+};
+
+// Memmap creates and destroys the fastmem views while this object is alive. New views are
+// writable, so each one has to be passed to ViewCreated, which protects it like the other views.
+class ScopedViewChange final
+{
+public:
+  ScopedViewChange();
+  ~ScopedViewChange();
+
+  ScopedViewChange(const ScopedViewChange&) = delete;
+  ScopedViewChange& operator=(const ScopedViewChange&) = delete;
+
+  void ViewCreated(u32 physical_address, u32 size);
+};
+}  // namespace WriteTracker
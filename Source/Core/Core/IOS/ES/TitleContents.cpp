@@ -10,6 +10,7 @@
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Core/HW/Memmap.h"
+#include "Core/HW/WriteTracker.h"
 #include "Core/IOS/ES/Formats.h"
 #include "Core/IOS/Uids.h"
 
@@ -108,6 +109,7 @@ IPCCommandResult ES::ReadContent(u32 uid, const IOCtlVRequest& request)
   const u32 size = request.io_vectors[0].size;
   const u32 addr = request.io_vectors[0].address;
 
+  WriteTracker::ScopedExternalWrite external_write(addr, size);
   return GetDefaultReply(ReadContent(cfd, Memory::GetPointer(addr), size, uid));
 }
 
@@ -22,6 +22,7 @@
 #include "Core/Config/MainSettings.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/HW/WriteTracker.h"
 #include "Core/IOS/Device.h"
 #include "Core/IOS/IOS.h"
 
@@ -610,6 +611,7 @@ void WiiSocket::Update(bool read, bool write, bool except)
           }
 #endif
           socklen_t addrlen = sizeof(sockaddr_in);
+          WriteTracker::ScopedExternalWrite external_write(BufferOut, BufferOutSize);
           const int ret = recvfrom(fd, data, data_len, flags,
                                    BufferOutSize2 ? (struct sockaddr*)&local_name : nullptr,
                                    BufferOutSize2 ? &addrlen : nullptr);
@@ -18,6 +18,7 @@
 #include "Core/Config/MainSettings.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/Memmap.h"
+#include "Core/HW/WriteTracker.h"
 #include "Core/IOS/IOS.h"
 #include "Core/IOS/VersionInfo.h"
 
@@ -255,6 +256,7 @@ s32 SDIOSlot0::ExecuteCommand(const Request& request, u32 buffer_in, u32 buffer_
       if (!m_card.Seek(address, SEEK_SET))
         ERROR_LOG_FMT(IOS_SD, "Seek failed WTF");
 
+      WriteTracker::ScopedExternalWrite external_write(req.addr, size);
       if (m_card.ReadBytes(Memory::GetPointer(req.addr), size))
       {
         DEBUG_LOG_FMT(IOS_SD, "Outbuffer size {} got {}", rw_buffer_size, size);
@@ -15,6 +15,7 @@
 #include "Common/Logging/Log.h"
 #include "Common/NandPaths.h"
 #include "Core/HW/Memmap.h"
+#include "Core/HW/WriteTracker.h"
 
 namespace IOS::HLE
 {
@@ -297,7 +298,10 @@ IPCCommandResult WFSSRV::IOCtl(const IOCtlRequest& request)
       fd_obj->file.Seek(position, SEEK_SET);
     }
     size_t read_bytes;
-    fd_obj->file.ReadArray(Memory::GetPointer(addr), size, &read_bytes);
+    {
+      WriteTracker::ScopedExternalWrite external_write(addr, size);
+      fd_obj->file.ReadArray(Memory::GetPointer(addr), size, &read_bytes);
+    }
     // TODO(wfs): Handle read errors.
     if (absolute)
     {
@@ -14,6 +14,7 @@
 #include "Common/MsgHandler.h"
 #include "Common/Thread.h"
 
+#include "Core/HW/WriteTracker.h"
 #include "Core/MachineContext.h"
 #include "Core/PowerPC/JitInterface.h"
 
@@ -26,6 +27,16 @@
 
 namespace EMM
 {
+[[maybe_unused]] static bool HandleFault(uintptr_t access_address, SContext* ctx)
+{
+  // Write tracking protects pages that fastmem also maps, so it has to see the fault before the
+  // JIT tries to backpatch the access.
+  if (WriteTracker::HandleFault(access_address))
+    return true;
+
+  return JitInterface::HandleFault(access_address, ctx);
+}
+
 #ifdef _WIN32
 
 static LONG NTAPI Handler(PEXCEPTION_POINTERS pPtrs)
@@ -44,7 +55,7 @@ static LONG NTAPI Handler(PEXCEPTION_POINTERS pPtrs)
     uintptr_t badAddress = (uintptr_t)pPtrs->ExceptionRecord->ExceptionInformation[1];
     CONTEXT* ctx = pPtrs->ContextRecord;
 
-    if (JitInterface::HandleFault(badAddress, ctx))
+    if (HandleFault(badAddress, ctx))
     {
       return (DWORD)EXCEPTION_CONTINUE_EXECUTION;
     }
@@ -171,7 +182,7 @@ static void ExceptionThread(mach_port_t port)
 
     x86_thread_state64_t* state = (x86_thread_state64_t*)msg_in.old_state;
 
-    bool ok = JitInterface::HandleFault((uintptr_t)msg_in.code[1], state);
+    bool ok = HandleFault((uintptr_t)msg_in.code[1], state);
 
     // Set up the reply.
     msg_out.Head.msgh_bits = MACH_MSGH_BITS(MACH_MSGH_BITS_REMOTE(msg_in.Head.msgh_bits), 0);
@@ -258,13 +269,13 @@ static void sigsegv_handler(int sig, siginfo_t* info, void* raw_context)
   mcontext_t* ctx = &context->uc_mcontext;
 #endif
   // assume it's not a write
-  if (!JitInterface::HandleFault(bad_address,
+  if (!HandleFault(bad_address,
 #ifdef __APPLE__
-                                 *ctx
+                   *ctx
 #else
-                                 ctx
+                   ctx
 #endif
-                                 ))
+                   ))
   {
     // retry and crash
     // According to the sigaction man page, if sa_flags "SA_SIGINFO" is set to the sigaction
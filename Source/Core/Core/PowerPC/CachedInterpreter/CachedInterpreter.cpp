@@ -6,12 +6,15 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
+#include "Common/Metrics.h"
 #include "Core/ConfigManager.h"
 #include "Core/CoreTiming.h"
 #include "Core/HLE/HLE.h"
 #include "Core/HW/CPU.h"
 #include "Core/PowerPC/Gekko.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
 #include "Core/PowerPC/Jit64Common/Jit64Constants.h"
+#include "Core/PowerPC/MMU.h"
 #include "Core/PowerPC/PPCAnalyst.h"
 #include "Core/PowerPC/PowerPC.h"
 
@@ -31,23 +34,107 @@ struct CachedInterpreter::Instruction
   {
   }
 
+  explicit Instruction(u32 destination)
+      : link_target(nullptr), data(destination), type(Type::LinkedExit)
+  {
+  }
+
+  // Keep this in the same order as the handlers in ExecuteOneBlock.
   enum class Type
   {
     Abort,
     Common,
     Conditional,
+    // Continues in the linked block if the block exits to the destination in data.
+    LinkedExit,
+    // Superinstructions, which replace a sequence of Common instructions. Their operands are the
+    // data of the instructions they replace, which are skipped.
+    // cmp, cmpl, cmpi or cmpli, WritePC and a bc which tests the compared field.
+    CompareBranch,
+    CompareLogicalBranch,
+    CompareImmediateBranch,
+    CompareLogicalImmediateBranch,
+    // lwz and an addi of the loaded register.
+    LoadWordAddImmediate,
+    // addi and an stw of the result.
+    AddImmediateStoreWord,
   };
 
   union
   {
     const CommonCallback common_callback;
     const ConditionalCallback conditional_callback;
+    const Instruction* link_target;
   };
 
   u32 data = 0;
   Type type = Type::Abort;
 };
 
+// Counted when an exit is linked to a block, not when it is taken.
+static Common::Metrics::Counter s_exit_links_metric(Common::Metrics::Thread::CPU,
+                                                    "cached_interpreter_exit_links");
+
+// The superinstructions do the same as the interpreter functions of the instructions they replace,
+// without a dispatch and a call for each of them.
+
+template <typename T>
+static u32 CompareField(T a, T b)
+{
+  u32 field = a < b ? 0x8 : a > b ? 0x4 : 0x2;
+  if (PowerPC::GetXER_SO())
+    field |= 0x1;
+  return field;
+}
+
+template <bool is_signed, bool is_immediate>
+static void CompareAndBranch(UGeckoInstruction compare, u32 address, UGeckoInstruction branch)
+{
+  const u32 a = rGPR[compare.RA];
+  u32 field;
+  if constexpr (is_signed)
+  {
+    const s32 b = is_immediate ? compare.SIMM_16 : static_cast<s32>(rGPR[compare.RB]);
+    field = CompareField(static_cast<s32>(a), b);
+  }
+  else
+  {
+    const u32 b = is_immediate ? compare.UIMM : rGPR[compare.RB];
+    field = CompareField(a, b);
+  }
+  PowerPC::ppcState.cr.SetField(compare.CRFD, field);
+
+  PC = address;
+  NPC = address + 4;
+
+  // The branch doesn't use CTR, and tests a bit of the field which was just compared.
+  if (((field >> (3 - (branch.BI & 3))) & 1) == ((branch.BO >> 3) & 1))
+  {
+    if (branch.LK)
+      LR = address + 4;
+    NPC = address + SignExt16(branch.BD << 2);
+  }
+}
+
+static void LoadWordAndAddImmediate(UGeckoInstruction load, UGeckoInstruction add)
+{
+  const u32 address = load.RA ? rGPR[load.RA] + load.SIMM_16 : u32(load.SIMM_16);
+  const u32 value = PowerPC::Read_U32(address);
+  if (!(PowerPC::ppcState.Exceptions & EXCEPTION_DSI))
+    rGPR[load.RD] = value;
+
+  rGPR[add.RD] = rGPR[load.RD] + add.SIMM_16;
+}
+
+static void AddImmediateAndStoreWord(UGeckoInstruction add, UGeckoInstruction store)
+{
+  const u32 value = add.RA ? rGPR[add.RA] + add.SIMM_16 : u32(add.SIMM_16);
+  rGPR[add.RD] = value;
+
+  const u32 address = store.RA ? rGPR[store.RA] + store.SIMM_16 : u32(store.SIMM_16);
+  PowerPC::Write_U32(value, address);
+}
+
 CachedInterpreter::CachedInterpreter() = default;
 
 CachedInterpreter::~CachedInterpreter() = default;
@@ -56,7 +143,7 @@ void CachedInterpreter::Init()
 {
   m_code.reserve(CODE_SIZE / sizeof(Instruction));
 
-  jo.enableBlocklink = false;
+  jo.enableBlocklink = !SConfig::GetInstance().bJITNoBlockLinking;
 
   m_block_cache.Init();
   UpdateMemoryOptions();
@@ -87,24 +174,108 @@ void CachedInterpreter::ExecuteOneBlock()
 
   const Instruction* code = reinterpret_cast<const Instruction*>(normal_entry);
 
-  for (; code->type != Instruction::Type::Abort; ++code)
+  // Each handler jumps to the handler of the next instruction by itself, so that the host can
+  // predict these jumps separately. Compilers without computed goto share one switch instead.
+#ifdef __GNUC__
+  static const void* const handlers[] = {&&abort,
+                                         &&common,
+                                         &&conditional,
+                                         &&linked_exit,
+                                         &&compare_branch,
+                                         &&compare_logical_branch,
+                                         &&compare_immediate_branch,
+                                         &&compare_logical_immediate_branch,
+                                         &&load_word_add_immediate,
+                                         &&add_immediate_store_word};
+#define DISPATCH() goto* handlers[static_cast<size_t>(code->type)]
+  DISPATCH();
+#else
+#define DISPATCH() goto dispatch
+dispatch:
+  switch (code->type)
   {
-    switch (code->type)
-    {
-    case Instruction::Type::Common:
-      code->common_callback(UGeckoInstruction(code->data));
-      break;
+  case Instruction::Type::Abort:
+    goto abort;
+  case Instruction::Type::Common:
+    goto common;
+  case Instruction::Type::Conditional:
+    goto conditional;
+  case Instruction::Type::LinkedExit:
+    goto linked_exit;
+  case Instruction::Type::CompareBranch:
+    goto compare_branch;
+  case Instruction::Type::CompareLogicalBranch:
+    goto compare_logical_branch;
+  case Instruction::Type::CompareImmediateBranch:
+    goto compare_immediate_branch;
+  case Instruction::Type::CompareLogicalImmediateBranch:
+    goto compare_logical_immediate_branch;
+  case Instruction::Type::LoadWordAddImmediate:
+    goto load_word_add_immediate;
+  case Instruction::Type::AddImmediateStoreWord:
+    goto add_immediate_store_word;
+  }
+#endif
 
-    case Instruction::Type::Conditional:
-      if (code->conditional_callback(code->data))
-        return;
-      break;
+common:
+  code->common_callback(UGeckoInstruction(code->data));
+  ++code;
+  DISPATCH();
 
-    default:
-      ERROR_LOG_FMT(POWERPC, "Unknown CachedInterpreter Instruction: {}", code->type);
-      break;
-    }
+conditional:
+  if (code->conditional_callback(code->data))
+    return;
+  ++code;
+  DISPATCH();
+
+linked_exit:
+  // Like the JIT, only check the downcount and leave exceptions to the dispatcher. Stepping and
+  // breakpoints change the CPU state, which stops the block from continuing in the next one.
+  if (code->link_target && PC == code->data && PowerPC::ppcState.downcount > 0 &&
+      CPU::GetState() == CPU::State::Running)
+  {
+    code = code->link_target;
   }
+  else
+  {
+    ++code;
+  }
+  DISPATCH();
+
+compare_branch:
+  CompareAndBranch<true, false>(code[0].data, code[1].data, code[2].data);
+  code += 3;
+  DISPATCH();
+
+compare_logical_branch:
+  CompareAndBranch<false, false>(code[0].data, code[1].data, code[2].data);
+  code += 3;
+  DISPATCH();
+
+compare_immediate_branch:
+  CompareAndBranch<true, true>(code[0].data, code[1].data, code[2].data);
+  code += 3;
+  DISPATCH();
+
+compare_logical_immediate_branch:
+  CompareAndBranch<false, true>(code[0].data, code[1].data, code[2].data);
+  code += 3;
+  DISPATCH();
+
+load_word_add_immediate:
+  LoadWordAndAddImmediate(code[0].data, code[1].data);
+  code += 2;
+  DISPATCH();
+
+add_immediate_store_word:
+  AddImmediateAndStoreWord(code[0].data, code[1].data);
+  code += 2;
+  DISPATCH();
+
+abort:
+  return;
+
+#undef DISPATCH
 }
 
 void CachedInterpreter::Run()
@@ -201,6 +372,81 @@ static bool CheckIdle(u32 idle_pc)
   return false;
 }
 
+void CachedInterpreter::WriteExit(u32 destination)
+{
+  if (!jo.enableBlocklink)
+    return;
+
+  m_code.emplace_back(destination);
+
+  JitBlock::LinkData linkData;
+  linkData.exitAddress = destination;
+  linkData.exitPtrs = reinterpret_cast<u8*>(&m_code.back());
+  linkData.linkStatus = false;
+  linkData.call = false;
+  js.curBlock->linkData.push_back(linkData);
+}
+
+void CachedInterpreter::LinkExit(u8* exit, const u8* destination)
+{
+  reinterpret_cast<Instruction*>(exit)->link_target =
+      reinterpret_cast<const Instruction*>(destination);
+  if (destination)
+    s_exit_links_metric.Increment();
+}
+
+void CachedInterpreter::FuseInstructions(size_t begin)
+{
+  const auto is_call = [this](size_t index, Instruction::CommonCallback callback) {
+    return m_code[index].type == Instruction::Type::Common &&
+           m_code[index].common_callback == callback;
+  };
+
+  for (size_t i = begin; i + 1 < m_code.size(); ++i)
+  {
+    const UGeckoInstruction first(m_code[i].data);
+    const UGeckoInstruction second(m_code[i + 1].data);
+
+    if (i + 2 < m_code.size() && is_call(i + 1, WritePC) && is_call(i + 2, Interpreter::bcx))
+    {
+      const UGeckoInstruction branch(m_code[i + 2].data);
+      const bool tests_compared_field =
+          (branch.BO & BO_DONT_DECREMENT_FLAG) && !(branch.BO & BO_DONT_CHECK_CONDITION) &&
+          !branch.AA && (branch.BI >> 2) == first.CRFD;
+
+      Instruction::Type type = Instruction::Type::Common;
+      if (is_call(i, Interpreter::cmp))
+        type = Instruction::Type::CompareBranch;
+      else if (is_call(i, Interpreter::cmpl))
+        type = Instruction::Type::CompareLogicalBranch;
+      else if (is_call(i, Interpreter::cmpi))
+        type = Instruction::Type::CompareImmediateBranch;
+      else if (is_call(i, Interpreter::cmpli))
+        type = Instruction::Type::CompareLogicalImmediateBranch;
+
+      if (type != Instruction::Type::Common && tests_compared_field)
+      {
+        m_code[i].type = type;
+        i += 2;
+        continue;
+      }
+    }
+
+    if (is_call(i, Interpreter::lwz) && is_call(i + 1, Interpreter::addi) &&
+        first.RD != 0 && second.RA == first.RD)
+    {
+      m_code[i].type = Instruction::Type::LoadWordAddImmediate;
+      ++i;
+    }
+    else if (is_call(i, Interpreter::addi) && is_call(i + 1, Interpreter::stw) &&
+             second.RS == first.RD)
+    {
+      m_code[i].type = Instruction::Type::AddImmediateStoreWord;
+      ++i;
+    }
+  }
+}
+
 bool CachedInterpreter::HandleFunctionHooking(u32 address)
 {
   return HLE::ReplaceFunctionIfPossible(address, [&](u32 hook_index, HLE::HookType type) {
@@ -247,6 +493,7 @@ void CachedInterpreter::Jit(u32 address)
 
   b->checkedEntry = GetCodePtr();
   b->normalEntry = GetCodePtr();
+  const size_t begin = m_code.size();
 
   for (u32 i = 0; i < code_block.m_num_instructions; i++)
   {
@@ -295,6 +542,11 @@ void CachedInterpreter::Jit(u32 address)
         m_code.emplace_back(EndBlock, js.downcountAmount);
         m_code.emplace_back(UpdateNumLoadStoreInstructions, js.numLoadStoreInst);
         m_code.emplace_back(UpdateNumFloatingPointInstructions, js.numFloatingPointInst);
+
+        if (op.branchTo != UINT32_MAX)
+          WriteExit(op.branchTo);
+        if (op.inst.OPCD == 16)
+          WriteExit(op.address + 4);
       }
     }
   }
@@ -304,7 +556,9 @@ void CachedInterpreter::Jit(u32 address)
     m_code.emplace_back(EndBlock, js.downcountAmount);
     m_code.emplace_back(UpdateNumLoadStoreInstructions, js.numLoadStoreInst);
     m_code.emplace_back(UpdateNumFloatingPointInstructions, js.numFloatingPointInst);
+    WriteExit(nextPC);
   }
+  FuseInstructions(begin);
   m_code.emplace_back();
 
   b->codeSize = (u32)(GetCodePtr() - b->checkedEntry);
@@ -315,7 +569,8 @@ void CachedInterpreter::Jit(u32 address)
 
 void CachedInterpreter::ClearCache()
 {
-  m_code.clear();
+  // Unlink the blocks before their code is cleared.
   m_block_cache.Clear();
+  m_code.clear();
   UpdateMemoryOptions();
 }
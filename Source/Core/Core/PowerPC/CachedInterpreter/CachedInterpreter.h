@@ -32,12 +32,20 @@ public:
   const char* GetName() const override { return "Cached Interpreter"; }
   const CommonAsmRoutinesBase* GetAsmRoutines() override { return nullptr; }
 
+  // Makes the linked exit continue in the code of a block, or unlinks it if that is null.
+  static void LinkExit(u8* exit, const u8* destination);
+
 private:
   struct Instruction;
 
   u8* GetCodePtr();
   void ExecuteOneBlock();
 
+  // Adds an exit to the destination, which can be linked to the block at that address.
+  void WriteExit(u32 destination);
+  // Replaces common sequences of interpreter calls from the index on with superinstructions.
+  void FuseInstructions(size_t begin);
+
   bool HandleFunctionHooking(u32 address);
 
   BlockCache m_block_cache{*this};
@@ -4,6 +4,7 @@
 
 #include "Core/PowerPC/CachedInterpreter/InterpreterBlockCache.h"
 
+#include "Core/PowerPC/CachedInterpreter/CachedInterpreter.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
 
 BlockCache::BlockCache(JitBase& jit) : JitBaseBlockCache{jit}
@@ -12,4 +13,5 @@ BlockCache::BlockCache(JitBase& jit) : JitBaseBlockCache{jit}
 
 void BlockCache::WriteLinkBlock(const JitBlock::LinkData& source, const JitBlock* dest)
 {
+  CachedInterpreter::LinkExit(source.exitPtrs, dest ? dest->normalEntry : nullptr);
 }
@@ -4,6 +4,7 @@
 
 #include "Core/PowerPC/Interpreter/Interpreter.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cinttypes>
@@ -80,6 +81,26 @@ void UpdatePC()
   last_pc = PC;
   PC = NPC;
 }
+
+// Looks the instruction up in the secondary tables directly, instead of going through RunTable*.
+Interpreter::Instruction GetHandler(UGeckoInstruction inst)
+{
+  switch (inst.OPCD)
+  {
+  case 4:
+    return Interpreter::m_op_table4[inst.SUBOP10];
+  case 19:
+    return Interpreter::m_op_table19[inst.SUBOP10];
+  case 31:
+    return Interpreter::m_op_table31[inst.SUBOP10];
+  case 59:
+    return Interpreter::m_op_table59[inst.SUBOP5];
+  case 63:
+    return Interpreter::m_op_table63[inst.SUBOP10];
+  default:
+    return Interpreter::m_op_table[inst.OPCD];
+  }
+}
 }  // Anonymous namespace
 
 void Interpreter::RunTable4(UGeckoInstruction inst)
@@ -106,12 +127,65 @@ void Interpreter::RunTable63(UGeckoInstruction inst)
 void Interpreter::Init()
 {
   InitializeInstructionTables();
+  ClearPredecodeCache();
   m_reserve = false;
   m_end_block = false;
 }
 
 void Interpreter::Shutdown()
 {
+  ClearPredecodeCache();
+}
+
+Interpreter::PredecodedInstruction Interpreter::Predecode(u32 address, UGeckoInstruction inst)
+{
+  const u32 page_index = address >> PREDECODE_PAGE_SHIFT;
+  if (!m_last_predecoded_page || page_index != m_last_predecoded_page_index)
+  {
+    std::unique_ptr<PredecodedPage>& page = m_predecoded_pages[page_index];
+    if (!page)
+      page = std::make_unique<PredecodedPage>();
+    m_last_predecoded_page = page.get();
+    m_last_predecoded_page_index = page_index;
+  }
+
+  const u32 offset = address & ((1 << PREDECODE_PAGE_SHIFT) - 1);
+  PredecodedInstruction& entry = (*m_last_predecoded_page)[offset / sizeof(UGeckoInstruction)];
+  if (entry.hex != inst.hex)
+  {
+    entry.hex = inst.hex;
+    entry.handler = GetHandler(inst);
+    entry.info = PPCTables::GetOpInfo(inst);
+  }
+  return entry;
+}
+
+void Interpreter::InvalidatePredecodeCache(u32 address, u32 size)
+{
+  if (m_predecoded_pages.empty() || size == 0)
+    return;
+
+  const u32 last_address = address + size - 1;
+  for (u32 page_index = address >> PREDECODE_PAGE_SHIFT;
+       page_index <= last_address >> PREDECODE_PAGE_SHIFT; ++page_index)
+  {
+    const auto it = m_predecoded_pages.find(page_index);
+    if (it == m_predecoded_pages.end())
+      continue;
+
+    const u32 page_address = page_index << PREDECODE_PAGE_SHIFT;
+    const u32 start = std::max(address, page_address) - page_address;
+    const u32 end = std::min(last_address, page_address + ((1 << PREDECODE_PAGE_SHIFT) - 1)) -
+                    page_address;
+    for (u32 offset = start & ~3; offset <= end; offset += sizeof(UGeckoInstruction))
+      (*it->second)[offset / sizeof(UGeckoInstruction)].hex = 0;
+  }
+}
+
+void Interpreter::ClearPredecodeCache()
+{
+  m_predecoded_pages.clear();
+  m_last_predecoded_page = nullptr;
 }
 
 static int startTrace = 0;
@@ -179,8 +253,12 @@ int Interpreter::SingleStepInner()
     Trace(m_prev_inst);
   }
 
+  const GekkoOPInfo* opinfo;
   if (m_prev_inst.hex != 0)
   {
+    const PredecodedInstruction decoded = Predecode(PC, m_prev_inst);
+    opinfo = decoded.info;
+
     if (IsInvalidPairedSingleExecution(m_prev_inst))
     {
       GenerateProgramException();
@@ -188,7 +266,7 @@ int Interpreter::SingleStepInner()
     }
     else if (MSR.FP)
     {
-      m_op_table[m_prev_inst.OPCD](m_prev_inst);
+      decoded.handler(m_prev_inst);
       if (PowerPC::ppcState.Exceptions & EXCEPTION_DSI)
       {
         CheckExceptions();
@@ -197,14 +275,14 @@ int Interpreter::SingleStepInner()
     else
     {
       // check if we have to generate a FPU unavailable exception or a program exception.
-      if (PPCTables::UsesFPU(m_prev_inst))
+      if ((opinfo->flags & FL_USE_FPU) != 0)
       {
         PowerPC::ppcState.Exceptions |= EXCEPTION_FPU_UNAVAILABLE;
         CheckExceptions();
       }
       else
       {
-        m_op_table[m_prev_inst.OPCD](m_prev_inst);
+        decoded.handler(m_prev_inst);
         if (PowerPC::ppcState.Exceptions & EXCEPTION_DSI)
         {
           CheckExceptions();
@@ -216,11 +294,11 @@ int Interpreter::SingleStepInner()
   {
     // Memory exception on instruction fetch
     CheckExceptions();
+    opinfo = PPCTables::GetOpInfo(m_prev_inst);
   }
 
   UpdatePC();
 
-  const GekkoOPInfo* opinfo = PPCTables::GetOpInfo(m_prev_inst);
   PowerPC::UpdatePerformanceMonitor(opinfo->numCycles, (opinfo->flags & FL_LOADSTORE) != 0,
                                     (opinfo->flags & FL_USE_FPU) != 0);
   return opinfo->numCycles;
@@ -360,7 +438,7 @@ void Interpreter::unknown_instruction(UGeckoInstruction inst)
 
 void Interpreter::ClearCache()
 {
-  // Do nothing.
+  ClearPredecodeCache();
 }
 
 void Interpreter::CheckExceptions()
@@ -5,11 +5,15 @@
 #pragma once
 
 #include <array>
+#include <memory>
+#include <unordered_map>
 
 #include "Common/CommonTypes.h"
 #include "Core/PowerPC/CPUCoreBase.h"
 #include "Core/PowerPC/Gekko.h"
 
+struct GekkoOPInfo;
+
 class Interpreter : public CPUCoreBase
 {
 public:
@@ -281,7 +285,30 @@ public:
 
   static u32 Helper_Carry(u32 value1, u32 value2);
 
+  // Drops the cached decodings of the instructions in the range, like the JIT drops its blocks.
+  void InvalidatePredecodeCache(u32 address, u32 size);
+
 private:
+  // An instruction which was looked up in the instruction tables before.
+  struct PredecodedInstruction
+  {
+    // Zero if the entry is unused, as instruction fetches which fail return zero.
+    u32 hex;
+    Instruction handler;
+    const GekkoOPInfo* info;
+  };
+
+  static constexpr u32 PREDECODE_PAGE_SHIFT = 12;
+  using PredecodedPage =
+      std::array<PredecodedInstruction, (1 << PREDECODE_PAGE_SHIFT) / sizeof(UGeckoInstruction)>;
+
+  // Returns the handler and the info of the instruction at the address, and caches them by page.
+  // Entries are still checked against the fetched instruction, as code can change without an
+  // icbi reaching InvalidatePredecodeCache (e.g. with the instruction cache disabled, or through
+  // another effective address).
+  PredecodedInstruction Predecode(u32 address, UGeckoInstruction inst);
+  void ClearPredecodeCache();
+
   void CheckExceptions();
 
   static void InitializeInstructionTables();
@@ -296,6 +323,11 @@ private:
 
   UGeckoInstruction m_prev_inst{};
 
+  std::unordered_map<u32, std::unique_ptr<PredecodedPage>> m_predecoded_pages;
+  // The page which was used last, which is usually the one of the next instruction too.
+  u32 m_last_predecoded_page_index = 0;
+  PredecodedPage* m_last_predecoded_page = nullptr;
+
   static bool m_end_block;
 
   // TODO: These should really be in the save state, although it's unlikely to matter much.
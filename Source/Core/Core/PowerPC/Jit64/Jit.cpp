@@ -4,9 +4,11 @@
 
 #include "Core/PowerPC/Jit64/Jit.h"
 
+#include <algorithm>
 #include <map>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include <disasm.h>
 #include <fmt/format.h>
@@ -21,6 +23,7 @@
 #include "Common/GekkoDisassembler.h"
 #include "Common/Logging/Log.h"
 #include "Common/MemoryUtil.h"
+#include "Common/Metrics.h"
 #include "Common/PerformanceCounter.h"
 #include "Common/StringUtil.h"
 #include "Common/Swap.h"
@@ -155,6 +158,23 @@ enum
   GUARD_OFFSET = STACK_SIZE - SAFE_STACK_SIZE - GUARD_SIZE,
 };
 
+static Common::Metrics::Counter s_evicted_regions_metric(Common::Metrics::Thread::CPU,
+                                                         "jit_evicted_code_regions");
+static Common::Metrics::Counter s_evicted_blocks_metric(Common::Metrics::Thread::CPU,
+                                                        "jit_evicted_blocks");
+static Common::Metrics::Counter s_cleared_blocks_metric(Common::Metrics::Thread::CPU,
+                                                        "jit_cleared_blocks");
+static Common::Metrics::Histogram s_cache_clear_time_metric(Common::Metrics::Thread::CPU,
+                                                            "jit_cache_clear_time_us");
+static Common::Metrics::Counter s_hot_branches_metric(Common::Metrics::Thread::CPU,
+                                                      "jit_hot_branches");
+static Common::Metrics::Counter s_gqr_speculations_metric(Common::Metrics::Thread::CPU,
+                                                          "jit_gqr_speculations");
+static Common::Metrics::Counter s_backpatches_metric(Common::Metrics::Thread::CPU,
+                                                     "jit_backpatches");
+static Common::Metrics::Counter s_page_table_faults_metric(Common::Metrics::Thread::CPU,
+                                                           "jit_page_table_faults");
+
 Jit64::Jit64() : QuantizedMemoryRoutines(*this)
 {
 }
@@ -230,16 +250,40 @@ bool Jit64::HandleFault(uintptr_t access_address, SContext* ctx)
   // TODO: do we properly handle off-the-end?
   const auto base_ptr = reinterpret_cast<uintptr_t>(Memory::physical_base);
   if (access_address >= base_ptr && access_address < base_ptr + 0x100010000)
-    return BackPatch(static_cast<u32>(access_address - base_ptr), ctx);
+    return BackPatch(static_cast<u32>(access_address - base_ptr), ctx, true);
 
   const auto logical_base_ptr = reinterpret_cast<uintptr_t>(Memory::logical_base);
   if (access_address >= logical_base_ptr && access_address < logical_base_ptr + 0x100010000)
-    return BackPatch(static_cast<u32>(access_address - logical_base_ptr), ctx);
+  {
+    const u32 em_address = static_cast<u32>(access_address - logical_base_ptr);
+
+    // The MMU maps the pages which the page table translates as they are used, so the first
+    // access to a page faults. Retry the access once the page is mapped. If it can't be mapped
+    // yet, run the slow path once without patching the access, so that it uses fastmem later.
+    u8* code_ptr = reinterpret_cast<u8*>(ctx->CTX_PC);
+    const auto it = m_back_patch_info.find(code_ptr);
+    if (IsInSpace(code_ptr) && it != m_back_patch_info.end())
+    {
+      switch (PowerPC::HandlePageTableFault(em_address, !it->second.read))
+      {
+      case PowerPC::PageTableFaultResult::Mapped:
+        s_page_table_faults_metric.Increment();
+        return true;
+      case PowerPC::PageTableFaultResult::SlowPath:
+        s_page_table_faults_metric.Increment();
+        return BackPatch(em_address, ctx, false);
+      case PowerPC::PageTableFaultResult::NotMappable:
+        break;
+      }
+    }
+
+    return BackPatch(em_address, ctx, true);
+  }
 
   return false;
 }
 
-bool Jit64::BackPatch(u32 emAddress, SContext* ctx)
+bool Jit64::BackPatch(u32 emAddress, SContext* ctx, bool patch)
 {
   u8* codePtr = reinterpret_cast<u8*>(ctx->CTX_PC);
 
@@ -270,24 +314,33 @@ bool Jit64::BackPatch(u32 emAddress, SContext* ctx)
   // into the original code if necessary to ensure there is enough space
   // to insert the backpatch jump.)
 
-  js.generatingTrampoline = true;
-  js.trampolineExceptionHandler = exceptionHandler;
-  js.compilerPC = info.pc;
+  // Generate the trampoline, unless an earlier fault without patching already did.
+  if (!info.trampoline)
+  {
+    js.generatingTrampoline = true;
+    js.trampolineExceptionHandler = exceptionHandler;
+    js.compilerPC = info.pc;
+
+    info.trampoline = trampolines.GenerateTrampoline(info);
+    js.generatingTrampoline = false;
+    js.trampolineExceptionHandler = nullptr;
+  }
+  const u8* trampoline = info.trampoline;
 
-  // Generate the trampoline.
-  const u8* trampoline = trampolines.GenerateTrampoline(info);
-  js.generatingTrampoline = false;
-  js.trampolineExceptionHandler = nullptr;
+  if (patch)
+  {
+    u8* start = info.start;
 
-  u8* start = info.start;
+    // Patch the original memory operation.
+    XEmitter emitter(start, start + info.len);
+    emitter.JMP(trampoline, true);
+    // NOPs become dead code
+    const u8* end = info.start + info.len;
+    for (const u8* i = emitter.GetCodePtr(); i < end; ++i)
+      emitter.INT3();
 
-  // Patch the original memory operation.
-  XEmitter emitter(start, start + info.len);
-  emitter.JMP(trampoline, true);
-  // NOPs become dead code
-  const u8* end = info.start + info.len;
-  for (const u8* i = emitter.GetCodePtr(); i < end; ++i)
-    emitter.INT3();
+    s_backpatches_metric.Increment();
+  }
 
   // Rewind time to just before the start of the write block. If we swapped memory
   // before faulting (eg: the store+swap was not an atomic op like MOVBE), let's
@@ -336,6 +389,7 @@ void Jit64::Init()
   jo.fastmem_arena = SConfig::GetInstance().bFastmem && Memory::InitFastmemArena();
   jo.optimizeGatherPipe = true;
   jo.accurateSinglePrecision = true;
+  jo.lower_integer_runs = true;
   UpdateMemoryOptions();
   js.fastmemLoadStore = nullptr;
   js.compilerPC = 0;
@@ -383,6 +437,9 @@ void Jit64::Init()
 
 void Jit64::ClearCache()
 {
+  Common::Metrics::ScopedTimer timer(&s_cache_clear_time_metric);
+  s_cleared_blocks_metric.Add(blocks.GetBlockCount());
+
   blocks.Clear();
   blocks.ClearRangesToFree();
   trampolines.ClearCodeSpace();
@@ -392,6 +449,9 @@ void Jit64::ClearCache()
   Clear();
   UpdateMemoryOptions();
   ResetFreeMemoryRanges();
+  m_branch_profiles.clear();
+  m_recompiled_branch_profiles.clear();
+  analyzer.ClearHotBranches();
 }
 
 void Jit64::ResetFreeMemoryRanges()
@@ -399,8 +459,11 @@ void Jit64::ResetFreeMemoryRanges()
   // Set the entire near and far code regions as unused.
   m_free_ranges_near.clear();
   m_free_ranges_near.insert(region, region + region_size);
+  m_far_code_begin = m_far_code.GetWritableCodePtr();
+  m_far_code_end = m_far_code.GetWritableCodeEnd();
   m_free_ranges_far.clear();
-  m_free_ranges_far.insert(m_far_code.GetWritableCodePtr(), m_far_code.GetWritableCodeEnd());
+  m_free_ranges_far.insert(m_far_code_begin, m_far_code_end);
+  m_next_eviction_region = 0;
 }
 
 void Jit64::Shutdown()
@@ -752,6 +815,7 @@ void Jit64::Jit(u32 em_address, bool clear_cache_and_retry_on_failure)
 #endif
   }
 
+  // Trampolines are shared by all blocks and can't be evicted separately.
   if (trampolines.IsAlmostFull() || SConfig::GetInstance().bJITNoBlockCache)
   {
     if (!SConfig::GetInstance().bJITNoBlockCache)
@@ -761,13 +825,7 @@ void Jit64::Jit(u32 em_address, bool clear_cache_and_retry_on_failure)
     ClearCache();
   }
 
-  // Check if any code blocks have been freed in the block cache and transfer this information to
-  // the local rangesets to allow overwriting them with new code.
-  for (auto range : blocks.GetRangesToFreeNear())
-    m_free_ranges_near.insert(range.first, range.second);
-  for (auto range : blocks.GetRangesToFreeFar())
-    m_free_ranges_far.insert(range.first, range.second);
-  blocks.ClearRangesToFree();
+  FreeRangesOfDestroyedBlocks();
 
   std::size_t block_size = m_code_buffer.size();
 
@@ -791,6 +849,7 @@ void Jit64::Jit(u32 em_address, bool clear_cache_and_retry_on_failure)
         analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_CROR_MERGE);
         analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_CARRY_MERGE);
         analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW);
+        analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_HOT_BRANCH_FOLLOW);
       }
       Trace();
     }
@@ -811,39 +870,18 @@ void Jit64::Jit(u32 em_address, bool clear_cache_and_retry_on_failure)
     return;
   }
 
-  if (SetEmitterStateToFreeCodeRegion())
-  {
-    u8* near_start = GetWritableCodePtr();
-    u8* far_start = m_far_code.GetWritableCodePtr();
+  if (JitToFreeCodeRegion(em_address, nextPC))
+    return;
 
-    JitBlock* b = blocks.AllocateBlock(em_address);
-    if (DoJit(em_address, b, nextPC))
-    {
-      // Code generation succeeded.
-
-      // Mark the memory regions that this code block uses as used in the local rangesets.
-      u8* near_end = GetWritableCodePtr();
-      if (near_start != near_end)
-        m_free_ranges_near.erase(near_start, near_end);
-      u8* far_end = m_far_code.GetWritableCodePtr();
-      if (far_start != far_end)
-        m_free_ranges_far.erase(far_start, far_end);
-
-      // Store the used memory regions in the block so we know what to mark as unused when the
-      // block gets invalidated.
-      b->near_begin = near_start;
-      b->near_end = near_end;
-      b->far_begin = far_start;
-      b->far_end = far_end;
-
-      blocks.FinalizeBlock(*b, jo.enableBlocklink, code_block.m_physical_addresses);
-      return;
-    }
-  }
+  // Code generation failed due to not enough free space in either the near or far code regions.
+  // Evict the oldest part of both regions and retry. This leaves enough contiguous space for any
+  // block, so the entire JIT cache should never have to be cleared because of this.
+  EvictOldestCodeRegion();
+  if (JitToFreeCodeRegion(em_address, nextPC))
+    return;
 
   if (clear_cache_and_retry_on_failure)
   {
-    // Code generation failed due to not enough free space in either the near or far code regions.
     // Clear the entire JIT cache and retry.
     WARN_LOG_FMT(POWERPC, "flushing code caches, please report if this happens a lot");
     ClearCache();
@@ -857,6 +895,81 @@ void Jit64::Jit(u32 em_address, bool clear_cache_and_retry_on_failure)
   std::exit(-1);
 }
 
+bool Jit64::JitToFreeCodeRegion(u32 em_address, u32 nextPC)
+{
+  if (!SetEmitterStateToFreeCodeRegion())
+    return false;
+
+  u8* near_start = GetWritableCodePtr();
+  u8* far_start = m_far_code.GetWritableCodePtr();
+
+  JitBlock* b = blocks.AllocateBlock(em_address);
+  if (!DoJit(em_address, b, nextPC))
+  {
+    DiscardBranchProfile(*b);
+    blocks.DiscardBlock(*b);
+    return false;
+  }
+
+  // Code generation succeeded.
+
+  // Mark the memory regions that this code block uses as used in the local rangesets.
+  u8* near_end = GetWritableCodePtr();
+  if (near_start != near_end)
+    m_free_ranges_near.erase(near_start, near_end);
+  u8* far_end = m_far_code.GetWritableCodePtr();
+  if (far_start != far_end)
+    m_free_ranges_far.erase(far_start, far_end);
+
+  // Store the used memory regions in the block so we know what to mark as unused when the
+  // block gets invalidated.
+  b->near_begin = near_start;
+  b->near_end = near_end;
+  b->far_begin = far_start;
+  b->far_end = far_end;
+
+  blocks.FinalizeBlock(*b, jo.enableBlocklink, code_block.m_physical_addresses);
+  return true;
+}
+
+void Jit64::FreeRangesOfDestroyedBlocks()
+{
+  // Check if any code blocks have been freed in the block cache and transfer this information to
+  // the local rangesets to allow overwriting them with new code.
+  for (auto range : blocks.GetRangesToFreeNear())
+    m_free_ranges_near.insert(range.first, range.second);
+  for (auto range : blocks.GetRangesToFreeFar())
+    m_free_ranges_far.insert(range.first, range.second);
+  EraseBranchProfilesOfDestroyedBlocks();
+  blocks.ClearRangesToFree();
+}
+
+void Jit64::EvictOldestCodeRegion()
+{
+  // The code regions are split into NUM_EVICTION_REGIONS parts of the same size, which are evicted
+  // in turn. New code goes into the largest free range, which usually is the part evicted last,
+  // so the next part holds the oldest code.
+  const size_t near_size = region_size / NUM_EVICTION_REGIONS;
+  u8* const near_begin = region + m_next_eviction_region * near_size;
+  u8* const near_end = near_begin + near_size;
+
+  const size_t far_size = (m_far_code_end - m_far_code_begin) / NUM_EVICTION_REGIONS;
+  u8* const far_begin = m_far_code_begin + m_next_eviction_region * far_size;
+  u8* const far_end = far_begin + far_size;
+
+  m_next_eviction_region = (m_next_eviction_region + 1) % NUM_EVICTION_REGIONS;
+
+  const size_t evicted = blocks.EraseBlocks([&](const JitBlock& block) {
+    return (block.near_begin < near_end && block.near_end > near_begin) ||
+           (block.far_begin < far_end && block.far_end > far_begin);
+  });
+  FreeRangesOfDestroyedBlocks();
+
+  s_evicted_regions_metric.Increment();
+  s_evicted_blocks_metric.Add(evicted);
+  DEBUG_LOG_FMT(DYNA_REC, "Evicted {} blocks from the JIT code cache", evicted);
+}
+
 bool Jit64::SetEmitterStateToFreeCodeRegion()
 {
   // Find the largest free memory blocks and set code emitters to point at them.
@@ -880,6 +993,17 @@ bool Jit64::SetEmitterStateToFreeCodeRegion()
   return true;
 }
 
+// Adds the start of the code of an instruction to a line table. If the previous instruction didn't
+// generate any code there, its line is replaced.
+static void AddSourceLine(JitRegister::SourceLines* lines, const u8* host_address,
+                          u32 guest_address)
+{
+  if (!lines->empty() && lines->back().host_address == host_address)
+    lines->back().guest_address = guest_address;
+  else
+    lines->push_back({host_address, guest_address});
+}
+
 bool Jit64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
 {
   js.firstFPInstructionFound = false;
@@ -890,12 +1014,21 @@ bool Jit64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
   js.curBlock = b;
   js.numLoadStoreInst = 0;
   js.numFloatingPointInst = 0;
+  js.near_source_lines.clear();
+  js.far_source_lines.clear();
 
   // TODO: Test if this or AlignCode16 make a difference from GetCodePtr
   u8* const start = AlignCode4();
   b->checkedEntry = start;
   b->normalEntry = start;
 
+  const bool record_source_lines = JitRegister::IsEnabled();
+  if (record_source_lines)
+  {
+    js.near_source_lines.push_back({start, em_address});
+    js.far_source_lines.push_back({m_far_code.GetCodePtr(), em_address});
+  }
+
   // Used to get a trace of the last few blocks before a crash, sometimes VERY useful
   if (ImHereDebug)
   {
@@ -919,6 +1052,8 @@ bool Jit64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
   MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
 #endif
 
+  StartBranchProfile(*b);
+
   // Start up the register allocators
   // They use the information in gpa/fpa to preload commonly used registers.
   gpr.Start();
@@ -959,6 +1094,7 @@ bool Jit64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
         CMP_or_TEST(32, PPCSTATE(spr[SPR_GQR0 + gqr]), Imm32(value));
         J_CC(CC_NZ, target);
       }
+      s_gqr_speculations_metric.Increment();
     }
   }
 
@@ -976,6 +1112,11 @@ bool Jit64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
     js.compilerPC = op.address;
     js.op = &op;
     js.instructionNumber = i;
+    if (record_source_lines)
+    {
+      AddSourceLine(&js.near_source_lines, GetCodePtr(), op.address);
+      AddSourceLine(&js.far_source_lines, m_far_code.GetCodePtr(), op.address);
+    }
     js.instructionsLeft = (code_block.m_num_instructions - 1) - i;
     const GekkoOPInfo* opinfo = op.opinfo;
     js.downcountAmount += opinfo->numCycles;
@@ -1041,6 +1182,13 @@ bool Jit64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
     if (HandleFunctionHooking(op.address))
       break;
 
+    // Runs of integer instructions with redundant operations are compiled from the JIT IR.
+    if (const u32 num_ops = CompileIRRun(i))
+    {
+      i += num_ops - 1;
+      continue;
+    }
+
     if (!op.skip)
     {
       if ((opinfo->flags & FL_USE_FPU) && !js.firstFPInstructionFound)
@@ -1201,6 +1349,144 @@ bool Jit64::DoJit(u32 em_address, JitBlock* b, u32 nextPC)
   return true;
 }
 
+void Jit64::StartBranchProfile(const JitBlock& block)
+{
+  m_branch_profile = nullptr;
+  if (!SConfig::GetInstance().bJITFollowBranch ||
+      !analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_HOT_BRANCH_FOLLOW))
+  {
+    return;
+  }
+
+  // A block compiled again after its profile was evaluated takes over the profile, and with it
+  // the hot branches that the profile added.
+  const auto recompiled =
+      m_recompiled_branch_profiles.find({block.effectiveAddress, block.msrBits});
+  if (recompiled != m_recompiled_branch_profiles.end())
+  {
+    m_branch_profiles[block.checkedEntry] = recompiled->second;
+    m_recompiled_branch_profiles.erase(recompiled);
+    return;
+  }
+
+  // Only profile blocks with conditional branches which could be followed.
+  bool has_branches = false;
+  for (u32 i = 0; i < code_block.m_num_instructions; i++)
+  {
+    const PPCAnalyst::CodeOp& op = m_code_buffer[i];
+    const bool conditional = (op.inst.BO & BO_DONT_DECREMENT_FLAG) == 0 ||
+                             (op.inst.BO & BO_DONT_CHECK_CONDITION) == 0;
+    has_branches |= op.inst.OPCD == 16 && !op.inst.LK && conditional && !op.branchIsFollowed &&
+                    !op.branchIsIdleLoop;
+  }
+  if (!has_branches)
+    return;
+
+  // The code of any earlier block with this entry point was freed along with its profile.
+  BranchProfile& profile = m_branch_profiles[block.checkedEntry];
+  profile = {};
+  profile.address = block.effectiveAddress;
+  profile.msr_bits = block.msrBits;
+  profile.countdown = BranchProfile::PERIOD;
+  m_branch_profile = &profile;
+
+  MOV(64, R(RSCRATCH), ImmPtr(&profile.countdown));
+  SUB(32, MatR(RSCRATCH), Imm8(1));
+  FixupBranch evaluate = J_CC(CC_Z, true);
+
+  SwitchToFarCode();
+  SetJumpTarget(evaluate);
+  ABI_PushRegistersAndAdjustStack({}, 0);
+  ABI_CallFunctionPP(EvaluateBranchProfile, this, &profile);
+  ABI_PopRegistersAndAdjustStack({}, 0);
+  FixupBranch back = J(true);
+  SwitchToNearCode();
+  SetJumpTarget(back);
+}
+
+void Jit64::ProfileTakenBranch(u32 address)
+{
+  if (!m_branch_profile || m_branch_profile->num_branches == BranchProfile::MAX_BRANCHES)
+    return;
+
+  const u32 index = m_branch_profile->num_branches++;
+  m_branch_profile->addresses[index] = address;
+  MOV(64, R(RSCRATCH), ImmPtr(&m_branch_profile->taken[index]));
+  ADD(32, MatR(RSCRATCH), Imm8(1));
+}
+
+void Jit64::EvaluateBranchProfile(Jit64& jit, BranchProfile* profile_ptr)
+{
+  BranchProfile& profile = *profile_ptr;
+  profile.evaluated = true;
+
+  // Each taken branch leaves the block, so the later branches run that many times less.
+  u32 runs = BranchProfile::PERIOD;
+  for (u32 i = 0; i < profile.num_branches; i++)
+  {
+    const u32 taken = std::min(profile.taken[i], runs);
+    if (runs >= BranchProfile::PERIOD / 8 && taken * 8 >= runs * 7)
+    {
+      jit.analyzer.AddHotBranch(profile.addresses[i]);
+      profile.hot[i] = true;
+      s_hot_branches_metric.Increment();
+    }
+    runs -= taken;
+  }
+
+  // Compile the block again, without the profiling code. The current block keeps running until it
+  // exits, as its code is only overwritten when the next block is compiled.
+  profile.recompiling = true;
+  jit.blocks.InvalidateICache(profile.address, 4, true);
+}
+
+void Jit64::DiscardBranchProfile(const JitBlock& block)
+{
+  const auto iter = m_branch_profiles.find(block.checkedEntry);
+  if (iter == m_branch_profiles.end())
+    return;
+
+  // A profile that was taken over waits for the next attempt to compile the block.
+  BranchProfile& profile = iter->second;
+  if (profile.evaluated)
+    m_recompiled_branch_profiles[{profile.address, profile.msr_bits}] = profile;
+  m_branch_profiles.erase(iter);
+}
+
+void Jit64::EraseBranchProfilesOfDestroyedBlocks()
+{
+  for (const u8* entry : blocks.GetDestroyedBlockEntries())
+  {
+    const auto iter = m_branch_profiles.find(entry);
+    if (iter == m_branch_profiles.end())
+      continue;
+
+    BranchProfile& profile = iter->second;
+    if (profile.recompiling)
+    {
+      profile.recompiling = false;
+      auto& recompiled = m_recompiled_branch_profiles[{profile.address, profile.msr_bits}];
+      // Another block for the same address and MSR bits may be waiting to be compiled again.
+      RemoveHotBranches(recompiled);
+      recompiled = profile;
+    }
+    else
+    {
+      RemoveHotBranches(profile);
+    }
+    m_branch_profiles.erase(iter);
+  }
+}
+
+void Jit64::RemoveHotBranches(const BranchProfile& profile)
+{
+  for (u32 i = 0; i < profile.num_branches; i++)
+  {
+    if (profile.hot[i])
+      analyzer.RemoveHotBranch(profile.addresses[i]);
+  }
+}
+
 BitSet8 Jit64::ComputeStaticGQRs(const PPCAnalyst::CodeBlock& cb) const
 {
   return cb.m_gqr_used & ~cb.m_gqr_modified;
@@ -1226,6 +1512,7 @@ void Jit64::EnableOptimization()
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CROR_MERGE);
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CARRY_MERGE);
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW);
+  analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_HOT_BRANCH_FOLLOW);
 }
 
 void Jit64::IntializeSpeculativeConstants()
@@ -18,6 +18,10 @@
 // ----------
 #pragma once
 
+#include <array>
+#include <map>
+#include <utility>
+
 #include <rangeset/rangesizeset.h>
 
 #include "Common/CommonTypes.h"
@@ -33,6 +37,11 @@
 #include "Core/PowerPC/JitCommon/JitBase.h"
 #include "Core/PowerPC/JitCommon/JitCache.h"
 
+namespace JitIR
+{
+struct Instruction;
+}
+
 namespace PPCAnalyst
 {
 struct CodeBlock;
@@ -50,7 +59,8 @@ public:
 
   bool HandleFault(uintptr_t access_address, SContext* ctx) override;
   bool HandleStackFault() override;
-  bool BackPatch(u32 emAddress, SContext* ctx);
+  // Sends the faulting access to the slow path. Unless patch is false, it stays there for good.
+  bool BackPatch(u32 emAddress, SContext* ctx, bool patch);
 
   void EnableOptimization();
   void EnableBlockLink();
@@ -60,6 +70,9 @@ public:
   void Jit(u32 em_address) override;
   void Jit(u32 em_address, bool clear_cache_and_retry_on_failure);
   bool DoJit(u32 em_address, JitBlock* b, u32 nextPC);
+  // Allocates a block and generates its code in the largest free memory regions.
+  // Returns false if there isn't enough free space in either of the two.
+  bool JitToFreeCodeRegion(u32 em_address, u32 nextPC);
 
   // Finds a free memory region and sets the near and far code emitters to point at that region.
   // Returns false if no free memory region can be found for either of the two.
@@ -70,6 +83,13 @@ public:
 
   void IntializeSpeculativeConstants();
 
+  // Compiles the run of integer instructions which starts at the instruction from the JIT IR, if
+  // the IR passes remove operations from it. Returns the number of instructions which were
+  // compiled, or 0 if the instruction has to be compiled on its own.
+  u32 CompileIRRun(u32 index);
+  void CompileIROperation(const JitIR::Instruction& instruction, Gen::X64Reg dest,
+                          const Gen::OpArg& a, const Gen::OpArg& b);
+
   JitBlockCache* GetBlockCache() override { return &blocks; }
   void Trace();
 
@@ -109,6 +129,8 @@ public:
   void DoMergedBranch();
   void DoMergedBranchCondition();
   void DoMergedBranchImmediate(s64 val);
+  // Counts how often the conditional branch at the address is taken, if the block is profiled.
+  void ProfileTakenBranch(u32 address);
 
   // Reads a given bit of a given CR register part.
   void GetCRFieldBit(int field, int bit, Gen::X64Reg out, bool negate = false);
@@ -252,7 +274,43 @@ private:
   void AllocStack();
   void FreeStack();
 
+  // Counts how often the conditional branches in a block are taken, so that the ones which are
+  // usually taken can be followed when the block is compiled again.
+  struct BranchProfile
+  {
+    // The number of times the block runs before the profile is evaluated.
+    static constexpr u32 PERIOD = 1024;
+    static constexpr u32 MAX_BRANCHES = 8;
+
+    // The effective address and MSR bits of the block.
+    u32 address;
+    u32 msr_bits;
+    u32 countdown;
+    u32 num_branches;
+    std::array<u32, MAX_BRANCHES> addresses;
+    std::array<u32, MAX_BRANCHES> taken;
+    // The branches which were added to the analyzer's hot branches.
+    BitSet8 hot;
+    bool evaluated;
+    // Set while the block is destroyed to compile it again with the evaluated profile, so that
+    // the profile is handed over to the new block.
+    bool recompiling;
+  };
+
+  void StartBranchProfile(const JitBlock& block);
+  static void EvaluateBranchProfile(Jit64& jit, BranchProfile* profile);
+  // Forgets the profile of a block which failed to compile.
+  void DiscardBranchProfile(const JitBlock& block);
+  // Forgets the profiles of blocks which were invalidated or evicted, so that they don't affect
+  // the code compiled at the same address later.
+  void EraseBranchProfilesOfDestroyedBlocks();
+  void RemoveHotBranches(const BranchProfile& profile);
+
   void ResetFreeMemoryRanges();
+  void FreeRangesOfDestroyedBlocks();
+  // Destroys the blocks in the oldest part of the near and far code regions, which is cheaper than
+  // clearing the entire cache when running out of space.
+  void EvictOldestCodeRegion();
 
   JitBlockCache blocks{*this};
   TrampolineCache trampolines{*this};
@@ -266,8 +324,25 @@ private:
   bool m_cleanup_after_stackfault;
   u8* m_stack;
 
+  // Indexed by the entry point of the block that owns the profile. Blocks for the same address with
+  // different MSR bits or physical addresses have their own profiles. The JIT code points to the
+  // profiles, so they are only removed before compiling the next block, when the code of destroyed
+  // blocks can't run anymore.
+  std::map<const u8*, BranchProfile> m_branch_profiles;
+  // Evaluated profiles of blocks which were destroyed to be compiled again, indexed by the address
+  // and MSR bits of the block.
+  std::map<std::pair<u32, u32>, BranchProfile> m_recompiled_branch_profiles;
+  // The profile of the block that's being compiled, if any.
+  BranchProfile* m_branch_profile = nullptr;
+
   HyoutaUtilities::RangeSizeSet<u8*> m_free_ranges_near;
   HyoutaUtilities::RangeSizeSet<u8*> m_free_ranges_far;
+
+  u8* m_far_code_begin = nullptr;
+  u8* m_far_code_end = nullptr;
+
+  static constexpr size_t NUM_EVICTION_REGIONS = 8;
+  size_t m_next_eviction_region = 0;
 };
 
 void LogGeneratedX86(size_t size, const PPCAnalyst::CodeBuffer& code_buffer, const u8* normalEntry,
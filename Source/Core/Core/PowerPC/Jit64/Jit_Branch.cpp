@@ -147,6 +147,26 @@ void Jit64::bcx(UGeckoInstruction inst)
     return;
   }
 
+  if (js.op->branchIsFollowed)
+  {
+    // The taken path continues in this block, so only the path that isn't taken exits it.
+    SwitchToFarCode();
+    if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)
+      SetJumpTarget(pConditionDontBranch);
+    if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)
+      SetJumpTarget(pCTRDontBranch);
+
+    {
+      RCForkGuard gpr_guard = gpr.Fork();
+      RCForkGuard fpr_guard = fpr.Fork();
+      gpr.Flush();
+      fpr.Flush();
+      WriteExit(js.compilerPC + 4);
+    }
+    SwitchToNearCode();
+    return;
+  }
+
   {
     RCForkGuard gpr_guard = gpr.Fork();
     RCForkGuard fpr_guard = fpr.Fork();
@@ -159,6 +179,10 @@ void Jit64::bcx(UGeckoInstruction inst)
     }
     else
     {
+      const bool conditional =
+          (inst.BO & BO_DONT_DECREMENT_FLAG) == 0 || (inst.BO & BO_DONT_CHECK_CONDITION) == 0;
+      if (conditional && !inst.LK)
+        ProfileTakenBranch(js.compilerPC);
       WriteExit(js.op->branchTo, inst.LK, js.compilerPC + 4);
     }
   }
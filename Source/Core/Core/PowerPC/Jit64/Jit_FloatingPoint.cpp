@@ -204,9 +204,16 @@ void Jit64::fp_arith(UGeckoInstruction inst)
       avx_op(avxOp, sseOp, dest, Rop1, Rop2, packed, reversible);
     }
 
-    HandleNaNs(inst, Rd, dest);
+    // Round straight from the temporary register, if any, instead of moving it to Rd first.
     if (single)
-      ForceSinglePrecision(Rd, Rd, packed, true);
+    {
+      HandleNaNs(inst, dest, dest);
+      ForceSinglePrecision(Rd, R(dest), packed, true);
+    }
+    else
+    {
+      HandleNaNs(inst, Rd, dest);
+    }
     SetFPRFIfNeeded(Rd);
   };
 
@@ -328,16 +335,15 @@ void Jit64::fmaddXX(UGeckoInstruction inst)
   {
     // We implement nmsub a little differently ((b - a*c) instead of -(a*c - b)), so handle it
     // separately.
-    MOVAPD(XMM1, Rb);
     if (packed)
     {
       MULPD(XMM0, Ra);
-      SUBPD(XMM1, R(XMM0));
+      avx_op(&XEmitter::VSUBPD, &XEmitter::SUBPD, XMM1, Rb, R(XMM0));
     }
     else
     {
       MULSD(XMM0, Ra);
-      SUBSD(XMM1, R(XMM0));
+      avx_op(&XEmitter::VSUBSD, &XEmitter::SUBSD, XMM1, Rb, R(XMM0), false);
     }
   }
   else
@@ -364,8 +370,8 @@ void Jit64::fmaddXX(UGeckoInstruction inst)
 
   if (single)
   {
-    HandleNaNs(inst, Rd, XMM1);
-    ForceSinglePrecision(Rd, Rd, packed, true);
+    HandleNaNs(inst, XMM1, XMM1);
+    ForceSinglePrecision(Rd, R(XMM1), packed, true);
   }
   else
   {
@@ -0,0 +1,427 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "Common/Assert.h"
+#include "Common/CommonTypes.h"
+#include "Common/Metrics.h"
+#include "Common/x64Emitter.h"
+#include "Core/ConfigManager.h"
+#include "Core/HLE/HLE.h"
+#include "Core/PatchEngine.h"
+#include "Core/PowerPC/Jit64/Jit.h"
+#include "Core/PowerPC/Jit64/RegCache/JitRegCache.h"
+#include "Core/PowerPC/Jit64Common/Jit64Constants.h"
+#include "Core/PowerPC/JitCommon/JitIR.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/PPCTables.h"
+
+using namespace Gen;
+
+namespace
+{
+// Runs which need more host registers than this for values that don't live in a guest register
+// are compiled instruction by instruction, so that the register cache keeps enough registers.
+constexpr u32 MAX_TEMPORARIES = 4;
+
+Common::Metrics::Counter s_lowered_runs_metric(Common::Metrics::Thread::CPU, "jit_ir_lowered_runs");
+Common::Metrics::Counter s_removed_operations_metric(Common::Metrics::Thread::CPU,
+                                                     "jit_ir_removed_operations");
+
+enum class Home : u8
+{
+  // An immediate.
+  Const,
+  // The guest register the value was loaded from or is stored to.
+  GPR,
+  // A host register which isn't bound to a guest register.
+  Temporary,
+};
+
+bool IsComputed(const JitIR::Instruction& instruction)
+{
+  switch (instruction.opcode)
+  {
+  case JitIR::Opcode::LoadGPR:
+  case JitIR::Opcode::StoreGPR:
+  case JitIR::Opcode::Const:
+  case JitIR::Opcode::Opaque:
+  case JitIR::Opcode::Exit:
+    return false;
+  default:
+    return true;
+  }
+}
+}  // namespace
+
+u32 Jit64::CompileIRRun(u32 index)
+{
+  if (!jo.lower_integer_runs || SConfig::GetInstance().bEnableDebugging ||
+      SConfig::GetInstance().bJITRegisterCacheOff)
+  {
+    return 0;
+  }
+
+  const PPCAnalyst::CodeOp* ops = &m_code_buffer[index];
+  u32 num_ops;
+  JitIR::Block block =
+      JitIR::Block::FromRun(ops, code_block.m_num_instructions - index, &num_ops);
+
+  // Function hooks are handled by DoJit, so the run has to end before them.
+  for (u32 i = 1; i < num_ops; ++i)
+  {
+    if (HLE::GetHookByFunctionAddress(ops[i].address) != 0)
+    {
+      block = JitIR::Block::FromRun(ops, i, &num_ops);
+      break;
+    }
+  }
+
+  if (num_ops < 2)
+    return 0;
+
+  // Jit64 already propagates the constants it knows of, so only runs in which the passes find
+  // something else are worth lowering.
+  const size_t num_operations = block.GetOperationCount();
+  block.Optimize();
+  const size_t num_removed_operations = num_operations - block.GetOperationCount();
+  if (num_removed_operations == 0)
+    return 0;
+
+  BitSet32 regs_in;
+  for (u32 i = 0; i < num_ops; ++i)
+    regs_in |= ops[i].regsIn;
+  for (const int reg : regs_in)
+  {
+    if (gpr.IsImm(reg))
+      block.SetInitialValue(reg, gpr.Imm32(reg));
+  }
+  block.Optimize();
+
+  const std::vector<JitIR::Instruction>& instructions = block.GetInstructions();
+  const size_t count = instructions.size();
+
+  std::vector<size_t> last_use(count, 0);
+  std::array<JitIR::ValueId, 32> loads;
+  std::array<JitIR::ValueId, 32> stores;
+  loads.fill(JitIR::NO_VALUE);
+  stores.fill(JitIR::NO_VALUE);
+  for (JitIR::ValueId id = 0; id < count; ++id)
+  {
+    const JitIR::Instruction& instruction = instructions[id];
+    if (instruction.removed)
+      continue;
+
+    if (instruction.a != JitIR::NO_VALUE)
+      last_use[instruction.a] = id;
+    if (instruction.b != JitIR::NO_VALUE)
+      last_use[instruction.b] = id;
+
+    switch (instruction.opcode)
+    {
+    case JitIR::Opcode::LoadGPR:
+      loads[instruction.imm] = id;
+      break;
+    case JitIR::Opcode::StoreGPR:
+      // Dead store elimination leaves one store per register in a run.
+      if (stores[instruction.imm] != JitIR::NO_VALUE)
+        return 0;
+      stores[instruction.imm] = id;
+      break;
+    case JitIR::Opcode::ShiftLeft:
+    case JitIR::Opcode::ShiftRight:
+      // Shifts by a register need ECX, which the register cache may have to give up.
+      if (instructions[instruction.b].opcode != JitIR::Opcode::Const)
+        return 0;
+      break;
+    default:
+      break;
+    }
+  }
+
+  // A value which is stored to a register is computed into that register, unless the old value of
+  // the register is loaded after that. The old value of a register which is written while it's
+  // still needed is copied to a temporary.
+  std::vector<Home> home(count, Home::Temporary);
+  std::vector<preg_t> home_reg(count);
+  std::array<size_t, 32> write_point;
+  write_point.fill(count);
+  for (preg_t reg = 0; reg < 32; ++reg)
+  {
+    const JitIR::ValueId store = stores[reg];
+    if (store == JitIR::NO_VALUE)
+      continue;
+
+    const JitIR::ValueId value = instructions[store].a;
+    if (IsComputed(instructions[value]) && home[value] != Home::GPR &&
+        (loads[reg] == JitIR::NO_VALUE || loads[reg] < value))
+    {
+      home[value] = Home::GPR;
+      home_reg[value] = reg;
+      write_point[reg] = value;
+    }
+    else
+    {
+      write_point[reg] = store;
+    }
+  }
+  for (preg_t reg = 0; reg < 32; ++reg)
+  {
+    const JitIR::ValueId load = loads[reg];
+    if (load != JitIR::NO_VALUE && last_use[load] <= write_point[reg])
+    {
+      home[load] = Home::GPR;
+      home_reg[load] = reg;
+    }
+  }
+
+  u32 max_temporaries = 0;
+  std::vector<size_t> temporary_ends;
+  for (JitIR::ValueId id = 0; id < count; ++id)
+  {
+    const JitIR::Instruction& instruction = instructions[id];
+    if (instruction.removed)
+      continue;
+
+    if (instruction.opcode == JitIR::Opcode::Const)
+      home[id] = Home::Const;
+
+    const bool defines_value =
+        IsComputed(instruction) || instruction.opcode == JitIR::Opcode::LoadGPR;
+    if (home[id] != Home::Temporary || !defines_value)
+      continue;
+
+    temporary_ends.erase(std::remove_if(temporary_ends.begin(), temporary_ends.end(),
+                                        [id](size_t end) { return end < id; }),
+                         temporary_ends.end());
+    temporary_ends.push_back(last_use[id]);
+    max_temporaries = std::max(max_temporaries, static_cast<u32>(temporary_ends.size()));
+  }
+  if (max_temporaries > MAX_TEMPORARIES)
+    return 0;
+
+  std::vector<RCX64Reg> temporaries(count);
+  const auto use = [&](JitIR::ValueId id) {
+    switch (home[id])
+    {
+    case Home::Const:
+      return RCOpArg::Imm32(instructions[id].imm);
+    case Home::GPR:
+      return gpr.Use(home_reg[id], RCMode::Read);
+    default:
+      return RCOpArg::R(temporaries[id]);
+    }
+  };
+
+  for (JitIR::ValueId id = 0; id < count; ++id)
+  {
+    const JitIR::Instruction& instruction = instructions[id];
+    if (instruction.removed)
+      continue;
+
+    if (instruction.opcode == JitIR::Opcode::LoadGPR && home[id] == Home::Temporary)
+    {
+      RCOpArg source = gpr.Use(instruction.imm, RCMode::Read);
+      temporaries[id] = gpr.Scratch();
+      RegCache::Realize(source, temporaries[id]);
+      MOV(32, R(temporaries[id]), source);
+    }
+    else if (instruction.opcode == JitIR::Opcode::StoreGPR)
+    {
+      const JitIR::ValueId value = instruction.a;
+      if (home[value] == Home::Const)
+      {
+        gpr.SetImmediate32(instruction.imm, instructions[value].imm);
+      }
+      else if (home[value] != Home::GPR || home_reg[value] != instruction.imm)
+      {
+        RCOpArg source = use(value);
+        RCX64Reg dest = gpr.Bind(instruction.imm, RCMode::Write);
+        RegCache::Realize(source, dest);
+        MOV(32, dest, source);
+      }
+    }
+    else if (IsComputed(instruction))
+    {
+      RCOpArg a = use(instruction.a);
+      RCOpArg b = instruction.b != JitIR::NO_VALUE ? use(instruction.b) : RCOpArg::Imm32(0);
+      RCX64Reg dest;
+      if (home[id] == Home::GPR)
+        dest = gpr.Bind(home_reg[id], RCMode::Write);
+      else
+        dest = gpr.Scratch();
+      RegCache::Realize(a, b, dest);
+      CompileIROperation(instruction, dest, a, b);
+      if (home[id] == Home::Temporary)
+        temporaries[id] = std::move(dest);
+    }
+
+    for (const JitIR::ValueId operand : {instruction.a, instruction.b})
+    {
+      if (operand != JitIR::NO_VALUE && home[operand] == Home::Temporary && last_use[operand] == id)
+        temporaries[operand].Unlock();
+    }
+  }
+
+  s_lowered_runs_metric.Increment();
+  s_removed_operations_metric.Add(num_removed_operations);
+
+  // Account for the instructions after the first one like DoJit would have.
+  for (u32 i = 1; i < num_ops; ++i)
+  {
+    js.downcountAmount += ops[i].opinfo->numCycles;
+    js.downcountAmount += PatchEngine::GetSpeedhackCycles(ops[i].address);
+  }
+
+  const u32 last = index + num_ops - 1;
+  js.compilerPC = m_code_buffer[last].address;
+  js.op = &m_code_buffer[last];
+  js.instructionNumber = last;
+  js.instructionsLeft = (code_block.m_num_instructions - 1) - last;
+  js.isLastInstruction = js.instructionsLeft == 0;
+
+  gpr.Commit();
+  fpr.Commit();
+  gpr.Flush(~js.op->gprInUse);
+  fpr.Flush(~js.op->fprInUse);
+
+  return num_ops;
+}
+
+void Jit64::CompileIROperation(const JitIR::Instruction& instruction, X64Reg dest, const OpArg& a,
+                               const OpArg& b)
+{
+  using JitIR::Opcode;
+
+  // dest = a op b, without overwriting b before it's used.
+  const auto binary = [&](void (XEmitter::*op)(int, const OpArg&, const OpArg&),
+                          bool commutative) {
+    if (a.IsSimpleReg(dest))
+    {
+      (this->*op)(32, R(dest), b);
+    }
+    else if (b.IsSimpleReg(dest) && commutative)
+    {
+      (this->*op)(32, R(dest), a);
+    }
+    else if (b.IsSimpleReg(dest))
+    {
+      MOV(32, R(RSCRATCH), a);
+      (this->*op)(32, R(RSCRATCH), b);
+      MOV(32, R(dest), R(RSCRATCH));
+    }
+    else
+    {
+      MOV(32, R(dest), a);
+      (this->*op)(32, R(dest), b);
+    }
+  };
+  // dest = a op ~b
+  const auto complemented = [&](void (XEmitter::*op)(int, const OpArg&, const OpArg&)) {
+    OpArg complement = Imm32(~b.Imm32());
+    if (!b.IsImm())
+    {
+      MOV(32, R(RSCRATCH), b);
+      NOT(32, R(RSCRATCH));
+      complement = R(RSCRATCH);
+    }
+    if (!a.IsSimpleReg(dest))
+      MOV(32, R(dest), a);
+    (this->*op)(32, R(dest), complement);
+  };
+
+  switch (instruction.opcode)
+  {
+  case Opcode::Add:
+    binary(&XEmitter::ADD, true);
+    break;
+  case Opcode::Sub:
+    binary(&XEmitter::SUB, false);
+    break;
+  case Opcode::Mul:
+    if (b.IsImm())
+      IMUL(32, dest, a, b);
+    else if (a.IsImm())
+      IMUL(32, dest, b, a);
+    else if (a.IsSimpleReg(dest))
+      IMUL(32, dest, b);
+    else if (b.IsSimpleReg(dest))
+      IMUL(32, dest, a);
+    else
+    {
+      MOV(32, R(dest), a);
+      IMUL(32, dest, b);
+    }
+    break;
+  case Opcode::And:
+    binary(&XEmitter::AND, true);
+    break;
+  case Opcode::Or:
+    binary(&XEmitter::OR, true);
+    break;
+  case Opcode::Xor:
+    binary(&XEmitter::XOR, true);
+    break;
+  case Opcode::AndNot:
+    complemented(&XEmitter::AND);
+    break;
+  case Opcode::OrNot:
+    complemented(&XEmitter::OR);
+    break;
+  case Opcode::Nand:
+    binary(&XEmitter::AND, true);
+    NOT(32, R(dest));
+    break;
+  case Opcode::Nor:
+    binary(&XEmitter::OR, true);
+    NOT(32, R(dest));
+    break;
+  case Opcode::Eqv:
+    binary(&XEmitter::XOR, true);
+    NOT(32, R(dest));
+    break;
+  case Opcode::Neg:
+    if (!a.IsSimpleReg(dest))
+      MOV(32, R(dest), a);
+    NEG(32, R(dest));
+    break;
+  case Opcode::ShiftLeft:
+  case Opcode::ShiftRight:
+  {
+    // Shifts by 32 to 63 clear the register, like slw and srw do.
+    const u32 amount = b.Imm32() & 0x3F;
+    if (amount >= 32)
+    {
+      XOR(32, R(dest), R(dest));
+      break;
+    }
+    if (!a.IsSimpleReg(dest))
+      MOV(32, R(dest), a);
+    if (amount == 0)
+      break;
+    if (instruction.opcode == Opcode::ShiftLeft)
+      SHL(32, R(dest), Imm8(amount));
+    else
+      SHR(32, R(dest), Imm8(amount));
+    break;
+  }
+  case Opcode::RotateLeftAndMask:
+    RotateLeft(32, dest, a, static_cast<u8>(instruction.imm));
+    AndWithMask(dest, instruction.imm2);
+    break;
+  case Opcode::SignExtend8:
+    MOVSX(32, 8, dest, a);
+    break;
+  case Opcode::SignExtend16:
+    MOVSX(32, 16, dest, a);
+    break;
+  default:
+    ASSERT_MSG(DYNA_REC, false, "Unexpected JIT IR opcode %d",
+               static_cast<int>(instruction.opcode));
+    break;
+  }
+}
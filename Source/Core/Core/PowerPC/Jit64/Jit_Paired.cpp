@@ -76,8 +76,8 @@ void Jit64::ps_sum(UGeckoInstruction inst)
   default:
     PanicAlertFmt("ps_sum WTF!!!");
   }
-  HandleNaNs(inst, Rd, tmp, tmp == XMM1 ? XMM0 : XMM1);
-  ForceSinglePrecision(Rd, Rd);
+  HandleNaNs(inst, tmp, tmp, tmp == XMM1 ? XMM0 : XMM1);
+  ForceSinglePrecision(Rd, R(tmp));
   SetFPRFIfNeeded(Rd);
 }
 
@@ -111,8 +111,8 @@ void Jit64::ps_muls(UGeckoInstruction inst)
   if (round_input)
     Force25BitPrecision(XMM1, R(XMM1), XMM0);
   MULPD(XMM1, Ra);
-  HandleNaNs(inst, Rd, XMM1);
-  ForceSinglePrecision(Rd, Rd);
+  HandleNaNs(inst, XMM1, XMM1);
+  ForceSinglePrecision(Rd, R(XMM1));
   SetFPRFIfNeeded(Rd);
 }
 
@@ -68,6 +68,7 @@ void JitBlockCache::DestroyBlock(JitBlock& block)
     m_ranges_to_free_on_next_codegen_near.emplace_back(block.near_begin, block.near_end);
   if (block.far_begin != block.far_end)
     m_ranges_to_free_on_next_codegen_far.emplace_back(block.far_begin, block.far_end);
+  m_destroyed_block_entries.push_back(block.checkedEntry);
 }
 
 const std::vector<std::pair<u8*, u8*>>& JitBlockCache::GetRangesToFreeNear() const
@@ -80,8 +81,14 @@ const std::vector<std::pair<u8*, u8*>>& JitBlockCache::GetRangesToFreeFar() cons
   return m_ranges_to_free_on_next_codegen_far;
 }
 
+const std::vector<const u8*>& JitBlockCache::GetDestroyedBlockEntries() const
+{
+  return m_destroyed_block_entries;
+}
+
 void JitBlockCache::ClearRangesToFree()
 {
   m_ranges_to_free_on_next_codegen_near.clear();
   m_ranges_to_free_on_next_codegen_far.clear();
+  m_destroyed_block_entries.clear();
 }
@@ -21,6 +21,8 @@ public:
 
   const std::vector<std::pair<u8*, u8*>>& GetRangesToFreeNear() const;
   const std::vector<std::pair<u8*, u8*>>& GetRangesToFreeFar() const;
+  // The entry points of the blocks which were destroyed since the ranges were cleared.
+  const std::vector<const u8*>& GetDestroyedBlockEntries() const;
 
   void ClearRangesToFree();
 
@@ -30,4 +32,5 @@ private:
 
   std::vector<std::pair<u8*, u8*>> m_ranges_to_free_on_next_codegen_near;
   std::vector<std::pair<u8*, u8*>> m_ranges_to_free_on_next_codegen_far;
+  std::vector<const u8*> m_destroyed_block_entries;
 };
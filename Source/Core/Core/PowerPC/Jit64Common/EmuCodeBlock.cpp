@@ -344,6 +344,7 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg& opAddress,
     info.offset = offset;
     info.registersInUse = registersInUse;
     info.flags = flags;
+    info.trampoline = nullptr;
     info.signExtend = signExtend;
     ptrdiff_t padding = BACKPATCH_SIZE - (GetCodePtr() - backpatchStart);
     if (padding > 0)
@@ -515,6 +516,7 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
     info.offset = offset;
     info.registersInUse = registersInUse;
     info.flags = flags;
+    info.trampoline = nullptr;
     ptrdiff_t padding = BACKPATCH_SIZE - (GetCodePtr() - backpatchStart);
     if (padding > 0)
     {
@@ -738,6 +740,14 @@ void EmuCodeBlock::ForceSinglePrecision(X64Reg output, const OpArg& input, bool
       CVTPD2PS(output, input);
       CVTPS2PD(output, R(output));
     }
+    else if (duplicate && input.IsSimpleReg() && cpu_info.bAVX)
+    {
+      // The upper half is overwritten anyway, so take it from the input instead of depending on
+      // the old value of the output.
+      VCVTSD2SS(output, input.GetSimpleReg(), input);
+      CVTSS2SD(output, R(output));
+      MOVDDUP(output, R(output));
+    }
     else
     {
       CVTSD2SS(output, input);
@@ -50,7 +50,8 @@ const u8* TrampolineCache::GenerateReadTrampoline(const TrampolineInfo& info)
 
   JMP(info.start + info.len, true);
 
-  JitRegister::Register(trampoline, GetCodePtr(), "JIT_ReadTrampoline_%x", info.pc);
+  JitRegister::RegisterWithLines(trampoline, GetCodePtr(), {{trampoline, info.pc}},
+                                 "JIT_ReadTrampoline_%x", info.pc);
   return trampoline;
 }
 
@@ -69,6 +70,7 @@ const u8* TrampolineCache::GenerateWriteTrampoline(const TrampolineInfo& info)
 
   JMP(info.start + info.len, true);
 
-  JitRegister::Register(trampoline, GetCodePtr(), "JIT_WriteTrampoline_%x", info.pc);
+  JitRegister::RegisterWithLines(trampoline, GetCodePtr(), {{trampoline, info.pc}},
+                                 "JIT_WriteTrampoline_%x", info.pc);
   return trampoline;
 }
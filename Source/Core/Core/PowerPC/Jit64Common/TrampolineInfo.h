@@ -47,4 +47,7 @@ struct TrampolineInfo final
 
   // Set to true if we added the offset to the address and need to undo it
   bool offsetAddedToAddress : 1;
+
+  // The slow path, once a fault generated it
+  const u8* trampoline = nullptr;
 };
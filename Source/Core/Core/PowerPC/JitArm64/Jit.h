@@ -170,6 +170,7 @@ private:
   {
     u32 length;
     const u8* slowmem_code;
+    bool is_write;
   };
 
   static void InitializeInstructionTables();
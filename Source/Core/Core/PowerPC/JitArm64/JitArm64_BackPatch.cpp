@@ -168,12 +168,14 @@ void JitArm64::EmitBackpatchRoutine(u32 flags, bool fastmem, bool do_farcode, AR
         m_handler_to_loc[handler] = handler_loc;
         fastmem_area->slowmem_code = handler_loc;
         fastmem_area->length = fastmem_end - fastmem_start;
+        fastmem_area->is_write = !(flags & BackPatchInfo::FLAG_LOAD);
       }
       else
       {
         const u8* handler_loc = handler_loc_iter->second;
         fastmem_area->slowmem_code = handler_loc;
         fastmem_area->length = fastmem_end - fastmem_start;
+        fastmem_area->is_write = !(flags & BackPatchInfo::FLAG_LOAD);
         return;
       }
     }
@@ -316,6 +318,26 @@ bool JitArm64::HandleFastmemFault(uintptr_t access_address, SContext* ctx)
   if ((const u8*)ctx->CTX_PC - fault_location > fastmem_area_length)
     return false;
 
+  // The MMU maps the pages which the page table translates as they are used, so the first access
+  // to a page faults. Retry the access once the page is mapped. If it can't be mapped yet, call
+  // the slow path like the patched code would, without patching the access.
+  const auto logical_base = reinterpret_cast<uintptr_t>(Memory::logical_base);
+  if (access_address >= logical_base && access_address < logical_base + 0x100010000)
+  {
+    const u32 em_address = static_cast<u32>(access_address - logical_base);
+    switch (PowerPC::HandlePageTableFault(em_address, slow_handler_iter->second.is_write))
+    {
+    case PowerPC::PageTableFaultResult::Mapped:
+      return true;
+    case PowerPC::PageTableFaultResult::SlowPath:
+      ctx->CTX_LR = reinterpret_cast<std::uintptr_t>(fault_location + fastmem_area_length);
+      ctx->CTX_PC = reinterpret_cast<std::uintptr_t>(slow_handler_iter->second.slowmem_code);
+      return true;
+    case PowerPC::PageTableFaultResult::NotMappable:
+      break;
+    }
+  }
+
   ARM64XEmitter emitter((u8*)fault_location);
 
   emitter.BL(slow_handler_iter->second.slowmem_code);
@@ -26,6 +26,12 @@ JitBase::JitBase() : m_code_buffer(code_buffer_size)
 
 JitBase::~JitBase() = default;
 
+u32 JitBase::AnalyzeBlock(u32 address, PPCAnalyst::CodeBlock* block,
+                          PPCAnalyst::CodeBuffer* buffer)
+{
+  return analyzer.Analyze(address, block, buffer, buffer->size());
+}
+
 bool JitBase::CanMergeNextInstructions(int count) const
 {
   if (CPU::IsStepping() || js.instructionsLeft < count)
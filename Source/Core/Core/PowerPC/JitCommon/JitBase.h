@@ -6,9 +6,11 @@
 
 #include <cstddef>
 #include <map>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "Common/CommonTypes.h"
+#include "Common/JitRegister.h"
 #include "Common/x64Emitter.h"
 #include "Core/ConfigManager.h"
 #include "Core/MachineContext.h"
@@ -51,6 +53,7 @@ protected:
     bool fastmem_arena;
     bool memcheck;
     bool profile_blocks;
+    bool lower_integer_runs;
   };
   struct JitState
   {
@@ -89,8 +92,15 @@ protected:
 
     JitBlock* curBlock;
 
+    // Where the near and far code of each instruction of the block starts, for the line tables of
+    // JitRegister. Only filled in while JitRegister is enabled.
+    JitRegister::SourceLines near_source_lines;
+    JitRegister::SourceLines far_source_lines;
+
     std::unordered_set<u32> fifoWriteAddresses;
     std::unordered_set<u32> pairedQuantizeAddresses;
+    // How often the GQR values which blocks were compiled with turned out to be wrong.
+    std::unordered_map<u32, u32> pairedQuantizeMisses;
     std::unordered_set<u32> noSpeculativeConstantsAddresses;
   };
 
@@ -116,6 +126,9 @@ public:
   virtual bool HandleFault(uintptr_t access_address, SContext* ctx) = 0;
   virtual bool HandleStackFault() { return false; }
 
+  // Analyzes the code at the address with the options the JIT uses, without compiling it.
+  u32 AnalyzeBlock(u32 address, PPCAnalyst::CodeBlock* block, PPCAnalyst::CodeBuffer* buffer);
+
   static constexpr std::size_t code_buffer_size = 32000;
 
   // This should probably be removed from public:
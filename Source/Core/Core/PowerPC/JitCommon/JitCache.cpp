@@ -65,6 +65,7 @@ void JitBaseBlockCache::Clear()
 #endif
   m_jit.js.fifoWriteAddresses.clear();
   m_jit.js.pairedQuantizeAddresses.clear();
+  m_jit.js.pairedQuantizeMisses.clear();
   for (auto& e : block_map)
   {
     DestroyBlock(e.second);
@@ -107,6 +108,20 @@ JitBlock* JitBaseBlockCache::AllocateBlock(u32 em_address)
   return &b;
 }
 
+void JitBaseBlockCache::DiscardBlock(JitBlock& block)
+{
+  // The block isn't linked or registered anywhere else yet.
+  auto iter = block_map.equal_range(block.physicalAddress);
+  for (; iter.first != iter.second; iter.first++)
+  {
+    if (&iter.first->second == &block)
+    {
+      block_map.erase(iter.first);
+      return;
+    }
+  }
+}
+
 void JitBaseBlockCache::FinalizeBlock(JitBlock& block, bool block_link,
                                       const std::set<u32>& physical_addresses)
 {
@@ -133,17 +148,35 @@ void JitBaseBlockCache::FinalizeBlock(JitBlock& block, bool block_link,
     LinkBlock(block);
   }
 
+  // The far code of a block is registered as a separate symbol, as it isn't contiguous with the
+  // near code. Only JITs which fill in the line tables set the far code range.
+  const JitRegister::SourceLines& near_lines = m_jit.js.near_source_lines;
+  const JitRegister::SourceLines& far_lines = m_jit.js.far_source_lines;
+  const u8* near_end = block.checkedEntry + block.codeSize;
+  const bool has_far_code = !far_lines.empty() && block.far_begin != block.far_end;
+
   Common::Symbol* symbol = nullptr;
   if (JitRegister::IsEnabled() &&
       (symbol = g_symbolDB.GetSymbolFromAddr(block.effectiveAddress)) != nullptr)
   {
-    JitRegister::Register(block.checkedEntry, block.codeSize, "JIT_PPC_%s_%08x",
-                          symbol->function_name.c_str(), block.physicalAddress);
+    JitRegister::RegisterWithLines(block.checkedEntry, near_end, near_lines, "JIT_PPC_%s_%08x",
+                                   symbol->function_name.c_str(), block.physicalAddress);
+    if (has_far_code)
+    {
+      JitRegister::RegisterWithLines(block.far_begin, block.far_end, far_lines,
+                                     "JIT_PPC_%s_%08x_far", symbol->function_name.c_str(),
+                                     block.physicalAddress);
+    }
   }
   else
   {
-    JitRegister::Register(block.checkedEntry, block.codeSize, "JIT_PPC_%08x",
-                          block.physicalAddress);
+    JitRegister::RegisterWithLines(block.checkedEntry, near_end, near_lines, "JIT_PPC_%08x",
+                                   block.physicalAddress);
+    if (has_far_code)
+    {
+      JitRegister::RegisterWithLines(block.far_begin, block.far_end, far_lines,
+                                     "JIT_PPC_%08x_far", block.physicalAddress);
+    }
   }
 }
 
@@ -216,6 +249,7 @@ void JitBaseBlockCache::InvalidateICache(u32 address, u32 length, bool forced)
       {
         m_jit.js.fifoWriteAddresses.erase(i);
         m_jit.js.pairedQuantizeAddresses.erase(i);
+        m_jit.js.pairedQuantizeMisses.erase(i);
       }
     }
   }
@@ -270,6 +304,38 @@ void JitBaseBlockCache::ErasePhysicalRange(u32 address, u32 length)
   }
 }
 
+size_t JitBaseBlockCache::EraseBlocks(const std::function<bool(const JitBlock&)>& predicate)
+{
+  const u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
+  size_t erased = 0;
+  auto iter = block_map.begin();
+  while (iter != block_map.end())
+  {
+    JitBlock& block = iter->second;
+    if (!predicate(block))
+    {
+      iter++;
+      continue;
+    }
+
+    for (u32 addr : block.physical_addresses)
+    {
+      auto macro_block = block_range_map.find(addr & range_mask);
+      if (macro_block == block_range_map.end())
+        continue;
+      macro_block->second.erase(&block);
+      if (macro_block->second.empty())
+        block_range_map.erase(macro_block);
+    }
+
+    // The valid_block bits are left set, as other blocks may overlap the same cache lines.
+    DestroyBlock(block);
+    iter = block_map.erase(iter);
+    erased++;
+  }
+  return erased;
+}
+
 u32* JitBaseBlockCache::GetBlockBitSet() const
 {
   return valid_block.m_valid_block.get();
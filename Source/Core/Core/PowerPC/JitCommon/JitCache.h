@@ -147,6 +147,10 @@ public:
 
   JitBlock* AllocateBlock(u32 em_address);
   void FinalizeBlock(JitBlock& block, bool block_link, const std::set<u32>& physical_addresses);
+  // Removes a block which was allocated but never finalized, e.g. because code generation failed.
+  void DiscardBlock(JitBlock& block);
+
+  size_t GetBlockCount() const { return block_map.size(); }
 
   // Look for the block in the slow but accurate way.
   // This function shall be used if FastLookupIndexForAddress() failed.
@@ -161,6 +165,10 @@ public:
 
   void InvalidateICache(u32 address, u32 length, bool forced);
   void ErasePhysicalRange(u32 address, u32 length);
+  // Destroys all blocks for which the predicate returns true, and unlinks the blocks which link to
+  // them. Unlike ErasePhysicalRange, this doesn't affect the blocks for the same emulated code.
+  // Returns the number of destroyed blocks.
+  size_t EraseBlocks(const std::function<bool(const JitBlock&)>& predicate);
 
   u32* GetBlockBitSet() const;
 
@@ -0,0 +1,730 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/PowerPC/JitCommon/JitIR.h"
+
+#include <array>
+#include <map>
+#include <tuple>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "Common/BitUtils.h"
+#include "Core/PowerPC/Gekko.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/PPCTables.h"
+
+namespace JitIR
+{
+namespace
+{
+bool IsBinary(Opcode opcode)
+{
+  switch (opcode)
+  {
+  case Opcode::Add:
+  case Opcode::Sub:
+  case Opcode::Mul:
+  case Opcode::And:
+  case Opcode::Or:
+  case Opcode::Xor:
+  case Opcode::AndNot:
+  case Opcode::OrNot:
+  case Opcode::Nand:
+  case Opcode::Nor:
+  case Opcode::Eqv:
+  case Opcode::ShiftLeft:
+  case Opcode::ShiftRight:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool IsUnary(Opcode opcode)
+{
+  switch (opcode)
+  {
+  case Opcode::Neg:
+  case Opcode::RotateLeftAndMask:
+  case Opcode::SignExtend8:
+  case Opcode::SignExtend16:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool IsCommutative(Opcode opcode)
+{
+  switch (opcode)
+  {
+  case Opcode::Add:
+  case Opcode::Mul:
+  case Opcode::And:
+  case Opcode::Or:
+  case Opcode::Xor:
+  case Opcode::Nand:
+  case Opcode::Nor:
+  case Opcode::Eqv:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Whether the value of the instruction only depends on its operands.
+bool IsPure(Opcode opcode)
+{
+  return opcode == Opcode::Const || IsUnary(opcode) || IsBinary(opcode);
+}
+
+u32 Evaluate(const Instruction& instruction, u32 a, u32 b)
+{
+  switch (instruction.opcode)
+  {
+  case Opcode::Add:
+    return a + b;
+  case Opcode::Sub:
+    return a - b;
+  case Opcode::Mul:
+    return a * b;
+  case Opcode::And:
+    return a & b;
+  case Opcode::Or:
+    return a | b;
+  case Opcode::Xor:
+    return a ^ b;
+  case Opcode::AndNot:
+    return a & ~b;
+  case Opcode::OrNot:
+    return a | ~b;
+  case Opcode::Nand:
+    return ~(a & b);
+  case Opcode::Nor:
+    return ~(a | b);
+  case Opcode::Eqv:
+    return ~(a ^ b);
+  case Opcode::Neg:
+    return 0 - a;
+  case Opcode::ShiftLeft:
+    return (b & 0x20) ? 0 : a << (b & 0x1F);
+  case Opcode::ShiftRight:
+    return (b & 0x20) ? 0 : a >> (b & 0x1F);
+  case Opcode::RotateLeftAndMask:
+    return Common::RotateLeft(a, instruction.imm) & instruction.imm2;
+  case Opcode::SignExtend8:
+    return u32(s32(s8(a)));
+  case Opcode::SignExtend16:
+    return u32(s32(s16(a)));
+  default:
+    return 0;
+  }
+}
+
+const char* GetOpcodeName(Opcode opcode)
+{
+  switch (opcode)
+  {
+  case Opcode::LoadGPR:
+    return "load";
+  case Opcode::StoreGPR:
+    return "store";
+  case Opcode::Const:
+    return "const";
+  case Opcode::Add:
+    return "add";
+  case Opcode::Sub:
+    return "sub";
+  case Opcode::Mul:
+    return "mul";
+  case Opcode::And:
+    return "and";
+  case Opcode::Or:
+    return "or";
+  case Opcode::Xor:
+    return "xor";
+  case Opcode::AndNot:
+    return "andnot";
+  case Opcode::OrNot:
+    return "ornot";
+  case Opcode::Nand:
+    return "nand";
+  case Opcode::Nor:
+    return "nor";
+  case Opcode::Eqv:
+    return "eqv";
+  case Opcode::Neg:
+    return "neg";
+  case Opcode::ShiftLeft:
+    return "shl";
+  case Opcode::ShiftRight:
+    return "shr";
+  case Opcode::RotateLeftAndMask:
+    return "rotlmask";
+  case Opcode::SignExtend8:
+    return "sext8";
+  case Opcode::SignExtend16:
+    return "sext16";
+  case Opcode::Opaque:
+    return "opaque";
+  case Opcode::Exit:
+    return "exit";
+  }
+  return "unknown";
+}
+}  // namespace
+
+Block::Block(const PPCAnalyst::CodeOp* ops, u32 num_ops)
+{
+  for (u32 i = 0; i < num_ops; ++i)
+  {
+    const PPCAnalyst::CodeOp& op = ops[i];
+    if (op.skip)
+      continue;
+
+    m_address = op.address;
+    if (EmitOperation(op))
+      continue;
+
+    Instruction opaque{Opcode::Opaque};
+    opaque.regs_in = op.regsIn;
+    opaque.regs_out = op.regsOut;
+    // lswx and lswi can write any number of registers, which the analyzer doesn't know.
+    if (op.inst.OPCD == 31 && (op.inst.SUBOP10 == 533 || op.inst.SUBOP10 == 597))
+      opaque.regs_out = BitSet32::AllTrue(32);
+    opaque.name = op.opinfo ? op.opinfo->opname : nullptr;
+    Emit(opaque);
+  }
+
+  Emit(Instruction{Opcode::Exit});
+}
+
+Block Block::FromRun(const PPCAnalyst::CodeOp* ops, u32 num_ops, u32* num_translated)
+{
+  Block block;
+  u32 i = 0;
+  for (; i < num_ops; ++i)
+  {
+    if (ops[i].skip)
+      break;
+
+    block.m_address = ops[i].address;
+    if (!block.EmitOperation(ops[i]))
+      break;
+  }
+
+  block.Emit(Instruction{Opcode::Exit});
+  *num_translated = i;
+  return block;
+}
+
+void Block::SetInitialValue(u32 reg, u32 value)
+{
+  for (ValueId id = 0; id < m_instructions.size(); ++id)
+  {
+    const Instruction& instruction = m_instructions[id];
+    if (instruction.removed)
+      continue;
+
+    if (instruction.opcode == Opcode::StoreGPR && instruction.imm == reg)
+      return;
+    if (instruction.opcode == Opcode::Opaque && instruction.regs_out[reg])
+      return;
+    if (instruction.opcode == Opcode::LoadGPR && instruction.imm == reg)
+      ReplaceWithConst(id, value);
+  }
+}
+
+ValueId Block::Emit(const Instruction& instruction)
+{
+  const ValueId id = static_cast<ValueId>(m_instructions.size());
+  m_instructions.push_back(instruction);
+  m_instructions.back().address = m_address;
+  return id;
+}
+
+ValueId Block::EmitConst(u32 value)
+{
+  Instruction instruction{Opcode::Const};
+  instruction.imm = value;
+  return Emit(instruction);
+}
+
+ValueId Block::EmitBinary(Opcode opcode, ValueId a, ValueId b)
+{
+  Instruction instruction{opcode};
+  instruction.a = a;
+  instruction.b = b;
+  return Emit(instruction);
+}
+
+ValueId Block::EmitLoad(u32 reg)
+{
+  Instruction instruction{Opcode::LoadGPR};
+  instruction.imm = reg;
+  return Emit(instruction);
+}
+
+void Block::EmitStore(u32 reg, ValueId value)
+{
+  Instruction instruction{Opcode::StoreGPR};
+  instruction.a = value;
+  instruction.imm = reg;
+  Emit(instruction);
+}
+
+bool Block::EmitOperation(const PPCAnalyst::CodeOp& op)
+{
+  const UGeckoInstruction inst = op.inst;
+
+  // (rA|0) + imm
+  const auto add_immediate = [&](u32 imm) {
+    const ValueId value = EmitConst(imm);
+    EmitStore(inst.RD, inst.RA ? EmitBinary(Opcode::Add, EmitLoad(inst.RA), value) : value);
+  };
+  // rA = rS op imm
+  const auto logical_immediate = [&](Opcode opcode, u32 imm) {
+    EmitStore(inst.RA, EmitBinary(opcode, EmitLoad(inst.RS), EmitConst(imm)));
+  };
+  // rA = rS op rB
+  const auto logical = [&](Opcode opcode) {
+    EmitStore(inst.RA, EmitBinary(opcode, EmitLoad(inst.RS), EmitLoad(inst.RB)));
+  };
+  // rD = rA op rB
+  const auto arithmetic = [&](Opcode opcode) {
+    EmitStore(inst.RD, EmitBinary(opcode, EmitLoad(inst.RA), EmitLoad(inst.RB)));
+  };
+  const auto unary = [&](Opcode opcode, u32 dest, u32 source) {
+    Instruction instruction{opcode};
+    instruction.a = EmitLoad(source);
+    EmitStore(dest, Emit(instruction));
+  };
+
+  switch (inst.OPCD)
+  {
+  case 7:  // mulli
+    EmitStore(inst.RD, EmitBinary(Opcode::Mul, EmitLoad(inst.RA), EmitConst(u32(inst.SIMM_16))));
+    return true;
+  case 14:  // addi
+    add_immediate(u32(inst.SIMM_16));
+    return true;
+  case 15:  // addis
+    add_immediate(u32(inst.SIMM_16) << 16);
+    return true;
+  case 21:  // rlwinm
+  {
+    if (inst.Rc)
+      return false;
+    Instruction instruction{Opcode::RotateLeftAndMask};
+    instruction.a = EmitLoad(inst.RS);
+    instruction.imm = inst.SH;
+    instruction.imm2 = MakeRotationMask(inst.MB, inst.ME);
+    EmitStore(inst.RA, Emit(instruction));
+    return true;
+  }
+  case 24:  // ori
+    logical_immediate(Opcode::Or, inst.UIMM);
+    return true;
+  case 25:  // oris
+    logical_immediate(Opcode::Or, inst.UIMM << 16);
+    return true;
+  case 26:  // xori
+    logical_immediate(Opcode::Xor, inst.UIMM);
+    return true;
+  case 27:  // xoris
+    logical_immediate(Opcode::Xor, inst.UIMM << 16);
+    return true;
+  case 31:
+    break;
+  default:
+    return false;
+  }
+
+  // The XO-form opcodes only match when OE is clear, since it's the top bit of SUBOP10.
+  if (inst.Rc)
+    return false;
+
+  switch (inst.SUBOP10)
+  {
+  case 266:  // add
+    arithmetic(Opcode::Add);
+    return true;
+  case 40:  // subf
+    EmitStore(inst.RD, EmitBinary(Opcode::Sub, EmitLoad(inst.RB), EmitLoad(inst.RA)));
+    return true;
+  case 104:  // neg
+    unary(Opcode::Neg, inst.RD, inst.RA);
+    return true;
+  case 235:  // mullw
+    arithmetic(Opcode::Mul);
+    return true;
+  case 28:  // and
+    logical(Opcode::And);
+    return true;
+  case 444:  // or
+    logical(Opcode::Or);
+    return true;
+  case 316:  // xor
+    logical(Opcode::Xor);
+    return true;
+  case 124:  // nor
+    logical(Opcode::Nor);
+    return true;
+  case 60:  // andc
+    logical(Opcode::AndNot);
+    return true;
+  case 412:  // orc
+    logical(Opcode::OrNot);
+    return true;
+  case 476:  // nand
+    logical(Opcode::Nand);
+    return true;
+  case 284:  // eqv
+    logical(Opcode::Eqv);
+    return true;
+  case 24:  // slw
+    logical(Opcode::ShiftLeft);
+    return true;
+  case 536:  // srw
+    logical(Opcode::ShiftRight);
+    return true;
+  case 954:  // extsb
+    unary(Opcode::SignExtend8, inst.RA, inst.RS);
+    return true;
+  case 922:  // extsh
+    unary(Opcode::SignExtend16, inst.RA, inst.RS);
+    return true;
+  default:
+    return false;
+  }
+}
+
+ValueId Block::Resolve(ValueId value) const
+{
+  while (value != NO_VALUE && m_instructions[value].replacement != NO_VALUE)
+    value = m_instructions[value].replacement;
+  return value;
+}
+
+void Block::ResolveOperands(Instruction* instruction) const
+{
+  instruction->a = Resolve(instruction->a);
+  instruction->b = Resolve(instruction->b);
+}
+
+bool Block::IsConst(ValueId value, u32 constant) const
+{
+  const Instruction& instruction = m_instructions[value];
+  return instruction.opcode == Opcode::Const && instruction.imm == constant;
+}
+
+void Block::Replace(ValueId value, ValueId replacement)
+{
+  Instruction& instruction = m_instructions[value];
+  instruction.removed = true;
+  instruction.replacement = replacement;
+}
+
+void Block::ReplaceWithConst(ValueId value, u32 constant)
+{
+  Instruction& instruction = m_instructions[value];
+  instruction.opcode = Opcode::Const;
+  instruction.a = NO_VALUE;
+  instruction.b = NO_VALUE;
+  instruction.imm = constant;
+  instruction.imm2 = 0;
+}
+
+void Block::ForwardLoadsAndStores()
+{
+  std::array<ValueId, 32> gprs;
+  gprs.fill(NO_VALUE);
+
+  for (ValueId id = 0; id < m_instructions.size(); ++id)
+  {
+    Instruction& instruction = m_instructions[id];
+    if (instruction.removed)
+      continue;
+    ResolveOperands(&instruction);
+
+    switch (instruction.opcode)
+    {
+    case Opcode::LoadGPR:
+      if (gprs[instruction.imm] != NO_VALUE)
+        Replace(id, gprs[instruction.imm]);
+      else
+        gprs[instruction.imm] = id;
+      break;
+    case Opcode::StoreGPR:
+      if (gprs[instruction.imm] == instruction.a)
+        instruction.removed = true;
+      else
+        gprs[instruction.imm] = instruction.a;
+      break;
+    case Opcode::Opaque:
+      for (const int reg : instruction.regs_out)
+        gprs[reg] = NO_VALUE;
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+void Block::FoldConstants()
+{
+  for (ValueId id = 0; id < m_instructions.size(); ++id)
+  {
+    Instruction& instruction = m_instructions[id];
+    if (instruction.removed)
+      continue;
+    ResolveOperands(&instruction);
+
+    const bool unary = IsUnary(instruction.opcode);
+    const bool binary = IsBinary(instruction.opcode);
+    if (!unary && !binary)
+      continue;
+
+    const ValueId a = instruction.a;
+    const ValueId b = instruction.b;
+    const bool a_is_const = m_instructions[a].opcode == Opcode::Const;
+    const bool b_is_const = binary && m_instructions[b].opcode == Opcode::Const;
+
+    if (a_is_const && (unary || b_is_const))
+    {
+      const u32 b_value = binary ? m_instructions[b].imm : 0;
+      ReplaceWithConst(id, Evaluate(instruction, m_instructions[a].imm, b_value));
+      continue;
+    }
+
+    switch (instruction.opcode)
+    {
+    case Opcode::Add:
+    case Opcode::Or:
+    case Opcode::Xor:
+      if (IsConst(b, 0))
+        Replace(id, a);
+      else if (IsConst(a, 0))
+        Replace(id, b);
+      else if (a == b && instruction.opcode == Opcode::Or)
+        Replace(id, a);
+      else if (a == b && instruction.opcode == Opcode::Xor)
+        ReplaceWithConst(id, 0);
+      break;
+    case Opcode::Sub:
+      if (IsConst(b, 0))
+        Replace(id, a);
+      else if (a == b)
+        ReplaceWithConst(id, 0);
+      break;
+    case Opcode::And:
+      if (IsConst(b, 0xFFFFFFFF) || a == b)
+        Replace(id, a);
+      else if (IsConst(a, 0xFFFFFFFF))
+        Replace(id, b);
+      else if (IsConst(a, 0) || IsConst(b, 0))
+        ReplaceWithConst(id, 0);
+      break;
+    case Opcode::Mul:
+      if (IsConst(b, 1))
+        Replace(id, a);
+      else if (IsConst(a, 1))
+        Replace(id, b);
+      else if (IsConst(a, 0) || IsConst(b, 0))
+        ReplaceWithConst(id, 0);
+      break;
+    case Opcode::ShiftLeft:
+    case Opcode::ShiftRight:
+      if (IsConst(b, 0))
+        Replace(id, a);
+      break;
+    case Opcode::RotateLeftAndMask:
+      if (instruction.imm == 0 && instruction.imm2 == 0xFFFFFFFF)
+        Replace(id, a);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+void Block::EliminateCommonSubexpressions()
+{
+  using Key = std::tuple<Opcode, ValueId, ValueId, u32, u32>;
+  std::map<Key, ValueId> values;
+
+  for (ValueId id = 0; id < m_instructions.size(); ++id)
+  {
+    Instruction& instruction = m_instructions[id];
+    if (instruction.removed)
+      continue;
+    ResolveOperands(&instruction);
+
+    if (!IsPure(instruction.opcode))
+      continue;
+
+    ValueId a = instruction.a;
+    ValueId b = instruction.b;
+    if (IsCommutative(instruction.opcode) && b < a)
+      std::swap(a, b);
+
+    const Key key{instruction.opcode, a, b, instruction.imm, instruction.imm2};
+    const auto [it, inserted] = values.emplace(key, id);
+    if (!inserted)
+      Replace(id, it->second);
+  }
+}
+
+void Block::EliminateDeadStores()
+{
+  // The registers which are written again before anything can observe their value.
+  BitSet32 overwritten;
+
+  for (size_t i = m_instructions.size(); i-- > 0;)
+  {
+    Instruction& instruction = m_instructions[i];
+    if (instruction.removed)
+      continue;
+
+    switch (instruction.opcode)
+    {
+    case Opcode::StoreGPR:
+      if (overwritten[instruction.imm])
+        instruction.removed = true;
+      overwritten[instruction.imm] = true;
+      break;
+    case Opcode::LoadGPR:
+      overwritten[instruction.imm] = false;
+      break;
+    case Opcode::Opaque:
+    case Opcode::Exit:
+      // These may leave the block, for example through an exception.
+      overwritten = BitSet32{};
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+void Block::EliminateDeadCode()
+{
+  for (Instruction& instruction : m_instructions)
+  {
+    if (!instruction.removed)
+      ResolveOperands(&instruction);
+  }
+
+  std::vector<bool> used(m_instructions.size());
+  for (size_t i = m_instructions.size(); i-- > 0;)
+  {
+    Instruction& instruction = m_instructions[i];
+    if (instruction.removed)
+      continue;
+
+    const bool has_side_effects = instruction.opcode == Opcode::StoreGPR ||
+                                  instruction.opcode == Opcode::Opaque ||
+                                  instruction.opcode == Opcode::Exit;
+    if (!has_side_effects && !used[i])
+    {
+      instruction.removed = true;
+      continue;
+    }
+
+    if (instruction.a != NO_VALUE)
+      used[instruction.a] = true;
+    if (instruction.b != NO_VALUE)
+      used[instruction.b] = true;
+  }
+}
+
+void Block::Optimize()
+{
+  size_t count = GetInstructionCount();
+  while (true)
+  {
+    ForwardLoadsAndStores();
+    FoldConstants();
+    EliminateCommonSubexpressions();
+    EliminateDeadStores();
+    EliminateDeadCode();
+
+    const size_t new_count = GetInstructionCount();
+    if (new_count == count)
+      break;
+    count = new_count;
+  }
+}
+
+size_t Block::GetInstructionCount() const
+{
+  size_t count = 0;
+  for (const Instruction& instruction : m_instructions)
+    count += !instruction.removed;
+  return count;
+}
+
+size_t Block::GetOperationCount() const
+{
+  size_t count = 0;
+  for (const Instruction& instruction : m_instructions)
+  {
+    count += !instruction.removed &&
+             (IsUnary(instruction.opcode) || IsBinary(instruction.opcode));
+  }
+  return count;
+}
+
+std::string Block::Dump() const
+{
+  std::string result;
+  for (ValueId id = 0; id < m_instructions.size(); ++id)
+  {
+    const Instruction& instruction = m_instructions[id];
+    if (instruction.removed)
+      continue;
+
+    result += fmt::format("{:08x}  ", instruction.address);
+    switch (instruction.opcode)
+    {
+    case Opcode::LoadGPR:
+      result += fmt::format("%{} = load r{}", id, instruction.imm);
+      break;
+    case Opcode::StoreGPR:
+      result += fmt::format("store r{}, %{}", instruction.imm, instruction.a);
+      break;
+    case Opcode::Const:
+      result += fmt::format("%{} = const 0x{:x}", id, instruction.imm);
+      break;
+    case Opcode::RotateLeftAndMask:
+      result += fmt::format("%{} = rotlmask %{}, {}, 0x{:08x}", id, instruction.a, instruction.imm,
+                            instruction.imm2);
+      break;
+    case Opcode::Opaque:
+      result += fmt::format("opaque {} in 0x{:08x} out 0x{:08x}",
+                            instruction.name ? instruction.name : "?", instruction.regs_in.m_val,
+                            instruction.regs_out.m_val);
+      break;
+    case Opcode::Exit:
+      result += "exit";
+      break;
+    default:
+      if (IsBinary(instruction.opcode))
+      {
+        result += fmt::format("%{} = {} %{}, %{}", id, GetOpcodeName(instruction.opcode),
+                              instruction.a, instruction.b);
+      }
+      else
+      {
+        result += fmt::format("%{} = {} %{}", id, GetOpcodeName(instruction.opcode), instruction.a);
+      }
+      break;
+    }
+    result += '\n';
+  }
+  return result;
+}
+}  // namespace JitIR
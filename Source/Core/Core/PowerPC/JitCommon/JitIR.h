@@ -0,0 +1,139 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Common/BitSet.h"
+#include "Common/CommonTypes.h"
+
+namespace PPCAnalyst
+{
+struct CodeOp;
+}
+
+// A small SSA intermediate representation of the integer GPR operations of an analyzed block.
+//
+// Each instruction defines at most one value, which is identified by the index of the instruction.
+// GPRs are only accessed through explicit loads from and stores to ppcState, so the passes can
+// forward and remove them. Instructions which aren't modeled become opaque barriers, which read
+// and write their registers in ppcState, and which may leave the block or raise an exception.
+namespace JitIR
+{
+using ValueId = u32;
+constexpr ValueId NO_VALUE = 0xFFFFFFFF;
+
+enum class Opcode : u8
+{
+  // Reads the GPR imm from ppcState.
+  LoadGPR,
+  // Writes a to the GPR imm in ppcState.
+  StoreGPR,
+  // The value imm.
+  Const,
+  Add,
+  // a - b
+  Sub,
+  Mul,
+  And,
+  Or,
+  Xor,
+  // a & ~b
+  AndNot,
+  // a | ~b
+  OrNot,
+  Nand,
+  Nor,
+  Eqv,
+  Neg,
+  // Shifts by the low 6 bits of b, like slw and srw.
+  ShiftLeft,
+  ShiftRight,
+  // Rotates a left by imm, and masks the result with imm2.
+  RotateLeftAndMask,
+  SignExtend8,
+  SignExtend16,
+  // An instruction which isn't modeled.
+  Opaque,
+  // The end of the block.
+  Exit,
+};
+
+struct Instruction
+{
+  Opcode opcode;
+  ValueId a = NO_VALUE;
+  ValueId b = NO_VALUE;
+  u32 imm = 0;
+  u32 imm2 = 0;
+  // The GPRs an opaque instruction reads and writes in ppcState.
+  BitSet32 regs_in;
+  BitSet32 regs_out;
+  // The address of the PowerPC instruction this was generated from.
+  u32 address = 0;
+  const char* name = nullptr;
+  // Removed instructions are kept so that the indices don't change. Uses of their value are
+  // replaced with the replacement.
+  bool removed = false;
+  ValueId replacement = NO_VALUE;
+};
+
+class Block
+{
+public:
+  Block(const PPCAnalyst::CodeOp* ops, u32 num_ops);
+
+  // Translates the longest run of operations at the start of ops which the IR models, so that the
+  // block doesn't contain opaque instructions. Skipped operations end the run as well.
+  // num_translated is set to the number of operations in the run.
+  static Block FromRun(const PPCAnalyst::CodeOp* ops, u32 num_ops, u32* num_translated);
+
+  // Replaces loads of the value the GPR has at the start of the block with the constant.
+  void SetInitialValue(u32 reg, u32 value);
+
+  // Replaces loads of GPRs with the last value loaded from or stored to them, and removes stores
+  // of the value a GPR already has.
+  void ForwardLoadsAndStores();
+  // Evaluates instructions with constant operands, and simplifies identities like x + 0.
+  void FoldConstants();
+  void EliminateCommonSubexpressions();
+  // Removes stores to GPRs which are overwritten before anything can observe them.
+  void EliminateDeadStores();
+  // Removes instructions whose values aren't used.
+  void EliminateDeadCode();
+
+  // Runs all passes until they don't remove anything anymore.
+  void Optimize();
+
+  // The number of instructions which weren't removed.
+  size_t GetInstructionCount() const;
+  // The number of instructions which weren't removed, and which compute a value from operands.
+  size_t GetOperationCount() const;
+  const std::vector<Instruction>& GetInstructions() const { return m_instructions; }
+
+  std::string Dump() const;
+
+private:
+  Block() = default;
+
+  ValueId Emit(const Instruction& instruction);
+  ValueId EmitConst(u32 value);
+  ValueId EmitBinary(Opcode opcode, ValueId a, ValueId b);
+  ValueId EmitLoad(u32 reg);
+  void EmitStore(u32 reg, ValueId value);
+  bool EmitOperation(const PPCAnalyst::CodeOp& op);
+
+  ValueId Resolve(ValueId value) const;
+  void ResolveOperands(Instruction* instruction) const;
+  bool IsConst(ValueId value, u32 constant) const;
+  void Replace(ValueId value, ValueId replacement);
+  void ReplaceWithConst(ValueId value, u32 constant);
+
+  std::vector<Instruction> m_instructions;
+  u32 m_address = 0;
+};
+}  // namespace JitIR
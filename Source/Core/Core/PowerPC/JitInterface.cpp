@@ -9,6 +9,7 @@
 #include <cstdio>
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -21,13 +22,17 @@
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
+#include "Common/Metrics.h"
 #include "Common/MsgHandler.h"
 
 #include "Core/Core.h"
 #include "Core/PowerPC/CPUCoreBase.h"
 #include "Core/PowerPC/CachedInterpreter/CachedInterpreter.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/JitCommon/JitIR.h"
 #include "Core/PowerPC/MMU.h"
+#include "Core/PowerPC/PPCAnalyst.h"
 #include "Core/PowerPC/PPCSymbolDB.h"
 #include "Core/PowerPC/PowerPC.h"
 #include "Core/PowerPC/Profiler.h"
@@ -153,6 +158,67 @@ void GetProfileResults(Profiler::ProfileStats* prof_stats)
     Core::SetState(Core::State::Running);
 }
 
+void WriteIRReport(const std::string& filename)
+{
+  if (!g_jit)
+    return;
+
+  Core::State old_state = Core::GetState();
+  if (old_state == Core::State::Running)
+    Core::SetState(Core::State::Paused);
+
+  std::vector<u32> addresses;
+  const u32 msr_bits = MSR.Hex & JitBaseBlockCache::JIT_CACHE_MSR_MASK;
+  g_jit->GetBlockCache()->RunOnBlocks([&addresses, msr_bits](const JitBlock& block) {
+    if (block.msrBits == msr_bits)
+      addresses.push_back(block.effectiveAddress);
+  });
+  std::sort(addresses.begin(), addresses.end());
+
+  PPCAnalyst::BlockStats stats;
+  PPCAnalyst::BlockRegStats gpa;
+  PPCAnalyst::BlockRegStats fpa;
+  PPCAnalyst::CodeBlock code_block;
+  code_block.m_stats = &stats;
+  code_block.m_gpa = &gpa;
+  code_block.m_fpa = &fpa;
+  PPCAnalyst::CodeBuffer code_buffer(JitBase::code_buffer_size);
+
+  std::string summary = "address\tppcInsts\tirInsts\toptimizedIrInsts\n";
+  std::string dumps;
+  size_t total_ppc = 0;
+  size_t total_ir = 0;
+  size_t total_optimized = 0;
+  for (const u32 address : addresses)
+  {
+    g_jit->AnalyzeBlock(address, &code_block, &code_buffer);
+    JitIR::Block block(code_buffer.data(), code_block.m_num_instructions);
+    const size_t ir_count = block.GetInstructionCount();
+    block.Optimize();
+    const size_t optimized_count = block.GetInstructionCount();
+
+    summary += fmt::format("{:08x}\t{}\t{}\t{}\n", address, code_block.m_num_instructions,
+                           ir_count, optimized_count);
+    dumps += fmt::format("\n{:08x}:\n{}", address, block.Dump());
+    total_ppc += code_block.m_num_instructions;
+    total_ir += ir_count;
+    total_optimized += optimized_count;
+  }
+
+  if (old_state == Core::State::Running)
+    Core::SetState(Core::State::Running);
+
+  File::IOFile f(filename, "w");
+  if (!f)
+  {
+    PanicAlertFmt("Failed to open {}", filename);
+    return;
+  }
+  f.WriteString(summary);
+  f.WriteString(fmt::format("total\t{}\t{}\t{}\n", total_ppc, total_ir, total_optimized));
+  f.WriteString(dumps);
+}
+
 int GetHostCode(u32* address, const u8** code, u32* code_size)
 {
   if (!g_jit)
@@ -226,10 +292,18 @@ void ClearSafe()
 
 void InvalidateICache(u32 address, u32 size, bool forced)
 {
+  Interpreter::getInstance()->InvalidatePredecodeCache(address, size);
   if (g_jit)
     g_jit->GetBlockCache()->InvalidateICache(address, size, forced);
 }
 
+// Blocks are recompiled with the current GQR values this many times before the JIT stops guessing
+// them, as most games only set their GQRs once in a while.
+constexpr u32 MAX_PAIRED_QUANTIZE_MISSES = 4;
+
+static Common::Metrics::Counter s_gqr_speculation_misses_metric(Common::Metrics::Thread::CPU,
+                                                                "jit_gqr_speculation_misses");
+
 void CompileExceptionCheck(ExceptionType type)
 {
   if (!g_jit)
@@ -259,6 +333,18 @@ void CompileExceptionCheck(ExceptionType type)
       if (optype != OpType::Store && optype != OpType::StoreFP && optype != OpType::StorePS)
         return;
     }
+
+    if (type == ExceptionType::PairedQuantize)
+    {
+      s_gqr_speculation_misses_metric.Increment();
+      if (++g_jit->js.pairedQuantizeMisses[PC] < MAX_PAIRED_QUANTIZE_MISSES)
+      {
+        // Recompile the block with the GQR values it sees now.
+        g_jit->GetBlockCache()->InvalidateICache(PC, 4, true);
+        return;
+      }
+    }
+
     exception_addresses->insert(PC);
 
     // Invalidate the JIT block so that it gets recompiled with the external exception check
@@ -47,6 +47,9 @@ enum class ProfilingState
 void SetProfilingState(ProfilingState state);
 void WriteProfileResults(const std::string& filename);
 void GetProfileResults(Profiler::ProfileStats* prof_stats);
+// Translates the compiled blocks to the JIT IR, and writes how many instructions the IR passes
+// remove from each of them, followed by the optimized IR.
+void WriteIRReport(const std::string& filename);
 int GetHostCode(u32* address, const u8** code, u32* code_size);
 
 // Memory Utilities
@@ -4,13 +4,16 @@
 
 #include "Core/PowerPC/MMU.h"
 
+#include <array>
 #include <cstddef>
 #include <cstring>
 #include <string>
 
 #include "Common/BitUtils.h"
 #include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
 
+#include "Core/Config/MainSettings.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/CPU.h"
 #include "Core/HW/GPFifo.h"
@@ -936,6 +939,21 @@ union UPTE2
   u32 Hex;
 };
 
+// Whether the physical address is backed by memory which the fastmem arena can map.
+static bool IsPhysicalFastmemAddress(u32 physical_address)
+{
+  if (Memory::m_pFakeVMEM && (physical_address & 0xFE000000) == 0x7E000000)
+    return true;
+  if (physical_address < Memory::GetRamSizeReal())
+    return true;
+  if (Memory::m_pEXRAM && physical_address >> 28 == 0x1 &&
+      (physical_address & 0x0FFFFFFF) < Memory::GetExRamSizeReal())
+  {
+    return true;
+  }
+  return physical_address >> 28 == 0xE && physical_address < 0xE0000000 + Memory::GetL1CacheSize();
+}
+
 static void GenerateDSIException(u32 effective_address, bool write)
 {
   // DSI exceptions are only supported in MMU mode.
@@ -979,6 +997,8 @@ void SDRUpdated()
   }
   PowerPC::ppcState.pagetable_base = htaborg << 16;
   PowerPC::ppcState.pagetable_hashmask = ((htabmask << 10) | 0x3ff);
+
+  PageTableUpdated();
 }
 
 enum class TLBLookupResult
@@ -1054,6 +1074,89 @@ static void UpdateTLBEntry(const XCheckTLBFlag flag, UPTE2 PTE2, const u32 addre
   tlbe.tag[index] = tag;
 }
 
+// Translation cache
+//
+// Like the hardware's, the TLB only holds two pages per set, so MMU games often miss it, and each
+// miss searches the page table. The translation cache remembers the page table entries that these
+// searches found for many more pages, and is checked on TLB misses before searching. The TLB is
+// refilled the same way in either case, so its contents don't depend on the translation cache.
+//
+// This relies on the guest executing tlbie after changing a page table entry, as the architecture
+// requires. Changes to SDR1 or the BATs empty the whole cache, and changes to a segment register
+// drop the pages of that segment.
+
+constexpr u32 TRANSLATION_CACHE_SIZE = 4096;
+
+struct TranslationCacheEntry
+{
+  static constexpr u32 INVALID_TAG = 0xffffffff;
+
+  // The effective address shifted right by HW_PAGE_INDEX_SHIFT.
+  u32 tag = INVALID_TAG;
+  u32 pte2 = 0;
+  // The physical address of the second word of the page table entry.
+  u32 pte2_address = 0;
+};
+
+// Split into data and instructions like ppcState.tlb.
+static std::array<std::array<TranslationCacheEntry, TRANSLATION_CACHE_SIZE>, NUM_TLBS>
+    s_translation_cache;
+static bool s_translation_cache_enabled = false;
+
+static void ClearTranslationCache()
+{
+  for (auto& cache : s_translation_cache)
+    cache.fill({});
+}
+
+void ResetTranslationCache()
+{
+  s_translation_cache_enabled = Config::Get(Config::MAIN_MMU_TRANSLATION_CACHE);
+  ClearTranslationCache();
+}
+
+static TranslationCacheEntry& GetTranslationCacheEntry(const XCheckTLBFlag flag, const u32 tag)
+{
+  return s_translation_cache[IsOpcodeFlag(flag)][tag & (TRANSLATION_CACHE_SIZE - 1)];
+}
+
+static bool LookupTranslationCache(const XCheckTLBFlag flag, const u32 address, UPTE2* PTE2)
+{
+  if (!s_translation_cache_enabled)
+    return false;
+
+  const u32 tag = address >> HW_PAGE_INDEX_SHIFT;
+  TranslationCacheEntry& entry = GetTranslationCacheEntry(flag, tag);
+  if (entry.tag != tag)
+    return false;
+
+  PTE2->Hex = entry.pte2;
+
+  // Only entries with the R bit set are cached, but an entry cached by a read can have the C bit
+  // clear, which the first write to the page has to set in the page table like the search does.
+  if (flag == XCheckTLBFlag::Write && !PTE2->C)
+  {
+    PTE2->C = 1;
+    Memory::Write_U32(PTE2->Hex, entry.pte2_address);
+    entry.pte2 = PTE2->Hex;
+  }
+
+  return true;
+}
+
+static void UpdateTranslationCache(const XCheckTLBFlag flag, UPTE2 PTE2, const u32 address,
+                                   const u32 pte2_address)
+{
+  if (!s_translation_cache_enabled || IsNoExceptionFlag(flag))
+    return;
+
+  const u32 tag = address >> HW_PAGE_INDEX_SHIFT;
+  TranslationCacheEntry& entry = GetTranslationCacheEntry(flag, tag);
+  entry.tag = tag;
+  entry.pte2 = PTE2.Hex;
+  entry.pte2_address = pte2_address;
+}
+
 void InvalidateTLBEntry(u32 address)
 {
   const u32 entry_index = (address >> HW_PAGE_INDEX_SHIFT) & HW_PAGE_INDEX_MASK;
@@ -1065,35 +1168,82 @@ void InvalidateTLBEntry(u32 address)
   TLBEntry& tlbe_i = ppcState.tlb[1][entry_index];
   tlbe_i.tag[0] = TLBEntry::INVALID_TAG;
   tlbe_i.tag[1] = TLBEntry::INVALID_TAG;
+
+  // tlbie invalidates the whole set of the TLB, so drop every cached page that maps to that set.
+  for (auto& cache : s_translation_cache)
+  {
+    for (u32 i = entry_index; i < TRANSLATION_CACHE_SIZE; i += HW_PAGE_INDEX_MASK + 1)
+      cache[i].tag = TranslationCacheEntry::INVALID_TAG;
+  }
+
+  // tlbie doesn't specify a segment, so unmap the page in all of them. The next access goes
+  // through the page table again, which maps the page again if it's still valid.
+  for (u32 segment = 0; segment < 16; ++segment)
+    Memory::UnmapPageTableEntry((segment << 28) | (address & 0x0ffff000));
 }
 
-// Page Address Translation
-static TranslateAddressResult TranslatePageAddress(const u32 address, const XCheckTLBFlag flag)
+// Page table fastmem
+//
+// Pages which are translated through the page table are mapped into the logical fastmem arena, so
+// that the JITs can access them without taking the slow path. A page is mapped when a translation
+// searches the page table for it, or when a fastmem access faults on it and the TLB or the page
+// table translates it. Changes to SDR1, the BATs or a segment register only unmap pages.
+//
+// Fastmem accesses can't set the R and C bits of the page table entry. Pages are only mapped once
+// their R bit is set, and pages whose C bit is clear are mapped read-only, so that the first write
+// to them takes the slow path.
+
+// Whether the guest has set up a page table. The exception vectors are at the start of physical
+// memory, so a page table at address 0 means that SDR1 has never been written.
+static bool IsPageTableSet()
 {
-  // TLB cache
-  // This catches 99%+ of lookups in practice, so the actual page table entry code below doesn't
-  // benefit
-  // much from optimization.
-  u32 translatedAddress = 0;
-  TLBLookupResult res = LookupTLBPageAddress(flag, address, &translatedAddress);
-  if (res == TLBLookupResult::Found)
-    return TranslateAddressResult{TranslateAddressResult::PAGE_TABLE_TRANSLATED, translatedAddress};
+  return PowerPC::ppcState.spr[SPR_SDR] != 0;
+}
 
-  u32 sr = PowerPC::ppcState.sr[EA_SR(address)];
+// The R bit of the entry must be set. Returns false if the page can't be accessed through fastmem.
+static bool MapPageTableEntry(u32 logical_address, UPTE2 PTE2)
+{
+  logical_address &= ~(HW_PAGE_SIZE - 1);
+  const u32 physical_address = PTE2.RPN << HW_PAGE_INDEX_SHIFT;
 
-  if (sr & 0x80000000)
-    return TranslateAddressResult{TranslateAddressResult::DIRECT_STORE_SEGMENT, 0};
+  if (!IsPageTableSet())
+    return false;
+  if (dbat_table[logical_address >> BAT_INDEX_SHIFT] & BAT_MAPPED_BIT)
+    return false;
+  if (!IsPhysicalFastmemAddress(physical_address))
+    return false;
+  if (PowerPC::memchecks.OverlapsMemcheck(logical_address, HW_PAGE_SIZE))
+    return false;
 
-  // TODO: Handle KS/KP segment register flags.
+  Memory::MapPageTableEntry(logical_address, physical_address, PTE2.C);
+  return true;
+}
 
-  // No-execute segment register flag.
-  if ((flag == XCheckTLBFlag::Opcode || flag == XCheckTLBFlag::OpcodeNoException) &&
-      (sr & 0x10000000))
+void PageTableUpdated()
+{
+  ClearTranslationCache();
+  Memory::UnmapPageTableEntries();
+}
+
+void SegmentRegisterUpdated(u32 index)
+{
+  for (auto& cache : s_translation_cache)
   {
-    return TranslateAddressResult{TranslateAddressResult::PAGE_FAULT, 0};
+    for (TranslationCacheEntry& entry : cache)
+    {
+      // The tag of an invalid entry is out of range for a segment number.
+      if (entry.tag >> (28 - HW_PAGE_INDEX_SHIFT) == index)
+        entry.tag = TranslationCacheEntry::INVALID_TAG;
+    }
   }
 
-  u32 offset = EA_Offset(address);         // 12 bit
+  Memory::UnmapPageTableEntries(index << 28, 0x10000000);
+}
+
+// Searches the page table for the entry which translates the address in the given segment, and
+// returns the address of the second word of the entry, or 0 if there is none.
+static u32 SearchPageTable(const u32 sr, const u32 address)
+{
   u32 page_index = EA_PageIndex(address);  // 16 bit
   u32 VSID = SR_VSID(sr);                  // 24 bit
   u32 api = EA_API(address);               //  6 bit (part of page_index)
@@ -1119,43 +1269,136 @@ static TranslateAddressResult TranslatePageAddress(const u32 address, const XChe
       u32 pteg = Common::swap32(Memory::Read_U32(pteg_addr));
 
       if (pte1 == pteg)
-      {
-        UPTE2 PTE2;
-        PTE2.Hex = Memory::Read_U32(pteg_addr + 4);
-
-        // set the access bits
-        switch (flag)
-        {
-        case XCheckTLBFlag::NoException:
-        case XCheckTLBFlag::OpcodeNoException:
-          break;
-        case XCheckTLBFlag::Read:
-          PTE2.R = 1;
-          break;
-        case XCheckTLBFlag::Write:
-          PTE2.R = 1;
-          PTE2.C = 1;
-          break;
-        case XCheckTLBFlag::Opcode:
-          PTE2.R = 1;
-          break;
-        }
-
-        if (!IsNoExceptionFlag(flag))
-        {
-          Memory::Write_U32(PTE2.Hex, pteg_addr + 4);
-        }
-
-        // We already updated the TLB entry if this was caused by a C bit.
-        if (res != TLBLookupResult::UpdateC)
-          UpdateTLBEntry(flag, PTE2, address);
-
-        return TranslateAddressResult{TranslateAddressResult::PAGE_TABLE_TRANSLATED,
-                                      (PTE2.RPN << 12) | offset};
-      }
+        return pteg_addr + 4;
     }
   }
-  return TranslateAddressResult{TranslateAddressResult::PAGE_FAULT, 0};
+  return 0;
+}
+
+PageTableFaultResult HandlePageTableFault(u32 address, bool write)
+{
+  if (!Memory::CanMapPageTableEntries() || !IsPageTableSet())
+    return PageTableFaultResult::NotMappable;
+  if (dbat_table[address >> BAT_INDEX_SHIFT] & BAT_MAPPED_BIT)
+    return PageTableFaultResult::NotMappable;
+
+  const u32 sr = PowerPC::ppcState.sr[EA_SR(address)];
+  if (sr & SR_T)
+    return PageTableFaultResult::NotMappable;
+
+  // Use the TLB entry if there is one, as the slow path would. This runs in the fault handler, so
+  // it must not write to emulated memory or change the TLB.
+  const u32 tag = address >> HW_PAGE_INDEX_SHIFT;
+  const TLBEntry& tlbe = ppcState.tlb[0][tag & HW_PAGE_INDEX_MASK];
+  UPTE2 PTE2;
+  if (tlbe.tag[0] == tag)
+  {
+    PTE2.Hex = tlbe.pte[0];
+  }
+  else if (tlbe.tag[1] == tag)
+  {
+    PTE2.Hex = tlbe.pte[1];
+  }
+  else
+  {
+    const u32 pte2_address = SearchPageTable(sr, address);
+    if (pte2_address == 0)
+      return PageTableFaultResult::SlowPath;
+    PTE2.Hex = Memory::Read_U32(pte2_address);
+  }
+
+  // The slow path sets the missing bit, and maps the page when it searches the page table.
+  if (!PTE2.R || (write && !PTE2.C))
+    return PageTableFaultResult::SlowPath;
+
+  return MapPageTableEntry(address, PTE2) ? PageTableFaultResult::Mapped :
+                                            PageTableFaultResult::NotMappable;
+}
+
+// Page Address Translation
+static TranslateAddressResult TranslatePageAddress(const u32 address, const XCheckTLBFlag flag)
+{
+  // TLB cache
+  // This catches 99%+ of lookups in practice, so the actual page table entry code below doesn't
+  // benefit
+  // much from optimization.
+  u32 translatedAddress = 0;
+  TLBLookupResult res = LookupTLBPageAddress(flag, address, &translatedAddress);
+  if (res == TLBLookupResult::Found)
+    return TranslateAddressResult{TranslateAddressResult::PAGE_TABLE_TRANSLATED, translatedAddress};
+
+  // A hit in the translation cache has already updated the R and C bits of the page table entry,
+  // so this only has to do what the search below does after finding it.
+  UPTE2 cached_PTE2;
+  if (LookupTranslationCache(flag, address, &cached_PTE2))
+  {
+    if (res != TLBLookupResult::UpdateC)
+      UpdateTLBEntry(flag, cached_PTE2, address);
+
+    if (!IsNoExceptionFlag(flag))
+      MapPageTableEntry(address, cached_PTE2);
+
+    return TranslateAddressResult{TranslateAddressResult::PAGE_TABLE_TRANSLATED,
+                                  (cached_PTE2.RPN << 12) | EA_Offset(address)};
+  }
+
+  u32 sr = PowerPC::ppcState.sr[EA_SR(address)];
+
+  if (sr & 0x80000000)
+    return TranslateAddressResult{TranslateAddressResult::DIRECT_STORE_SEGMENT, 0};
+
+  // TODO: Handle KS/KP segment register flags.
+
+  // No-execute segment register flag.
+  if ((flag == XCheckTLBFlag::Opcode || flag == XCheckTLBFlag::OpcodeNoException) &&
+      (sr & 0x10000000))
+  {
+    return TranslateAddressResult{TranslateAddressResult::PAGE_FAULT, 0};
+  }
+
+  u32 offset = EA_Offset(address);  // 12 bit
+
+  const u32 pte2_address = SearchPageTable(sr, address);
+  if (pte2_address == 0)
+    return TranslateAddressResult{TranslateAddressResult::PAGE_FAULT, 0};
+
+  UPTE2 PTE2;
+  PTE2.Hex = Memory::Read_U32(pte2_address);
+
+  // set the access bits
+  switch (flag)
+  {
+  case XCheckTLBFlag::NoException:
+  case XCheckTLBFlag::OpcodeNoException:
+    break;
+  case XCheckTLBFlag::Read:
+    PTE2.R = 1;
+    break;
+  case XCheckTLBFlag::Write:
+    PTE2.R = 1;
+    PTE2.C = 1;
+    break;
+  case XCheckTLBFlag::Opcode:
+    PTE2.R = 1;
+    break;
+  }
+
+  if (!IsNoExceptionFlag(flag))
+  {
+    Memory::Write_U32(PTE2.Hex, pte2_address);
+  }
+
+  UpdateTranslationCache(flag, PTE2, address, pte2_address);
+
+  // We already updated the TLB entry if this was caused by a C bit.
+  if (res != TLBLookupResult::UpdateC)
+    UpdateTLBEntry(flag, PTE2, address);
+
+  if (!IsNoExceptionFlag(flag))
+    MapPageTableEntry(address, PTE2);
+
+  return TranslateAddressResult{TranslateAddressResult::PAGE_TABLE_TRANSLATED,
+                                (PTE2.RPN << 12) | offset};
 }
 
 static void UpdateBATs(BatTable& bat_table, u32 base_spr)
@@ -1209,15 +1452,7 @@ static void UpdateBATs(BatTable& bat_table, u32 base_spr)
         // The bottom bit is whether the translation is valid; the second
         // bit from the bottom is whether we can use the fastmem arena.
         u32 valid_bit = BAT_MAPPED_BIT;
-        if (Memory::m_pFakeVMEM && (physical_address & 0xFE000000) == 0x7E000000)
-          valid_bit |= BAT_PHYSICAL_BIT;
-        else if (physical_address < Memory::GetRamSizeReal())
-          valid_bit |= BAT_PHYSICAL_BIT;
-        else if (Memory::m_pEXRAM && physical_address >> 28 == 0x1 &&
-                 (physical_address & 0x0FFFFFFF) < Memory::GetExRamSizeReal())
-          valid_bit |= BAT_PHYSICAL_BIT;
-        else if (physical_address >> 28 == 0xE &&
-                 physical_address < 0xE0000000 + Memory::GetL1CacheSize())
+        if (IsPhysicalFastmemAddress(physical_address))
           valid_bit |= BAT_PHYSICAL_BIT;
 
         // Fastmem doesn't support memchecks, so disable it for all overlapping virtual pages.
@@ -1264,6 +1499,7 @@ void DBATUpdated()
 
 #ifndef _ARCH_32
   Memory::UpdateLogicalMemory(dbat_table);
+  PageTableUpdated();
 #endif
 
   // IsOptimizable*Address and dcbz depends on the BAT mapping, so we need a flush here.
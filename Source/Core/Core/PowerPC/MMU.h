@@ -84,10 +84,30 @@ void ClearCacheLine(u32 address);  // Zeroes 32 bytes; address should be 32-byte
 
 // TLB functions
 void SDRUpdated();
+// Drops the cached translations and the fastmem mappings of the pages which the page table
+// translates, after SDR1 or the BATs have changed. They are mapped again as they are translated.
+void PageTableUpdated();
+// Like PageTableUpdated, but only for the pages in the segment of the segment register.
+void SegmentRegisterUpdated(u32 index);
 void InvalidateTLBEntry(u32 address);
+// Reads whether the translation cache is enabled, and empties it.
+void ResetTranslationCache();
 void DBATUpdated();
 void IBATUpdated();
 
+enum class PageTableFaultResult
+{
+  // The page is mapped now, so the access can be retried.
+  Mapped,
+  // The access has to take the slow path this time. The slow path raises the DSI, or sets the R or
+  // C bit and maps the page.
+  SlowPath,
+  // The page can't be accessed through fastmem, e.g. because it isn't RAM or has a memcheck.
+  NotMappable,
+};
+// Called by the JITs when a fastmem access to the logical arena faults. Must run on the CPU thread.
+PageTableFaultResult HandlePageTableFault(u32 address, bool write);
+
 // Result changes based on the BAT registers and MSR.DR.  Returns whether
 // it's safe to optimize a read or write to this address to an unguarded
 // memory access.  Does not consider page tables.
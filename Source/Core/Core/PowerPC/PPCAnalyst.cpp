@@ -40,6 +40,8 @@ namespace PPCAnalyst
 {
 // 0 does not perform block merging
 constexpr u32 BRANCH_FOLLOWING_THRESHOLD = 2;
+// The number of hot conditional branches which are followed in a block.
+constexpr u32 HOT_BRANCH_FOLLOWING_THRESHOLD = 4;
 
 constexpr u32 INVALID_BRANCH_TARGET = 0xFFFFFFFF;
 
@@ -727,6 +729,13 @@ bool PPCAnalyzer::IsBusyWaitLoop(CodeBlock* block, CodeOp* code, size_t instruct
   return false;
 }
 
+void PPCAnalyzer::RemoveHotBranch(u32 address)
+{
+  const auto iter = m_hot_branches.find(address);
+  if (iter != m_hot_branches.end() && --iter->second == 0)
+    m_hot_branches.erase(iter);
+}
+
 u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, std::size_t block_size)
 {
   // Clear block stats
@@ -755,6 +764,7 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, std:
   bool found_call = false;
   size_t caller = 0;
   u32 numFollows = 0;
+  u32 numHotFollows = 0;
   u32 num_inst = 0;
 
   const bool enable_follow = SConfig::GetInstance().bJITFollowBranch;
@@ -878,7 +888,19 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, std:
     code[i].branchIsIdleLoop =
         code[i].branchTo == block->m_address && IsBusyWaitLoop(block, code, i);
 
-    if (follow && numFollows < BRANCH_FOLLOWING_THRESHOLD)
+    if (enable_follow && HasOption(OPTION_HOT_BRANCH_FOLLOW) && inst.OPCD == 16 && !inst.LK &&
+        conditional_continue && !code[i].branchIsIdleLoop && block_size > 1 &&
+        numHotFollows < HOT_BRANCH_FOLLOWING_THRESHOLD &&
+        m_hot_branches.find(code[i].address) != m_hot_branches.end())
+    {
+      // Follow the taken path of the conditional branch. The path that isn't taken becomes a side
+      // exit, so we can't guarantee to get the matching CALL/RET pair either.
+      numHotFollows++;
+      code[i].branchIsFollowed = true;
+      found_call = false;
+      address = code[i].branchTo;
+    }
+    else if (follow && numFollows < BRANCH_FOLLOWING_THRESHOLD)
     {
       // Follow the unconditional branch.
       numFollows++;
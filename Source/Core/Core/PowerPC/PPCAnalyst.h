@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/BitSet.h"
@@ -46,6 +47,8 @@ struct CodeOp  // 16B
   bool outputCA;
   bool canEndBlock;
   bool skipLRStack;
+  // The taken path of this conditional branch continues in the block, and the other path exits it.
+  bool branchIsFollowed;
   bool skip;  // followed BL-s for example
   // which registers are still needed after this instruction in this block
   BitSet32 fprInUse;
@@ -195,6 +198,11 @@ public:
 
     // Reorder cror instructions next to their associated fcmp.
     OPTION_CROR_MERGE = (1 << 6),
+
+    // Follow the taken path of conditional branches which were marked as hot, like unconditional
+    // branches are followed. The branch is marked as branchIsFollowed.
+    // Requires JIT support to be enabled.
+    OPTION_HOT_BRANCH_FOLLOW = (1 << 7),
   };
 
   // Option setting/getting
@@ -203,6 +211,12 @@ public:
   bool HasOption(AnalystOption option) const { return !!(m_options & option); }
   u32 Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, std::size_t block_size);
 
+  // Conditional branches which are usually taken, see OPTION_HOT_BRANCH_FOLLOW. Each branch stays
+  // hot until it has been removed as many times as it was added.
+  void AddHotBranch(u32 address) { m_hot_branches[address]++; }
+  void RemoveHotBranch(u32 address);
+  void ClearHotBranches() { m_hot_branches.clear(); }
+
 private:
   enum class ReorderType
   {
@@ -218,6 +232,9 @@ private:
 
   // Options
   u32 m_options = 0;
+
+  // Hot branch addresses, with the number of times each one was added.
+  std::unordered_map<u32, u32> m_hot_branches;
 };
 
 void FindFunctions(u32 startAddr, u32 endAddr, PPCSymbolDB* func_db);
@@ -267,6 +267,7 @@ void Reset()
   ppcState.pagetable_base = 0;
   ppcState.pagetable_hashmask = 0;
   ppcState.tlb = {};
+  ResetTranslationCache();
 
   ResetRegisters();
   ppcState.iCache.Reset();
@@ -622,7 +623,11 @@ void CheckBreakPoints()
 void PowerPCState::SetSR(u32 index, u32 value)
 {
   DEBUG_LOG_FMT(POWERPC, "{:08x}: MMU: Segment register {} set to {:08x}", pc, index, value);
+  if (sr[index] == value)
+    return;
+
   sr[index] = value;
+  SegmentRegisterUpdated(index);
 }
 
 // FPSCR update functions
@@ -0,0 +1,223 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DolphinNoGUI/FifoRunner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <variant>
+
+#include <fmt/format.h>
+#include <picojson.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/Timer.h"
+#include "Core/Boot/Boot.h"
+#include "Core/BootManager.h"
+#include "Core/Config/MainSettings.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/FifoPlayer/FifoDataFile.h"
+#include "Core/FifoPlayer/FifoPlayer.h"
+#include "DolphinNoGUI/Platform.h"
+#include "VideoCommon/FrameDump.h"
+#include "VideoCommon/RenderBase.h"
+
+namespace FifoRunner
+{
+namespace
+{
+constexpr const char* SOFTWARE_RENDERER_NAME = "Software Renderer";
+
+struct FrameResult
+{
+  int frame_number;
+  int width;
+  int height;
+  u64 hash;
+  u64 render_time_us;
+};
+
+// Written on the frame dump thread.
+std::mutex s_frames_lock;
+std::vector<FrameResult> s_frames;
+
+// Written on the CPU thread.
+std::atomic<u32> s_log_frame_count;
+std::atomic<u32> s_frames_played;
+
+// Restores the settings the runner overrides, so that they are not saved.
+class ScopedSettings
+{
+public:
+  ScopedSettings()
+  {
+    SConfig& config = SConfig::GetInstance();
+    m_cpu_thread = config.bCPUThread;
+    m_emulation_speed = config.m_EmulationSpeed;
+    m_loop_fifo_replay = config.bLoopFifoReplay;
+
+    // Single core mode makes the replay deterministic.
+    config.bCPUThread = false;
+    config.m_EmulationSpeed = 0.0f;
+    config.bLoopFifoReplay = false;
+  }
+
+  ~ScopedSettings()
+  {
+    SConfig& config = SConfig::GetInstance();
+    config.bCPUThread = m_cpu_thread;
+    config.m_EmulationSpeed = m_emulation_speed;
+    config.bLoopFifoReplay = m_loop_fifo_replay;
+  }
+
+  ScopedSettings(const ScopedSettings&) = delete;
+  ScopedSettings& operator=(const ScopedSettings&) = delete;
+
+private:
+  bool m_cpu_thread;
+  float m_emulation_speed;
+  bool m_loop_fifo_replay;
+};
+}  // namespace
+
+static void OnFrameDumped(const FrameDump::FrameData& frame)
+{
+  // Rows may be padded, so only the pixels themselves are hashed.
+  const size_t row_size = static_cast<size_t>(frame.width) * 4;
+  std::vector<u8> pixels(row_size * frame.height);
+  for (int y = 0; y < frame.height; y++)
+    std::copy_n(frame.data + y * frame.stride, row_size, pixels.data() + y * row_size);
+
+  std::lock_guard<std::mutex> guard(s_frames_lock);
+  s_frames.push_back({frame.state.frame_number, frame.width, frame.height,
+                      Common::GetStableHash64(pixels.data(), pixels.size()),
+                      frame.state.render_time_us});
+}
+
+static picojson::object PlayLog(Platform* platform, const std::string& path, bool* completed)
+{
+  picojson::object result;
+  result["path"] = picojson::value(path);
+  *completed = false;
+
+  {
+    std::lock_guard<std::mutex> guard(s_frames_lock);
+    s_frames.clear();
+  }
+  s_log_frame_count = 0;
+  s_frames_played = 0;
+
+  std::unique_ptr<BootParameters> boot = BootParameters::GenerateFromFile(path);
+  if (!boot)
+  {
+    result["error"] = picojson::value("Could not open");
+    return result;
+  }
+  if (!std::holds_alternative<BootParameters::DFF>(boot->parameters))
+  {
+    std::fprintf(stderr, "%s is not a FIFO log\n", path.c_str());
+    result["error"] = picojson::value("Not a FIFO log");
+    return result;
+  }
+
+  const u64 start_time = Common::Timer::GetTimeUs();
+  if (!BootManager::BootCore(std::move(boot), platform->GetWindowSystemInfo()))
+  {
+    std::fprintf(stderr, "Could not boot %s\n", path.c_str());
+    result["error"] = picojson::value("Could not boot");
+    return result;
+  }
+
+  // The FIFO player stops the core after the last frame.
+  platform->MainLoop();
+  Core::Stop();
+  Core::Shutdown();
+  const u64 total_time_us = Common::Timer::GetTimeUs() - start_time;
+
+  const u32 log_frame_count = s_log_frame_count;
+  *completed = log_frame_count != 0 && s_frames_played == log_frame_count;
+  if (!*completed)
+    result["error"] = picojson::value("Stopped before the last frame");
+
+  picojson::array frames;
+  {
+    std::lock_guard<std::mutex> guard(s_frames_lock);
+    for (const FrameResult& frame : s_frames)
+    {
+      picojson::object entry;
+      entry["frame"] = picojson::value(static_cast<double>(frame.frame_number));
+      entry["width"] = picojson::value(static_cast<double>(frame.width));
+      entry["height"] = picojson::value(static_cast<double>(frame.height));
+      // As a string, since JSON numbers cannot hold every 64-bit value.
+      entry["hash"] = picojson::value(fmt::format("{:016x}", frame.hash));
+      entry["render_time_us"] = picojson::value(static_cast<double>(frame.render_time_us));
+      frames.emplace_back(std::move(entry));
+    }
+  }
+
+  result["log_frame_count"] = picojson::value(static_cast<double>(log_frame_count));
+  result["total_time_us"] = picojson::value(static_cast<double>(total_time_us));
+
+  std::fprintf(stdout, "%s: %zu frames in %.3f s\n", path.c_str(), frames.size(),
+               total_time_us / 1000000.0);
+
+  result["frames"] = picojson::value(std::move(frames));
+  return result;
+}
+
+bool Run(Platform* platform, const std::vector<std::string>& paths,
+         const std::string& report_path, bool use_configured_backend)
+{
+  ScopedSettings settings;
+  const std::string backend =
+      use_configured_backend ? Config::Get(Config::MAIN_GFX_BACKEND) : SOFTWARE_RENDERER_NAME;
+
+  FifoPlayer& player = FifoPlayer::GetInstance();
+  player.SetFileLoadedCallback([] {
+    if (const FifoDataFile* file = FifoPlayer::GetInstance().GetFile())
+      s_log_frame_count = file->GetFrameCount();
+  });
+  player.SetFrameWrittenCallback([] { ++s_frames_played; });
+  Renderer::SetFrameDumpCallback(OnFrameDumped);
+
+  bool success = true;
+  picojson::array logs;
+  for (const std::string& path : paths)
+  {
+    // Current run settings are cleared whenever the core stops.
+    Config::SetCurrent(Config::MAIN_GFX_BACKEND, backend);
+
+    bool completed;
+    logs.emplace_back(PlayLog(platform, path, &completed));
+    success &= completed;
+
+    if (!platform->Restart())
+    {
+      success = false;
+      break;
+    }
+  }
+
+  Renderer::SetFrameDumpCallback(nullptr);
+  player.SetFrameWrittenCallback(nullptr);
+  player.SetFileLoadedCallback(nullptr);
+
+  picojson::object report;
+  report["backend"] = picojson::value(backend);
+  report["logs"] = picojson::value(std::move(logs));
+  if (!File::WriteStringToFile(report_path, picojson::value(std::move(report)).serialize(true)))
+  {
+    std::fprintf(stderr, "Could not write the report to %s\n", report_path.c_str());
+    return false;
+  }
+
+  return success;
+}
+}  // namespace FifoRunner
@@ -0,0 +1,24 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+class Platform;
+
+// Replays FIFO logs for regression testing and benchmarking of the video backends.
+//
+// Each log is played once, to its last frame, in single core mode and without a speed limit. Every
+// frame the renderer presents is hashed, and the hash and the host time taken to render the frame
+// are written to a JSON report. Frames are hashed with Common::GetStableHash64, so the reports of
+// different machines and builds can be compared directly.
+namespace FifoRunner
+{
+// Unless use_configured_backend is set, the logs are played with the software renderer.
+// Returns false if a log could not be played to the end, or the report could not be written.
+bool Run(Platform* platform, const std::vector<std::string>& paths,
+         const std::string& report_path, bool use_configured_backend);
+}  // namespace FifoRunner
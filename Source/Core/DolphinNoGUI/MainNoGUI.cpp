@@ -22,6 +22,7 @@
 #include "Core/BootManager.h"
 #include "Core/Core.h"
 #include "Core/Host.h"
+#include "DolphinNoGUI/FifoRunner.h"
 
 #include "UICommon/CommandLineParse.h"
 #ifdef USE_DISCORD_PRESENCE
@@ -110,6 +111,10 @@ static std::unique_ptr<Platform> GetPlatform(const optparse::Values& options)
 {
   std::string platform_name = static_cast<const char*>(options.get("platform"));
 
+  // FIFO logs are replayed without a window unless asked otherwise.
+  if (platform_name.empty() && options.is_set("fifo_report"))
+    platform_name = "headless";
+
 #if HAVE_X11
   if (platform_name == "x11" || platform_name.empty())
     return Platform::CreateX11Platform();
@@ -152,6 +157,11 @@ int main(int argc, char* argv[])
             "win32"
 #endif
       });
+  parser->add_option("--fifo-report")
+      .action("store")
+      .metavar("<file>")
+      .help("Play the FIFO logs given as arguments to the end, and write the hash and render time "
+            "of every frame to this JSON file");
 
   optparse::Values& options = CommandLineParse::ParseArguments(parser.get(), argc, argv);
   std::vector<std::string> args = parser->args();
@@ -164,7 +174,16 @@ int main(int argc, char* argv[])
 
   std::unique_ptr<BootParameters> boot;
   bool game_specified = false;
-  if (options.is_set("exec"))
+  const bool fifo_report = options.is_set("fifo_report");
+  if (fifo_report)
+  {
+    if (args.empty())
+    {
+      fprintf(stderr, "No FIFO logs to play\n");
+      return 1;
+    }
+  }
+  else if (options.is_set("exec"))
   {
     const std::list<std::string> paths_list = options.all("exec");
     const std::vector<std::string> paths{std::make_move_iterator(std::begin(paths_list)),
@@ -236,6 +255,16 @@ int main(int argc, char* argv[])
 
   DolphinAnalytics::Instance().ReportDolphinStart("nogui");
 
+  if (fifo_report)
+  {
+    const std::string report_path = static_cast<const char*>(options.get("fifo_report"));
+    const bool success = FifoRunner::Run(s_platform.get(), args, report_path,
+                                         options.is_set_by_user("video_backend"));
+    s_platform.reset();
+    UICommon::Shutdown();
+    return success ? 0 : 1;
+  }
+
   if (!BootManager::BootCore(std::move(boot), s_platform->GetWindowSystemInfo()))
   {
     fprintf(stderr, "Could not boot the specified file\n");
@@ -47,7 +47,17 @@ void Platform::Stop()
   m_running.Clear();
 }
 
+bool Platform::Restart()
+{
+  if (m_shutdown_received.IsSet())
+    return false;
+
+  m_running.Set();
+  return true;
+}
+
 void Platform::RequestShutdown()
 {
+  m_shutdown_received.Set();
   m_shutdown_requested.Set();
 }
@@ -31,6 +31,10 @@ public:
   // Request an immediate shutdown.
   void Stop();
 
+  // Lets MainLoop() run again after it returned, to boot something else. Returns false if a
+  // shutdown was requested from a signal, in which case nothing else should be booted.
+  bool Restart();
+
   static std::unique_ptr<Platform> CreateHeadlessPlatform();
 #ifdef HAVE_X11
   static std::unique_ptr<Platform> CreateX11Platform();
@@ -49,6 +53,7 @@ protected:
 
   Common::Flag m_running{true};
   Common::Flag m_shutdown_requested{false};
+  Common::Flag m_shutdown_received{false};
   Common::Flag m_tried_graceful_shutdown{false};
 
   bool m_window_focus = true;
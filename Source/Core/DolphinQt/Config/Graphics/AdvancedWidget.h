@@ -36,9 +36,11 @@ private:
   GraphicsBool* m_show_statistics;
   GraphicsBool* m_enable_format_overlay;
   GraphicsBool* m_enable_api_validation;
+  GraphicsBool* m_profile_gpu_thread;
 
   // Utility
   GraphicsBool* m_prefetch_custom_textures;
+  GraphicsBool* m_async_custom_textures;
   GraphicsBool* m_dump_efb_target;
   GraphicsBool* m_disable_vram_copies;
   GraphicsBool* m_load_custom_textures;
@@ -68,6 +68,10 @@ void HacksWidget::CreateWidgets()
   m_accuracy->setTickPosition(QSlider::TicksBelow);
   m_gpu_texture_decoding =
       new GraphicsBool(tr("GPU Texture Decoding"), Config::GFX_ENABLE_GPU_TEXTURE_DECODING);
+  m_xxh3_texture_hash =
+      new GraphicsBool(tr("Vectorized Texture Hashing"), Config::GFX_TEXTURE_CACHE_XXH3);
+  m_write_tracking = new GraphicsBool(tr("Track Texture Memory Writes"),
+                                      Config::GFX_TEXTURE_CACHE_WRITE_TRACKING);
 
   auto* safe_label = new QLabel(tr("Safe"));
   safe_label->setAlignment(Qt::AlignRight);
@@ -79,6 +83,8 @@ void HacksWidget::CreateWidgets()
   texture_cache_layout->addWidget(m_accuracy, 0, 2);
   texture_cache_layout->addWidget(new QLabel(tr("Fast")), 0, 3);
   texture_cache_layout->addWidget(m_gpu_texture_decoding, 1, 0);
+  texture_cache_layout->addWidget(m_xxh3_texture_hash, 1, 2);
+  texture_cache_layout->addWidget(m_write_tracking, 2, 0);
 
   // XFB
   auto* xfb_box = new QGroupBox(tr("External Frame Buffer (XFB)"));
@@ -107,11 +113,14 @@ void HacksWidget::CreateWidgets()
   m_vertex_rounding = new GraphicsBool(tr("Vertex Rounding"), Config::GFX_HACK_VERTEX_ROUDING);
   m_save_texture_cache_state =
       new GraphicsBool(tr("Save Texture Cache to State"), Config::GFX_SAVE_TEXTURE_CACHE_TO_STATE);
+  m_display_list_cache =
+      new GraphicsBool(tr("Cache Display Lists"), Config::GFX_HACK_DISPLAY_LIST_CACHE);
 
   other_layout->addWidget(m_fast_depth_calculation, 0, 0);
   other_layout->addWidget(m_disable_bounding_box, 0, 1);
   other_layout->addWidget(m_vertex_rounding, 1, 0);
   other_layout->addWidget(m_save_texture_cache_state, 1, 1);
+  other_layout->addWidget(m_display_list_cache, 2, 0);
 
   main_layout->addWidget(efb_box);
   main_layout->addWidget(texture_cache_box);
@@ -123,6 +132,7 @@ void HacksWidget::CreateWidgets()
 
   UpdateDeferEFBCopiesEnabled();
   UpdateSkipPresentingDuplicateFramesEnabled();
+  UpdateDisplayListCacheEnabled();
 }
 
 void HacksWidget::OnBackendChanged(const QString& backend_name)
@@ -148,6 +158,8 @@ void HacksWidget::ConnectWidgets()
           [this](int) { UpdateDeferEFBCopiesEnabled(); });
   connect(m_immediate_xfb, &QCheckBox::stateChanged,
           [this](int) { UpdateSkipPresentingDuplicateFramesEnabled(); });
+  connect(m_write_tracking, &QCheckBox::stateChanged,
+          [this](int) { UpdateDisplayListCacheEnabled(); });
 }
 
 void HacksWidget::LoadSettings()
@@ -259,6 +271,15 @@ void HacksWidget::AddDescriptions()
       "performance gains in some scenarios, or on systems where the CPU is the "
       "bottleneck.<br><br><dolphin_emphasis>If unsure, leave this "
       "unchecked.</dolphin_emphasis>");
+  static const char TR_XXH3_TEXTURE_HASH_DESCRIPTION[] = QT_TR_NOOP(
+      "Uses xxHash3 to detect texture changes when the whole texture is hashed, which is faster "
+      "on CPUs with SSE2, AVX2 or NEON. Has no effect on texture dumping and custom texture "
+      "names.<br><br><dolphin_emphasis>If unsure, leave this unchecked.</dolphin_emphasis>");
+  static const char TR_WRITE_TRACKING_DESCRIPTION[] = QT_TR_NOOP(
+      "Write-protects the memory of cached textures, so that textures which the game has not "
+      "modified do not need to be hashed again.<br><br>Reduces CPU usage in games with many "
+      "large textures, but may be slower in games which rewrite textures every "
+      "frame.<br><br><dolphin_emphasis>If unsure, leave this unchecked.</dolphin_emphasis>");
   static const char TR_FAST_DEPTH_CALC_DESCRIPTION[] = QT_TR_NOOP(
       "Uses a less accurate algorithm to calculate depth values.<br><br>Causes issues in a few "
       "games, but can result in a decent speed increase depending on the game and/or "
@@ -277,6 +298,11 @@ void HacksWidget::AddDescriptions()
       "higher internal resolutions. This setting has no effect when native internal "
       "resolution is used.<br><br><dolphin_emphasis>If unsure, leave this "
       "unchecked.</dolphin_emphasis>");
+  static const char TR_DISPLAY_LIST_CACHE_DESCRIPTION[] = QT_TR_NOOP(
+      "Keeps the vertices loaded by display lists which the game calls repeatedly, and reuses "
+      "them while the display list and its vertex data are unchanged.<br><br>Reduces CPU usage "
+      "in games which draw with static display lists. Requires Track Texture Memory Writes to be "
+      "enabled.<br><br><dolphin_emphasis>If unsure, leave this unchecked.</dolphin_emphasis>");
 
   m_skip_efb_cpu->SetDescription(tr(TR_SKIP_EFB_CPU_ACCESS_DESCRIPTION));
   m_ignore_format_changes->SetDescription(tr(TR_IGNORE_FORMAT_CHANGE_DESCRIPTION));
@@ -288,10 +314,13 @@ void HacksWidget::AddDescriptions()
   m_immediate_xfb->SetDescription(tr(TR_IMMEDIATE_XFB_DESCRIPTION));
   m_skip_duplicate_xfbs->SetDescription(tr(TR_SKIP_DUPLICATE_XFBS_DESCRIPTION));
   m_gpu_texture_decoding->SetDescription(tr(TR_GPU_DECODING_DESCRIPTION));
+  m_xxh3_texture_hash->SetDescription(tr(TR_XXH3_TEXTURE_HASH_DESCRIPTION));
+  m_write_tracking->SetDescription(tr(TR_WRITE_TRACKING_DESCRIPTION));
   m_fast_depth_calculation->SetDescription(tr(TR_FAST_DEPTH_CALC_DESCRIPTION));
   m_disable_bounding_box->SetDescription(tr(TR_DISABLE_BOUNDINGBOX_DESCRIPTION));
   m_save_texture_cache_state->SetDescription(tr(TR_SAVE_TEXTURE_CACHE_TO_STATE_DESCRIPTION));
   m_vertex_rounding->SetDescription(tr(TR_VERTEX_ROUNDING_DESCRIPTION));
+  m_display_list_cache->SetDescription(tr(TR_DISPLAY_LIST_CACHE_DESCRIPTION));
 }
 
 void HacksWidget::UpdateDeferEFBCopiesEnabled()
@@ -308,3 +337,9 @@ void HacksWidget::UpdateSkipPresentingDuplicateFramesEnabled()
   // when the XFB is created, therefore all XFB copies will be unique.
   m_skip_duplicate_xfbs->setEnabled(!m_immediate_xfb->isChecked());
 }
+
+void HacksWidget::UpdateDisplayListCacheEnabled()
+{
+  // Changes to display lists and vertex arrays are detected by write tracking.
+  m_display_list_cache->setEnabled(m_write_tracking->isChecked());
+}
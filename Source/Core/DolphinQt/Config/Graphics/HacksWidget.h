@@ -32,6 +32,8 @@ private:
   QLabel* m_accuracy_label;
   ToolTipSlider* m_accuracy;
   GraphicsBool* m_gpu_texture_decoding;
+  GraphicsBool* m_xxh3_texture_hash;
+  GraphicsBool* m_write_tracking;
 
   // External Framebuffer
   GraphicsBool* m_store_xfb_copies;
@@ -43,6 +45,7 @@ private:
   GraphicsBool* m_disable_bounding_box;
   GraphicsBool* m_vertex_rounding;
   GraphicsBool* m_save_texture_cache_state;
+  GraphicsBool* m_display_list_cache;
   GraphicsBool* m_defer_efb_copies;
 
   void CreateWidgets();
@@ -51,4 +54,5 @@ private:
 
   void UpdateDeferEFBCopiesEnabled();
   void UpdateSkipPresentingDuplicateFramesEnabled();
+  void UpdateDisplayListCacheEnabled();
 };
@@ -172,7 +172,9 @@ void FIFOAnalyzer::UpdateDetails()
   int object_nr = items[0]->data(0, OBJECT_ROLE).toInt();
 
   const auto& frame_info = FifoPlayer::GetInstance().GetAnalyzedFrameInfo(frame_nr);
-  const auto& fifo_frame = FifoPlayer::GetInstance().GetFile()->GetFrame(frame_nr);
+  const std::shared_ptr<const FifoFrameInfo> fifo_frame_data =
+      FifoPlayer::GetInstance().GetFile()->GetFrame(frame_nr);
+  const FifoFrameInfo& fifo_frame = *fifo_frame_data;
 
   const u8* objectdata_start = &fifo_frame.fifoData[frame_info.objectStarts[object_nr]];
   const u8* objectdata_end = &fifo_frame.fifoData[frame_info.objectEnds[object_nr]];
@@ -345,7 +347,9 @@ void FIFOAnalyzer::BeginSearch()
   int object_nr = items[0]->data(0, OBJECT_ROLE).toInt();
 
   const AnalyzedFrameInfo& frame_info = FifoPlayer::GetInstance().GetAnalyzedFrameInfo(frame_nr);
-  const FifoFrameInfo& fifo_frame = FifoPlayer::GetInstance().GetFile()->GetFrame(frame_nr);
+  const std::shared_ptr<const FifoFrameInfo> fifo_frame_data =
+      FifoPlayer::GetInstance().GetFile()->GetFrame(frame_nr);
+  const FifoFrameInfo& fifo_frame = *fifo_frame_data;
 
   // TODO: Support searching through the last object...how do we know where the cmd data ends?
   // TODO: Support searching for bit patterns
@@ -457,7 +461,9 @@ void FIFOAnalyzer::UpdateDescription()
   int entry_nr = m_detail_list->currentRow();
 
   const AnalyzedFrameInfo& frame = FifoPlayer::GetInstance().GetAnalyzedFrameInfo(frame_nr);
-  const FifoFrameInfo& fifo_frame = FifoPlayer::GetInstance().GetFile()->GetFrame(frame_nr);
+  const std::shared_ptr<const FifoFrameInfo> fifo_frame_data =
+      FifoPlayer::GetInstance().GetFile()->GetFrame(frame_nr);
+  const FifoFrameInfo& fifo_frame = *fifo_frame_data;
 
   const u8* cmddata =
       &fifo_frame.fifoData[frame.objectStarts[object_nr]] + m_object_data_offsets[entry_nr];
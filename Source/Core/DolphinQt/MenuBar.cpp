@@ -139,6 +139,7 @@ void MenuBar::OnEmulationStateChanged(Core::State state)
   m_jit_disable_fastmem->setEnabled(!running);
   m_jit_clear_cache->setEnabled(running);
   m_jit_log_coverage->setEnabled(!running);
+  m_jit_write_ir_report->setEnabled(running);
   m_jit_search_instruction->setEnabled(running);
 
   for (QAction* action :
@@ -844,6 +845,8 @@ void MenuBar::AddJITMenu()
 
   m_jit_log_coverage =
       m_jit->addAction(tr("Log JIT Instruction Coverage"), this, &MenuBar::LogInstructions);
+  m_jit_write_ir_report =
+      m_jit->addAction(tr("Write JIT IR Report"), this, &MenuBar::WriteIRReport);
   m_jit_search_instruction =
       m_jit->addAction(tr("Search for an Instruction"), this, &MenuBar::SearchInstruction);
 
@@ -1585,6 +1588,11 @@ void MenuBar::LogInstructions()
   PPCTables::LogCompiledInstructions();
 }
 
+void MenuBar::WriteIRReport()
+{
+  JitInterface::WriteIRReport(File::GetUserPath(D_LOGS_IDX) + "jit_ir.txt");
+}
+
 void MenuBar::SearchInstruction()
 {
   bool good;
@@ -170,6 +170,7 @@ private:
   void PatchHLEFunctions();
   void ClearCache();
   void LogInstructions();
+  void WriteIRReport();
   void SearchInstruction();
 
   void OnSelectionChanged(std::shared_ptr<const UICommon::GameFile> game_file);
@@ -253,6 +254,7 @@ private:
   QAction* m_jit_disable_fastmem;
   QAction* m_jit_clear_cache;
   QAction* m_jit_log_coverage;
+  QAction* m_jit_write_ir_report;
   QAction* m_jit_search_instruction;
   QAction* m_jit_off;
   QAction* m_jit_loadstore_off;
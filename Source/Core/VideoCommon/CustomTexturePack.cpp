@@ -0,0 +1,419 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/CustomTexturePack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <fmt/format.h>
+#include <zstd.h>
+
+#include "Common/File.h"
+#include "Common/FileSearch.h"
+#include "Common/Logging/Log.h"
+#include "Common/StringUtil.h"
+#include "VideoCommon/TextureConfig.h"
+
+namespace
+{
+constexpr u32 PACK_MAGIC = 0x4B505444;  // "DTPK"
+constexpr u32 PACK_VERSION = 1;
+
+struct Header
+{
+  u32 magic;
+  u32 version;
+  u32 num_textures;
+  u32 num_levels;
+  u64 index_offset;
+  u64 names_size;
+};
+static_assert(sizeof(Header) == 32);
+
+enum class Compression : u8
+{
+  None = 0,
+  Zstd = 1,
+};
+
+enum TextureFlags : u16
+{
+  TEXTURE_FLAG_ARBITRARY_MIPMAPS = 1 << 0,
+};
+
+bool IsValidFormat(AbstractTextureFormat format)
+{
+  switch (format)
+  {
+  case AbstractTextureFormat::RGBA8:
+  case AbstractTextureFormat::BGRA8:
+  case AbstractTextureFormat::DXT1:
+  case AbstractTextureFormat::DXT3:
+  case AbstractTextureFormat::DXT5:
+  case AbstractTextureFormat::BPTC:
+    return true;
+  default:
+    return false;
+  }
+}
+}  // namespace
+
+struct CustomTexturePack::TextureInfo
+{
+  u64 name_offset;
+  u32 name_size;
+  u32 first_level;
+  u16 num_levels;
+  u16 flags;
+  u32 padding;
+};
+
+struct CustomTexturePack::LevelInfo
+{
+  u64 offset;
+  u64 stored_size;
+  u64 size;
+  u32 width;
+  u32 height;
+  u32 row_length;
+  AbstractTextureFormat format;
+  Compression compression;
+  u8 padding[7];
+};
+
+CustomTexturePack::~CustomTexturePack()
+{
+  if (!m_data)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(m_data);
+  CloseHandle(m_file_mapping);
+#else
+  munmap(const_cast<u8*>(m_data), m_size);
+#endif
+}
+
+std::unique_ptr<CustomTexturePack> CustomTexturePack::Open(const std::string& path)
+{
+  // Can't use make_unique due to private constructor.
+  std::unique_ptr<CustomTexturePack> pack(new CustomTexturePack());
+
+#ifdef _WIN32
+  const HANDLE file = CreateFileW(UTF8ToWString(path).c_str(), GENERIC_READ, FILE_SHARE_READ,
+                                  nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return nullptr;
+
+  LARGE_INTEGER size;
+  if (GetFileSizeEx(file, &size) && size.QuadPart >= static_cast<LONGLONG>(sizeof(Header)))
+    pack->m_file_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!pack->m_file_mapping)
+    return nullptr;
+
+  pack->m_data =
+      static_cast<const u8*>(MapViewOfFile(pack->m_file_mapping, FILE_MAP_READ, 0, 0, 0));
+  if (!pack->m_data)
+  {
+    CloseHandle(pack->m_file_mapping);
+    pack->m_file_mapping = nullptr;
+    return nullptr;
+  }
+  pack->m_size = static_cast<u64>(size.QuadPart);
+#else
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return nullptr;
+
+  struct stat file_info;
+  void* data = MAP_FAILED;
+  if (fstat(fd, &file_info) == 0 && file_info.st_size >= static_cast<off_t>(sizeof(Header)))
+    data = mmap(nullptr, file_info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return nullptr;
+
+  pack->m_data = static_cast<const u8*>(data);
+  pack->m_size = static_cast<u64>(file_info.st_size);
+#endif
+
+  Header header;
+  std::memcpy(&header, pack->m_data, sizeof(Header));
+  if (header.magic != PACK_MAGIC || header.version != PACK_VERSION)
+  {
+    ERROR_LOG_FMT(VIDEO, "Custom texture pack {} has an unsupported format", path);
+    return nullptr;
+  }
+
+  const u64 index_size = u64{header.num_textures} * sizeof(TextureInfo) +
+                         u64{header.num_levels} * sizeof(LevelInfo) + header.names_size;
+  if (header.index_offset > pack->m_size || pack->m_size - header.index_offset < index_size)
+  {
+    ERROR_LOG_FMT(VIDEO, "Custom texture pack {} is truncated", path);
+    return nullptr;
+  }
+
+  pack->m_num_textures = header.num_textures;
+  pack->m_num_levels = header.num_levels;
+  pack->m_textures = pack->m_data + header.index_offset;
+  pack->m_levels = pack->m_textures + pack->m_num_textures * sizeof(TextureInfo);
+  pack->m_names =
+      reinterpret_cast<const char*>(pack->m_levels + pack->m_num_levels * sizeof(LevelInfo));
+  pack->m_names_size = header.names_size;
+
+  for (size_t i = 0; i < pack->m_num_textures; i++)
+  {
+    const TextureInfo info = pack->GetTextureInfo(i);
+    if (info.name_offset > pack->m_names_size ||
+        pack->m_names_size - info.name_offset < info.name_size ||
+        info.first_level > pack->m_num_levels ||
+        pack->m_num_levels - info.first_level < info.num_levels)
+    {
+      ERROR_LOG_FMT(VIDEO, "Custom texture pack {} has an invalid index", path);
+      return nullptr;
+    }
+  }
+
+  return pack;
+}
+
+CustomTexturePack::TextureInfo CustomTexturePack::GetTextureInfo(size_t index) const
+{
+  static_assert(sizeof(TextureInfo) == 24);
+  TextureInfo info;
+  std::memcpy(&info, m_textures + index * sizeof(TextureInfo), sizeof(TextureInfo));
+  return info;
+}
+
+CustomTexturePack::LevelInfo CustomTexturePack::GetLevelInfo(size_t index) const
+{
+  static_assert(sizeof(LevelInfo) == 48);
+  LevelInfo info;
+  std::memcpy(&info, m_levels + index * sizeof(LevelInfo), sizeof(LevelInfo));
+  return info;
+}
+
+std::string_view CustomTexturePack::GetTextureName(size_t index) const
+{
+  const TextureInfo info = GetTextureInfo(index);
+  return std::string_view(m_names + info.name_offset, info.name_size);
+}
+
+bool CustomTexturePack::HasArbitraryMipmaps(size_t index) const
+{
+  return (GetTextureInfo(index).flags & TEXTURE_FLAG_ARBITRARY_MIPMAPS) != 0;
+}
+
+std::optional<size_t> CustomTexturePack::FindTexture(std::string_view name) const
+{
+  size_t first = 0;
+  size_t last = m_num_textures;
+  while (first < last)
+  {
+    const size_t middle = first + (last - first) / 2;
+    const std::string_view middle_name = GetTextureName(middle);
+    if (middle_name == name)
+      return middle;
+
+    if (middle_name < name)
+      first = middle + 1;
+    else
+      last = middle;
+  }
+
+  return std::nullopt;
+}
+
+bool CustomTexturePack::LoadLevels(size_t index, std::vector<HiresTexture::Level>* levels) const
+{
+  const TextureInfo texture_info = GetTextureInfo(index);
+  if (texture_info.num_levels == 0)
+    return false;
+
+  // Only append the levels once all of them have been decoded.
+  std::vector<HiresTexture::Level> new_levels;
+  new_levels.reserve(texture_info.num_levels);
+  for (u32 i = 0; i < texture_info.num_levels; i++)
+  {
+    const LevelInfo info = GetLevelInfo(texture_info.first_level + i);
+    if (!IsValidFormat(info.format) || info.offset > m_size ||
+        m_size - info.offset < info.stored_size)
+    {
+      return false;
+    }
+
+    HiresTexture::Level level;
+    level.format = info.format;
+    level.width = info.width;
+    level.height = info.height;
+    level.row_length = info.row_length;
+    level.data.resize(info.size);
+
+    const u8* stored_data = m_data + info.offset;
+    if (info.compression == Compression::None)
+    {
+      if (info.stored_size != info.size)
+        return false;
+      std::copy_n(stored_data, info.size, level.data.begin());
+    }
+    else if (info.compression == Compression::Zstd)
+    {
+      const size_t result =
+          ZSTD_decompress(level.data.data(), level.data.size(), stored_data, info.stored_size);
+      if (ZSTD_isError(result) || result != info.size)
+        return false;
+    }
+    else
+    {
+      return false;
+    }
+
+    new_levels.push_back(std::move(level));
+  }
+
+  std::move(new_levels.begin(), new_levels.end(), std::back_inserter(*levels));
+  return true;
+}
+
+bool CustomTexturePack::Build(const std::string& texture_directory,
+                              const std::string& output_path, int compression_level,
+                              std::string* error)
+{
+  struct SourceTexture
+  {
+    std::string name;
+    std::string path;
+    bool has_arbitrary_mipmaps;
+  };
+
+  std::vector<SourceTexture> sources;
+  for (const std::string& path :
+       Common::DoFileSearch({texture_directory}, {".png", ".dds"}, /*recursive*/ true))
+  {
+    SourceTexture source;
+    source.path = path;
+    if (HiresTexture::GetNameFromPath(path, &source.name, &source.has_arbitrary_mipmaps))
+      sources.push_back(std::move(source));
+  }
+
+  // The index is searched with a binary search. Keep the first of any duplicate names, like
+  // HiresTexture::Update does.
+  std::stable_sort(sources.begin(), sources.end(),
+                   [](const SourceTexture& a, const SourceTexture& b) { return a.name < b.name; });
+  sources.erase(std::unique(sources.begin(), sources.end(),
+                            [](const SourceTexture& a, const SourceTexture& b) {
+                              return a.name == b.name;
+                            }),
+                sources.end());
+
+  File::IOFile file(output_path, "wb");
+  if (!file)
+  {
+    *error = fmt::format("Failed to open {} for writing", output_path);
+    return false;
+  }
+
+  Header header{};
+  if (!file.WriteArray(&header, 1))
+  {
+    *error = fmt::format("Failed to write to {}", output_path);
+    return false;
+  }
+
+  std::vector<TextureInfo> textures;
+  std::vector<LevelInfo> levels;
+  std::string names;
+  std::vector<u8> compressed;
+  u64 offset = sizeof(Header);
+
+  for (const SourceTexture& source : sources)
+  {
+    std::vector<HiresTexture::Level> source_levels;
+    if (!HiresTexture::LoadFile(source.path, HiresTexture::GetMipLevelFromName(source.name),
+                                &source_levels))
+    {
+      WARN_LOG_FMT(VIDEO, "Skipping custom texture {}, which failed to load", source.path);
+      continue;
+    }
+
+    TextureInfo texture{};
+    texture.name_offset = names.size();
+    texture.name_size = static_cast<u32>(source.name.size());
+    texture.first_level = static_cast<u32>(levels.size());
+    texture.num_levels = static_cast<u16>(source_levels.size());
+    texture.flags = source.has_arbitrary_mipmaps ? TEXTURE_FLAG_ARBITRARY_MIPMAPS : 0;
+    textures.push_back(texture);
+    names += source.name;
+
+    for (const HiresTexture::Level& source_level : source_levels)
+    {
+      LevelInfo level{};
+      level.offset = offset;
+      level.size = source_level.data.size();
+      level.width = source_level.width;
+      level.height = source_level.height;
+      level.row_length = source_level.row_length;
+      level.format = source_level.format;
+
+      compressed.resize(ZSTD_compressBound(source_level.data.size()));
+      const size_t compressed_size =
+          ZSTD_compress(compressed.data(), compressed.size(), source_level.data.data(),
+                        source_level.data.size(), compression_level);
+
+      // Block compressed formats often do not get any smaller, so store those as they are.
+      const u8* stored_data;
+      if (!ZSTD_isError(compressed_size) && compressed_size < source_level.data.size())
+      {
+        level.compression = Compression::Zstd;
+        level.stored_size = compressed_size;
+        stored_data = compressed.data();
+      }
+      else
+      {
+        level.compression = Compression::None;
+        level.stored_size = source_level.data.size();
+        stored_data = source_level.data.data();
+      }
+
+      if (!file.WriteBytes(stored_data, level.stored_size))
+      {
+        *error = fmt::format("Failed to write to {}", output_path);
+        return false;
+      }
+
+      offset += level.stored_size;
+      levels.push_back(level);
+    }
+  }
+
+  header.magic = PACK_MAGIC;
+  header.version = PACK_VERSION;
+  header.num_textures = static_cast<u32>(textures.size());
+  header.num_levels = static_cast<u32>(levels.size());
+  header.index_offset = offset;
+  header.names_size = names.size();
+
+  if (!file.WriteArray(textures.data(), textures.size()) ||
+      !file.WriteArray(levels.data(), levels.size()) || !file.WriteString(names) ||
+      !file.Seek(0, SEEK_SET) || !file.WriteArray(&header, 1))
+  {
+    *error = fmt::format("Failed to write to {}", output_path);
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,74 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/HiresTextures.h"
+
+// A single file containing the custom textures of a game, already decoded. Loading a texture from
+// a pack is an index lookup and a decompression, instead of opening and decoding a PNG or DDS.
+//
+// Packs are built from a texture directory with texturepacktool. Each texture is stored under the
+// same name its file would have in the directory (without extension and "_arb" suffix), so the
+// names produced by HiresTexture::GenBaseName can be looked up directly.
+//
+// Layout, all values little endian:
+//   Header
+//   Level payloads, zstd compressed unless that did not make them smaller
+//   TextureInfo[num_textures], sorted by name
+//   LevelInfo[num_levels]
+//   Names
+class CustomTexturePack
+{
+public:
+  ~CustomTexturePack();
+
+  CustomTexturePack(const CustomTexturePack&) = delete;
+  CustomTexturePack& operator=(const CustomTexturePack&) = delete;
+
+  static std::unique_ptr<CustomTexturePack> Open(const std::string& path);
+
+  // Packs every custom texture file below texture_directory into a new pack at output_path.
+  static bool Build(const std::string& texture_directory, const std::string& output_path,
+                    int compression_level, std::string* error);
+
+  size_t GetTextureCount() const { return m_num_textures; }
+  std::string_view GetTextureName(size_t index) const;
+  bool HasArbitraryMipmaps(size_t index) const;
+  std::optional<size_t> FindTexture(std::string_view name) const;
+
+  // Appends the levels stored for the texture. For a texture whose source was a DDS file, this
+  // includes the mipmaps stored in that file.
+  bool LoadLevels(size_t index, std::vector<HiresTexture::Level>* levels) const;
+
+private:
+  struct TextureInfo;
+  struct LevelInfo;
+
+  CustomTexturePack() = default;
+
+  TextureInfo GetTextureInfo(size_t index) const;
+  LevelInfo GetLevelInfo(size_t index) const;
+
+  const u8* m_data = nullptr;
+  u64 m_size = 0;
+#ifdef _WIN32
+  void* m_file_mapping = nullptr;
+#endif
+
+  size_t m_num_textures = 0;
+  size_t m_num_levels = 0;
+  const u8* m_textures = nullptr;
+  const u8* m_levels = nullptr;
+  const char* m_names = nullptr;
+  u64 m_names_size = 0;
+};
@@ -0,0 +1,341 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/DisplayListCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Hash.h"
+#include "Common/Swap.h"
+#include "Core/HW/Memmap.h"
+#include "Core/HW/WriteTracker.h"
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/Fifo.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/VertexLoaderBase.h"
+#include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace DisplayListCache
+{
+namespace
+{
+// Draws with fewer vertices are cheaper to load than to look up.
+constexpr int MIN_CACHED_VERTICES = 3;
+constexpr size_t MAX_CACHE_SIZE = 64 * 1024 * 1024;
+constexpr size_t MAX_DISPLAY_LISTS = 16384;
+
+struct MemoryRange
+{
+  u32 address = 0;
+  u32 size = 0;
+  u64 hash = 0;
+  u64 write_stamp = 0;
+
+  // Returns false if the range cannot be tracked.
+  bool Update(u32 new_address, u32 new_size)
+  {
+    address = new_address;
+    size = new_size;
+    // Protect before hashing, so that a write racing with the hash is not missed.
+    write_stamp = WriteTracker::Protect(address, size);
+    if (write_stamp == 0)
+      return false;
+
+    hash = Common::GetHash64(Memory::GetPointer(address), size, 0);
+    return true;
+  }
+
+  bool Matches()
+  {
+    if (WriteTracker::IsUnmodified(address, size, write_stamp))
+      return true;
+
+    const u64 stamp = WriteTracker::Protect(address, size);
+    if (stamp == 0 || hash != Common::GetHash64(Memory::GetPointer(address), size, 0))
+      return false;
+
+    write_stamp = stamp;
+    return true;
+  }
+};
+
+struct ArrayRange
+{
+  int array;
+  u32 base;
+  u32 stride;
+  MemoryRange memory;
+};
+
+struct Batch
+{
+  // Once a draw changes between calls, it is always loaded by the vertex loader.
+  bool valid = true;
+
+  VertexLoaderBase* loader = nullptr;
+  int count = 0;
+  int loaded_count = 0;
+  std::vector<ArrayRange> arrays;
+  std::vector<u8> vertices;
+
+  // The state the vertex loader leaves behind for later draws.
+  float position_cache[3][4];
+  u32 position_matrix_index[4];
+};
+
+struct DisplayList
+{
+  MemoryRange memory;
+  // Keyed by the offset of the vertex data in the display list.
+  std::unordered_map<u32, Batch> batches;
+  size_t size = 0;
+  std::list<u64>::iterator lru_position;
+};
+
+std::unordered_map<u64, DisplayList> s_display_lists;
+// Most recently used first.
+std::list<u64> s_lru;
+size_t s_cache_size = 0;
+
+DisplayList* s_current = nullptr;
+const u8* s_current_data = nullptr;
+}  // namespace
+
+static u64 GetKey(u32 address, u32 size)
+{
+  return (static_cast<u64>(address) << 32) | size;
+}
+
+static bool IsEnabled()
+{
+  return g_ActiveConfig.bDisplayListCache && WriteTracker::IsEnabled() &&
+         !Fifo::UseDeterministicGPUThread() && !OpcodeDecoder::g_record_fifo_data;
+}
+
+static void ClearBatches(DisplayList* display_list)
+{
+  s_cache_size -= display_list->size;
+  display_list->size = 0;
+  display_list->batches.clear();
+}
+
+static void RemoveDisplayList(u64 key)
+{
+  const auto iter = s_display_lists.find(key);
+  ClearBatches(&iter->second);
+  s_lru.erase(iter->second.lru_position);
+  s_display_lists.erase(iter);
+}
+
+// Evicts the least recently used display lists, other than the current one.
+static void EvictIfNeeded()
+{
+  auto iter = s_lru.end();
+  while (iter != s_lru.begin() &&
+         (s_cache_size > MAX_CACHE_SIZE || s_display_lists.size() > MAX_DISPLAY_LISTS))
+  {
+    --iter;
+    const auto display_list = s_display_lists.find(*iter);
+    if (&display_list->second == s_current)
+      continue;
+
+    ClearBatches(&display_list->second);
+    s_display_lists.erase(display_list);
+    iter = s_lru.erase(iter);
+  }
+}
+
+void Clear()
+{
+  s_display_lists.clear();
+  s_lru.clear();
+  s_cache_size = 0;
+  s_current = nullptr;
+  s_current_data = nullptr;
+}
+
+void BeginDisplayList(u32 address, u32 size, const u8* data)
+{
+  if (!IsEnabled())
+  {
+    if (!s_display_lists.empty())
+      Clear();
+    return;
+  }
+
+  const u64 key = GetKey(address, size);
+  const auto [iter, inserted] = s_display_lists.try_emplace(key);
+  DisplayList& display_list = iter->second;
+  if (inserted)
+  {
+    // Lists which are only executed once are not worth recording, so only start doing so on the
+    // next call.
+    s_lru.push_front(key);
+    display_list.lru_position = s_lru.begin();
+    if (!display_list.memory.Update(address, size))
+      RemoveDisplayList(key);
+    else
+      EvictIfNeeded();
+    return;
+  }
+
+  s_lru.splice(s_lru.begin(), s_lru, display_list.lru_position);
+
+  if (!display_list.memory.Matches())
+  {
+    // The list was rewritten. If it stays the same from now on, it is recorded again next time.
+    ClearBatches(&display_list);
+    if (!display_list.memory.Update(address, size))
+      RemoveDisplayList(key);
+    return;
+  }
+
+  s_current = &display_list;
+  s_current_data = data;
+}
+
+void EndDisplayList()
+{
+  s_current = nullptr;
+  s_current_data = nullptr;
+}
+
+bool IsActive()
+{
+  return s_current != nullptr;
+}
+
+static bool ArraysMatch(Batch* batch)
+{
+  return std::all_of(batch->arrays.begin(), batch->arrays.end(), [](ArrayRange& range) {
+    return g_main_cp_state.array_bases[range.array] == range.base &&
+           g_main_cp_state.array_strides[range.array] == range.stride && range.memory.Matches();
+  });
+}
+
+static u32 ReadIndex(const u8* data, u32 index_size)
+{
+  return index_size == 2 ? Common::swap16(data) : *data;
+}
+
+// Finds the ranges of the vertex arrays which the draw reads from.
+static bool RecordArrays(Batch* batch, const VertexLoaderBase* loader, const u8* src, int count)
+{
+  const std::optional<std::vector<VertexLoaderBase::ArrayIndex>> indices =
+      loader->GetArrayIndices();
+  if (!indices)
+    return false;
+
+  // The vertex loaders skip vertices whose position index has all bits set. Nothing else they
+  // read for such a vertex ends up in the vertex buffer.
+  const auto position = std::find_if(indices->begin(), indices->end(), [](const auto& index) {
+    return index.array == ARRAY_POSITION;
+  });
+  const auto is_skipped = [&position, &indices](const u8* vertex) {
+    if (position == indices->end())
+      return false;
+    const u32 skip_index = position->index_size == 2 ? 0xFFFF : 0xFF;
+    return ReadIndex(vertex + position->offset, position->index_size) == skip_index;
+  };
+
+  const u32 vertex_size = static_cast<u32>(loader->m_VertexSize);
+  for (const VertexLoaderBase::ArrayIndex& index : *indices)
+  {
+    u32 min_index = UINT32_MAX;
+    u32 max_index = 0;
+    for (int i = 0; i < count; i++)
+    {
+      const u8* vertex = src + i * vertex_size;
+      if (is_skipped(vertex))
+        continue;
+
+      for (u32 j = 0; j < index.num_indices; j++)
+      {
+        const u32 value = ReadIndex(vertex + index.offset + j * index.index_size, index.index_size);
+        min_index = std::min(min_index, value);
+        max_index = std::max(max_index, value);
+      }
+    }
+
+    // Every vertex was skipped.
+    if (min_index > max_index)
+      continue;
+
+    ArrayRange range;
+    range.array = index.array;
+    range.base = g_main_cp_state.array_bases[index.array];
+    range.stride = g_main_cp_state.array_strides[index.array];
+    const u32 address = range.base + min_index * range.stride;
+    const u32 size = (max_index - min_index) * range.stride + index.element_size;
+    if (!range.memory.Update(address, size))
+      return false;
+
+    batch->arrays.push_back(range);
+  }
+
+  return true;
+}
+
+int LoadVertices(VertexLoaderBase* loader, DataReader src, DataReader dst, int count)
+{
+  const u32 offset = static_cast<u32>(src.GetPointer() - s_current_data);
+  const auto [iter, inserted] = s_current->batches.try_emplace(offset);
+  Batch& batch = iter->second;
+
+  if (!inserted)
+  {
+    if (!batch.valid)
+      return loader->RunVertices(src, dst, count);
+
+    if (batch.loader == loader && batch.count == count && ArraysMatch(&batch))
+    {
+      std::memcpy(dst.GetPointer(), batch.vertices.data(), batch.vertices.size());
+      std::memcpy(VertexLoaderManager::position_cache, batch.position_cache,
+                  sizeof(batch.position_cache));
+      std::memcpy(VertexLoaderManager::position_matrix_index, batch.position_matrix_index,
+                  sizeof(batch.position_matrix_index));
+      loader->m_numLoadedVertices += count;
+      return batch.loaded_count;
+    }
+
+    s_cache_size -= batch.vertices.size();
+    s_current->size -= batch.vertices.size();
+    batch = {};
+    batch.valid = false;
+    return loader->RunVertices(src, dst, count);
+  }
+
+  const int loaded_count = loader->RunVertices(src, dst, count);
+
+  if (count < MIN_CACHED_VERTICES || !RecordArrays(&batch, loader, src.GetPointer(), count))
+  {
+    batch = {};
+    batch.valid = false;
+    return loaded_count;
+  }
+
+  batch.loader = loader;
+  batch.count = count;
+  batch.loaded_count = loaded_count;
+  const u8* vertices = dst.GetPointer();
+  batch.vertices.assign(vertices, vertices + loaded_count * loader->m_native_vtx_decl.stride);
+  std::memcpy(batch.position_cache, VertexLoaderManager::position_cache,
+              sizeof(batch.position_cache));
+  std::memcpy(batch.position_matrix_index, VertexLoaderManager::position_matrix_index,
+              sizeof(batch.position_matrix_index));
+
+  s_cache_size += batch.vertices.size();
+  s_current->size += batch.vertices.size();
+  EvictIfNeeded();
+
+  return loaded_count;
+}
+}  // namespace DisplayListCache
@@ -0,0 +1,37 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/DataReader.h"
+
+class VertexLoaderBase;
+
+// Caches the vertices which the vertex loaders produce for the draws in a display list.
+//
+// Many games call the same static display lists every frame, so the same raw vertices are decoded
+// again and again. While a cached list is being executed, each draw in it looks up the native
+// vertices recorded the last time it ran, and copies them into the vertex buffer instead of running
+// the vertex loader. A recorded draw is only reused if the vertex loader (and so the VAT and vertex
+// descriptor), the array bases and strides, and the contents of the display list and of the array
+// ranges its indices refer to are all unchanged.
+//
+// Changes to memory are detected like in the texture cache: by write tracking, and by rehashing the
+// memory once it has been written. The cache is therefore only active while write tracking is.
+namespace DisplayListCache
+{
+void Clear();
+
+// Called around the execution of a display list. The data is the display list in memory.
+void BeginDisplayList(u32 address, u32 size, const u8* data);
+void EndDisplayList();
+
+// Returns true if the draws of the current display list should go through LoadVertices().
+bool IsActive();
+
+// Has the same effect as loader->RunVertices(src, dst, count), but may copy the vertices from the
+// cache instead. src must point into the data of the current display list.
+int LoadVertices(VertexLoaderBase* loader, DataReader src, DataReader dst, int count);
+}  // namespace DisplayListCache
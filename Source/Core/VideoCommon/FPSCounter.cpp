@@ -7,12 +7,16 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
+#include "Common/Metrics.h"
 #include "Common/Timer.h"
 #include "VideoCommon/FPSCounter.h"
 #include "VideoCommon/VideoConfig.h"
 
 static constexpr u64 FPS_REFRESH_INTERVAL = 250000;
 
+static Common::Metrics::Histogram s_frame_time_metric(Common::Metrics::Thread::GPU,
+                                                      "frame_time_us");
+
 FPSCounter::FPSCounter()
 {
   m_last_time = Common::Timer::GetTimeUs();
@@ -35,6 +39,7 @@ void FPSCounter::Update()
   u64 diff = time - m_last_time;
   if (g_ActiveConfig.bLogRenderTimeToFile)
     LogRenderTimeToFile(diff);
+  s_frame_time_metric.Record(diff);
 
   m_frame_counter++;
   m_time_since_update += diff;
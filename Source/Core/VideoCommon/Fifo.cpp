@@ -14,6 +14,7 @@
 #include "Common/Event.h"
 #include "Common/FPURoundMode.h"
 #include "Common/MemoryUtil.h"
+#include "Common/Metrics.h"
 #include "Common/MsgHandler.h"
 
 #include "Core/ConfigManager.h"
@@ -72,6 +73,9 @@ static std::atomic<int> s_sync_ticks;
 static bool s_syncing_suspended;
 static Common::Event s_sync_wakeup_event;
 
+// How long the CPU thread waits for the GPU thread to catch up.
+static Common::Metrics::Histogram s_gpu_wait_metric(Common::Metrics::Thread::CPU, "gpu_wait_us");
+
 void DoState(PointerWrap& p)
 {
   p.DoArray(s_video_buffer, FIFO_SIZE);
@@ -161,7 +165,10 @@ void SyncGPU(SyncGPUReason reason, bool may_move_read_ptr)
 {
   if (s_use_deterministic_gpu_thread)
   {
-    s_gpu_mainloop.Wait();
+    {
+      Common::Metrics::ScopedTimer timer(&s_gpu_wait_metric);
+      s_gpu_mainloop.Wait();
+    }
     if (!s_gpu_mainloop.IsRunning())
       return;
 
@@ -556,7 +563,10 @@ static int WaitForGpuThread(int ticks)
 
   // Wait for GPU
   if (now >= param.iSyncGpuMaxDistance)
+  {
+    Common::Metrics::ScopedTimer timer(&s_gpu_wait_metric);
     s_sync_wakeup_event.Wait();
+  }
 
   return GPU_TIME_SLOT_SIZE;
 }
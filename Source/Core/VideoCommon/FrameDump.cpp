@@ -8,8 +8,13 @@
 #define __STDC_CONSTANT_MACROS 1
 #endif
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <fmt/chrono.h>
 #include <fmt/format.h>
@@ -25,6 +30,7 @@ extern "C" {
 #include "Common/FileUtil.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
+#include "Common/Thread.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/HW/SystemTimers.h"
@@ -39,9 +45,17 @@ struct FrameDumpContext
   AVStream* stream = nullptr;
   AVCodecContext* codec = nullptr;
   AVFrame* src_frame = nullptr;
-  AVFrame* scaled_frame = nullptr;
   SwsContext* sws = nullptr;
 
+  // Frames in the pixel format of the encoder. Each is either free, or waiting to be encoded.
+  std::vector<AVFrame*> scaled_frames;
+  std::vector<AVFrame*> free_frames;
+  std::deque<AVFrame*> encode_queue;
+  std::mutex encode_mutex;
+  std::condition_variable encode_queue_changed;
+  bool stop_encoding = false;
+  std::thread encode_thread;
+
   s64 last_pts = AV_NOPTS_VALUE;
 
   int width = 0;
@@ -55,6 +69,10 @@ struct FrameDumpContext
 
 namespace
 {
+// Bounds the number of converted frames waiting for the encoder. AddFrame blocks when all of them
+// are in use.
+constexpr size_t NUM_SCALED_FRAMES = 4;
+
 AVRational GetTimeBaseForCurrentRefreshRate()
 {
   int num;
@@ -139,8 +157,11 @@ bool FrameDump::PrepareEncoding(int w, int h, u64 start_ticks, u32 savestate_ind
   {
     CloseVideoFile();
     OSD::AddMessage("FrameDump Start failed");
+    return false;
   }
-  return success;
+
+  m_context->encode_thread = std::thread(&FrameDump::EncodeThreadFunc, this);
+  return true;
 }
 
 bool FrameDump::CreateVideoFile()
@@ -220,6 +241,10 @@ bool FrameDump::CreateVideoFile()
   if (output_format->flags & AVFMT_GLOBALHEADER)
     m_context->codec->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
 
+  // Use one thread per core, with whichever of frame and slice threading the encoder supports.
+  m_context->codec->thread_count = 0;
+  m_context->codec->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
   if (avcodec_open2(m_context->codec, codec, nullptr) < 0)
   {
     ERROR_LOG_FMT(FRAMEDUMP, "Could not open codec");
@@ -227,14 +252,22 @@ bool FrameDump::CreateVideoFile()
   }
 
   m_context->src_frame = av_frame_alloc();
-  m_context->scaled_frame = av_frame_alloc();
 
-  m_context->scaled_frame->format = m_context->codec->pix_fmt;
-  m_context->scaled_frame->width = m_context->width;
-  m_context->scaled_frame->height = m_context->height;
-
-  if (av_frame_get_buffer(m_context->scaled_frame, 1))
-    return false;
+  for (size_t i = 0; i < NUM_SCALED_FRAMES; i++)
+  {
+    AVFrame* const scaled_frame = av_frame_alloc();
+    if (!scaled_frame)
+      return false;
+    m_context->scaled_frames.push_back(scaled_frame);
+
+    scaled_frame->format = m_context->codec->pix_fmt;
+    scaled_frame->width = m_context->width;
+    scaled_frame->height = m_context->height;
+
+    if (av_frame_get_buffer(scaled_frame, 1))
+      return false;
+    m_context->free_frames.push_back(scaled_frame);
+  }
 
   m_context->stream = avformat_new_stream(m_context->format, codec);
   if (!m_context->stream ||
@@ -302,6 +335,24 @@ void FrameDump::AddFrame(const FrameData& frame)
     }
   }
 
+  AVFrame* scaled_frame;
+  {
+    std::unique_lock lock(m_context->encode_mutex);
+    m_context->encode_queue_changed.wait(lock, [this] { return !m_context->free_frames.empty(); });
+    scaled_frame = m_context->free_frames.back();
+    m_context->free_frames.pop_back();
+  }
+
+  // The encoder may still hold a reference to the frame's buffer, in which case a new one is
+  // allocated.
+  if (const int error = av_frame_make_writable(scaled_frame))
+  {
+    ERROR_LOG_FMT(FRAMEDUMP, "Could not make frame writable: {}", error);
+    std::lock_guard lock(m_context->encode_mutex);
+    m_context->free_frames.push_back(scaled_frame);
+    return;
+  }
+
   constexpr AVPixelFormat pix_fmt = AV_PIX_FMT_RGBA;
 
   m_context->src_frame->data[0] = const_cast<u8*>(frame.data);
@@ -317,19 +368,68 @@ void FrameDump::AddFrame(const FrameData& frame)
   if (m_context->sws)
   {
     sws_scale(m_context->sws, m_context->src_frame->data, m_context->src_frame->linesize, 0,
-              frame.height, m_context->scaled_frame->data, m_context->scaled_frame->linesize);
+              frame.height, scaled_frame->data, scaled_frame->linesize);
   }
 
   m_context->last_pts = pts;
-  m_context->scaled_frame->pts = pts;
+  scaled_frame->pts = pts;
 
-  if (const int error = avcodec_send_frame(m_context->codec, m_context->scaled_frame))
   {
-    ERROR_LOG_FMT(FRAMEDUMP, "Error while encoding video: {}", error);
-    return;
+    std::lock_guard lock(m_context->encode_mutex);
+    m_context->encode_queue.push_back(scaled_frame);
+    m_encode_queue_depth.store(static_cast<int>(m_context->encode_queue.size()),
+                               std::memory_order_relaxed);
   }
+  m_context->encode_queue_changed.notify_all();
+}
 
-  ProcessPackets();
+void FrameDump::EncodeThreadFunc()
+{
+  Common::SetCurrentThreadName("FrameDumpEncoding");
+
+  while (true)
+  {
+    AVFrame* frame;
+    {
+      std::unique_lock lock(m_context->encode_mutex);
+      m_context->encode_queue_changed.wait(lock, [this] {
+        return !m_context->encode_queue.empty() || m_context->stop_encoding;
+      });
+
+      // Frames still queued when stopping are encoded first.
+      if (m_context->encode_queue.empty())
+        break;
+
+      frame = m_context->encode_queue.front();
+    }
+
+    if (const int error = avcodec_send_frame(m_context->codec, frame))
+      ERROR_LOG_FMT(FRAMEDUMP, "Error while encoding video: {}", error);
+    else
+      ProcessPackets();
+
+    {
+      std::lock_guard lock(m_context->encode_mutex);
+      m_context->encode_queue.pop_front();
+      m_context->free_frames.push_back(frame);
+      m_encode_queue_depth.store(static_cast<int>(m_context->encode_queue.size()),
+                                 std::memory_order_relaxed);
+    }
+    m_context->encode_queue_changed.notify_all();
+  }
+}
+
+void FrameDump::StopEncodeThread()
+{
+  if (!m_context->encode_thread.joinable())
+    return;
+
+  {
+    std::lock_guard lock(m_context->encode_mutex);
+    m_context->stop_encoding = true;
+  }
+  m_context->encode_queue_changed.notify_all();
+  m_context->encode_thread.join();
 }
 
 void FrameDump::ProcessPackets()
@@ -369,6 +469,8 @@ void FrameDump::Stop()
   if (!IsStarted())
     return;
 
+  StopEncodeThread();
+
   // Signal end of stream to encoder.
   if (const int flush_error = avcodec_send_frame(m_context->codec, nullptr))
     WARN_LOG_FMT(FRAMEDUMP, "Error sending flush packet: {}", flush_error);
@@ -388,8 +490,11 @@ bool FrameDump::IsStarted() const
 
 void FrameDump::CloseVideoFile()
 {
+  StopEncodeThread();
+
   av_frame_free(&m_context->src_frame);
-  av_frame_free(&m_context->scaled_frame);
+  for (AVFrame*& scaled_frame : m_context->scaled_frames)
+    av_frame_free(&scaled_frame);
 
   avcodec_free_context(&m_context->codec);
 
@@ -402,6 +507,7 @@ void FrameDump::CloseVideoFile()
     sws_freeContext(m_context->sws);
 
   m_context.reset();
+  m_encode_queue_depth.store(0, std::memory_order_relaxed);
 }
 
 void FrameDump::DoState(PointerWrap& p)
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <ctime>
 #include <memory>
 
@@ -27,6 +28,8 @@ public:
     u32 savestate_index = 0;
     int refresh_rate_num = 0;
     int refresh_rate_den = 0;
+    // Host time spent since the previous frame was finished.
+    u64 render_time_us = 0;
   };
 
   struct FrameData
@@ -39,11 +42,15 @@ public:
   };
 
   bool Start(int w, int h, u64 start_ticks);
+  // Converts the frame to the pixel format of the encoder, and queues it for encoding on the
+  // encoder thread. The frame's data is not accessed after this returns.
   void AddFrame(const FrameData&);
   void Stop();
   void DoState(PointerWrap&);
   bool IsStarted() const;
   FrameState FetchState(u64 ticks, int frame_number) const;
+  // Number of converted frames waiting for the encoder.
+  int GetEncodeQueueDepth() const { return m_encode_queue_depth.load(std::memory_order_relaxed); }
 
 private:
   bool IsFirstFrameInCurrentFile() const;
@@ -52,6 +59,8 @@ private:
   void CloseVideoFile();
   void CheckForConfigChange(const FrameData&);
   void ProcessPackets();
+  void EncodeThreadFunc();
+  void StopEncodeThread();
 
 #if defined(HAVE_FFMPEG)
   std::unique_ptr<FrameDumpContext> m_context;
@@ -63,6 +72,8 @@ private:
   // Used for filename generation.
   std::time_t m_start_time = {};
   u32 m_file_index = 0;
+
+  std::atomic<int> m_encode_queue_depth{0};
 };
 
 #if !defined(HAVE_FFMPEG)
@@ -71,6 +82,9 @@ inline FrameDump::~FrameDump() = default;
 
 inline FrameDump::FrameState FrameDump::FetchState(u64 ticks, int frame_number) const
 {
-  return {};
+  FrameState state;
+  state.ticks = ticks;
+  state.frame_number = frame_number;
+  return state;
 }
 #endif
@@ -0,0 +1,214 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/GPUProfiler.h"
+
+#include <array>
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Core/ConfigManager.h"
+#include "VideoCommon/OnScreenDisplay.h"
+
+namespace GPUProfiler
+{
+namespace
+{
+// 24 bytes each, so a capture uses at most 96 MiB.
+constexpr size_t MAX_EVENTS = 4 * 1024 * 1024;
+constexpr size_t NUM_EVENTS = static_cast<size_t>(Event::NumEvents);
+
+constexpr std::array<const char*, NUM_EVENTS> EVENT_NAMES = {
+    "CP register load", "XF register load", "Indexed XF load", "BP register load",
+    "Display list",     "Draw",             "Other command",   "Flush",
+    "Texture lookup",   "Texture decode",   "Pipeline lookup",
+};
+
+constexpr std::array<const char*, NUM_EVENTS> EVENT_CATEGORIES = {
+    "command", "command", "command", "command", "command",  "command",
+    "command", "vertex",  "texture", "texture", "pipeline",
+};
+
+struct RecordedEvent
+{
+  u64 start;
+  u64 end;
+  Event event;
+};
+
+struct FrameTotals
+{
+  u64 end;
+  std::array<u64, NUM_EVENTS> times;
+};
+
+u64 s_capture_start;
+std::vector<RecordedEvent> s_events;
+std::vector<FrameTotals> s_frames;
+std::array<u64, NUM_EVENTS> s_frame_times;
+bool s_capture_full;
+}  // namespace
+
+bool g_capturing = false;
+
+u64 GetTimestamp()
+{
+  return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now().time_since_epoch())
+                              .count());
+}
+
+void AddEvent(Event event, u64 start)
+{
+  // The capture may have been stopped or restarted since the event started.
+  if (!g_capturing || start < s_capture_start)
+    return;
+
+  const u64 end = GetTimestamp();
+  s_frame_times[static_cast<size_t>(event)] += end - start;
+
+  if (s_events.size() == MAX_EVENTS)
+  {
+    s_capture_full = true;
+    return;
+  }
+
+  s_events.push_back({start, end, event});
+}
+
+static double ToMicroseconds(u64 time)
+{
+  return time / 1000.0;
+}
+
+static void StartCapture()
+{
+  s_events.clear();
+  s_events.reserve(MAX_EVENTS);
+  s_frames.clear();
+  s_frame_times = {};
+  s_capture_full = false;
+  s_capture_start = GetTimestamp();
+  g_capturing = true;
+}
+
+static bool WriteTrace(const std::string& path)
+{
+  File::IOFile file(path, "wb");
+  if (!file)
+    return false;
+
+  std::string buffer =
+      "{\"traceEvents\":[\n"
+      "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+      "\"args\":{\"name\":\"GPU thread\"}}";
+
+  const auto flush_if_needed = [&file, &buffer] {
+    if (buffer.size() < 1024 * 1024)
+      return true;
+    const bool success = file.WriteString(buffer);
+    buffer.clear();
+    return success;
+  };
+
+  bool success = true;
+  for (const RecordedEvent& event : s_events)
+  {
+    const size_t index = static_cast<size_t>(event.event);
+    buffer += fmt::format(",\n{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"ts\":{:.3f},"
+                          "\"dur\":{:.3f},\"pid\":1,\"tid\":1}}",
+                          EVENT_NAMES[index], EVENT_CATEGORIES[index],
+                          ToMicroseconds(event.start - s_capture_start),
+                          ToMicroseconds(event.end - event.start));
+    success &= flush_if_needed();
+  }
+
+  for (const FrameTotals& frame : s_frames)
+  {
+    buffer += fmt::format(",\n{{\"name\":\"Time per frame (us)\",\"ph\":\"C\",\"ts\":{:.3f},"
+                          "\"pid\":1,\"args\":{{",
+                          ToMicroseconds(frame.end - s_capture_start));
+    for (size_t i = 0; i < NUM_EVENTS; ++i)
+    {
+      buffer += fmt::format("{}\"{}\":{:.3f}", i == 0 ? "" : ",", EVENT_NAMES[i],
+                            ToMicroseconds(frame.times[i]));
+    }
+    buffer += "}}";
+    success &= flush_if_needed();
+  }
+
+  buffer += "\n],\"displayTimeUnit\":\"ns\"}\n";
+  success &= file.WriteString(buffer);
+  return file.Close() && success;
+}
+
+static void StopCapture()
+{
+  g_capturing = false;
+
+  const std::time_t time = std::time(nullptr);
+  const std::string path =
+      fmt::format("{}GPUProfile" DIR_SEP "{}_{:%Y-%m-%d_%H-%M-%S}.json",
+                  File::GetUserPath(D_DUMP_IDX), SConfig::GetInstance().GetGameID(),
+                  *std::localtime(&time));
+  File::CreateFullPath(path);
+
+  if (WriteTrace(path))
+  {
+    OSD::AddMessage(fmt::format("GPU thread profile saved to {}", path));
+  }
+  else
+  {
+    ERROR_LOG_FMT(VIDEO, "Failed to write the GPU thread profile to {}", path);
+    OSD::AddMessage("Failed to save the GPU thread profile", OSD::Duration::NORMAL,
+                    OSD::Color::RED);
+  }
+
+  s_events.clear();
+  s_events.shrink_to_fit();
+  s_frames.clear();
+  s_frames.shrink_to_fit();
+}
+
+void OnFrameEnd(bool enabled)
+{
+  if (g_capturing)
+  {
+    s_frames.push_back({GetTimestamp(), s_frame_times});
+    s_frame_times = {};
+
+    if (!enabled || s_capture_full)
+    {
+      if (s_capture_full)
+        WARN_LOG_FMT(VIDEO, "The GPU thread profile is full, stopping the capture");
+      StopCapture();
+    }
+  }
+  else if (enabled && !s_capture_full)
+  {
+    StartCapture();
+  }
+
+  // A full capture is only restarted once profiling has been disabled and enabled again.
+  if (!enabled)
+    s_capture_full = false;
+}
+
+void Shutdown()
+{
+  if (g_capturing)
+    StopCapture();
+  s_capture_full = false;
+}
+}  // namespace GPUProfiler
@@ -0,0 +1,104 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+// Records where the GPU thread spends its time, to find out why a game is GPU thread bound without
+// attaching an external profiler.
+//
+// While Config::GFX_PROFILE_GPU_THREAD is enabled, the time taken by FIFO commands, by
+// VertexManagerBase::Flush, and by texture and pipeline lookups is recorded. Once the option is
+// disabled again, or the capture is full, it is written to User/Dump/GPUProfile/ as a JSON trace,
+// which chrome://tracing and Perfetto can open. Consecutive FIFO commands of the same kind are
+// recorded as one event. The total time spent on each kind of event in a frame is added to the
+// trace as counters; these times include the time of the events nested within.
+//
+// Only the GPU thread is profiled. While no capture is running, each instrumented scope costs one
+// branch.
+namespace GPUProfiler
+{
+enum class Event : u8
+{
+  // Kinds of FIFO commands
+  CPRegisterLoad,
+  XFRegisterLoad,
+  IndexedXFLoad,
+  BPRegisterLoad,
+  DisplayList,
+  Draw,
+  OtherCommand,
+
+  Flush,
+  TextureLookup,
+  TextureDecode,
+  PipelineLookup,
+
+  NumEvents
+};
+
+extern bool g_capturing;
+
+u64 GetTimestamp();
+void AddEvent(Event event, u64 start);
+
+// Called at the end of each frame. Starts or stops a capture if enabled has changed.
+void OnFrameEnd(bool enabled);
+// Writes the capture which is running, if any.
+void Shutdown();
+
+class ScopedEvent
+{
+public:
+  explicit ScopedEvent(Event event) : m_event(event), m_start(g_capturing ? GetTimestamp() : 0) {}
+  ~ScopedEvent()
+  {
+    if (m_start != 0)
+      AddEvent(m_event, m_start);
+  }
+
+  ScopedEvent(const ScopedEvent&) = delete;
+  ScopedEvent& operator=(const ScopedEvent&) = delete;
+
+private:
+  Event m_event;
+  u64 m_start;
+};
+
+// Records consecutive FIFO commands of the same kind as one event.
+class CommandTimer
+{
+public:
+  CommandTimer() = default;
+  ~CommandTimer() { End(); }
+
+  CommandTimer(const CommandTimer&) = delete;
+  CommandTimer& operator=(const CommandTimer&) = delete;
+
+  // Only call this while g_capturing is set.
+  void Begin(Event event)
+  {
+    if (event == m_event)
+      return;
+
+    End();
+    m_event = event;
+    m_start = GetTimestamp();
+  }
+
+  void End()
+  {
+    if (m_event == Event::NumEvents)
+      return;
+
+    AddEvent(m_event, m_start);
+    m_event = Event::NumEvents;
+  }
+
+private:
+  Event m_event = Event::NumEvents;
+  u64 m_start = 0;
+};
+}  // namespace GPUProfiler
@@ -5,15 +5,18 @@
 #include "VideoCommon/HiresTextures.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <limits>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <string_view>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
-#include <xxhash.h>
 
 #include <fmt/format.h>
 
@@ -22,6 +25,7 @@
 #include "Common/FileSearch.h"
 #include "Common/FileUtil.h"
 #include "Common/Flag.h"
+#include "Common/Hash.h"
 #include "Common/Image.h"
 #include "Common/Logging/Log.h"
 #include "Common/MemoryUtil.h"
@@ -31,6 +35,7 @@
 #include "Common/Timer.h"
 #include "Core/Config/GraphicsSettings.h"
 #include "Core/ConfigManager.h"
+#include "VideoCommon/CustomTexturePack.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/VideoConfig.h"
 
@@ -38,17 +43,62 @@ struct DiskTexture
 {
   std::string path;
   bool has_arbitrary_mipmaps;
+  // Set for textures stored in a pack, in which case path is the path of the pack.
+  std::shared_ptr<const CustomTexturePack> pack;
+  size_t pack_index = 0;
+};
+
+struct CachedTexture
+{
+  std::shared_ptr<HiresTexture> texture;
+  std::list<std::string>::iterator lru_position;
+};
+
+struct LoadRequest
+{
+  std::string base_filename;
+  u32 width;
+  u32 height;
 };
 
 constexpr std::string_view s_format_prefix{"tex1_"};
 
 static std::unordered_map<std::string, DiskTexture> s_textureMap;
-static std::unordered_map<std::string, std::shared_ptr<HiresTexture>> s_textureCache;
+static std::unordered_map<std::string, CachedTexture> s_textureCache;
+// Names of the cached textures, most recently used first.
+static std::list<std::string> s_textureCacheLRU;
+static size_t s_textureCacheSize = 0;
+static size_t s_textureCacheMaxSize = std::numeric_limits<size_t>::max();
 static std::mutex s_textureCacheMutex;
 static Common::Flag s_textureCacheAbortLoading;
 
 static std::thread s_prefetcher;
 
+// Asynchronous loading. Everything here is guarded by s_textureCacheMutex.
+static std::vector<std::thread> s_loaders;
+static std::condition_variable s_loadQueueCondition;
+// Handled last in, first out, as the textures requested most recently are the ones on screen.
+static std::vector<LoadRequest> s_loadQueue;
+// Textures which are queued or being loaded.
+static std::unordered_set<std::string> s_pendingLoads;
+static std::unordered_set<std::string> s_failedLoads;
+static bool s_loadersExit = false;
+
+// Keep 2GB memory for system stability if system RAM is 4GB+ - use half of memory in other cases
+static size_t GetMaxTextureMemory()
+{
+  const size_t sys_mem = Common::MemPhysical();
+  const size_t recommended_min_mem = 2 * size_t(1024 * 1024 * 1024);
+  return (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
+}
+
+static void ClearTextureCache()
+{
+  s_textureCache.clear();
+  s_textureCacheLRU.clear();
+  s_textureCacheSize = 0;
+}
+
 void HiresTexture::Init()
 {
   // Note: Update is not called here so that we handle dynamic textures on startup more gracefully
@@ -61,9 +111,10 @@ void HiresTexture::Shutdown()
     s_textureCacheAbortLoading.Set();
     s_prefetcher.join();
   }
+  StopLoaderThreads();
 
   s_textureMap.clear();
-  s_textureCache.clear();
+  ClearTextureCache();
 }
 
 void HiresTexture::Update()
@@ -73,6 +124,7 @@ void HiresTexture::Update()
     s_textureCacheAbortLoading.Set();
     s_prefetcher.join();
   }
+  StopLoaderThreads();
 
   if (!g_ActiveConfig.bHiresTextures)
   {
@@ -82,9 +134,14 @@ void HiresTexture::Update()
 
   if (!g_ActiveConfig.bCacheHiresTextures)
   {
-    s_textureCache.clear();
+    ClearTextureCache();
   }
 
+  // Prefetching keeps every texture, up to the limit it checks itself. Otherwise only the most
+  // recently used textures are kept in memory.
+  s_textureCacheMaxSize = g_ActiveConfig.bCacheHiresTextures ? std::numeric_limits<size_t>::max() :
+                                                               GetMaxTextureMemory() / 4;
+
   const std::string& game_id = SConfig::GetInstance().GetGameID();
   const std::set<std::string> texture_directories =
       GetTextureDirectoriesWithGameId(File::GetUserPath(D_HIRESTEXTURES_IDX), game_id);
@@ -99,15 +156,9 @@ void HiresTexture::Update()
     for (auto& path : texture_paths)
     {
       std::string filename;
-      SplitPath(path, nullptr, &filename, nullptr);
-
-      if (filename.substr(0, s_format_prefix.length()) == s_format_prefix)
+      bool has_arbitrary_mipmaps;
+      if (GetNameFromPath(path, &filename, &has_arbitrary_mipmaps))
       {
-        const size_t arb_index = filename.rfind("_arb");
-        const bool has_arbitrary_mipmaps = arb_index != std::string::npos;
-        if (has_arbitrary_mipmaps)
-          filename.erase(arb_index, 4);
-
         const auto [it, inserted] =
             s_textureMap.try_emplace(filename, DiskTexture{path, has_arbitrary_mipmaps});
         if (!inserted)
@@ -117,6 +168,25 @@ void HiresTexture::Update()
       }
     }
 
+    // Loose files take precedence over packs, so single textures of a pack can be replaced
+    // without rebuilding it.
+    for (const std::string& pack_path :
+         Common::DoFileSearch({texture_directory}, {".texpack"}, /*recursive*/ true))
+    {
+      const std::shared_ptr<const CustomTexturePack> pack = CustomTexturePack::Open(pack_path);
+      if (!pack)
+      {
+        ERROR_LOG_FMT(VIDEO, "Failed to open custom texture pack {}", pack_path);
+        continue;
+      }
+
+      for (size_t i = 0; i < pack->GetTextureCount(); i++)
+      {
+        s_textureMap.try_emplace(std::string(pack->GetTextureName(i)),
+                                 DiskTexture{pack_path, pack->HasArbitraryMipmaps(i), pack, i});
+      }
+    }
+
     if (failed_insert)
     {
       ERROR_LOG_FMT(VIDEO, "One or more textures at path '{}' were already inserted",
@@ -132,6 +202,8 @@ void HiresTexture::Update()
     {
       if (s_textureMap.find(iter->first) == s_textureMap.end())
       {
+        s_textureCacheSize -= iter->second.texture->GetMemorySize();
+        s_textureCacheLRU.erase(iter->second.lru_position);
         iter = s_textureCache.erase(iter);
       }
       else
@@ -147,8 +219,84 @@ void HiresTexture::Update()
 
 void HiresTexture::Clear()
 {
+  StopLoaderThreads();
+
   s_textureMap.clear();
-  s_textureCache.clear();
+  ClearTextureCache();
+}
+
+void HiresTexture::InsertIntoCache(const std::string& base_filename,
+                                   std::shared_ptr<HiresTexture> texture)
+{
+  if (s_textureCache.find(base_filename) != s_textureCache.end())
+    return;
+
+  s_textureCacheLRU.push_front(base_filename);
+  s_textureCacheSize += texture->GetMemorySize();
+  s_textureCache.emplace(base_filename,
+                         CachedTexture{std::move(texture), s_textureCacheLRU.begin()});
+
+  // Never evict the texture which was just inserted, even if it alone exceeds the limit.
+  while (s_textureCacheSize > s_textureCacheMaxSize && s_textureCacheLRU.size() > 1)
+  {
+    const auto iter = s_textureCache.find(s_textureCacheLRU.back());
+    s_textureCacheSize -= iter->second.texture->GetMemorySize();
+    s_textureCache.erase(iter);
+    s_textureCacheLRU.pop_back();
+  }
+}
+
+void HiresTexture::StartLoaderThreads()
+{
+  const u32 num_threads = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+  for (u32 i = 0; i < num_threads; i++)
+    s_loaders.emplace_back(LoaderThread);
+}
+
+void HiresTexture::StopLoaderThreads()
+{
+  {
+    std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+    s_loadersExit = true;
+    s_loadQueue.clear();
+  }
+  s_loadQueueCondition.notify_all();
+
+  for (std::thread& loader : s_loaders)
+    loader.join();
+  s_loaders.clear();
+
+  std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+  s_loadersExit = false;
+  s_pendingLoads.clear();
+  s_failedLoads.clear();
+}
+
+void HiresTexture::LoaderThread()
+{
+  Common::SetCurrentThreadName("Custom texture loader");
+
+  std::unique_lock<std::mutex> lk(s_textureCacheMutex);
+  while (true)
+  {
+    s_loadQueueCondition.wait(lk, [] { return s_loadersExit || !s_loadQueue.empty(); });
+    if (s_loadersExit)
+      return;
+
+    const LoadRequest request = std::move(s_loadQueue.back());
+    s_loadQueue.pop_back();
+
+    lk.unlock();
+    std::shared_ptr<HiresTexture> texture =
+        Load(request.base_filename, request.width, request.height);
+    lk.lock();
+
+    if (texture)
+      InsertIntoCache(request.base_filename, std::move(texture));
+    else
+      s_failedLoads.insert(request.base_filename);
+    s_pendingLoads.erase(request.base_filename);
+  }
 }
 
 void HiresTexture::Prefetch()
@@ -156,11 +304,7 @@ void HiresTexture::Prefetch()
   Common::SetCurrentThreadName("Prefetcher");
 
   size_t size_sum = 0;
-  const size_t sys_mem = Common::MemPhysical();
-  const size_t recommended_min_mem = 2 * size_t(1024 * 1024 * 1024);
-  // keep 2GB memory for system stability if system RAM is 4GB+ - use half of memory in other cases
-  const size_t max_mem =
-      (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
+  const size_t max_mem = GetMaxTextureMemory();
 
   const u32 start_time = Common::Timer::GetTimeMs();
   for (const auto& entry : s_textureMap)
@@ -181,15 +325,12 @@ void HiresTexture::Prefetch()
         lk.lock();
         if (texture)
         {
-          std::shared_ptr<HiresTexture> ptr(std::move(texture));
-          iter = s_textureCache.insert(iter, std::make_pair(base_filename, ptr));
+          InsertIntoCache(base_filename, std::move(texture));
+          iter = s_textureCache.find(base_filename);
         }
       }
       if (iter != s_textureCache.end())
-      {
-        for (const Level& l : iter->second->m_levels)
-          size_sum += l.data.size();
-      }
+        size_sum += iter->second.texture->GetMemorySize();
     }
 
     if (s_textureCacheAbortLoading.IsSet())
@@ -267,8 +408,10 @@ std::string HiresTexture::GenBaseName(const u8* texture, size_t texture_size, co
     tlut += 2 * min;
   }
 
-  const u64 tex_hash = XXH64(texture, texture_size, 0);
-  const u64 tlut_hash = tlut_size ? XXH64(tlut, tlut_size, 0) : 0;
+  // These names are what texture packs are keyed on, so they must not follow the texture cache's
+  // choice of hash function.
+  const u64 tex_hash = Common::GetStableHash64(texture, texture_size);
+  const u64 tlut_hash = tlut_size ? Common::GetStableHash64(tlut, tlut_size) : 0;
 
   const std::string base_name = fmt::format("{}{}x{}{}_{:016x}", s_format_prefix, width, height,
                                             has_mipmaps ? "_m" : "", tex_hash);
@@ -291,6 +434,34 @@ std::string HiresTexture::GenBaseName(const u8* texture, size_t texture_size, co
   return "";
 }
 
+bool HiresTexture::GetNameFromPath(const std::string& path, std::string* name,
+                                   bool* has_arbitrary_mipmaps)
+{
+  std::string filename;
+  SplitPath(path, nullptr, &filename, nullptr);
+
+  if (filename.substr(0, s_format_prefix.length()) != s_format_prefix)
+    return false;
+
+  const size_t arb_index = filename.rfind("_arb");
+  *has_arbitrary_mipmaps = arb_index != std::string::npos;
+  if (*has_arbitrary_mipmaps)
+    filename.erase(arb_index, 4);
+
+  *name = std::move(filename);
+  return true;
+}
+
+u32 HiresTexture::GetMipLevelFromName(const std::string& name)
+{
+  const size_t mip_index = name.rfind("_mip");
+  u32 mip_level;
+  if (mip_index == std::string::npos || !TryParse(name.substr(mip_index + 4), &mip_level))
+    return 0;
+
+  return mip_level;
+}
+
 u32 HiresTexture::CalculateMipCount(u32 width, u32 height)
 {
   u32 mip_width = width;
@@ -309,7 +480,7 @@ u32 HiresTexture::CalculateMipCount(u32 width, u32 height)
 std::shared_ptr<HiresTexture> HiresTexture::Search(const u8* texture, size_t texture_size,
                                                    const u8* tlut, size_t tlut_size, u32 width,
                                                    u32 height, TextureFormat format,
-                                                   bool has_mipmaps)
+                                                   bool has_mipmaps, std::string* pending_name)
 {
   std::string base_filename =
       GenBaseName(texture, texture_size, tlut, tlut_size, width, height, format, has_mipmaps);
@@ -319,19 +490,46 @@ std::shared_ptr<HiresTexture> HiresTexture::Search(const u8* texture, size_t tex
   auto iter = s_textureCache.find(base_filename);
   if (iter != s_textureCache.end())
   {
-    return iter->second;
+    s_textureCacheLRU.splice(s_textureCacheLRU.begin(), s_textureCacheLRU,
+                             iter->second.lru_position);
+    return iter->second.texture;
   }
 
-  std::shared_ptr<HiresTexture> ptr(Load(base_filename, width, height));
+  if (s_textureMap.find(base_filename) == s_textureMap.end())
+    return nullptr;
 
-  if (ptr && g_ActiveConfig.bCacheHiresTextures)
+  if (g_ActiveConfig.bHiresTexturesAsync)
   {
-    s_textureCache[base_filename] = ptr;
+    if (s_failedLoads.find(base_filename) != s_failedLoads.end())
+      return nullptr;
+
+    if (s_pendingLoads.insert(base_filename).second)
+    {
+      if (s_loaders.empty())
+        StartLoaderThreads();
+
+      s_loadQueue.push_back({base_filename, width, height});
+      s_loadQueueCondition.notify_one();
+    }
+
+    if (pending_name)
+      *pending_name = std::move(base_filename);
+    return nullptr;
   }
 
+  std::shared_ptr<HiresTexture> ptr(Load(base_filename, width, height));
+  if (ptr)
+    InsertIntoCache(base_filename, ptr);
+
   return ptr;
 }
 
+bool HiresTexture::IsLoadFinished(const std::string& base_filename)
+{
+  std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+  return s_pendingLoads.find(base_filename) == s_pendingLoads.end();
+}
+
 std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filename, u32 width,
                                                  u32 height)
 {
@@ -340,16 +538,14 @@ std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filenam
   if (filename_iter == s_textureMap.end())
     return nullptr;
 
-  // Try to load level 0 (and any mipmaps) from a DDS file.
-  // If this fails, it's fine, we'll just load level0 again using SOIL.
   // Can't use make_unique due to private constructor.
   std::unique_ptr<HiresTexture> ret = std::unique_ptr<HiresTexture>(new HiresTexture());
   const DiskTexture& first_mip_file = filename_iter->second;
   ret->m_has_arbitrary_mipmaps = first_mip_file.has_arbitrary_mipmaps;
-  LoadDDSTexture(ret.get(), first_mip_file.path);
 
-  // Load remaining mip levels, or from the start if it's not a DDS texture.
-  for (u32 mip_level = static_cast<u32>(ret->m_levels.size());; mip_level++)
+  // Load level 0, along with any mipmaps stored in the same DDS file or pack entry, then continue
+  // with the first level that is still missing.
+  for (u32 mip_level = 0;; mip_level = static_cast<u32>(ret->m_levels.size()))
   {
     std::string filename = base_filename;
     if (mip_level != 0)
@@ -359,24 +555,14 @@ std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filenam
     if (filename_iter == s_textureMap.end())
       break;
 
-    // Try loading DDS textures first, that way we maintain compression of DXT formats.
-    // TODO: Reduce the number of open() calls here. We could use one fd.
-    Level level;
-    if (!LoadDDSTexture(level, filename_iter->second.path, mip_level))
+    const DiskTexture& file = filename_iter->second;
+    const bool loaded = file.pack ? file.pack->LoadLevels(file.pack_index, &ret->m_levels) :
+                                    LoadFile(file.path, mip_level, &ret->m_levels);
+    if (!loaded)
     {
-      File::IOFile file;
-      file.Open(filename_iter->second.path, "rb");
-      std::vector<u8> buffer(file.GetSize());
-      file.ReadBytes(buffer.data(), file.GetSize());
-
-      if (!LoadTexture(level, buffer))
-      {
-        ERROR_LOG_FMT(VIDEO, "Custom texture {} failed to load", filename);
-        break;
-      }
+      ERROR_LOG_FMT(VIDEO, "Custom texture {} failed to load", filename);
+      break;
     }
-
-    ret->m_levels.push_back(std::move(level));
   }
 
   // If we failed to load any mip levels, we can't use this texture at all.
@@ -446,6 +632,37 @@ std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filenam
   return ret;
 }
 
+bool HiresTexture::LoadFile(const std::string& path, u32 mip_level, std::vector<Level>* levels)
+{
+  // Try loading DDS textures first, that way we maintain compression of DXT formats.
+  if (mip_level == 0)
+  {
+    if (LoadDDSTexture(levels, path))
+      return true;
+  }
+  else
+  {
+    Level level;
+    if (LoadDDSTexture(level, path, mip_level))
+    {
+      levels->push_back(std::move(level));
+      return true;
+    }
+  }
+
+  File::IOFile file;
+  file.Open(path, "rb");
+  std::vector<u8> buffer(file.GetSize());
+  file.ReadBytes(buffer.data(), file.GetSize());
+
+  Level level;
+  if (!LoadTexture(level, buffer))
+    return false;
+
+  levels->push_back(std::move(level));
+  return true;
+}
+
 bool HiresTexture::LoadTexture(Level& level, const std::vector<u8>& buffer)
 {
   if (!Common::LoadPNG(buffer, &level.data, &level.width, &level.height))
@@ -510,6 +727,14 @@ HiresTexture::~HiresTexture()
 {
 }
 
+size_t HiresTexture::GetMemorySize() const
+{
+  size_t size = 0;
+  for (const Level& level : m_levels)
+    size += level.data.size();
+  return size;
+}
+
 AbstractTextureFormat HiresTexture::GetFormat() const
 {
   return m_levels.at(0).format;
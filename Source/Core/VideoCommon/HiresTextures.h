@@ -25,9 +25,14 @@ public:
   static void Clear();
   static void Shutdown();
 
+  // With asynchronous loading enabled, a texture which is not loaded yet is queued for loading
+  // and nullptr is returned. Its name is then written to pending_name, and the caller can poll
+  // IsLoadFinished() to find out when searching again will return the loaded texture.
   static std::shared_ptr<HiresTexture> Search(const u8* texture, size_t texture_size,
                                               const u8* tlut, size_t tlut_size, u32 width,
-                                              u32 height, TextureFormat format, bool has_mipmaps);
+                                              u32 height, TextureFormat format, bool has_mipmaps,
+                                              std::string* pending_name = nullptr);
+  static bool IsLoadFinished(const std::string& base_filename);
 
   static std::string GenBaseName(const u8* texture, size_t texture_size, const u8* tlut,
                                  size_t tlut_size, u32 width, u32 height, TextureFormat format,
@@ -35,6 +40,13 @@ public:
 
   static u32 CalculateMipCount(u32 width, u32 height);
 
+  // Returns false if the file at path is not a custom texture. Otherwise, name is set to the name
+  // the texture is looked up by.
+  static bool GetNameFromPath(const std::string& path, std::string* name,
+                              bool* has_arbitrary_mipmaps);
+  // Returns the mipmap level of a texture name ending in "_mip<level>", or 0.
+  static u32 GetMipLevelFromName(const std::string& name);
+
   ~HiresTexture();
 
   AbstractTextureFormat GetFormat() const;
@@ -50,13 +62,24 @@ public:
   };
   std::vector<Level> m_levels;
 
+  // Appends the given level of a PNG or DDS file. For level 0 of a DDS file, this includes the
+  // mipmaps stored in the file.
+  static bool LoadFile(const std::string& path, u32 mip_level, std::vector<Level>* levels);
+
 private:
   static std::unique_ptr<HiresTexture> Load(const std::string& base_filename, u32 width,
                                             u32 height);
-  static bool LoadDDSTexture(HiresTexture* tex, const std::string& filename);
+  static bool LoadDDSTexture(std::vector<Level>* levels, const std::string& filename);
   static bool LoadDDSTexture(Level& level, const std::string& filename, u32 mip_level);
   static bool LoadTexture(Level& level, const std::vector<u8>& buffer);
   static void Prefetch();
+  static void LoaderThread();
+  static void StartLoaderThreads();
+  static void StopLoaderThreads();
+  static void InsertIntoCache(const std::string& base_filename,
+                              std::shared_ptr<HiresTexture> texture);
+
+  size_t GetMemorySize() const;
 
   HiresTexture() {}
   bool m_has_arbitrary_mipmaps;
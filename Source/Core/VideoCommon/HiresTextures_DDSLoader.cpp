@@ -435,7 +435,7 @@ bool ReadMipLevel(HiresTexture::Level* level, File::IOFile& file, const std::str
 
 }  // namespace
 
-bool HiresTexture::LoadDDSTexture(HiresTexture* tex, const std::string& filename)
+bool HiresTexture::LoadDDSTexture(std::vector<Level>* levels, const std::string& filename)
 {
   File::IOFile file;
   file.Open(filename, "rb");
@@ -455,7 +455,7 @@ bool HiresTexture::LoadDDSTexture(HiresTexture* tex, const std::string& filename
     return false;
   }
 
-  tex->m_levels.push_back(std::move(first_level));
+  levels->push_back(std::move(first_level));
 
   // Read in any remaining mip levels in the file.
   // If the .dds file does not contain a full mip chain, we'll fall back to the old path.
@@ -476,7 +476,7 @@ bool HiresTexture::LoadDDSTexture(HiresTexture* tex, const std::string& filename
                       mip_size))
       break;
 
-    tex->m_levels.push_back(std::move(level));
+    levels->push_back(std::move(level));
   }
 
   return true;
@@ -13,6 +13,12 @@
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/VideoConfig.h"
 
+#if defined(_M_X86_64)
+#include <emmintrin.h>
+#elif defined(_M_ARM_64)
+#include <arm_neon.h>
+#endif
+
 namespace
 {
 constexpr u16 s_primitive_restart = UINT16_MAX;
@@ -81,11 +87,10 @@ u16* AddStrip(u16* index_ptr, u32 num_verts, u32 index)
  * so we use 6 indices for 3 triangles
  */
 
+// Adds the triangles of a fan, starting with the one which ends with vertex i.
 template <bool pr>
-u16* AddFan(u16* index_ptr, u32 num_verts, u32 index)
+u16* AddFanTriangles(u16* index_ptr, u32 num_verts, u32 index, u32 i)
 {
-  u32 i = 2;
-
   if constexpr (pr)
   {
     for (; i + 3 <= num_verts; i += 3)
@@ -115,6 +120,12 @@ u16* AddFan(u16* index_ptr, u32 num_verts, u32 index)
   return index_ptr;
 }
 
+template <bool pr>
+u16* AddFan(u16* index_ptr, u32 num_verts, u32 index)
+{
+  return AddFanTriangles<pr>(index_ptr, num_verts, index, 2);
+}
+
 /*
  * QUAD simulator
  *
@@ -199,11 +210,275 @@ u16* AddPoints(u16* index_ptr, u32 num_verts, u32 index)
   }
   return index_ptr;
 }
+
+#if defined(_M_X86_64) || defined(_M_ARM_64)
+#define VECTORIZED_INDEX_GENERATORS
+
+/*
+ * Vectorized generators
+ *
+ * The indices of most primitives repeat in blocks, where each block uses the same pattern of
+ * vertices, offset by the number of vertices in the block before it. The blocks are written
+ * 8 indices at a time, and the primitives which do not fill a whole block are left to the
+ * scalar generators.
+ */
+
+// Lanes which are not an offset from the first vertex of the block.
+constexpr s8 RESTART = -1;  // A primitive restart index
+constexpr s8 CENTER = -2;   // The first vertex of a fan, which every block uses
+
+template <size_t N>
+struct BlockPattern
+{
+  static_assert(N % 8 == 0, "Blocks must consist of whole vectors");
+
+  constexpr BlockPattern(u32 vertices, const std::array<s8, N>& lanes) : num_vertices(vertices)
+  {
+    for (size_t i = 0; i < N; ++i)
+    {
+      offsets[i] = lanes[i] >= 0 ? lanes[i] : 0;
+      step_mask[i] = lanes[i] != CENTER && lanes[i] != RESTART ? 0xFFFF : 0;
+      restart_mask[i] = lanes[i] == RESTART ? 0xFFFF : 0;
+    }
+  }
+
+  // Vertices used by each block, which is how far the stepping lanes advance per block.
+  u32 num_vertices;
+  std::array<u16, N> offsets{};
+  std::array<u16, N> step_mask{};
+  std::array<u16, N> restart_mask{};
+};
+
+template <size_t N>
+u16* WriteBlocks(u16* index_ptr, u32 num_blocks, u32 index, const BlockPattern<N>& pattern)
+{
+  constexpr size_t num_vectors = N / 8;
+  if (num_blocks == 0)
+    return index_ptr;
+
+  // 16-bit arithmetic truncates the indices the same way as storing them in the scalar
+  // generators does.
+#if defined(_M_X86_64)
+  const __m128i base_index = _mm_set1_epi16(static_cast<s16>(index));
+  const __m128i step = _mm_set1_epi16(static_cast<s16>(pattern.num_vertices));
+  __m128i base[num_vectors], step_mask[num_vectors], restart_mask[num_vectors];
+  for (size_t i = 0; i < num_vectors; ++i)
+  {
+    const auto load = [i](const std::array<u16, N>& lanes) {
+      return _mm_loadu_si128(reinterpret_cast<const __m128i*>(&lanes[i * 8]));
+    };
+    base[i] = _mm_add_epi16(load(pattern.offsets), base_index);
+    step_mask[i] = load(pattern.step_mask);
+    restart_mask[i] = load(pattern.restart_mask);
+  }
+
+  __m128i current_step = _mm_setzero_si128();
+  for (u32 block = 0; block < num_blocks; ++block)
+  {
+    for (size_t i = 0; i < num_vectors; ++i)
+    {
+      const __m128i indices = _mm_add_epi16(base[i], _mm_and_si128(current_step, step_mask[i]));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(index_ptr),
+                       _mm_or_si128(indices, restart_mask[i]));
+      index_ptr += 8;
+    }
+    current_step = _mm_add_epi16(current_step, step);
+  }
+#elif defined(_M_ARM_64)
+  const uint16x8_t base_index = vdupq_n_u16(static_cast<u16>(index));
+  const uint16x8_t step = vdupq_n_u16(static_cast<u16>(pattern.num_vertices));
+  uint16x8_t base[num_vectors], step_mask[num_vectors], restart_mask[num_vectors];
+  for (size_t i = 0; i < num_vectors; ++i)
+  {
+    base[i] = vaddq_u16(vld1q_u16(&pattern.offsets[i * 8]), base_index);
+    step_mask[i] = vld1q_u16(&pattern.step_mask[i * 8]);
+    restart_mask[i] = vld1q_u16(&pattern.restart_mask[i * 8]);
+  }
+
+  uint16x8_t current_step = vdupq_n_u16(0);
+  for (u32 block = 0; block < num_blocks; ++block)
+  {
+    for (size_t i = 0; i < num_vectors; ++i)
+    {
+      const uint16x8_t indices = vaddq_u16(base[i], vandq_u16(current_step, step_mask[i]));
+      vst1q_u16(index_ptr, vorrq_u16(indices, restart_mask[i]));
+      index_ptr += 8;
+    }
+    current_step = vaddq_u16(current_step, step);
+  }
+#endif
+
+  return index_ptr;
+}
+
+constexpr BlockPattern<8> s_sequence_pattern(8, {0, 1, 2, 3, 4, 5, 6, 7});
+
+template <bool pr>
+u16* AddListVectorized(u16* index_ptr, u32 num_verts, u32 index)
+{
+  u32 done;
+  if constexpr (pr)
+  {
+    static constexpr BlockPattern<24> pattern(18, {0,  1,  2,  RESTART, 3,  4,  5,  RESTART,
+                                                   6,  7,  8,  RESTART, 9,  10, 11, RESTART,
+                                                   12, 13, 14, RESTART, 15, 16, 17, RESTART});
+    index_ptr = WriteBlocks(index_ptr, num_verts / 18, index, pattern);
+    done = num_verts / 18 * 18;
+  }
+  else
+  {
+    // The indices are sequential, but the scalar generator has to continue at a triangle.
+    index_ptr = WriteBlocks(index_ptr, num_verts / 24 * 3, index, s_sequence_pattern);
+    done = num_verts / 24 * 24;
+  }
+  return AddList<pr>(index_ptr, num_verts - done, index + done);
+}
+
+template <bool pr>
+u16* AddStripVectorized(u16* index_ptr, u32 num_verts, u32 index)
+{
+  if constexpr (pr)
+  {
+    const u32 done = num_verts / 8 * 8;
+    index_ptr = WriteBlocks(index_ptr, num_verts / 8, index, s_sequence_pattern);
+    index_ptr = AddPoints(index_ptr, num_verts - done, index + done);
+    *index_ptr++ = s_primitive_restart;
+    return index_ptr;
+  }
+  else
+  {
+    // 8 triangles. Blocks have an even number of triangles so that the winding order of the
+    // remaining ones does not change.
+    static constexpr BlockPattern<24> pattern(8, {0, 1, 2, 1, 3, 2, 2, 3, 4, 3, 5, 4,
+                                                  4, 5, 6, 5, 7, 6, 6, 7, 8, 7, 9, 8});
+    const u32 num_blocks = num_verts >= 2 ? (num_verts - 2) / 8 : 0;
+    const u32 done = num_blocks * 8;
+    index_ptr = WriteBlocks(index_ptr, num_blocks, index, pattern);
+    return AddStrip<pr>(index_ptr, num_verts - done, index + done);
+  }
+}
+
+template <bool pr>
+u16* AddFanVectorized(u16* index_ptr, u32 num_verts, u32 index)
+{
+  u32 done;
+  if constexpr (pr)
+  {
+    // 4 groups of 3 triangles, written as strips.
+    static constexpr BlockPattern<24> pattern(
+        12, {1, 2,  CENTER, 3,  4,  RESTART, 4,  5,  CENTER, 6,  7,  RESTART,
+             7, 8,  CENTER, 9,  10, RESTART, 10, 11, CENTER, 12, 13, RESTART});
+    const u32 num_blocks = num_verts >= 2 ? (num_verts - 2) / 12 : 0;
+    index_ptr = WriteBlocks(index_ptr, num_blocks, index, pattern);
+    done = num_blocks * 12;
+  }
+  else
+  {
+    // 8 triangles
+    static constexpr BlockPattern<24> pattern(
+        8, {CENTER, 1, 2, CENTER, 2, 3, CENTER, 3, 4, CENTER, 4, 5,
+            CENTER, 5, 6, CENTER, 6, 7, CENTER, 7, 8, CENTER, 8, 9});
+    const u32 num_blocks = num_verts >= 2 ? (num_verts - 2) / 8 : 0;
+    index_ptr = WriteBlocks(index_ptr, num_blocks, index, pattern);
+    done = num_blocks * 8;
+  }
+  return AddFanTriangles<pr>(index_ptr, num_verts, index, 2 + done);
+}
+
+template <bool pr>
+u16* AddQuadsVectorized(u16* index_ptr, u32 num_verts, u32 index)
+{
+  u32 done;
+  if constexpr (pr)
+  {
+    // 8 quads, written as strips.
+    static constexpr BlockPattern<40> pattern(
+        32, {1,  2,  0,  3,  RESTART, 5,  6,  4,  7,  RESTART,  //
+             9,  10, 8,  11, RESTART, 13, 14, 12, 15, RESTART,  //
+             17, 18, 16, 19, RESTART, 21, 22, 20, 23, RESTART,  //
+             25, 26, 24, 27, RESTART, 29, 30, 28, 31, RESTART});
+    index_ptr = WriteBlocks(index_ptr, num_verts / 32, index, pattern);
+    done = num_verts / 32 * 32;
+  }
+  else
+  {
+    // 4 quads
+    static constexpr BlockPattern<24> pattern(16, {0, 1,  2,  0, 2,  3,  4,  5,  6,  4,  6,  7,
+                                                   8, 9,  10, 8, 10, 11, 12, 13, 14, 12, 14, 15});
+    index_ptr = WriteBlocks(index_ptr, num_verts / 16, index, pattern);
+    done = num_verts / 16 * 16;
+  }
+  // The block size is a multiple of 4, so a triangle at the end is still drawn.
+  return AddQuads<pr>(index_ptr, num_verts - done, index + done);
+}
+
+template <bool pr>
+u16* AddQuadsVectorized_nonstandard(u16* index_ptr, u32 num_verts, u32 index)
+{
+  WARN_LOG_FMT(VIDEO, "Non-standard primitive drawing command GL_DRAW_QUADS_2");
+  return AddQuadsVectorized<pr>(index_ptr, num_verts, index);
+}
+
+u16* AddLineListVectorized(u16* index_ptr, u32 num_verts, u32 index)
+{
+  const u32 done = num_verts / 8 * 8;
+  index_ptr = WriteBlocks(index_ptr, num_verts / 8, index, s_sequence_pattern);
+  return AddLineList(index_ptr, num_verts - done, index + done);
+}
+
+u16* AddLineStripVectorized(u16* index_ptr, u32 num_verts, u32 index)
+{
+  // 4 lines
+  static constexpr BlockPattern<8> pattern(4, {0, 1, 1, 2, 2, 3, 3, 4});
+  const u32 num_blocks = num_verts >= 1 ? (num_verts - 1) / 4 : 0;
+  const u32 done = num_blocks * 4;
+  index_ptr = WriteBlocks(index_ptr, num_blocks, index, pattern);
+  return AddLineStrip(index_ptr, num_verts - done, index + done);
+}
+
+u16* AddPointsVectorized(u16* index_ptr, u32 num_verts, u32 index)
+{
+  const u32 done = num_verts / 8 * 8;
+  index_ptr = WriteBlocks(index_ptr, num_verts / 8, index, s_sequence_pattern);
+  return AddPoints(index_ptr, num_verts - done, index + done);
+}
+#endif
 }  // Anonymous namespace
 
 void IndexGenerator::Init()
 {
-  if (g_Config.backend_info.bSupportsPrimitiveRestart)
+  Init(g_Config.backend_info.bSupportsPrimitiveRestart, true);
+}
+
+void IndexGenerator::Init(bool primitive_restart, bool vectorized)
+{
+#ifdef VECTORIZED_INDEX_GENERATORS
+  if (vectorized)
+  {
+    if (primitive_restart)
+    {
+      m_primitive_table[OpcodeDecoder::GX_DRAW_QUADS] = AddQuadsVectorized<true>;
+      m_primitive_table[OpcodeDecoder::GX_DRAW_QUADS_2] = AddQuadsVectorized_nonstandard<true>;
+      m_primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLES] = AddListVectorized<true>;
+      m_primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP] = AddStripVectorized<true>;
+      m_primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_FAN] = AddFanVectorized<true>;
+    }
+    else
+    {
+      m_primitive_table[OpcodeDecoder::GX_DRAW_QUADS] = AddQuadsVectorized<false>;
+      m_primitive_table[OpcodeDecoder::GX_DRAW_QUADS_2] = AddQuadsVectorized_nonstandard<false>;
+      m_primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLES] = AddListVectorized<false>;
+      m_primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP] = AddStripVectorized<false>;
+      m_primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_FAN] = AddFanVectorized<false>;
+    }
+    m_primitive_table[OpcodeDecoder::GX_DRAW_LINES] = AddLineListVectorized;
+    m_primitive_table[OpcodeDecoder::GX_DRAW_LINE_STRIP] = AddLineStripVectorized;
+    m_primitive_table[OpcodeDecoder::GX_DRAW_POINTS] = AddPointsVectorized;
+    return;
+  }
+#endif
+
+  if (primitive_restart)
   {
     m_primitive_table[OpcodeDecoder::GX_DRAW_QUADS] = AddQuads<true>;
     m_primitive_table[OpcodeDecoder::GX_DRAW_QUADS_2] = AddQuads_nonstandard<true>;
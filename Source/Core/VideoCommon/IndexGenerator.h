@@ -14,6 +14,9 @@ class IndexGenerator
 {
 public:
   void Init();
+  // Vectorized generators are only used when vectorized is set and the CPU supports them. They
+  // produce the same indices as the scalar generators.
+  void Init(bool primitive_restart, bool vectorized);
   void Start(u16* index_ptr);
 
   void AddIndices(int primitive, u32 num_vertices);
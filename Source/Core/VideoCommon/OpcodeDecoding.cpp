@@ -23,7 +23,9 @@
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/DataReader.h"
+#include "VideoCommon/DisplayListCache.h"
 #include "VideoCommon/Fifo.h"
+#include "VideoCommon/GPUProfiler.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/XFMemory.h"
@@ -37,8 +39,9 @@ bool s_is_fifo_error_seen = false;
 u32 InterpretDisplayList(u32 address, u32 size)
 {
   u8* start_address;
+  const bool deterministic = Fifo::UseDeterministicGPUThread();
 
-  if (Fifo::UseDeterministicGPUThread())
+  if (deterministic)
     start_address = static_cast<u8*>(Fifo::PopFifoAuxBuffer(size));
   else
     start_address = Memory::GetPointer(address);
@@ -51,7 +54,11 @@ u32 InterpretDisplayList(u32 address, u32 size)
     // temporarily swap dl and non-dl (small "hack" for the stats)
     g_stats.SwapDL();
 
+    // The aux buffer is a copy of the list, which cannot be tracked for changes.
+    if (!deterministic)
+      DisplayListCache::BeginDisplayList(address, size, start_address);
     Run(DataReader(start_address, start_address + size), &cycles, true);
+    DisplayListCache::EndDisplayList();
     INCSTAT(g_stats.this_frame.num_dlists_called);
 
     // un-swap
@@ -76,6 +83,28 @@ void InterpretDisplayListPreprocess(u32 address, u32 size)
 
 bool g_record_fifo_data = false;
 
+static GPUProfiler::Event GetProfilerEvent(u8 cmd_byte)
+{
+  switch (cmd_byte)
+  {
+  case GX_LOAD_CP_REG:
+    return GPUProfiler::Event::CPRegisterLoad;
+  case GX_LOAD_XF_REG:
+    return GPUProfiler::Event::XFRegisterLoad;
+  case GX_LOAD_INDX_A:
+  case GX_LOAD_INDX_B:
+  case GX_LOAD_INDX_C:
+  case GX_LOAD_INDX_D:
+    return GPUProfiler::Event::IndexedXFLoad;
+  case GX_CMD_CALL_DL:
+    return GPUProfiler::Event::DisplayList;
+  case GX_LOAD_BP_REG:
+    return GPUProfiler::Event::BPRegisterLoad;
+  default:
+    return (cmd_byte & 0xC0) == 0x80 ? GPUProfiler::Event::Draw : GPUProfiler::Event::OtherCommand;
+  }
+}
+
 void Init()
 {
   s_is_fifo_error_seen = false;
@@ -86,6 +115,7 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list)
 {
   u32 total_cycles = 0;
   u8* opcode_start = nullptr;
+  GPUProfiler::CommandTimer command_timer;
 
   const auto finish_up = [cycles, &opcode_start, &total_cycles] {
     if (cycles != nullptr)
@@ -103,6 +133,12 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list)
       return finish_up();
 
     const u8 cmd_byte = src.Read<u8>();
+    if constexpr (!is_preprocess)
+    {
+      if (GPUProfiler::g_capturing)
+        command_timer.Begin(GetProfilerEvent(cmd_byte));
+    }
+
     switch (cmd_byte)
     {
     case GX_NOP:
@@ -65,6 +65,7 @@
 #include "VideoCommon/FramebufferManager.h"
 #include "VideoCommon/FramebufferShaderGen.h"
 #include "VideoCommon/FreeLookCamera.h"
+#include "VideoCommon/GPUProfiler.h"
 #include "VideoCommon/NetPlayChatUI.h"
 #include "VideoCommon/NetPlayGolfUI.h"
 #include "VideoCommon/OnScreenDisplay.h"
@@ -87,6 +88,12 @@
 
 std::unique_ptr<Renderer> g_renderer;
 
+static Renderer::FrameDumpCallback s_frame_dump_callback;
+
+// Number of frames which can wait for the frame dump thread before the GPU thread blocks. Each of
+// them holds on to a readback texture.
+constexpr size_t MAX_QUEUED_FRAME_DUMPS = 8;
+
 static float AspectToWidescreen(float aspect)
 {
   return aspect * ((16.0f / 9.0f) / (4.0f / 3.0f));
@@ -112,6 +119,7 @@ Renderer::Renderer(int backbuffer_width, int backbuffer_height, float backbuffer
 
   m_is_game_widescreen = SConfig::GetInstance().bWii && Config::Get(Config::SYSCONF_WIDESCREEN);
   g_freelook_camera.SetControlType(FreeLook::GetActiveConfig().camera_config.control_type);
+  m_last_frame_time_us = Common::Timer::GetTimeUs();
 }
 
 Renderer::~Renderer() = default;
@@ -136,6 +144,7 @@ void Renderer::Shutdown()
   // First stop any framedumping, which might need to dump the last xfb frame. This process
   // can require additional graphics sub-systems so it needs to be done first
   ShutdownFrameDumping();
+  GPUProfiler::Shutdown();
   ShutdownImGui();
   m_post_processor.reset();
 }
@@ -1300,7 +1309,9 @@ void Renderer::Swap(u32 xfb_addr, u32 fb_width, u32 fb_stride, u32 fb_height, u6
 
         // Begin new frame
         m_frame_count++;
+        m_last_frame_time_us = Common::Timer::GetTimeUs();
         g_stats.ResetFrame();
+        GPUProfiler::OnFrameEnd(g_ActiveConfig.bProfileGPUThread);
       }
 
       g_shader_cache->RetrieveAsyncShaders();
@@ -1374,11 +1385,19 @@ void Renderer::RenderXFBToScreen(const MathUtil::Rectangle<int>& target_rc,
   }
 }
 
+void Renderer::SetFrameDumpCallback(FrameDumpCallback callback)
+{
+  s_frame_dump_callback = std::move(callback);
+}
+
 bool Renderer::IsFrameDumping() const
 {
   if (m_screenshot_request.IsSet())
     return true;
 
+  if (s_frame_dump_callback)
+    return true;
+
   if (SConfig::GetInstance().m_DumpFrames)
     return true;
 
@@ -1422,6 +1441,7 @@ void Renderer::DumpCurrentFrame(const AbstractTexture* src_texture,
   m_frame_dump_readback_texture->CopyFromTexture(src_texture, copy_rect, 0, 0,
                                                  m_frame_dump_readback_texture->GetRect());
   m_last_frame_state = m_frame_dump.FetchState(ticks, frame_number);
+  m_last_frame_state.render_time_us = Common::Timer::GetTimeUs() - m_last_frame_time_us;
   m_frame_dump_needs_flush = true;
 }
 
@@ -1458,6 +1478,20 @@ bool Renderer::CheckFrameDumpReadbackTexture(u32 target_width, u32 target_height
     return true;
 
   rbtex.reset();
+
+  // Reuse a texture the dump thread is done with. Textures of a different size are not going to
+  // be needed again soon, so release them.
+  while (!m_frame_dump_free_textures.empty())
+  {
+    std::unique_ptr<AbstractStagingTexture> texture = std::move(m_frame_dump_free_textures.back());
+    m_frame_dump_free_textures.pop_back();
+    if (texture->GetWidth() == target_width && texture->GetHeight() == target_height)
+    {
+      rbtex = std::move(texture);
+      return true;
+    }
+  }
+
   rbtex = CreateStagingTexture(
       StagingTextureType::Readback,
       TextureConfig(target_width, target_height, 1, 1, 1, AbstractTextureFormat::RGBA8, 0));
@@ -1472,22 +1506,23 @@ void Renderer::FlushFrameDump()
   if (!m_frame_dump_needs_flush)
     return;
 
-  // Ensure dumping thread is done with output texture before swapping.
-  FinishFrameData();
-
-  std::swap(m_frame_dump_output_texture, m_frame_dump_readback_texture);
+  // Only block when the dump thread is too far behind.
+  WaitForFrameDumpQueue(MAX_QUEUED_FRAME_DUMPS - 1);
 
   // Queue encoding of the last frame dumped.
-  auto& output = m_frame_dump_output_texture;
+  std::unique_ptr<AbstractStagingTexture> output = std::move(m_frame_dump_readback_texture);
   output->Flush();
   if (output->Map())
   {
-    DumpFrameData(reinterpret_cast<u8*>(output->GetMappedPointer()), output->GetConfig().width,
-                  output->GetConfig().height, static_cast<int>(output->GetMappedStride()));
+    m_frame_dump_output_textures.push_back(std::move(output));
+    const auto& queued = m_frame_dump_output_textures.back();
+    DumpFrameData(reinterpret_cast<u8*>(queued->GetMappedPointer()), queued->GetConfig().width,
+                  queued->GetConfig().height, static_cast<int>(queued->GetMappedStride()));
   }
   else
   {
     ERROR_LOG_FMT(VIDEO, "Failed to map texture for dumping.");
+    m_frame_dump_free_textures.push_back(std::move(output));
   }
 
   m_frame_dump_needs_flush = false;
@@ -1509,20 +1544,25 @@ void Renderer::ShutdownFrameDumping()
   FinishFrameData();
 
   // Wake thread up, and wait for it to exit.
-  m_frame_dump_thread_running.Clear();
-  m_frame_dump_start.Set();
+  {
+    std::lock_guard<std::mutex> lk(m_frame_dump_queue_lock);
+    m_frame_dump_thread_running.Clear();
+  }
+  m_frame_dump_queue_changed.notify_all();
   if (m_frame_dump_thread.joinable())
     m_frame_dump_thread.join();
+  SETSTAT(g_stats.frame_dump_encode_queue_depth, 0);
   m_frame_dump_render_framebuffer.reset();
   m_frame_dump_render_texture.reset();
 
   m_frame_dump_readback_texture.reset();
-  m_frame_dump_output_texture.reset();
+  m_frame_dump_free_textures.clear();
 }
 
 void Renderer::DumpFrameData(const u8* data, int w, int h, int stride)
 {
-  m_frame_dump_data = FrameDump::FrameData{data, w, h, stride, m_last_frame_state};
+  // Screenshots are taken of the first frame queued after the request.
+  const bool screenshot = m_screenshot_request.TestAndClear();
 
   if (!m_frame_dump_thread_running.IsSet())
   {
@@ -1533,19 +1573,39 @@ void Renderer::DumpFrameData(const u8* data, int w, int h, int stride)
   }
 
   // Wake worker thread up.
-  m_frame_dump_start.Set();
-  m_frame_dump_frame_running = true;
+  {
+    std::lock_guard<std::mutex> lk(m_frame_dump_queue_lock);
+    m_frame_dump_queue.push_back(
+        {FrameDump::FrameData{data, w, h, stride, m_last_frame_state}, screenshot});
+  }
+  m_frame_dump_queue_changed.notify_all();
 }
 
-void Renderer::FinishFrameData()
+void Renderer::WaitForFrameDumpQueue(size_t max_queued_frames)
 {
-  if (!m_frame_dump_frame_running)
-    return;
+  size_t queued_frames;
+  {
+    std::unique_lock<std::mutex> lk(m_frame_dump_queue_lock);
+    m_frame_dump_queue_changed.wait(
+        lk, [&] { return m_frame_dump_queue.size() <= max_queued_frames; });
+    queued_frames = m_frame_dump_queue.size();
+  }
 
-  m_frame_dump_done.Wait();
-  m_frame_dump_frame_running = false;
+  // The dump thread processes frames in order, so the textures it is done with are the oldest.
+  while (m_frame_dump_output_textures.size() > queued_frames)
+  {
+    m_frame_dump_output_textures.front()->Unmap();
+    m_frame_dump_free_textures.push_back(std::move(m_frame_dump_output_textures.front()));
+    m_frame_dump_output_textures.pop_front();
+  }
+
+  SETSTAT(g_stats.frame_dump_queue_depth, queued_frames);
+  SETSTAT(g_stats.frame_dump_encode_queue_depth, m_frame_dump.GetEncodeQueueDepth());
+}
 
-  m_frame_dump_output_texture->Unmap();
+void Renderer::FinishFrameData()
+{
+  WaitForFrameDumpQueue(0);
 }
 
 void Renderer::FrameDumpThreadFunc()
@@ -1567,14 +1627,24 @@ void Renderer::FrameDumpThreadFunc()
 
   while (true)
   {
-    m_frame_dump_start.Wait();
-    if (!m_frame_dump_thread_running.IsSet())
-      break;
+    QueuedFrameDump queued;
+    {
+      std::unique_lock<std::mutex> lk(m_frame_dump_queue_lock);
+      m_frame_dump_queue_changed.wait(lk, [this] {
+        return !m_frame_dump_queue.empty() || !m_frame_dump_thread_running.IsSet();
+      });
 
-    auto frame = m_frame_dump_data;
+      // Frames still queued when stopping are dumped first.
+      if (m_frame_dump_queue.empty())
+        break;
+
+      queued = m_frame_dump_queue.front();
+    }
+
+    const FrameDump::FrameData& frame = queued.frame;
 
     // Save screenshot
-    if (m_screenshot_request.TestAndClear())
+    if (queued.screenshot)
     {
       std::lock_guard<std::mutex> lk(m_screenshot_lock);
 
@@ -1586,6 +1656,9 @@ void Renderer::FrameDumpThreadFunc()
       m_screenshot_completed.Set();
     }
 
+    if (s_frame_dump_callback)
+      s_frame_dump_callback(frame);
+
     if (SConfig::GetInstance().m_DumpFrames)
     {
       if (!frame_dump_started)
@@ -1610,7 +1683,11 @@ void Renderer::FrameDumpThreadFunc()
       }
     }
 
-    m_frame_dump_done.Set();
+    {
+      std::lock_guard<std::mutex> lk(m_frame_dump_queue_lock);
+      m_frame_dump_queue.pop_front();
+    }
+    m_frame_dump_queue_changed.notify_all();
   }
 
   if (frame_dump_started)
@@ -15,6 +15,9 @@
 #pragma once
 
 #include <array>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -218,6 +221,12 @@ public:
   virtual void Flush() {}
   virtual void WaitForGPUIdle() {}
 
+  // Called on the frame dump thread with every frame that is dumped while it is set. Setting it
+  // dumps every frame, even if frame dumping is disabled. Must not be changed while a renderer
+  // exists.
+  using FrameDumpCallback = std::function<void(const FrameDump::FrameData&)>;
+  static void SetFrameDumpCallback(FrameDumpCallback callback);
+
   // Finish up the current frame, print some stats
   void Swap(u32 xfb_addr, u32 fb_width, u32 fb_stride, u32 fb_height, u64 ticks);
 
@@ -355,29 +364,35 @@ private:
   std::thread m_frame_dump_thread;
   Common::Flag m_frame_dump_thread_running;
 
-  // Used to kick frame dump thread.
-  Common::Event m_frame_dump_start;
-
-  // Set by frame dump thread on frame completion.
-  Common::Event m_frame_dump_done;
-
   // Holds emulation state during the last swap when dumping.
   FrameDump::FrameState m_last_frame_state;
+  // Host time at which the previous frame was finished.
+  u64 m_last_frame_time_us = 0;
 
-  // Communication of frame between video and dump threads.
-  FrameDump::FrameData m_frame_dump_data;
+  struct QueuedFrameDump
+  {
+    FrameDump::FrameData frame;
+    bool screenshot;
+  };
+
+  // Frames waiting for the dump thread, oldest first. A frame is removed once the dump thread is
+  // done with it, so the front one may be in progress. Guarded by m_frame_dump_queue_lock.
+  std::deque<QueuedFrameDump> m_frame_dump_queue;
+  std::mutex m_frame_dump_queue_lock;
+  std::condition_variable m_frame_dump_queue_changed;
 
   // Texture used for screenshot/frame dumping
   std::unique_ptr<AbstractTexture> m_frame_dump_render_texture;
   std::unique_ptr<AbstractFramebuffer> m_frame_dump_render_framebuffer;
 
-  // Double buffer:
+  // The readback texture receives the current frame. Once it has been mapped and queued, it stays
+  // in the output textures (in the order of the queue) until the dump thread is done with it, and
+  // then goes back to the free textures for reuse.
   std::unique_ptr<AbstractStagingTexture> m_frame_dump_readback_texture;
-  std::unique_ptr<AbstractStagingTexture> m_frame_dump_output_texture;
+  std::deque<std::unique_ptr<AbstractStagingTexture>> m_frame_dump_output_textures;
+  std::vector<std::unique_ptr<AbstractStagingTexture>> m_frame_dump_free_textures;
   // Set when readback texture holds a frame that needs to be dumped.
   bool m_frame_dump_needs_flush = false;
-  // Set when thread is processing output texture.
-  bool m_frame_dump_frame_running = false;
 
   // Used to generate screenshot names.
   u32 m_frame_dump_image_counter = 0;
@@ -419,6 +434,10 @@ private:
   // Ensures all rendered frames are queued for encoding.
   void FlushFrameDump();
 
+  // Waits until at most max_queued_frames are waiting for the dump thread, and recycles the
+  // textures of the frames it is done with.
+  void WaitForFrameDumpQueue(size_t max_queued_frames);
+
   // Ensures all encoded frames have been written to the output file.
   void FinishFrameData();
 
@@ -8,13 +8,86 @@
 
 #include <imgui.h>
 
+#include "Common/CommonTypes.h"
+#include "Common/Metrics.h"
 #include "VideoCommon/VideoCommon.h"
 #include "VideoCommon/VideoConfig.h"
 
 Statistics g_stats;
 
+namespace
+{
+using Common::Metrics::Counter;
+using Common::Metrics::Gauge;
+using Common::Metrics::Thread;
+using ThisFrame = Statistics::ThisFrame;
+
+// The statistics of each frame are added to cumulative counters when it ends.
+struct FrameMetric
+{
+  int ThisFrame::*statistic;
+  Counter metric;
+};
+
+FrameMetric s_frame_metrics[] = {
+    {&ThisFrame::num_bp_loads, {Thread::GPU, "bp_loads"}},
+    {&ThisFrame::num_cp_loads, {Thread::GPU, "cp_loads"}},
+    {&ThisFrame::num_xf_loads, {Thread::GPU, "xf_loads"}},
+    {&ThisFrame::num_bp_loads_in_dl, {Thread::GPU, "bp_loads_in_dl"}},
+    {&ThisFrame::num_cp_loads_in_dl, {Thread::GPU, "cp_loads_in_dl"}},
+    {&ThisFrame::num_xf_loads_in_dl, {Thread::GPU, "xf_loads_in_dl"}},
+    {&ThisFrame::num_prims, {Thread::GPU, "prims"}},
+    {&ThisFrame::num_dl_prims, {Thread::GPU, "dl_prims"}},
+    {&ThisFrame::num_shader_changes, {Thread::GPU, "shader_changes"}},
+    {&ThisFrame::num_primitive_joins, {Thread::GPU, "primitive_joins"}},
+    {&ThisFrame::num_draw_calls, {Thread::GPU, "draw_calls"}},
+    {&ThisFrame::num_merged_xf_loads, {Thread::GPU, "merged_xf_loads"}},
+    {&ThisFrame::num_dlists_called, {Thread::GPU, "dlists_called"}},
+    {&ThisFrame::bytes_vertex_streamed, {Thread::GPU, "bytes_vertex_streamed"}},
+    {&ThisFrame::bytes_index_streamed, {Thread::GPU, "bytes_index_streamed"}},
+    {&ThisFrame::bytes_uniform_streamed, {Thread::GPU, "bytes_uniform_streamed"}},
+    {&ThisFrame::num_triangles_clipped, {Thread::GPU, "triangles_clipped"}},
+    {&ThisFrame::num_triangles_in, {Thread::GPU, "triangles_in"}},
+    {&ThisFrame::num_triangles_rejected, {Thread::GPU, "triangles_rejected"}},
+    {&ThisFrame::num_triangles_culled, {Thread::GPU, "triangles_culled"}},
+    {&ThisFrame::num_drawn_objects, {Thread::GPU, "drawn_objects"}},
+    {&ThisFrame::rasterized_pixels, {Thread::GPU, "rasterized_pixels"}},
+    {&ThisFrame::num_triangles_drawn, {Thread::GPU, "triangles_drawn"}},
+    {&ThisFrame::num_vertices_loaded, {Thread::GPU, "vertices_loaded"}},
+    {&ThisFrame::tev_pixels_in, {Thread::GPU, "tev_pixels_in"}},
+    {&ThisFrame::tev_pixels_out, {Thread::GPU, "tev_pixels_out"}},
+    {&ThisFrame::num_efb_peeks, {Thread::GPU, "efb_peeks"}},
+    {&ThisFrame::num_efb_pokes, {Thread::GPU, "efb_pokes"}},
+};
+
+// The other statistics are current values, which are copied to gauges when a frame ends.
+struct TotalMetric
+{
+  int Statistics::*statistic;
+  Gauge metric;
+};
+
+TotalMetric s_total_metrics[] = {
+    {&Statistics::num_pixel_shaders_created, {Thread::GPU, "pixel_shaders_created"}},
+    {&Statistics::num_pixel_shaders_alive, {Thread::GPU, "pixel_shaders_alive"}},
+    {&Statistics::num_vertex_shaders_created, {Thread::GPU, "vertex_shaders_created"}},
+    {&Statistics::num_vertex_shaders_alive, {Thread::GPU, "vertex_shaders_alive"}},
+    {&Statistics::num_textures_created, {Thread::GPU, "textures_created"}},
+    {&Statistics::num_textures_uploaded, {Thread::GPU, "textures_uploaded"}},
+    {&Statistics::num_textures_alive, {Thread::GPU, "textures_alive"}},
+    {&Statistics::num_vertex_loaders, {Thread::GPU, "vertex_loaders"}},
+    {&Statistics::frame_dump_queue_depth, {Thread::GPU, "frame_dump_queue_depth"}},
+    {&Statistics::frame_dump_encode_queue_depth, {Thread::GPU, "frame_dump_encode_queue_depth"}},
+};
+}  // namespace
+
 void Statistics::ResetFrame()
 {
+  for (FrameMetric& frame_metric : s_frame_metrics)
+    frame_metric.metric.Add(static_cast<u64>(this_frame.*frame_metric.statistic));
+  for (TotalMetric& total_metric : s_total_metrics)
+    total_metric.metric.Set(this->*total_metric.statistic);
+
   this_frame = {};
 }
 
@@ -72,6 +145,7 @@ void Statistics::Display() const
   draw_statistic("dlists called", "%d", this_frame.num_dlists_called);
   draw_statistic("Primitive joins", "%d", this_frame.num_primitive_joins);
   draw_statistic("Draw calls", "%d", this_frame.num_draw_calls);
+  draw_statistic("Draws merged over XF loads", "%d", this_frame.num_merged_xf_loads);
   draw_statistic("Primitives", "%d", this_frame.num_prims);
   draw_statistic("Primitives (DL)", "%d", this_frame.num_dl_prims);
   draw_statistic("XF loads", "%d", this_frame.num_xf_loads);
@@ -86,6 +160,8 @@ void Statistics::Display() const
   draw_statistic("Vertex Loaders", "%d", num_vertex_loaders);
   draw_statistic("EFB peeks:", "%d", this_frame.num_efb_peeks);
   draw_statistic("EFB pokes:", "%d", this_frame.num_efb_pokes);
+  draw_statistic("Frame dump queue", "%d", frame_dump_queue_depth);
+  draw_statistic("Frame encode queue", "%d", frame_dump_encode_queue_depth);
 
   ImGui::Columns(1);
 
@@ -19,6 +19,9 @@ struct Statistics
 
   int num_vertex_loaders;
 
+  int frame_dump_queue_depth;
+  int frame_dump_encode_queue_depth;
+
   std::array<float, 6> proj;
   std::array<float, 16> gproj;
   std::array<float, 16> g2proj;
@@ -39,6 +42,7 @@ struct Statistics
 
     int num_primitive_joins;
     int num_draw_calls;
+    int num_merged_xf_loads;
 
     int num_dlists_called;
 
@@ -61,6 +65,7 @@ struct Statistics
     int num_efb_pokes;
   };
   ThisFrame this_frame;
+  // Adds the statistics of the frame to the metrics in Common/Metrics.h, and clears them.
   void ResetFrame();
   void SwapDL();
   void Display() const;
@@ -32,11 +32,13 @@
 #include "Core/FifoPlayer/FifoPlayer.h"
 #include "Core/FifoPlayer/FifoRecorder.h"
 #include "Core/HW/Memmap.h"
+#include "Core/HW/WriteTracker.h"
 
 #include "VideoCommon/AbstractFramebuffer.h"
 #include "VideoCommon/AbstractStagingTexture.h"
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/FramebufferManager.h"
+#include "VideoCommon/GPUProfiler.h"
 #include "VideoCommon/HiresTextures.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/PixelShaderManager.h"
@@ -94,7 +96,9 @@ TextureCacheBase::TextureCacheBase()
 
   HiresTexture::Init();
 
-  Common::SetHash64Function();
+  Common::SetHash64Function(backup_config.xxh3_hash ? Common::Hash64Function::XXH3 :
+                                                      Common::Hash64Function::Legacy);
+  WriteTracker::SetEnabled(backup_config.write_tracking);
 
   InvalidateAllBindPoints();
 }
@@ -104,6 +108,7 @@ TextureCacheBase::~TextureCacheBase()
   // Clear pending EFB copies first, so we don't try to flush them.
   m_pending_efb_copies.clear();
 
+  WriteTracker::SetEnabled(false);
   HiresTexture::Shutdown();
   Invalidate();
   Common::FreeAlignedMemory(temp);
@@ -156,8 +161,18 @@ void TextureCacheBase::OnConfigChanged(const VideoConfig& config)
     HiresTexture::Update();
   }
 
+  if (config.bTextureCacheXXH3 != backup_config.xxh3_hash)
+  {
+    Common::SetHash64Function(config.bTextureCacheXXH3 ? Common::Hash64Function::XXH3 :
+                                                         Common::Hash64Function::Legacy);
+  }
+
+  if (config.bTextureCacheWriteTracking != backup_config.write_tracking)
+    WriteTracker::SetEnabled(config.bTextureCacheWriteTracking);
+
   // TODO: Invalidating texcache is really stupid in some of these cases
   if (config.iSafeTextureCache_ColorSamples != backup_config.color_samples ||
+      config.bTextureCacheXXH3 != backup_config.xxh3_hash ||
       config.bTexFmtOverlayEnable != backup_config.texfmt_overlay ||
       config.bTexFmtOverlayCenter != backup_config.texfmt_overlay_center ||
       config.bHiresTextures != backup_config.hires_textures ||
@@ -196,7 +211,7 @@ void TextureCacheBase::Cleanup(int _frameCount)
         // host GPU are unrecoverable. Perform this check only every TEXTURE_KILL_THRESHOLD for
         // performance reasons
         if ((_frameCount - iter->second->frameCount) % TEXTURE_KILL_THRESHOLD == 1 &&
-            iter->second->hash != iter->second->CalculateHash())
+            !iter->second->MatchesMemory())
         {
           iter = InvalidateTexture(iter);
         }
@@ -249,6 +264,8 @@ bool TextureCacheBase::TCacheEntry::OverlapsMemoryRange(u32 range_address, u32 r
 void TextureCacheBase::SetBackupConfig(const VideoConfig& config)
 {
   backup_config.color_samples = config.iSafeTextureCache_ColorSamples;
+  backup_config.xxh3_hash = config.bTextureCacheXXH3;
+  backup_config.write_tracking = config.bTextureCacheWriteTracking;
   backup_config.texfmt_overlay = config.bTexFmtOverlayEnable;
   backup_config.texfmt_overlay_center = config.bTexFmtOverlayCenter;
   backup_config.hires_textures = config.bHiresTextures;
@@ -772,7 +789,7 @@ TextureCacheBase::DoPartialTextureUpdates(TCacheEntry* entry_to_update, u8* pale
         entry->OverlapsMemoryRange(entry_to_update->addr, entry_to_update->size_in_bytes) &&
         entry->memory_stride == numBlocksX * block_size)
     {
-      if (entry->hash == entry->CalculateHash())
+      if (entry->MatchesMemory())
       {
         // If the texture formats are not compatible or convertible, skip it.
         if (!IsCompatibleTextureFormat(entry_to_update->format.texfmt, entry->format.texfmt))
@@ -1182,6 +1199,7 @@ TextureCacheBase::TCacheEntry* TextureCacheBase::Load(const u32 stage)
     return bound_textures[stage];
   }
 
+  GPUProfiler::ScopedEvent profiler_event(GPUProfiler::Event::TextureLookup);
   const FourTexUnits& tex = bpmem.tex[stage >> 2];
   const u32 id = stage & 3;
   const u32 address = (tex.texImage3[id].image_base /* & 0x1FFFFF*/) << 5;
@@ -1213,6 +1231,31 @@ TextureCacheBase::TCacheEntry* TextureCacheBase::Load(const u32 stage)
   return entry;
 }
 
+TextureCacheBase::TCacheEntry* TextureCacheBase::FindUnmodifiedEntry(u32 address, u32 size,
+                                                                     TextureFormat texformat,
+                                                                     u32 width, u32 height)
+{
+  if (!WriteTracker::IsEnabled())
+    return nullptr;
+
+  auto iter_range = textures_by_address.equal_range(address);
+  for (auto iter = iter_range.first; iter != iter_range.second; ++iter)
+  {
+    TCacheEntry* entry = iter->second;
+    if (entry->IsCopy() || entry->tmem_only || entry->format.texfmt != texformat ||
+        entry->size_in_bytes != size || entry->native_width != width ||
+        entry->native_height != height)
+    {
+      continue;
+    }
+
+    if (WriteTracker::IsUnmodified(address, size, entry->write_stamp))
+      return entry;
+  }
+
+  return nullptr;
+}
+
 TextureCacheBase::TCacheEntry*
 TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFormat texformat,
                              const int textureCacheSafetyColorSampleSize, u32 tlutaddr,
@@ -1285,9 +1328,25 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
                                           MemoryUpdate::TEXTURE_MAP);
   }
 
-  // TODO: This doesn't hash GB tiles for preloaded RGBA8 textures (instead, it's hashing more data
-  // from the low tmem bank than it should)
-  base_hash = Common::GetHash64(src_data, texture_size, textureCacheSafetyColorSampleSize);
+  // With write tracking, an entry whose memory has not been written since it was hashed still
+  // has the right hash, so there is no need to read the whole texture again.
+  u64 write_stamp = 0;
+  const TCacheEntry* unmodified_entry =
+      from_tmem ? nullptr : FindUnmodifiedEntry(address, texture_size, texformat, nativeW, nativeH);
+  if (unmodified_entry)
+  {
+    base_hash = unmodified_entry->base_hash;
+    write_stamp = unmodified_entry->write_stamp;
+  }
+  else
+  {
+    if (!from_tmem)
+      write_stamp = WriteTracker::Protect(address, texture_size);
+
+    // TODO: This doesn't hash GB tiles for preloaded RGBA8 textures (instead, it's hashing more
+    // data from the low tmem bank than it should)
+    base_hash = Common::GetHash64(src_data, texture_size, textureCacheSafetyColorSampleSize);
+  }
   u32 palette_size = 0;
   if (isPaletteTexture)
   {
@@ -1431,6 +1490,17 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
           entry->native_levels >= tex_levels && entry->native_width == nativeW &&
           entry->native_height == nativeH)
       {
+        // Recreate the texture once its custom texture has finished loading.
+        if (!entry->pending_custom_tex.empty() &&
+            HiresTexture::IsLoadFinished(entry->pending_custom_tex))
+        {
+          iter = InvalidateTexture(iter);
+          continue;
+        }
+
+        if (entry->base_hash == base_hash && !from_tmem)
+          entry->write_stamp = write_stamp;
+
         entry = DoPartialTextureUpdates(iter->second, &texMem[tlutaddr], tlutfmt);
         entry->texture->FinishedRendering();
         return entry;
@@ -1492,7 +1562,9 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
       TCacheEntry* entry = hash_iter->second;
       // All parameters, except the address, need to match here
       if (entry->format == full_format && entry->native_levels >= tex_levels &&
-          entry->native_width == nativeW && entry->native_height == nativeH)
+          entry->native_width == nativeW && entry->native_height == nativeH &&
+          (entry->pending_custom_tex.empty() ||
+           !HiresTexture::IsLoadFinished(entry->pending_custom_tex)))
       {
         entry = DoPartialTextureUpdates(hash_iter->second, &texMem[tlutaddr], tlutfmt);
         entry->texture->FinishedRendering();
@@ -1510,10 +1582,11 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   }
 
   std::shared_ptr<HiresTexture> hires_tex;
+  std::string pending_hires_tex;
   if (g_ActiveConfig.bHiresTextures)
   {
     hires_tex = HiresTexture::Search(src_data, texture_size, &texMem[tlutaddr], palette_size, width,
-                                     height, texformat, use_mipmaps);
+                                     height, texformat, use_mipmaps, &pending_hires_tex);
 
     if (hires_tex)
     {
@@ -1539,6 +1612,9 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   const bool decode_on_gpu = !hires_tex && g_ActiveConfig.UseGPUTextureDecoding() &&
                              !(from_tmem && texformat == TextureFormat::RGBA8);
 
+  // The rest of the function creates the texture and decodes the data into it.
+  GPUProfiler::ScopedEvent profiler_event(GPUProfiler::Event::TextureDecode);
+
   // create the entry/texture
   const TextureConfig config(width, height, texLevels, 1, 1,
                              hires_tex ? hires_tex->GetFormat() : AbstractTextureFormat::RGBA8, 0);
@@ -1615,7 +1691,9 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   entry->SetGeneralParameters(address, texture_size, full_format, false);
   entry->SetDimensions(nativeW, nativeH, tex_levels);
   entry->SetHashes(base_hash, full_hash);
+  entry->write_stamp = write_stamp;
   entry->is_custom_tex = hires_tex != nullptr;
+  entry->pending_custom_tex = std::move(pending_hires_tex);
   entry->memory_stride = entry->BytesPerRow();
   entry->SetNotCopy();
 
@@ -1850,7 +1928,7 @@ void TextureCacheBase::StitchXFBCopy(TCacheEntry* stitched_entry)
         entry->OverlapsMemoryRange(stitched_entry->addr, stitched_entry->size_in_bytes) &&
         entry->memory_stride == stitched_entry->memory_stride)
     {
-      if (entry->hash == entry->CalculateHash())
+      if (entry->MatchesMemory())
       {
         // Can't check the height here because of Y scaling.
         if (entry->native_width != entry->GetWidth())
@@ -2218,6 +2296,7 @@ void TextureCacheBase::CopyRenderTargetToTexture(
       if (!copy_to_vram || !g_ActiveConfig.bDeferEFBCopies)
       {
         // Immediately flush it.
+        WriteTracker::ScopedExternalWrite external_write(dstAddr, num_blocks_y * dstStride);
         WriteEFBCopyToRAM(dst, bytes_per_row / sizeof(u32), num_blocks_y, dstStride,
                           std::move(staging_texture));
       }
@@ -2359,8 +2438,11 @@ void TextureCacheBase::FlushEFBCopy(TCacheEntry* entry)
 {
   // Copy from texture -> guest memory.
   u8* const dst = Memory::GetPointer(entry->addr);
-  WriteEFBCopyToRAM(dst, entry->pending_efb_copy_width, entry->pending_efb_copy_height,
-                    entry->memory_stride, std::move(entry->pending_efb_copy));
+  {
+    WriteTracker::ScopedExternalWrite external_write(entry->addr, entry->size_in_bytes);
+    WriteEFBCopyToRAM(dst, entry->pending_efb_copy_width, entry->pending_efb_copy_height,
+                      entry->memory_stride, std::move(entry->pending_efb_copy));
+  }
 
   // If the EFB copy was invalidated (e.g. the bloom case mentioned in InvalidateTexture), now is
   // the time to clean up the TCacheEntry. In which case, we don't need to compute the new hash of
@@ -2914,6 +2996,20 @@ int TextureCacheBase::TCacheEntry::HashSampleSize() const
   return g_ActiveConfig.iSafeTextureCache_ColorSamples;
 }
 
+bool TextureCacheBase::TCacheEntry::MatchesMemory()
+{
+  if (WriteTracker::IsUnmodified(addr, size_in_bytes, write_stamp))
+    return true;
+
+  // Protect before hashing, so that a write racing with the hash is not missed.
+  const u64 stamp = WriteTracker::Protect(addr, size_in_bytes);
+  if (hash != CalculateHash())
+    return false;
+
+  write_stamp = stamp;
+  return true;
+}
+
 u64 TextureCacheBase::TCacheEntry::CalculateHash() const
 {
   u8* ptr = Memory::GetPointer(addr);
@@ -93,10 +93,13 @@ public:
     u32 size_in_bytes;
     u64 base_hash;
     u64 hash;  // for paletted textures, hash = base_hash ^ palette_hash
+    u64 write_stamp = 0;  // WriteTracker stamp taken when base_hash was last known to be valid
     TextureAndTLUTFormat format;
     u32 memory_stride;
     bool is_efb_copy;
     bool is_custom_tex;
+    // Name of the custom texture which is being loaded asynchronously to replace this one
+    std::string pending_custom_tex;
     bool may_have_overlapping_textures = true;
     bool tmem_only = false;           // indicates that this texture only exists in the tmem cache
     bool has_arbitrary_mips = false;  // indicates that the mips in this texture are arbitrary
@@ -157,6 +160,7 @@ public:
     {
       base_hash = _base_hash;
       hash = _hash;
+      write_stamp = 0;
     }
 
     // This texture entry is used by the other entry as a sub-texture
@@ -179,6 +183,9 @@ public:
     u32 BytesPerRow() const;
 
     u64 CalculateHash() const;
+    // Like comparing hash to CalculateHash(), but skips hashing if write tracking shows the memory
+    // has not been written.
+    bool MatchesMemory();
 
     int HashSampleSize() const;
     u32 GetWidth() const { return texture->GetConfig().width; }
@@ -290,6 +297,11 @@ private:
 
   TCacheEntry* ReinterpretEntry(const TCacheEntry* existing_entry, TextureFormat new_format);
 
+  // Returns an entry for the texture at address whose memory has not been written since its
+  // base_hash was computed, so that hashing can be skipped.
+  TCacheEntry* FindUnmodifiedEntry(u32 address, u32 size, TextureFormat texformat, u32 width,
+                                   u32 height);
+
   TCacheEntry* DoPartialTextureUpdates(TCacheEntry* entry_to_update, u8* palette,
                                        TLUTFormat tlutfmt);
   void StitchXFBCopy(TCacheEntry* entry_to_update);
@@ -343,6 +355,8 @@ private:
   struct BackupConfig
   {
     int color_samples;
+    bool xxh3_hash;
+    bool write_tracking;
     bool texfmt_overlay;
     bool texfmt_overlay_center;
     bool hires_textures;
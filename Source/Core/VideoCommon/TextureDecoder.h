@@ -161,6 +161,12 @@ void TexDecoder_DecodeXFB(u8* dst, const u8* src, u32 width, u32 height, u32 str
 
 void TexDecoder_SetTexFmtOverlayOptions(bool enable, bool center);
 
-/* Internal method, implemented by TextureDecoder_Generic and TextureDecoder_x64. */
+/* Internal method, implemented by TextureDecoder_Generic, TextureDecoder_x64 and
+ * TextureDecoder_ARM64. */
 void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, TextureFormat texformat,
                             const u8* tlut, TLUTFormat tlutfmt);
+
+/* Reference C implementation from TextureDecoder_Generic. Used as a fallback by the
+ * architecture-specific decoders, and to validate them. */
+void _TexDecoder_DecodeImplGeneric(u32* dst, const u8* src, int width, int height,
+                                   TextureFormat texformat, const u8* tlut, TLUTFormat tlutfmt);
@@ -0,0 +1,437 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <arm_neon.h>
+#include <array>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/Swap.h"
+
+#include "VideoCommon/LookUpTables.h"
+#include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/TextureDecoder_Util.h"
+
+// GameCube/Wii texture decoder, NEON version.
+//
+// Formats which are rarely used (C14X2, XFB) are forwarded to the generic decoder. The output of
+// every path here must be bit-identical to TextureDecoder_Generic, which is checked by
+// UnitTests/VideoCommon/TextureDecoderTest.
+
+// Replicates a 4-bit value into both nibbles of each byte (Convert4To8).
+static inline uint8x8_t Expand4To8(uint8x8_t v)
+{
+  return vorr_u8(vshl_n_u8(v, 4), v);
+}
+
+static inline uint16x8_t Expand3To8(uint16x8_t v)
+{
+  return vorrq_u16(vorrq_u16(vshlq_n_u16(v, 5), vshlq_n_u16(v, 2)), vshrq_n_u16(v, 1));
+}
+
+static inline uint16x8_t Expand4To8(uint16x8_t v)
+{
+  return vorrq_u16(vshlq_n_u16(v, 4), v);
+}
+
+static inline uint16x8_t Expand5To8(uint16x8_t v)
+{
+  return vorrq_u16(vshlq_n_u16(v, 3), vshrq_n_u16(v, 2));
+}
+
+static inline uint16x8_t Expand6To8(uint16x8_t v)
+{
+  return vorrq_u16(vshlq_n_u16(v, 2), vshrq_n_u16(v, 4));
+}
+
+// The helpers below decode eight 16-bit texels to RGBA8. The inputs hold the texels with their
+// channels in the low/high byte of each lane (i.e. already byteswapped where needed), and the
+// result holds texels 0-3 in val[0] and texels 4-7 in val[1].
+static inline uint16x8x2_t DecodeIA8(uint16x8_t val)
+{
+  const uint16x8_t i = vshrq_n_u16(val, 8);
+  const uint16x8_t rg = vorrq_u16(i, vshlq_n_u16(i, 8));
+  const uint16x8_t ba = vorrq_u16(i, vshlq_n_u16(val, 8));
+  return vzipq_u16(rg, ba);
+}
+
+static inline uint16x8x2_t DecodeRGB565(uint16x8_t val)
+{
+  const uint16x8_t r = Expand5To8(vshrq_n_u16(val, 11));
+  const uint16x8_t g = Expand6To8(vandq_u16(vshrq_n_u16(val, 5), vdupq_n_u16(0x3f)));
+  const uint16x8_t b = Expand5To8(vandq_u16(val, vdupq_n_u16(0x1f)));
+  const uint16x8_t rg = vorrq_u16(r, vshlq_n_u16(g, 8));
+  const uint16x8_t ba = vorrq_u16(b, vdupq_n_u16(0xFF00));
+  return vzipq_u16(rg, ba);
+}
+
+static inline uint16x8x2_t DecodeRGB5A3(uint16x8_t val)
+{
+  const uint16x8_t mask5 = vdupq_n_u16(0x1f);
+  const uint16x8_t mask4 = vdupq_n_u16(0xf);
+
+  // Top bit set: RGB555, opaque.
+  const uint16x8_t r5 = Expand5To8(vandq_u16(vshrq_n_u16(val, 10), mask5));
+  const uint16x8_t g5 = Expand5To8(vandq_u16(vshrq_n_u16(val, 5), mask5));
+  const uint16x8_t b5 = Expand5To8(vandq_u16(val, mask5));
+  const uint16x8_t rg5 = vorrq_u16(r5, vshlq_n_u16(g5, 8));
+  const uint16x8_t ba5 = vorrq_u16(b5, vdupq_n_u16(0xFF00));
+
+  // Top bit clear: RGB4A3.
+  const uint16x8_t a3 = Expand3To8(vandq_u16(vshrq_n_u16(val, 12), vdupq_n_u16(0x7)));
+  const uint16x8_t r4 = Expand4To8(vandq_u16(vshrq_n_u16(val, 8), mask4));
+  const uint16x8_t g4 = Expand4To8(vandq_u16(vshrq_n_u16(val, 4), mask4));
+  const uint16x8_t b4 = Expand4To8(vandq_u16(val, mask4));
+  const uint16x8_t rg4 = vorrq_u16(r4, vshlq_n_u16(g4, 8));
+  const uint16x8_t ba4 = vorrq_u16(b4, vshlq_n_u16(a3, 8));
+
+  const uint16x8_t opaque = vtstq_u16(val, vdupq_n_u16(0x8000));
+  return vzipq_u16(vbslq_u16(opaque, rg5, rg4), vbslq_u16(opaque, ba5, ba4));
+}
+
+// Loads eight big-endian texels and swaps them to host order.
+static inline uint16x8_t LoadBE16x8(const u8* src)
+{
+  return vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(src)));
+}
+
+static inline void StoreRows4x2(u32* row0, u32* row1, uint16x8x2_t texels)
+{
+  vst1q_u16(reinterpret_cast<u16*>(row0), texels.val[0]);
+  vst1q_u16(reinterpret_cast<u16*>(row1), texels.val[1]);
+}
+
+// Decodes a TLUT into RGBA8 so that paletted textures only need a lookup per texel.
+static void DecodeTLUT(u32* dst, const u8* tlut, int num_entries, TLUTFormat tlutfmt)
+{
+  for (int i = 0; i < num_entries; i += 8, tlut += 16, dst += 8)
+  {
+    uint16x8x2_t texels;
+    switch (tlutfmt)
+    {
+    case TLUTFormat::IA8:
+      texels = DecodeIA8(vld1q_u16(reinterpret_cast<const u16*>(tlut)));
+      break;
+    case TLUTFormat::RGB565:
+      texels = DecodeRGB565(LoadBE16x8(tlut));
+      break;
+    case TLUTFormat::RGB5A3:
+      texels = DecodeRGB5A3(LoadBE16x8(tlut));
+      break;
+    default:
+      texels.val[0] = texels.val[1] = vdupq_n_u16(0);
+      break;
+    }
+    StoreRows4x2(dst, dst + 4, texels);
+  }
+}
+
+static void TexDecoder_DecodeImpl_C4(u32* dst, const u8* src, int width, int height,
+                                     const u8* tlut, TLUTFormat tlutfmt)
+{
+  alignas(16) std::array<u32, 16> palette;
+  DecodeTLUT(palette.data(), tlut, 16, tlutfmt);
+
+  // The whole palette fits in four registers, so every texel becomes a table lookup. Each texel
+  // index is expanded to the four byte offsets of its palette entry.
+  const u8* palette_bytes = reinterpret_cast<const u8*>(palette.data());
+  const uint8x16x4_t table = {{vld1q_u8(palette_bytes), vld1q_u8(palette_bytes + 16),
+                               vld1q_u8(palette_bytes + 32), vld1q_u8(palette_bytes + 48)}};
+  static constexpr u8 spread_lo[16] = {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3};
+  static constexpr u8 spread_hi[16] = {4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7};
+  static constexpr u8 byte_offsets[16] = {0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3};
+  const uint8x16_t spread_lo_v = vld1q_u8(spread_lo);
+  const uint8x16_t spread_hi_v = vld1q_u8(spread_hi);
+  const uint8x16_t byte_offsets_v = vld1q_u8(byte_offsets);
+
+  for (int y = 0; y < height; y += 8)
+  {
+    for (int x = 0; x < width; x += 8)
+    {
+      // Two block rows of eight 4-bit indices per load.
+      for (int iy = 0; iy < 8; iy += 2, src += 8)
+      {
+        const uint8x8_t packed = vld1_u8(src);
+        const uint8x8x2_t indices = vzip_u8(vshr_n_u8(packed, 4), vand_u8(packed, vdup_n_u8(0xF)));
+        for (int row = 0; row < 2; row++)
+        {
+          const uint8x16_t idx = vshlq_n_u8(vcombine_u8(indices.val[row], indices.val[row]), 2);
+          const uint8x16_t lo = vaddq_u8(vqtbl1q_u8(idx, spread_lo_v), byte_offsets_v);
+          const uint8x16_t hi = vaddq_u8(vqtbl1q_u8(idx, spread_hi_v), byte_offsets_v);
+          u8* out = reinterpret_cast<u8*>(dst + (y + iy + row) * width + x);
+          vst1q_u8(out, vqtbl4q_u8(table, lo));
+          vst1q_u8(out + 16, vqtbl4q_u8(table, hi));
+        }
+      }
+    }
+  }
+}
+
+static void TexDecoder_DecodeImpl_C8(u32* dst, const u8* src, int width, int height,
+                                     const u8* tlut, TLUTFormat tlutfmt)
+{
+  // 256 entries do not fit in a table lookup, but decoding the TLUT once up front still saves
+  // the per-texel conversion.
+  alignas(16) std::array<u32, 256> palette;
+  DecodeTLUT(palette.data(), tlut, 256, tlutfmt);
+
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0; x < width; x += 8)
+    {
+      for (int iy = 0; iy < 4; iy++, src += 8)
+      {
+        u32* out = dst + (y + iy) * width + x;
+        for (int ix = 0; ix < 8; ix++)
+          out[ix] = palette[src[ix]];
+      }
+    }
+  }
+}
+
+static void TexDecoder_DecodeImpl_I4(u32* dst, const u8* src, int width, int height)
+{
+  for (int y = 0; y < height; y += 8)
+  {
+    for (int x = 0; x < width; x += 8)
+    {
+      // Two block rows of eight 4-bit texels per load.
+      for (int iy = 0; iy < 8; iy += 2, src += 8)
+      {
+        const uint8x8_t packed = vld1_u8(src);
+        const uint8x8x2_t i =
+            vzip_u8(Expand4To8(vshr_n_u8(packed, 4)), Expand4To8(vand_u8(packed, vdup_n_u8(0xF))));
+        u8* out = reinterpret_cast<u8*>(dst + (y + iy) * width + x);
+        vst4_u8(out, (uint8x8x4_t{{i.val[0], i.val[0], i.val[0], i.val[0]}}));
+        vst4_u8(out + width * 4, (uint8x8x4_t{{i.val[1], i.val[1], i.val[1], i.val[1]}}));
+      }
+    }
+  }
+}
+
+static void TexDecoder_DecodeImpl_I8(u32* dst, const u8* src, int width, int height)
+{
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0; x < width; x += 8)
+    {
+      for (int iy = 0; iy < 4; iy++, src += 8)
+      {
+        const uint8x8_t i = vld1_u8(src);
+        vst4_u8(reinterpret_cast<u8*>(dst + (y + iy) * width + x), (uint8x8x4_t{{i, i, i, i}}));
+      }
+    }
+  }
+}
+
+static void TexDecoder_DecodeImpl_IA4(u32* dst, const u8* src, int width, int height)
+{
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0; x < width; x += 8)
+    {
+      for (int iy = 0; iy < 4; iy++, src += 8)
+      {
+        const uint8x8_t packed = vld1_u8(src);
+        const uint8x8_t a = Expand4To8(vshr_n_u8(packed, 4));
+        const uint8x8_t l = Expand4To8(vand_u8(packed, vdup_n_u8(0xF)));
+        vst4_u8(reinterpret_cast<u8*>(dst + (y + iy) * width + x), (uint8x8x4_t{{l, l, l, a}}));
+      }
+    }
+  }
+}
+
+static void TexDecoder_DecodeImpl_IA8(u32* dst, const u8* src, int width, int height)
+{
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0; x < width; x += 4)
+    {
+      // Two block rows of four texels per load.
+      for (int iy = 0; iy < 4; iy += 2, src += 16)
+      {
+        u32* out = dst + (y + iy) * width + x;
+        StoreRows4x2(out, out + width, DecodeIA8(vld1q_u16(reinterpret_cast<const u16*>(src))));
+      }
+    }
+  }
+}
+
+static void TexDecoder_DecodeImpl_RGB565(u32* dst, const u8* src, int width, int height)
+{
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0; x < width; x += 4)
+    {
+      for (int iy = 0; iy < 4; iy += 2, src += 16)
+      {
+        u32* out = dst + (y + iy) * width + x;
+        StoreRows4x2(out, out + width, DecodeRGB565(LoadBE16x8(src)));
+      }
+    }
+  }
+}
+
+static void TexDecoder_DecodeImpl_RGB5A3(u32* dst, const u8* src, int width, int height)
+{
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0; x < width; x += 4)
+    {
+      for (int iy = 0; iy < 4; iy += 2, src += 16)
+      {
+        u32* out = dst + (y + iy) * width + x;
+        StoreRows4x2(out, out + width, DecodeRGB5A3(LoadBE16x8(src)));
+      }
+    }
+  }
+}
+
+static void TexDecoder_DecodeImpl_RGBA8(u32* dst, const u8* src, int width, int height)
+{
+  // A block is 32 bytes of AR pairs followed by 32 bytes of GB pairs. Gather R, G, B, A for each
+  // texel from the two halves with a single two-register table lookup per row.
+  static constexpr u8 shuffle_row0[16] = {1, 16, 17, 0, 3, 18, 19, 2,
+                                          5, 20, 21, 4, 7, 22, 23, 6};
+  static constexpr u8 shuffle_row1[16] = {9,  24, 25, 8,  11, 26, 27, 10,
+                                          13, 28, 29, 12, 15, 30, 31, 14};
+  const uint8x16_t shuffle_row0_v = vld1q_u8(shuffle_row0);
+  const uint8x16_t shuffle_row1_v = vld1q_u8(shuffle_row1);
+
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0; x < width; x += 4, src += 64)
+    {
+      for (int iy = 0; iy < 4; iy += 2)
+      {
+        const uint8x16x2_t ar_gb = {{vld1q_u8(src + 8 * iy), vld1q_u8(src + 32 + 8 * iy)}};
+        u8* out = reinterpret_cast<u8*>(dst + (y + iy) * width + x);
+        vst1q_u8(out, vqtbl2q_u8(ar_gb, shuffle_row0_v));
+        vst1q_u8(out + width * 4, vqtbl2q_u8(ar_gb, shuffle_row1_v));
+      }
+    }
+  }
+}
+
+static void DecodeDXTBlock(u32* dst, const DXTBlock* src, int pitch)
+{
+  // The palette is built exactly like the generic decoder does it. Expanding the 2-bit selectors
+  // into palette lookups is where the time goes, and that is done four texels at a time.
+  const u16 c1 = Common::swap16(src->color1);
+  const u16 c2 = Common::swap16(src->color2);
+  const int blue1 = Convert5To8(c1 & 0x1F);
+  const int blue2 = Convert5To8(c2 & 0x1F);
+  const int green1 = Convert6To8((c1 >> 5) & 0x3F);
+  const int green2 = Convert6To8((c2 >> 5) & 0x3F);
+  const int red1 = Convert5To8((c1 >> 11) & 0x1F);
+  const int red2 = Convert5To8((c2 >> 11) & 0x1F);
+
+  alignas(16) u32 colors[4];
+  colors[0] = MakeRGBA(red1, green1, blue1, 255);
+  colors[1] = MakeRGBA(red2, green2, blue2, 255);
+  if (c1 > c2)
+  {
+    colors[2] =
+        MakeRGBA(DXTBlend(red2, red1), DXTBlend(green2, green1), DXTBlend(blue2, blue1), 255);
+    colors[3] =
+        MakeRGBA(DXTBlend(red1, red2), DXTBlend(green1, green2), DXTBlend(blue1, blue2), 255);
+  }
+  else
+  {
+    // color[3] is the same as color[2] (average of both colors), but transparent.
+    // This differs from DXT1 where color[3] is transparent black.
+    colors[2] = MakeRGBA((red1 + red2) / 2, (green1 + green2) / 2, (blue1 + blue2) / 2, 255);
+    colors[3] = MakeRGBA((red1 + red2) / 2, (green1 + green2) / 2, (blue1 + blue2) / 2, 0);
+  }
+  const uint8x16_t palette = vld1q_u8(reinterpret_cast<const u8*>(colors));
+
+  // Texel x of a line uses bits (7 - 2x):(6 - 2x), so the first texel is in the top bits.
+  static constexpr s8 selector_shifts[16] = {-6, -6, -6, -6, -4, -4, -4, -4,
+                                             -2, -2, -2, -2, 0,  0,  0,  0};
+  static constexpr u8 byte_offsets[16] = {0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3};
+  const int8x16_t selector_shifts_v = vld1q_s8(selector_shifts);
+  const uint8x16_t byte_offsets_v = vld1q_u8(byte_offsets);
+
+  for (int y = 0; y < 4; y++, dst += pitch)
+  {
+    const uint8x16_t line = vdupq_n_u8(src->lines[y]);
+    const uint8x16_t selectors = vandq_u8(vshlq_u8(line, selector_shifts_v), vdupq_n_u8(3));
+    const uint8x16_t offsets = vaddq_u8(vshlq_n_u8(selectors, 2), byte_offsets_v);
+    vst1q_u8(reinterpret_cast<u8*>(dst), vqtbl1q_u8(palette, offsets));
+  }
+}
+
+static void TexDecoder_DecodeImpl_CMPR(u32* dst, const u8* src, int width, int height)
+{
+  for (int y = 0; y < height; y += 8)
+  {
+    for (int x = 0; x < width; x += 8)
+    {
+      const DXTBlock* block = reinterpret_cast<const DXTBlock*>(src);
+      DecodeDXTBlock(dst + y * width + x, block, width);
+      DecodeDXTBlock(dst + y * width + x + 4, block + 1, width);
+      DecodeDXTBlock(dst + (y + 4) * width + x, block + 2, width);
+      DecodeDXTBlock(dst + (y + 4) * width + x + 4, block + 3, width);
+      src += 4 * sizeof(DXTBlock);
+    }
+  }
+}
+
+void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, TextureFormat texformat,
+                            const u8* tlut, TLUTFormat tlutfmt)
+{
+  // ASIMD is mandatory on ARMv8-A, but respect the detected features in case it was masked off.
+  if (!cpu_info.bASIMD)
+  {
+    _TexDecoder_DecodeImplGeneric(dst, src, width, height, texformat, tlut, tlutfmt);
+    return;
+  }
+
+  switch (texformat)
+  {
+  case TextureFormat::C4:
+    TexDecoder_DecodeImpl_C4(dst, src, width, height, tlut, tlutfmt);
+    break;
+
+  case TextureFormat::I4:
+    TexDecoder_DecodeImpl_I4(dst, src, width, height);
+    break;
+
+  case TextureFormat::I8:
+    TexDecoder_DecodeImpl_I8(dst, src, width, height);
+    break;
+
+  case TextureFormat::C8:
+    TexDecoder_DecodeImpl_C8(dst, src, width, height, tlut, tlutfmt);
+    break;
+
+  case TextureFormat::IA4:
+    TexDecoder_DecodeImpl_IA4(dst, src, width, height);
+    break;
+
+  case TextureFormat::IA8:
+    TexDecoder_DecodeImpl_IA8(dst, src, width, height);
+    break;
+
+  case TextureFormat::RGB565:
+    TexDecoder_DecodeImpl_RGB565(dst, src, width, height);
+    break;
+
+  case TextureFormat::RGB5A3:
+    TexDecoder_DecodeImpl_RGB5A3(dst, src, width, height);
+    break;
+
+  case TextureFormat::RGBA8:
+    TexDecoder_DecodeImpl_RGBA8(dst, src, width, height);
+    break;
+
+  case TextureFormat::CMPR:
+    TexDecoder_DecodeImpl_CMPR(dst, src, width, height);
+    break;
+
+  default:
+    _TexDecoder_DecodeImplGeneric(dst, src, width, height, texformat, tlut, tlutfmt);
+    break;
+  }
+}
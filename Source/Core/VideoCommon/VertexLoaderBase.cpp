@@ -8,17 +8,22 @@
 #include <cinttypes>
 #include <cstring>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include <fmt/format.h>
 
+#include "Common/BitSet.h"
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/VertexLoader.h"
+#include "VideoCommon/VertexLoader_Normal.h"
+#include "VideoCommon/VertexLoader_Position.h"
+#include "VideoCommon/VertexLoader_TextCoord.h"
 
 #ifdef _M_X86_64
 #include "VideoCommon/VertexLoaderX64.h"
@@ -73,6 +78,65 @@ void VertexLoaderBase::SetVAT(const VAT& vat)
   m_VtxAttr.texCoord[7].Frac = vat.g2.Tex7Frac;
 };
 
+std::optional<std::vector<VertexLoaderBase::ArrayIndex>> VertexLoaderBase::GetArrayIndices() const
+{
+  static constexpr std::array<u32, 8> color_sizes{2, 3, 4, 2, 3, 4, 0, 0};
+
+  std::vector<ArrayIndex> indices;
+  // The matrix indices come first, and are always direct.
+  u32 offset = BitSet32(static_cast<u32>(m_VtxDesc.Hex & 0x1FF)).Count();
+
+  const auto add_attribute = [&](int array, u64 type, u32 direct_size, u32 size) {
+    if (type == NOT_PRESENT)
+      return;
+
+    if (type & MASK_INDEXED)
+    {
+      const u32 index_size = type == INDEX16 ? 2 : 1;
+      indices.push_back({array, offset, index_size, size / index_size, direct_size});
+    }
+    offset += size;
+  };
+
+  const u64 position = m_VtxDesc.Position;
+  add_attribute(
+      ARRAY_POSITION, position,
+      VertexLoader_Position::GetSize(DIRECT, m_VtxAttr.PosFormat, m_VtxAttr.PosElements),
+      VertexLoader_Position::GetSize(position, m_VtxAttr.PosFormat, m_VtxAttr.PosElements));
+
+  const u64 normal = m_VtxDesc.Normal;
+  add_attribute(ARRAY_NORMAL, normal,
+                VertexLoader_Normal::GetSize(DIRECT, m_VtxAttr.NormalFormat,
+                                             m_VtxAttr.NormalElements, false),
+                VertexLoader_Normal::GetSize(normal, m_VtxAttr.NormalFormat,
+                                             m_VtxAttr.NormalElements, m_VtxAttr.NormalIndex3));
+
+  const u64 colors[2] = {m_VtxDesc.Color0, m_VtxDesc.Color1};
+  for (int i = 0; i < 2; i++)
+  {
+    const u32 direct_size = color_sizes[m_VtxAttr.color[i].Comp];
+    const u32 size = colors[i] == DIRECT ? direct_size : colors[i] == INDEX16 ? 2 : 1;
+    add_attribute(ARRAY_COLOR + i, colors[i], direct_size, size);
+  }
+
+  const u64 tex_coords[8] = {m_VtxDesc.Tex0Coord, m_VtxDesc.Tex1Coord, m_VtxDesc.Tex2Coord,
+                             m_VtxDesc.Tex3Coord, m_VtxDesc.Tex4Coord, m_VtxDesc.Tex5Coord,
+                             m_VtxDesc.Tex6Coord, m_VtxDesc.Tex7Coord};
+  for (int i = 0; i < 8; i++)
+  {
+    const u32 format = m_VtxAttr.texCoord[i].Format;
+    const u32 elements = m_VtxAttr.texCoord[i].Elements;
+    add_attribute(ARRAY_TEXCOORD0 + i, tex_coords[i],
+                  VertexLoader_TextCoord::GetSize(DIRECT, format, elements),
+                  VertexLoader_TextCoord::GetSize(tex_coords[i], format, elements));
+  }
+
+  if (offset != static_cast<u32>(m_VertexSize))
+    return std::nullopt;
+
+  return indices;
+}
+
 std::string VertexLoaderBase::ToString() const
 {
   std::string dest;
@@ -6,7 +6,9 @@
 
 #include <array>
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "VideoCommon/CPMemory.h"
@@ -72,6 +74,22 @@ public:
 
   virtual std::string GetName() const = 0;
 
+  // An index into a vertex array, as stored in a raw GC vertex.
+  struct ArrayIndex
+  {
+    int array;
+    // Of the first index in the raw vertex
+    u32 offset;
+    // 1 or 2 bytes, big endian
+    u32 index_size;
+    // 3 for normals with separate indices for the normal, binormal and tangent
+    u32 num_indices;
+    // Bytes read from the array, starting at index * stride
+    u32 element_size;
+  };
+  // Returns the indexed attributes of a raw vertex, or nullopt if the vertex format is invalid.
+  std::optional<std::vector<ArrayIndex>> GetArrayIndices() const;
+
   // per loader public state
   int m_VertexSize = 0;  // number of bytes of a raw GC vertex
   PortableVertexDeclaration m_native_vtx_decl{};
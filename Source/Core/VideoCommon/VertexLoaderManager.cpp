@@ -5,6 +5,7 @@
 #include "VideoCommon/VertexLoaderManager.h"
 
 #include <algorithm>
+#include <atomic>
 #include <iterator>
 #include <memory>
 #include <mutex>
@@ -20,6 +21,7 @@
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/DataReader.h"
+#include "VideoCommon/DisplayListCache.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/NativeVertexFormat.h"
 #include "VideoCommon/RenderBase.h"
@@ -43,7 +45,63 @@ u32 g_current_components;
 typedef std::unordered_map<VertexLoaderUID, std::unique_ptr<VertexLoaderBase>> VertexLoaderMap;
 static std::mutex s_vertex_loader_map_lock;
 static VertexLoaderMap s_vertex_loader_map;
-// TODO - change into array of pointers. Keep a map of all seen so far.
+
+namespace
+{
+// Open addressing hash table of the loaders in s_vertex_loader_map, which both the GPU thread and
+// the preprocessing thread can search without taking s_vertex_loader_map_lock.
+//
+// Loaders are only ever added until Clear() is called. A slot is written once, with the loader
+// pointer published last, so a reader either sees an empty slot or a complete one. When the table
+// is half full, a copy with twice the capacity is published instead. Replaced tables are kept
+// until Clear(), as the other thread may still be searching them.
+struct VertexLoaderTable
+{
+  struct Slot
+  {
+    VertexLoaderUID uid;
+    std::atomic<VertexLoaderBase*> loader{nullptr};
+  };
+
+  explicit VertexLoaderTable(size_t capacity_)
+      : slots(std::make_unique<Slot[]>(capacity_)), capacity(capacity_)
+  {
+  }
+
+  VertexLoaderBase* Find(const VertexLoaderUID& uid) const
+  {
+    const size_t mask = capacity - 1;
+    for (size_t i = uid.GetHash() & mask;; i = (i + 1) & mask)
+    {
+      VertexLoaderBase* const loader = slots[i].loader.load(std::memory_order_acquire);
+      if (!loader || slots[i].uid == uid)
+        return loader;
+    }
+  }
+
+  // Only called with s_vertex_loader_map_lock held.
+  void Insert(const VertexLoaderUID& uid, VertexLoaderBase* loader)
+  {
+    const size_t mask = capacity - 1;
+    size_t i = uid.GetHash() & mask;
+    while (slots[i].loader.load(std::memory_order_relaxed))
+      i = (i + 1) & mask;
+
+    slots[i].uid = uid;
+    slots[i].loader.store(loader, std::memory_order_release);
+    size++;
+  }
+
+  std::unique_ptr<Slot[]> slots;
+  size_t capacity;
+  size_t size = 0;
+};
+}  // namespace
+
+constexpr size_t INITIAL_VERTEX_LOADER_TABLE_CAPACITY = 256;
+static std::atomic<const VertexLoaderTable*> s_vertex_loader_table{nullptr};
+// The current table is the last one. Guarded by s_vertex_loader_map_lock.
+static std::vector<std::unique_ptr<VertexLoaderTable>> s_vertex_loader_tables;
 
 u8* cached_arraybases[12];
 
@@ -60,8 +118,12 @@ void Init()
 void Clear()
 {
   std::lock_guard<std::mutex> lk(s_vertex_loader_map_lock);
+  s_vertex_loader_table = nullptr;
+  s_vertex_loader_tables.clear();
   s_vertex_loader_map.clear();
   s_native_vertex_map.clear();
+  // The cached vertices refer to the vertex loaders.
+  DisplayListCache::Clear();
 }
 
 void UpdateVertexArrayPointers()
@@ -198,6 +260,45 @@ NativeVertexFormat* GetUberVertexFormat(const PortableVertexDeclaration& decl)
   return GetOrCreateMatchingFormat(new_decl);
 }
 
+static VertexLoaderBase* FindLoader(const VertexLoaderUID& uid)
+{
+  const VertexLoaderTable* const table = s_vertex_loader_table.load(std::memory_order_acquire);
+  return table ? table->Find(uid) : nullptr;
+}
+
+static VertexLoaderBase* CreateLoader(const VertexLoaderUID& uid, const TVtxDesc& vtx_desc,
+                                      const VAT& vtx_attr)
+{
+  std::lock_guard<std::mutex> lk(s_vertex_loader_map_lock);
+
+  // The other thread may have created the loader since we searched the table.
+  std::unique_ptr<VertexLoaderBase>& loader = s_vertex_loader_map[uid];
+  if (loader)
+    return loader.get();
+
+  loader = VertexLoaderBase::CreateVertexLoader(vtx_desc, vtx_attr);
+  INCSTAT(g_stats.num_vertex_loaders);
+
+  if (s_vertex_loader_tables.empty() ||
+      (s_vertex_loader_tables.back()->size + 1) * 2 > s_vertex_loader_tables.back()->capacity)
+  {
+    const size_t capacity = s_vertex_loader_tables.empty() ?
+                                INITIAL_VERTEX_LOADER_TABLE_CAPACITY :
+                                s_vertex_loader_tables.back()->capacity * 2;
+    auto table = std::make_unique<VertexLoaderTable>(capacity);
+    for (const auto& entry : s_vertex_loader_map)
+      table->Insert(entry.first, entry.second.get());
+    s_vertex_loader_table.store(table.get(), std::memory_order_release);
+    s_vertex_loader_tables.push_back(std::move(table));
+  }
+  else
+  {
+    s_vertex_loader_tables.back()->Insert(uid, loader.get());
+  }
+
+  return loader.get();
+}
+
 static VertexLoaderBase* RefreshLoader(int vtx_attr_group, bool preprocess = false)
 {
   CPState* state = preprocess ? &g_preprocess_cp_state : &g_main_cp_state;
@@ -206,26 +307,14 @@ static VertexLoaderBase* RefreshLoader(int vtx_attr_group, bool preprocess = fal
   VertexLoaderBase* loader;
   if (state->attr_dirty[vtx_attr_group])
   {
-    // We are not allowed to create a native vertex format on preprocessing as this is on the wrong
-    // thread
-    bool check_for_native_format = !preprocess;
-
     VertexLoaderUID uid(state->vtx_desc, state->vtx_attr[vtx_attr_group]);
-    std::lock_guard<std::mutex> lk(s_vertex_loader_map_lock);
-    VertexLoaderMap::iterator iter = s_vertex_loader_map.find(uid);
-    if (iter != s_vertex_loader_map.end())
-    {
-      loader = iter->second.get();
-      check_for_native_format &= !loader->m_native_vertex_format;
-    }
-    else
-    {
-      s_vertex_loader_map[uid] =
-          VertexLoaderBase::CreateVertexLoader(state->vtx_desc, state->vtx_attr[vtx_attr_group]);
-      loader = s_vertex_loader_map[uid].get();
-      INCSTAT(g_stats.num_vertex_loaders);
-    }
-    if (check_for_native_format)
+    loader = FindLoader(uid);
+    if (!loader)
+      loader = CreateLoader(uid, state->vtx_desc, state->vtx_attr[vtx_attr_group]);
+
+    // We are not allowed to create a native vertex format on preprocessing as this is on the wrong
+    // thread. The native formats are only accessed by the GPU thread, so need no lock.
+    if (!preprocess && !loader->m_native_vertex_format)
     {
       // search for a cached native vertex format
       const PortableVertexDeclaration& format = loader->m_native_vtx_decl;
@@ -281,7 +370,10 @@ int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bo
   DataReader dst = g_vertex_manager->PrepareForAdditionalData(
       primitive, count, loader->m_native_vtx_decl.stride, cullall);
 
-  count = loader->RunVertices(src, dst, count);
+  if (DisplayListCache::IsActive())
+    count = DisplayListCache::LoadVertices(loader, src, dst, count);
+  else
+    count = loader->RunVertices(src, dst, count);
 
   g_vertex_manager->AddIndices(primitive, count);
   g_vertex_manager->FlushData(count, loader->m_native_vtx_decl.stride);
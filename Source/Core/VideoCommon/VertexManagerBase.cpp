@@ -22,6 +22,7 @@
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/FramebufferManager.h"
 #include "VideoCommon/GeometryShaderManager.h"
+#include "VideoCommon/GPUProfiler.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/NativeVertexFormat.h"
 #include "VideoCommon/OpcodeDecoding.h"
@@ -359,6 +360,7 @@ void VertexManagerBase::Flush()
   if (m_is_flushed)
     return;
 
+  GPUProfiler::ScopedEvent profiler_event(GPUProfiler::Event::Flush);
   m_is_flushed = true;
 
   if (xfmem.numTexGen.numTexGens != bpmem.genMode.numtexgens ||
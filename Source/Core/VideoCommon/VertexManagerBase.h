@@ -99,6 +99,7 @@ public:
   void FlushData(u32 count, u32 stride);
 
   void Flush();
+  bool IsFlushed() const { return m_is_flushed; }
 
   void DoState(PointerWrap& p);
 
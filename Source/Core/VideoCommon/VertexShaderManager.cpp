@@ -4,6 +4,7 @@
 
 #include "VideoCommon/VertexShaderManager.h"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstring>
@@ -22,6 +23,7 @@
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/FreeLookCamera.h"
+#include "VideoCommon/NativeVertexFormat.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexManagerBase.h"
@@ -571,6 +573,71 @@ void VertexShaderManager::InvalidateXFRange(int start, int end)
   }
 }
 
+static bool RangesOverlap(u32 start, u32 end, u32 range_start, u32 range_size)
+{
+  return start < range_start + range_size && end > range_start;
+}
+
+bool VertexShaderManager::IsXFRangeUsed(u32 start, u32 end)
+{
+  // Changes to the vertex format and to the XF and CP registers used below flush the batch, so
+  // they are the same for all of its vertices.
+  const u32 components = constants.components;
+  const TMatrixIndexA& index_a = g_main_cp_state.matrix_index_a;
+  const TMatrixIndexB& index_b = g_main_cp_state.matrix_index_b;
+
+  // A position matrix index in the vertices can select any of the position and normal matrices.
+  if (components & VB_HAS_POSMTXIDX)
+  {
+    if (RangesOverlap(start, end, XFMEM_POSMATRICES, XFMEM_POSMATRICES_END - XFMEM_POSMATRICES) ||
+        RangesOverlap(start, end, XFMEM_NORMALMATRICES,
+                      XFMEM_NORMALMATRICES_END - XFMEM_NORMALMATRICES))
+    {
+      return true;
+    }
+  }
+  else if (RangesOverlap(start, end, index_a.PosNormalMtxIdx * 4, 12) ||
+           RangesOverlap(start, end, XFMEM_NORMALMATRICES + (index_a.PosNormalMtxIdx & 31) * 3, 9))
+  {
+    return true;
+  }
+
+  const std::array<u32, 8> tex_matrices = {
+      index_a.Tex0MtxIdx, index_a.Tex1MtxIdx, index_a.Tex2MtxIdx, index_a.Tex3MtxIdx,
+      index_b.Tex4MtxIdx, index_b.Tex5MtxIdx, index_b.Tex6MtxIdx, index_b.Tex7MtxIdx,
+  };
+  bool uses_lights = false;
+  const u32 num_texgens = std::min<u32>(xfmem.numTexGen.numTexGens, 8);
+  for (u32 i = 0; i < num_texgens; ++i)
+  {
+    if (components & (VB_HAS_TEXMTXIDX0 << i))
+    {
+      if (RangesOverlap(start, end, XFMEM_POSMATRICES, XFMEM_POSMATRICES_END - XFMEM_POSMATRICES))
+        return true;
+    }
+    else if (RangesOverlap(start, end, tex_matrices[i] * 4, 12))
+    {
+      return true;
+    }
+
+    if (xfmem.texMtxInfo[i].texgentype == XF_TEXGEN_EMBOSS_MAP)
+      uses_lights = true;
+  }
+
+  if (xfmem.dualTexTrans.enabled &&
+      RangesOverlap(start, end, XFMEM_POSTMATRICES, XFMEM_POSTMATRICES_END - XFMEM_POSTMATRICES))
+  {
+    return true;
+  }
+
+  for (u32 i = 0; i < NUM_XF_COLOR_CHANNELS; ++i)
+  {
+    if (xfmem.color[i].enablelighting || xfmem.alpha[i].enablelighting)
+      uses_lights = true;
+  }
+  return uses_lights && RangesOverlap(start, end, XFMEM_LIGHTS, XFMEM_LIGHTS_END - XFMEM_LIGHTS);
+}
+
 void VertexShaderManager::SetTexMatrixChangedA(u32 Value)
 {
   if (g_main_cp_state.matrix_index_a.Hex != Value)
@@ -23,6 +23,9 @@ public:
   static void SetConstants();
 
   static void InvalidateXFRange(int start, int end);
+  // Returns whether the vertices of the current batch are transformed with any of the XF memory in
+  // [start, end). Writes to other memory can be made without flushing the batch first.
+  static bool IsXFRangeUsed(u32 start, u32 end);
   static void SetTexMatrixChangedA(u32 value);
   static void SetTexMatrixChangedB(u32 value);
   static void SetViewportChanged();
@@ -88,6 +88,7 @@ struct VideoConfig final
   bool bTexFmtOverlayEnable;
   bool bTexFmtOverlayCenter;
   bool bLogRenderTimeToFile;
+  bool bProfileGPUThread;
 
   // Render
   bool bWireFrame;
@@ -99,6 +100,7 @@ struct VideoConfig final
   bool bDumpBaseTextures;
   bool bHiresTextures;
   bool bCacheHiresTextures;
+  bool bHiresTexturesAsync;
   bool bDumpEFBTarget;
   bool bDumpXFBTarget;
   bool bDumpFramesAsImages;
@@ -128,10 +130,13 @@ struct VideoConfig final
   bool bSkipPresentingDuplicateXFBs;
   bool bCopyEFBScaled;
   int iSafeTextureCache_ColorSamples;
+  bool bTextureCacheXXH3;
+  bool bTextureCacheWriteTracking;
   float fAspectRatioHackW, fAspectRatioHackH;
   bool bEnablePixelLighting;
   bool bFastDepthCalc;
   bool bVertexRounding;
+  bool bDisplayListCache;
   int iEFBAccessTileSize;
   int iLog;           // CONF_ bits
   int iSaveTargetId;  // TODO: Should be dropped
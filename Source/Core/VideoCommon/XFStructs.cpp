@@ -13,13 +13,21 @@
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/GeometryShaderManager.h"
 #include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/XFMemory.h"
 
 static void XFMemWritten(u32 transferSize, u32 baseAddress)
 {
-  g_vertex_manager->Flush();
+  // Games often load the matrices of the next object while the current one is still being drawn
+  // with other matrices. As the uniforms of the current batch do not change, it can be merged
+  // with the draws which follow into a single backend draw.
+  if (VertexShaderManager::IsXFRangeUsed(baseAddress, baseAddress + transferSize))
+    g_vertex_manager->Flush();
+  else if (!g_vertex_manager->IsFlushed())
+    INCSTAT(g_stats.this_frame.num_merged_xf_loads);
+
   VertexShaderManager::InvalidateXFRange(baseAddress, baseAddress + transferSize);
 }
 
@@ -235,7 +243,17 @@ void LoadXFReg(u32 transferSize, u32 baseAddress, DataReader src)
       transferSize = 0;
     }
 
-    XFMemWritten(xfMemTransferSize, xfMemBase);
+    // Like indexed loads, loads which do not change the memory do not need to flush.
+    const u32* const xf_mem = reinterpret_cast<const u32*>(&xfmem) + xfMemBase;
+    for (u32 i = 0; i < xfMemTransferSize; i++)
+    {
+      if (xf_mem[i] != src.Peek<u32>(i * sizeof(u32)))
+      {
+        XFMemWritten(xfMemTransferSize, xfMemBase);
+        break;
+      }
+    }
+
     for (u32 i = 0; i < xfMemTransferSize; i++)
     {
       ((u32*)&xfmem)[xfMemBase + i] = src.Read<u32>();
@@ -0,0 +1,50 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Builds a custom texture pack (see VideoCommon/CustomTexturePack.h) from a directory of PNG and
+// DDS custom textures. Place the pack in the game's texture directory instead of the files.
+
+#include <cstdio>
+#include <string>
+
+#include "Common/StringUtil.h"
+#include "VideoCommon/CustomTexturePack.h"
+
+constexpr int DEFAULT_COMPRESSION_LEVEL = 19;
+
+int main(int argc, const char* argv[])
+{
+  if (argc != 3 && argc != 4)
+  {
+    printf("USAGE: texturepacktool <TEXTURE DIRECTORY> <OUTPUT FILE> [COMPRESSION LEVEL]\n");
+    printf("Packs the custom textures in the directory into a single file. The compression level "
+           "is a zstd level, %d by default.\n",
+           DEFAULT_COMPRESSION_LEVEL);
+    return 1;
+  }
+
+  int compression_level = DEFAULT_COMPRESSION_LEVEL;
+  if (argc == 4 && !TryParse(argv[3], &compression_level))
+  {
+    fprintf(stderr, "Invalid compression level %s\n", argv[3]);
+    return 1;
+  }
+
+  std::string error;
+  if (!CustomTexturePack::Build(argv[1], argv[2], compression_level, &error))
+  {
+    fprintf(stderr, "%s\n", error.c_str());
+    return 1;
+  }
+
+  const auto pack = CustomTexturePack::Open(argv[2]);
+  if (!pack)
+  {
+    fprintf(stderr, "Failed to read back %s\n", argv[2]);
+    return 1;
+  }
+
+  printf("Packed %zu textures into %s\n", pack->GetTextureCount(), argv[2]);
+  return 0;
+}
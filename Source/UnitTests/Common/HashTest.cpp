@@ -0,0 +1,150 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/Hash.h"
+
+namespace
+{
+// Looks roughly like a tiled GameCube texture: smooth gradients with some noise, and long runs of
+// identical blocks, which is where weak hashes tend to collide.
+std::vector<u8> MakeTextureLikeData(size_t size, u32 seed)
+{
+  std::mt19937 rng(seed);
+  std::vector<u8> data(size);
+  for (size_t i = 0; i < size; i++)
+  {
+    const size_t block = i / 32;
+    data[i] = static_cast<u8>(block % 7 == 0 ? 0x80 : (i % 32) * 8 + block + (rng() & 3));
+  }
+  return data;
+}
+
+// Counts how many single-byte modifications of the texture change its hash.
+size_t CountDetectedChanges(const std::vector<u8>& texture, u32 samples)
+{
+  const u32 size = static_cast<u32>(texture.size());
+  const u64 base_hash = Common::GetHash64(texture.data(), size, samples);
+  std::unordered_set<u64> hashes{base_hash};
+
+  std::vector<u8> modified = texture;
+  size_t detected = 0;
+  for (size_t i = 0; i < modified.size(); i += 61)
+  {
+    modified[i] ^= 0x10;
+    const u64 hash = Common::GetHash64(modified.data(), size, samples);
+    if (hash != base_hash && hashes.insert(hash).second)
+      detected++;
+    modified[i] ^= 0x10;
+  }
+  return detected;
+}
+
+class HashTest : public testing::TestWithParam<Common::Hash64Function>
+{
+protected:
+  void SetUp() override { Common::SetHash64Function(GetParam()); }
+  void TearDown() override { Common::SetHash64Function(); }
+};
+}  // namespace
+
+TEST(Hash, StableHash64)
+{
+  // Texture dump and custom texture names depend on these exact values.
+  EXPECT_EQ(0xEF46DB3751D8E999ULL, Common::GetStableHash64(nullptr, 0));
+  const u8 data[] = {'D', 'o', 'l', 'p', 'h', 'i', 'n'};
+  EXPECT_EQ(Common::GetStableHash64(data, sizeof(data)),
+            Common::GetStableHash64(data, sizeof(data)));
+  EXPECT_NE(Common::GetStableHash64(data, sizeof(data)),
+            Common::GetStableHash64(data, sizeof(data) - 1));
+}
+
+TEST(Hash, XXH3KnownAnswer)
+{
+  Common::SetHash64Function(Common::Hash64Function::XXH3);
+  EXPECT_EQ(0x2D06800538D394C2ULL, Common::GetHash64(nullptr, 0, 0));
+  Common::SetHash64Function();
+}
+
+TEST(Hash, XXH3SameResultForEveryInstructionSet)
+{
+  const std::vector<u8> texture = MakeTextureLikeData(64 * 1024 + 3, 1);
+  const CPUInfo saved_cpu_info = cpu_info;
+
+  for (u32 len : {0u, 1u, 16u, 17u, 128u, 240u, 241u, 1024u, 1025u, 64u * 1024u + 3u})
+  {
+    cpu_info.bAVX2 = false;
+    Common::SetHash64Function(Common::Hash64Function::XXH3);
+    const u64 expected = Common::GetHash64(texture.data(), len, 0);
+
+    cpu_info = saved_cpu_info;
+    Common::SetHash64Function(Common::Hash64Function::XXH3);
+    EXPECT_EQ(expected, Common::GetHash64(texture.data(), len, 0)) << "length " << len;
+  }
+
+  cpu_info = saved_cpu_info;
+  Common::SetHash64Function();
+}
+
+TEST_P(HashTest, Deterministic)
+{
+  const std::vector<u8> texture = MakeTextureLikeData(256 * 256 * 4, 2);
+  const std::vector<u8> copy = texture;
+  for (u32 samples : {0u, 1u, 128u, 4096u})
+  {
+    EXPECT_EQ(Common::GetHash64(texture.data(), static_cast<u32>(texture.size()), samples),
+              Common::GetHash64(copy.data(), static_cast<u32>(copy.size()), samples));
+  }
+}
+
+TEST_P(HashTest, FullHashDetectsEveryChange)
+{
+  for (size_t size : {32u, 4096u, 64u * 64u * 4u})
+  {
+    const std::vector<u8> texture = MakeTextureLikeData(size, 3);
+    const size_t modifications = (size + 60) / 61;
+    EXPECT_EQ(modifications, CountDetectedChanges(texture, 0)) << "size " << size;
+  }
+}
+
+TEST_P(HashTest, Throughput)
+{
+  // 1024x1024 RGBA8, the largest texture size the GameCube supports.
+  const std::vector<u8> texture = MakeTextureLikeData(1024 * 1024 * 4, 4);
+  const u32 size = static_cast<u32>(texture.size());
+  constexpr int iterations = 16;
+
+  // Checking every modification of the full texture would take too long, so collision behaviour
+  // is measured on a 64x64 RGBA8 texture.
+  const std::vector<u8> small_texture = MakeTextureLikeData(64 * 64 * 4, 5);
+
+  for (u32 samples : {0u, 128u})
+  {
+    u64 result = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+      result += Common::GetHash64(texture.data(), size, samples);
+    const auto end = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    std::printf("%s, %u samples: %.2f GB/s, %zu of %zu changes detected (%016llx)\n",
+                GetParam() == Common::Hash64Function::XXH3 ? "XXH3" : "Legacy", samples,
+                size * static_cast<double>(iterations) / seconds / 1e9,
+                CountDetectedChanges(small_texture, samples), (small_texture.size() + 60) / 61,
+                static_cast<unsigned long long>(result));
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(Hash, HashTest,
+                        testing::Values(Common::Hash64Function::Legacy,
+                                        Common::Hash64Function::XXH3));
@@ -0,0 +1,107 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "Common/FileUtil.h"
+#include "Common/Metrics.h"
+
+using namespace Common::Metrics;
+
+namespace
+{
+bool IsRegistered(const std::string& name)
+{
+  bool found = false;
+  ForEachMetric([&](const Metric& metric) { found |= metric.GetName() == name; });
+  return found;
+}
+}  // namespace
+
+TEST(Metrics, Counter)
+{
+  Counter counter(Thread::CPU, "test_counter");
+  EXPECT_EQ("cpu.test_counter", counter.GetName());
+  EXPECT_EQ(Metric::Type::Counter, counter.GetType());
+  EXPECT_EQ(0u, counter.GetValue());
+
+  counter.Increment();
+  counter.Add(41);
+  EXPECT_EQ(42u, counter.GetValue());
+}
+
+TEST(Metrics, Gauge)
+{
+  Gauge gauge(Thread::Audio, "test_gauge");
+  EXPECT_EQ("audio.test_gauge", gauge.GetName());
+
+  gauge.Set(2.5);
+  EXPECT_EQ(2.5, gauge.GetValue());
+
+  std::string json;
+  gauge.WriteJSON(&json);
+  EXPECT_EQ("2.5", json);
+}
+
+TEST(Metrics, Histogram)
+{
+  Histogram histogram(Thread::GPU, "test_histogram");
+  for (const u64 value : {0, 1, 2, 3, 4, 1000})
+    histogram.Record(value);
+  histogram.Record(1ull << 40);
+
+  const Histogram::Snapshot snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(7u, snapshot.count);
+  EXPECT_EQ(1010u + (1ull << 40), snapshot.sum);
+  EXPECT_EQ(1u, snapshot.buckets[0]);
+  EXPECT_EQ(1u, snapshot.buckets[1]);
+  EXPECT_EQ(2u, snapshot.buckets[2]);
+  EXPECT_EQ(1u, snapshot.buckets[3]);
+  // 1000 is in [512, 1024).
+  EXPECT_EQ(1u, snapshot.buckets[10]);
+  EXPECT_EQ(1u, snapshot.buckets[Histogram::NUM_BUCKETS - 1]);
+
+  Histogram empty(Thread::GPU, "test_empty_histogram");
+  std::string json;
+  empty.WriteJSON(&json);
+  EXPECT_EQ("{\"count\":0,\"sum\":0,\"buckets\":[]}", json);
+}
+
+TEST(Metrics, Registration)
+{
+  EXPECT_FALSE(IsRegistered("dvd.test_registration"));
+  {
+    Counter counter(Thread::DVD, "test_registration");
+    EXPECT_TRUE(IsRegistered("dvd.test_registration"));
+  }
+  EXPECT_FALSE(IsRegistered("dvd.test_registration"));
+}
+
+TEST(Metrics, Exporter)
+{
+  const std::string directory = File::CreateTempDir();
+  const std::string path = directory + "/metrics.jsonl";
+
+  Counter counter(Thread::CPU, "test_exported_counter");
+  counter.Add(3);
+
+  Exporter exporter;
+  ASSERT_TRUE(exporter.Start(path, std::chrono::hours(1)));
+  EXPECT_TRUE(exporter.IsRunning());
+  counter.Add(4);
+  exporter.Stop();
+  EXPECT_FALSE(exporter.IsRunning());
+
+  // Stopping writes the values at that time.
+  std::string contents;
+  ASSERT_TRUE(File::ReadFileToString(path, contents));
+  EXPECT_EQ(0u, contents.find("{\"time_us\":"));
+  EXPECT_NE(std::string::npos, contents.find("\"cpu.test_exported_counter\":7"));
+  EXPECT_EQ("}}\n", contents.substr(contents.size() - 3));
+
+  File::DeleteDirRecursively(directory);
+}
@@ -1167,6 +1167,8 @@ AVX_RRM_TEST(VSUBPD, "dqword")
 AVX_RRM_TEST(VMULPD, "dqword")
 AVX_RRM_TEST(VDIVPD, "dqword")
 AVX_RRM_TEST(VSQRTSD, "qword")
+AVX_RRM_TEST(VCVTSD2SS, "qword")
+AVX_RRM_TEST(VCVTSS2SD, "dword")
 AVX_RRM_TEST(VUNPCKLPS, "dqword")
 AVX_RRM_TEST(VUNPCKLPD, "dqword")
 AVX_RRM_TEST(VUNPCKHPD, "dqword")
@@ -0,0 +1,258 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/CommonPaths.h"
+#include "Common/FileSearch.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/FifoPlayer/FifoDataFile.h"
+#include "Core/FifoPlayer/FifoPlaybackAnalyzer.h"
+#include "Core/HW/Memmap.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+class FifoDataFileTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_profile_path = File::CreateTempDir();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    Memory::Init();
+  }
+
+  void TearDown() override
+  {
+    Memory::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  std::string GetPath() const { return m_profile_path + "/test.dff"; }
+
+private:
+  std::string m_profile_path;
+};
+
+std::vector<u8> GetRandomData(size_t size, u32 seed)
+{
+  std::mt19937 generator(seed);
+  std::vector<u8> data(size);
+  for (u8& value : data)
+    value = static_cast<u8>(generator());
+  return data;
+}
+
+// Position only, as three floats.
+constexpr u32 VCD_LO_POSITION_DIRECT = 1 << 9;
+constexpr u32 VAT_A_POSITION_XYZ_FLOAT = 9;
+constexpr u32 VAT_A_POSITION_XY_FLOAT = 8;
+
+void AppendDraw(std::vector<u8>* data, u16 num_vertices, u32 vertex_size)
+{
+  data->push_back(0x80);
+  data->push_back(static_cast<u8>(num_vertices >> 8));
+  data->push_back(static_cast<u8>(num_vertices));
+  data->resize(data->size() + num_vertices * vertex_size);
+}
+
+void AppendCommand(std::vector<u8>* data, std::vector<u8> command)
+{
+  data->insert(data->end(), command.begin(), command.end());
+}
+
+// The first frame switches the positions of vertex format 0 from XYZ to XY, which changes the size
+// of the vertices of the frames after it.
+std::unique_ptr<FifoDataFile> CreateVertexFormatFile(bool with_vertex_regs)
+{
+  auto file = std::make_unique<FifoDataFile>();
+  std::fill_n(file->GetCPMem(), FifoDataFile::CP_MEM_SIZE, 0);
+  file->GetCPMem()[0x50] = VCD_LO_POSITION_DIRECT;
+  file->GetCPMem()[0x70] = VAT_A_POSITION_XYZ_FLOAT;
+
+  FifoFrameInfo frame{};
+  AppendDraw(&frame.fifoData, 3, 12);
+  AppendCommand(&frame.fifoData, {0x08, 0x70, 0x00, 0x00, 0x00, VAT_A_POSITION_XY_FLOAT});
+  AppendCommand(&frame.fifoData, {0x61, 0x00, 0x00, 0x00, 0x00});
+  file->AddFrame(frame);
+
+  frame.fifoData.clear();
+  AppendDraw(&frame.fifoData, 2, 8);
+  AppendCommand(&frame.fifoData, {0x61, 0x00, 0x00, 0x00, 0x00});
+  if (with_vertex_regs)
+  {
+    frame.vertexRegs.resize(FifoFrameInfo::NUM_VERTEX_REGS);
+    frame.vertexRegs[0] = VCD_LO_POSITION_DIRECT;
+    frame.vertexRegs[2] = VAT_A_POSITION_XY_FLOAT;
+  }
+  for (int i = 0; i < 15; i++)
+    file->AddFrame(frame);
+
+  return file;
+}
+
+void ExpectVertexFormatAnalysis(const std::vector<AnalyzedFrameInfo>& frame_info)
+{
+  ASSERT_EQ(16u, frame_info.size());
+  EXPECT_EQ(std::vector<u32>{0}, frame_info[0].objectStarts);
+  EXPECT_EQ(std::vector<u32>{3 + 3 * 12}, frame_info[0].objectEnds);
+  for (size_t i = 1; i < frame_info.size(); i++)
+  {
+    EXPECT_EQ(std::vector<u32>{0}, frame_info[i].objectStarts);
+    EXPECT_EQ(std::vector<u32>{3 + 2 * 8}, frame_info[i].objectEnds);
+  }
+}
+
+void ExpectFramesEqual(const FifoFrameInfo& expected, const FifoFrameInfo& actual)
+{
+  EXPECT_EQ(expected.fifoData, actual.fifoData);
+  EXPECT_EQ(expected.fifoStart, actual.fifoStart);
+  EXPECT_EQ(expected.fifoEnd, actual.fifoEnd);
+  EXPECT_EQ(expected.vertexRegs, actual.vertexRegs);
+  ASSERT_EQ(expected.memoryUpdates.size(), actual.memoryUpdates.size());
+  for (size_t i = 0; i < expected.memoryUpdates.size(); i++)
+  {
+    EXPECT_EQ(expected.memoryUpdates[i].fifoPosition, actual.memoryUpdates[i].fifoPosition);
+    EXPECT_EQ(expected.memoryUpdates[i].address, actual.memoryUpdates[i].address);
+    EXPECT_EQ(expected.memoryUpdates[i].type, actual.memoryUpdates[i].type);
+    EXPECT_EQ(expected.memoryUpdates[i].data, actual.memoryUpdates[i].data);
+  }
+}
+}  // namespace
+
+TEST_F(FifoDataFileTest, SaveAndLoad)
+{
+  constexpr u32 NUM_FRAMES = 8;
+  constexpr size_t TEXTURE_SIZE = 0x10000;
+  const std::vector<u8> texture = GetRandomData(TEXTURE_SIZE, 0);
+
+  auto file = std::make_unique<FifoDataFile>();
+  file->SetIsWii(true);
+  file->GetBPMem()[0x28] = 0x12345678;
+  file->GetTexMem()[0x100] = 0xAB;
+
+  std::vector<FifoFrameInfo> frames(NUM_FRAMES);
+  for (u32 i = 0; i < NUM_FRAMES; i++)
+  {
+    FifoFrameInfo& frame = frames[i];
+    frame.fifoData = GetRandomData(0x1000 + i, i + 1);
+    frame.fifoStart = 0x00200000;
+    frame.fifoEnd = 0x00210000;
+    if (i % 2 == 0)
+      frame.vertexRegs = std::vector<u32>(FifoFrameInfo::NUM_VERTEX_REGS, i);
+    // The same texture is uploaded every frame, along with data which changes.
+    frame.memoryUpdates.push_back({0x10, 0x00300000, texture, MemoryUpdate::TEXTURE_MAP});
+    frame.memoryUpdates.push_back(
+        {0x20, 0x00400000, GetRandomData(0x100, 100 + i), MemoryUpdate::VERTEX_STREAM});
+    file->AddFrame(frame);
+  }
+
+  ASSERT_TRUE(file->Save(GetPath()));
+
+  // The texture is only stored once. Texture memory is stored uncompressed.
+  EXPECT_LT(File::GetSize(GetPath()), FifoDataFile::TEX_MEM_SIZE + 2 * TEXTURE_SIZE);
+
+  const std::unique_ptr<FifoDataFile> loaded = FifoDataFile::Load(GetPath(), false);
+  ASSERT_NE(nullptr, loaded);
+  EXPECT_TRUE(loaded->GetIsWii());
+  EXPECT_EQ(0x12345678u, loaded->GetBPMem()[0x28]);
+  EXPECT_EQ(0xABu, loaded->GetTexMem()[0x100]);
+  ASSERT_EQ(NUM_FRAMES, loaded->GetFrameCount());
+
+  // Frames can be read in any order.
+  ExpectFramesEqual(frames[5], *loaded->GetFrame(5));
+  for (u32 i = 0; i < NUM_FRAMES; i++)
+    ExpectFramesEqual(frames[i], *loaded->GetFrame(i));
+}
+
+TEST_F(FifoDataFileTest, EmptyFrame)
+{
+  auto file = std::make_unique<FifoDataFile>();
+  file->AddFrame({});
+  ASSERT_TRUE(file->Save(GetPath()));
+
+  const std::unique_ptr<FifoDataFile> loaded = FifoDataFile::Load(GetPath(), false);
+  ASSERT_NE(nullptr, loaded);
+  ASSERT_EQ(1u, loaded->GetFrameCount());
+  EXPECT_TRUE(loaded->GetFrame(0)->fifoData.empty());
+  EXPECT_TRUE(loaded->GetFrame(0)->memoryUpdates.empty());
+}
+
+TEST_F(FifoDataFileTest, AnalyzeFramesWithoutVertexRegs)
+{
+  const std::unique_ptr<FifoDataFile> file = CreateVertexFormatFile(false);
+  std::vector<AnalyzedFrameInfo> frame_info;
+  FifoPlaybackAnalyzer::AnalyzeFrames(file.get(), frame_info);
+  ExpectVertexFormatAnalysis(frame_info);
+}
+
+TEST_F(FifoDataFileTest, AnalyzeFramesWithVertexRegs)
+{
+  const std::unique_ptr<FifoDataFile> file = CreateVertexFormatFile(true);
+  std::vector<AnalyzedFrameInfo> frame_info;
+  FifoPlaybackAnalyzer::AnalyzeFrames(file.get(), frame_info);
+  ExpectVertexFormatAnalysis(frame_info);
+}
+
+TEST_F(FifoDataFileTest, AnalyzeFramesWithUnknownCommand)
+{
+  const std::unique_ptr<FifoDataFile> valid_file = CreateVertexFormatFile(true);
+
+  // The workers stop when one of them finds the unknown command, which can be before the first
+  // frame has been analyzed, so try a few times.
+  for (int attempt = 0; attempt < 20; attempt++)
+  {
+    auto file = std::make_unique<FifoDataFile>();
+    std::copy_n(valid_file->GetCPMem(), FifoDataFile::CP_MEM_SIZE, file->GetCPMem());
+    file->AddFrame(*valid_file->GetFrame(0));
+
+    FifoFrameInfo frame = *valid_file->GetFrame(1);
+    AppendCommand(&frame.fifoData, {0x01});
+    for (int i = 0; i < 31; i++)
+      file->AddFrame(frame);
+
+    std::vector<AnalyzedFrameInfo> frame_info;
+    FifoPlaybackAnalyzer::AnalyzeFrames(file.get(), frame_info);
+
+    // The frame before the unknown command is still analyzed, and the others are left empty.
+    ASSERT_EQ(32u, frame_info.size());
+    EXPECT_EQ(std::vector<u32>{0}, frame_info[0].objectStarts);
+    EXPECT_EQ(std::vector<u32>{3 + 3 * 12}, frame_info[0].objectEnds);
+    for (size_t i = 1; i < frame_info.size(); i++)
+    {
+      EXPECT_TRUE(frame_info[i].objectStarts.empty());
+      EXPECT_TRUE(frame_info[i].objectEnds.empty());
+    }
+  }
+}
+
+TEST_F(FifoDataFileTest, AnalyzeFramesCached)
+{
+  ASSERT_TRUE(CreateVertexFormatFile(true)->Save(GetPath()));
+  const std::string cache_path = File::GetUserPath(D_CACHE_IDX);
+  EXPECT_TRUE(Common::DoFileSearch({cache_path}, {".fifoanalysis"}).empty());
+
+  std::vector<AnalyzedFrameInfo> frame_info;
+  FifoPlaybackAnalyzer::AnalyzeFrames(FifoDataFile::Load(GetPath(), false).get(), frame_info);
+  ExpectVertexFormatAnalysis(frame_info);
+  EXPECT_EQ(1u, Common::DoFileSearch({cache_path}, {".fifoanalysis"}).size());
+
+  frame_info.clear();
+  FifoPlaybackAnalyzer::AnalyzeFrames(FifoDataFile::Load(GetPath(), false).get(), frame_info);
+  ExpectVertexFormatAnalysis(frame_info);
+}
@@ -0,0 +1,288 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+constexpr u32 DATA_ADDRESS = 0x00002000;
+constexpr u32 CODE_ADDRESS = 0x00003000;
+
+u32 DForm(u32 opcode, u32 d, u32 a, u32 imm)
+{
+  return opcode << 26 | d << 21 | a << 16 | (imm & 0xFFFF);
+}
+u32 lwz(u32 d, s16 offset, u32 a)
+{
+  return DForm(32, d, a, offset);
+}
+u32 stw(u32 s, s16 offset, u32 a)
+{
+  return DForm(36, s, a, offset);
+}
+u32 addi(u32 d, u32 a, s16 imm)
+{
+  return DForm(14, d, a, imm);
+}
+u32 cmpi(u32 crf, u32 a, s16 imm)
+{
+  return DForm(11, crf << 2, a, imm);
+}
+u32 cmpli(u32 crf, u32 a, u16 imm)
+{
+  return DForm(10, crf << 2, a, imm);
+}
+u32 cmp(u32 crf, u32 a, u32 b)
+{
+  return 31 << 26 | crf << 23 | a << 16 | b << 11;
+}
+u32 cmpl(u32 crf, u32 a, u32 b)
+{
+  return cmp(crf, a, b) | 32 << 1;
+}
+u32 bc(u32 bo, u32 bi, s16 offset, bool link = false)
+{
+  return DForm(16, bo, bi, offset) | (link ? 1 : 0);
+}
+u32 b(s32 offset)
+{
+  return 18 << 26 | (offset & 0x03FFFFFC);
+}
+
+constexpr u32 BRANCH_IF_TRUE = 12;
+constexpr u32 BRANCH_IF_FALSE = 4;
+constexpr u32 LT = 0;
+constexpr u32 GT = 1;
+constexpr u32 EQ = 2;
+
+// Counts to r5 in a memory word. Every iteration ends with a compare and a branch, and most
+// iterations also run a load followed by an add of the loaded register, and an add followed by a
+// store of the result. Finishes at the returned address.
+u32 WriteCountingLoop(u32 address)
+{
+  const std::vector<u32> code = {
+      lwz(4, 0, 3),                             // 0x00
+      addi(4, 4, 1),                            // 0x04
+      stw(4, 0, 3),                             // 0x08
+      addi(6, 6, 3),                            // 0x0c
+      stw(6, 4, 3),                             // 0x10
+      cmpi(2, 4, 50),                           // 0x14
+      bc(BRANCH_IF_FALSE, 8 + LT, 0x0c, true),  // 0x18: bgel cr2, 0x24
+      addi(7, 7, 1),                            // 0x1c
+      b(0x08),                                  // 0x20: b 0x28
+      addi(8, 8, 1),                            // 0x24
+      cmpl(1, 4, 5),                            // 0x28
+      bc(BRANCH_IF_TRUE, 4 + LT, -0x2c),        // 0x2c: blt cr1, 0x00
+      cmpli(3, 4, 100),                         // 0x30
+      bc(BRANCH_IF_TRUE, 12 + EQ, 0x08),        // 0x34: beq cr3, 0x3c
+      addi(9, 9, 1),                            // 0x38
+      cmp(0, 6, 4),                             // 0x3c
+      bc(BRANCH_IF_TRUE, GT, 0x08),             // 0x40: bgt 0x48
+      addi(9, 9, 2),                            // 0x44
+      b(0),                                     // 0x48
+  };
+  for (size_t i = 0; i < code.size(); ++i)
+    Memory::Write_U32(code[i], address + static_cast<u32>(i * 4));
+  return address + 0x48;
+}
+
+// A shorter loop, whose load and add, add and store, and compare and branch can be fused.
+u32 WriteFusableLoop(u32 address)
+{
+  const std::vector<u32> code = {
+      lwz(4, 0, 3),                       // 0x00
+      addi(4, 4, 1),                      // 0x04
+      addi(6, 6, 3),                      // 0x08
+      stw(6, 4, 3),                       // 0x0c
+      stw(4, 0, 3),                       // 0x10
+      cmpi(2, 4, 50),                     // 0x14
+      cmpl(1, 4, 5),                      // 0x18
+      bc(BRANCH_IF_TRUE, 4 + LT, -0x1c),  // 0x1c: blt cr1, 0x00
+      b(0),                               // 0x20
+  };
+  for (size_t i = 0; i < code.size(); ++i)
+    Memory::Write_U32(code[i], address + static_cast<u32>(i * 4));
+  return address + 0x20;
+}
+
+// The same instructions in an order which can't be fused: each instruction uses registers which
+// the instruction before it doesn't write, and the branch tests a field which the compare before
+// it doesn't set.
+u32 WriteUnfusableLoop(u32 address)
+{
+  const std::vector<u32> code = {
+      lwz(4, 0, 3),                       // 0x00
+      addi(6, 6, 3),                      // 0x04
+      addi(4, 4, 1),                      // 0x08
+      stw(6, 4, 3),                       // 0x0c
+      stw(4, 0, 3),                       // 0x10
+      cmpl(1, 4, 5),                      // 0x14
+      cmpi(2, 4, 50),                     // 0x18
+      bc(BRANCH_IF_TRUE, 4 + LT, -0x1c),  // 0x1c: blt cr1, 0x00
+      b(0),                               // 0x20
+  };
+  for (size_t i = 0; i < code.size(); ++i)
+    Memory::Write_U32(code[i], address + static_cast<u32>(i * 4));
+  return address + 0x20;
+}
+
+struct CPUState
+{
+  std::array<u32, 32> gpr;
+  u32 cr;
+  u32 lr;
+  u32 pc;
+  u32 counter;
+  u32 sum;
+};
+
+class CachedInterpreterTest : public testing::Test
+{
+protected:
+  void TearDown() override { Shutdown(); }
+
+  void Init(PowerPC::CPUCore core)
+  {
+    m_profile_path = File::CreateTempDir();
+    Core::DeclareAsCPUThread();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    Memory::Init();
+    PowerPC::Init(core);
+    CoreTiming::Init();
+
+    // Real mode, so that effective addresses are physical addresses.
+    MSR.Hex = 0;
+    rGPR[3] = DATA_ADDRESS;
+    rGPR[5] = 100;
+    PowerPC::SetXER_SO(true);
+    m_initialized = true;
+  }
+
+  void Shutdown()
+  {
+    if (!m_initialized)
+      return;
+    CoreTiming::Shutdown();
+    PowerPC::Shutdown();
+    Memory::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    Core::UndeclareAsCPUThread();
+    File::DeleteDirRecursively(m_profile_path);
+    m_initialized = false;
+  }
+
+  // Steps until the code reaches the end address. Each step runs a block, or one instruction for
+  // the interpreter.
+  static void RunUntil(u32 end_address)
+  {
+    PC = CODE_ADDRESS;
+    NPC = CODE_ADDRESS + 4;
+    for (int i = 0; i < 100000 && PC != end_address; ++i)
+      PowerPC::SingleStep();
+    ASSERT_EQ(end_address, PC);
+  }
+
+  static CPUState GetState()
+  {
+    CPUState state;
+    std::copy(std::begin(rGPR), std::end(rGPR), state.gpr.begin());
+    state.cr = PowerPC::ppcState.cr.Get();
+    state.lr = LR;
+    state.pc = PC;
+    state.counter = Memory::Read_U32(DATA_ADDRESS);
+    state.sum = Memory::Read_U32(DATA_ADDRESS + 4);
+    return state;
+  }
+
+  CPUState Run(PowerPC::CPUCore core, u32 (*write_code)(u32))
+  {
+    Init(core);
+    RunUntil(write_code(CODE_ADDRESS));
+    const CPUState state = GetState();
+    Shutdown();
+    return state;
+  }
+
+private:
+  std::string m_profile_path;
+  bool m_initialized = false;
+};
+
+void ExpectSameState(const CPUState& expected, const CPUState& actual)
+{
+  for (size_t i = 0; i < expected.gpr.size(); ++i)
+    EXPECT_EQ(expected.gpr[i], actual.gpr[i]) << "r" << i;
+  EXPECT_EQ(expected.cr, actual.cr);
+  EXPECT_EQ(expected.lr, actual.lr);
+  EXPECT_EQ(expected.pc, actual.pc);
+  EXPECT_EQ(expected.counter, actual.counter);
+  EXPECT_EQ(expected.sum, actual.sum);
+}
+}  // namespace
+
+TEST_F(CachedInterpreterTest, SuperinstructionsMatchInterpreter)
+{
+  const CPUState expected = Run(PowerPC::CPUCore::Interpreter, WriteCountingLoop);
+  EXPECT_EQ(100u, expected.counter);
+  EXPECT_EQ(300u, expected.sum);
+  EXPECT_EQ(49u, expected.gpr[7]);
+  EXPECT_EQ(51u, expected.gpr[8]);
+  EXPECT_EQ(CODE_ADDRESS + 0x1c, expected.lr);
+  EXPECT_EQ(0u, expected.gpr[9]);
+
+  ExpectSameState(expected, Run(PowerPC::CPUCore::CachedInterpreter, WriteCountingLoop));
+}
+
+TEST_F(CachedInterpreterTest, ShortLoopsMatchInterpreter)
+{
+  for (const auto write_code : {WriteFusableLoop, WriteUnfusableLoop})
+  {
+    const CPUState expected = Run(PowerPC::CPUCore::Interpreter, write_code);
+    EXPECT_EQ(100u, expected.counter);
+    EXPECT_EQ(300u, expected.sum);
+
+    ExpectSameState(expected, Run(PowerPC::CPUCore::CachedInterpreter, write_code));
+  }
+}
+
+class CachedInterpreterSpeedTest : public CachedInterpreterTest,
+                                   public testing::WithParamInterface<bool>
+{
+};
+
+INSTANTIATE_TEST_CASE_P(FusableAndUnfusable, CachedInterpreterSpeedTest, testing::Bool());
+
+TEST_P(CachedInterpreterSpeedTest, CountingLoop)
+{
+  const bool fusable = GetParam();
+  printf("code: %s\n", fusable ? "fusable" : "unfusable");
+
+  Init(PowerPC::CPUCore::CachedInterpreter);
+  const u32 end_address = (fusable ? WriteFusableLoop : WriteUnfusableLoop)(CODE_ADDRESS);
+  for (int i = 0; i < 20000; ++i)
+  {
+    Memory::Write_U32(0, DATA_ADDRESS);
+    RunUntil(end_address);
+  }
+}
@@ -0,0 +1,163 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/BitUtils.h"
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+#include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+constexpr u32 DATA_ADDRESS = 0x00002000;
+constexpr u32 CODE_ADDRESS = 0x00003000;
+
+u32 DForm(u32 opcode, u32 d, u32 a, u32 imm)
+{
+  return opcode << 26 | d << 21 | a << 16 | (imm & 0xFFFF);
+}
+u32 XForm(u32 opcode, u32 d, u32 a, u32 b, u32 subop)
+{
+  return opcode << 26 | d << 21 | a << 16 | b << 11 | subop << 1;
+}
+
+// Counts r4 up to r5 in a memory word, and adds f2 to a double in memory and to f3 as often.
+// Besides integer and floating point arithmetic, it uses loads and stores, a rotate, and
+// instructions from the secondary tables of opcodes 31, 59 and 63. Finishes at the returned
+// address.
+u32 WriteMixedLoop(u32 address)
+{
+  const std::vector<u32> code = {
+      DForm(32, 4, 3, 0),                               // 0x00: lwz r4, 0(r3)
+      DForm(14, 4, 4, 1),                               // 0x04: addi r4, r4, 1
+      DForm(36, 4, 3, 0),                               // 0x08: stw r4, 0(r3)
+      DForm(50, 1, 3, 8),                               // 0x0c: lfd f1, 8(r3)
+      XForm(63, 1, 1, 2, 21),                           // 0x10: fadd f1, f1, f2
+      XForm(59, 3, 3, 2, 21),                           // 0x14: fadds f3, f3, f2
+      DForm(54, 1, 3, 8),                               // 0x18: stfd f1, 8(r3)
+      21 << 26 | 4 << 21 | 6 << 16 | 2 << 11 | 29 << 1,  // 0x1c: rlwinm r6, r4, 2, 0, 29
+      XForm(31, 7, 7, 6, 266),                          // 0x20: add r7, r7, r6
+      XForm(31, 4, 4, 5, 32),                           // 0x24: cmplw cr1, r4, r5
+      DForm(16, 12, 4, -0x28),                          // 0x28: blt cr1, 0x00
+      18 << 26,                                         // 0x2c: b 0x2c
+  };
+  for (size_t i = 0; i < code.size(); ++i)
+    Memory::Write_U32(code[i], address + static_cast<u32>(i * 4));
+  return address + 0x2c;
+}
+
+class InterpreterTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_profile_path = File::CreateTempDir();
+    Core::DeclareAsCPUThread();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    Memory::Init();
+    PowerPC::Init(PowerPC::CPUCore::Interpreter);
+    CoreTiming::Init();
+
+    // Real mode, so that effective addresses are physical addresses.
+    MSR.Hex = 0;
+    MSR.FP = 1;
+  }
+
+  void TearDown() override
+  {
+    CoreTiming::Shutdown();
+    PowerPC::Shutdown();
+    Memory::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    Core::UndeclareAsCPUThread();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  // Steps like the run loop of the interpreter, without ending the timing slice after each
+  // instruction like SingleStep does.
+  static void RunUntil(u32 end_address)
+  {
+    PC = CODE_ADDRESS;
+    NPC = CODE_ADDRESS + 4;
+    for (int i = 0; i < 100000 && PC != end_address; ++i)
+      Interpreter::getInstance()->SingleStepInner();
+    ASSERT_EQ(end_address, PC);
+  }
+
+  static void RunMixedLoop(u32 end_address, u32 iterations)
+  {
+    Memory::Write_U32(0, DATA_ADDRESS);
+    Memory::Write_U64(0, DATA_ADDRESS + 8);
+    rGPR[3] = DATA_ADDRESS;
+    rGPR[5] = iterations;
+    rGPR[7] = 0;
+    rPS(2).SetBoth(1.0, 1.0);
+    rPS(3).SetBoth(0.0, 0.0);
+    RunUntil(end_address);
+  }
+
+private:
+  std::string m_profile_path;
+};
+}  // namespace
+
+TEST_F(InterpreterTest, MixedLoop)
+{
+  RunMixedLoop(WriteMixedLoop(CODE_ADDRESS), 100);
+  EXPECT_EQ(100u, Memory::Read_U32(DATA_ADDRESS));
+  EXPECT_EQ(100.0, Common::BitCast<double>(Memory::Read_U64(DATA_ADDRESS + 8)));
+  EXPECT_EQ(100.0, rPS(3).PS0AsDouble());
+  EXPECT_EQ(4u * 100 * 101 / 2, rGPR[7]);
+}
+
+TEST_F(InterpreterTest, ModifiedCodeIsDecodedAgain)
+{
+  const u32 end_address = WriteMixedLoop(CODE_ADDRESS);
+  RunMixedLoop(end_address, 10);
+  EXPECT_EQ(4u * 10 * 11 / 2, rGPR[7]);
+
+  // subf r7, r6, r7, followed by an invalidation like the one of icbi.
+  Memory::Write_U32(XForm(31, 7, 6, 7, 40), CODE_ADDRESS + 0x20);
+  JitInterface::InvalidateICache(CODE_ADDRESS + 0x20, 32, false);
+  RunMixedLoop(end_address, 10);
+  EXPECT_EQ(0u - 4 * 10 * 11 / 2, rGPR[7]);
+
+  // Code which is changed without invalidating it runs as well, as the instruction cache isn't
+  // emulated.
+  Memory::Write_U32(XForm(31, 7, 7, 6, 266), CODE_ADDRESS + 0x20);
+  RunMixedLoop(end_address, 10);
+  EXPECT_EQ(4u * 10 * 11 / 2, rGPR[7]);
+}
+
+class InterpreterSpeedTest : public InterpreterTest, public testing::WithParamInterface<u32>
+{
+};
+
+INSTANTIATE_TEST_CASE_P(Iterations, InterpreterSpeedTest, testing::Values(10u, 1000u));
+
+TEST_P(InterpreterSpeedTest, MixedLoop)
+{
+  const u32 iterations = GetParam();
+  printf("iterations per run: %u\n", iterations);
+
+  const u32 end_address = WriteMixedLoop(CODE_ADDRESS);
+  for (u32 i = 0; i < 4000000 / iterations; ++i)
+    RunMixedLoop(end_address, iterations);
+}
@@ -0,0 +1,267 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// JitBase.h includes the x64Emitter, whose TEST method conflicts with the TEST macro of gtest. This
+// file only uses TEST_F and TEST_P.
+#undef TEST
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Common/Metrics.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+constexpr u32 CODE_ADDRESS = 0x00003000;
+
+u32 DForm(u32 opcode, u32 d, u32 a, u32 imm)
+{
+  return opcode << 26 | d << 21 | a << 16 | (imm & 0xFFFF);
+}
+u32 XForm(u32 opcode, u32 d, u32 a, u32 b, u32 subop)
+{
+  return opcode << 26 | d << 21 | a << 16 | b << 11 | subop << 1;
+}
+u32 Li(u32 d, u32 imm)
+{
+  return DForm(14, d, 0, imm);
+}
+u32 Rlwinm(u32 a, u32 s, u32 sh, u32 mb, u32 me)
+{
+  return 21 << 26 | s << 21 | a << 16 | sh << 11 | mb << 6 | me << 1;
+}
+u32 Cmplw(u32 a, u32 b)
+{
+  return XForm(31, 0, a, b, 32);
+}
+
+// XO-form arithmetic takes rD, rA, rB, and X-form logical operations take rS, rA, rB, with rA as
+// the destination.
+const std::vector<std::vector<u32>> s_runs = {
+    // Common subexpressions, and old values of registers which are needed after they're written.
+    {
+        XForm(31, 5, 3, 4, 266),  // add r5, r3, r4
+        XForm(31, 6, 4, 3, 266),  // add r6, r4, r3
+        XForm(31, 3, 7, 3, 444),  // mr r7, r3
+        DForm(14, 3, 3, 1),       // addi r3, r3, 1
+        XForm(31, 8, 7, 3, 40),   // subf r8, r7, r3
+        XForm(31, 4, 4, 5, 40),   // subf r4, r4, r5
+        XForm(31, 9, 5, 6, 40),   // subf r9, r5, r6
+    },
+    // Swapping registers, and a dead store.
+    {
+        XForm(31, 3, 5, 3, 444),  // mr r5, r3
+        XForm(31, 4, 3, 4, 444),  // mr r3, r4
+        XForm(31, 5, 4, 5, 444),  // mr r4, r5
+        DForm(14, 6, 3, 7),       // addi r6, r3, 7
+        XForm(31, 6, 4, 3, 266),  // add r6, r4, r3
+        XForm(31, 7, 3, 4, 266),  // add r7, r3, r4
+    },
+    // Logical operations.
+    {
+        XForm(31, 3, 5, 4, 28),    // and r5, r3, r4
+        XForm(31, 4, 6, 3, 28),    // and r6, r4, r3
+        XForm(31, 3, 7, 4, 60),    // andc r7, r3, r4
+        XForm(31, 4, 8, 3, 412),   // orc r8, r4, r3
+        XForm(31, 3, 9, 4, 476),   // nand r9, r3, r4
+        XForm(31, 3, 10, 4, 124),  // nor r10, r3, r4
+        XForm(31, 3, 11, 4, 284),  // eqv r11, r3, r4
+        XForm(31, 3, 12, 4, 316),  // xor r12, r3, r4
+        XForm(31, 3, 13, 4, 444),  // or r13, r3, r4
+        XForm(31, 3, 3, 3, 60),    // andc r3, r3, r3
+        DForm(24, 4, 4, 0x8001),   // ori r4, r4, 0x8001
+        DForm(27, 4, 4, 0x1234),   // xoris r4, r4, 0x1234
+    },
+    // Rotates, shifts by constants, sign extension, negation and multiplication.
+    {
+        Rlwinm(5, 3, 8, 0, 23),    // rlwinm r5, r3, 8, 0, 23
+        Rlwinm(6, 3, 8, 0, 23),    // rlwinm r6, r3, 8, 0, 23
+        Rlwinm(7, 4, 0, 24, 31),   // rlwinm r7, r4, 0, 24, 31
+        Rlwinm(8, 4, 28, 4, 31),   // rlwinm r8, r4, 28, 4, 31
+        Li(9, 5),                  // li r9, 5
+        Li(10, 35),                // li r10, 35
+        XForm(31, 3, 11, 9, 24),   // slw r11, r3, r9
+        XForm(31, 4, 12, 9, 536),  // srw r12, r4, r9
+        XForm(31, 3, 13, 10, 24),  // slw r13, r3, r10
+        XForm(31, 3, 14, 0, 954),  // extsb r14, r3
+        XForm(31, 4, 15, 0, 922),  // extsh r15, r4
+        XForm(31, 16, 3, 0, 104),  // neg r16, r3
+        DForm(7, 17, 3, -7),       // mulli r17, r3, -7
+        XForm(31, 18, 3, 4, 235),  // mullw r18, r3, r4
+        XForm(31, 19, 4, 3, 235),  // mullw r19, r4, r3
+        XForm(31, 3, 3, 4, 235),   // mullw r3, r3, r4
+    },
+    // Registers which the register cache knows the value of at the start of the run.
+    {
+        Li(3, 5),                 // li r3, 5
+        Cmplw(3, 4),              // cmplw r3, r4
+        XForm(31, 5, 3, 4, 266),  // add r5, r3, r4
+        XForm(31, 6, 4, 3, 266),  // add r6, r4, r3
+        XForm(31, 7, 3, 3, 266),  // add r7, r3, r3
+        XForm(31, 8, 3, 3, 444),  // mr r8, r3
+    },
+};
+
+// Computes the address of element r20 of the array at r3 twice, and the product of r20 and r4
+// twice. The differences of the two, which are zero, are added to r10 and r14. Loops r21 times.
+const std::vector<u32> s_loop = {
+    Rlwinm(5, 20, 2, 0, 29),     // 0x00: rlwinm r5, r20, 2, 0, 29
+    XForm(31, 6, 3, 5, 266),     // 0x04: add r6, r3, r5
+    Rlwinm(7, 20, 2, 0, 29),     // 0x08: rlwinm r7, r20, 2, 0, 29
+    XForm(31, 8, 3, 7, 266),     // 0x0c: add r8, r3, r7
+    XForm(31, 6, 9, 8, 316),     // 0x10: xor r9, r6, r8
+    XForm(31, 10, 10, 9, 266),   // 0x14: add r10, r10, r9
+    XForm(31, 11, 20, 4, 235),   // 0x18: mullw r11, r20, r4
+    XForm(31, 12, 4, 20, 235),   // 0x1c: mullw r12, r4, r20
+    XForm(31, 13, 11, 12, 40),   // 0x20: subf r13, r11, r12
+    XForm(31, 14, 14, 6, 266),   // 0x24: add r14, r14, r6
+    XForm(31, 14, 14, 13, 266),  // 0x28: add r14, r14, r13
+    XForm(31, 14, 15, 14, 444),  // 0x2c: mr r15, r14
+    DForm(14, 20, 20, 1),        // 0x30: addi r20, r20, 1
+    Cmplw(20, 21),               // 0x34: cmplw r20, r21
+    DForm(16, 12, 0, -0x38),     // 0x38: blt 0x00
+};
+
+u64 GetLoweredRuns()
+{
+  u64 value = 0;
+  Common::Metrics::ForEachMetric([&](const Common::Metrics::Metric& metric) {
+    if (metric.GetName() == "cpu.jit_ir_lowered_runs")
+      value = static_cast<const Common::Metrics::Counter&>(metric).GetValue();
+  });
+  return value;
+}
+
+class Jit64IRTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_profile_path = File::CreateTempDir();
+    Core::DeclareAsCPUThread();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    Memory::Init();
+    PowerPC::Init(PowerPC::CPUCore::JIT64);
+    CoreTiming::Init();
+
+    // Real mode, so that effective addresses are physical addresses.
+    MSR.Hex = 0;
+  }
+
+  void TearDown() override
+  {
+    CoreTiming::Shutdown();
+    PowerPC::Shutdown();
+    Memory::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    Core::UndeclareAsCPUThread();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  // Writes the code followed by a branch to itself, and compiles it from scratch.
+  static u32 WriteCode(const std::vector<u32>& code, bool lower)
+  {
+    static_cast<JitBase*>(JitInterface::GetCore())->jo.lower_integer_runs = lower;
+    JitInterface::ClearCache();
+
+    for (size_t i = 0; i < code.size(); ++i)
+      Memory::Write_U32(code[i], CODE_ADDRESS + static_cast<u32>(i * 4));
+    const u32 end_address = CODE_ADDRESS + static_cast<u32>(code.size() * 4);
+    Memory::Write_U32(18 << 26, end_address);
+    return end_address;
+  }
+
+  static void RunUntil(u32 end_address)
+  {
+    PC = CODE_ADDRESS;
+    NPC = CODE_ADDRESS + 4;
+    for (int i = 0; i < 100000 && PC != end_address; ++i)
+      PowerPC::SingleStep();
+    ASSERT_EQ(end_address, PC);
+  }
+
+  static std::array<u32, 32> Run(const std::vector<u32>& code, bool lower)
+  {
+    const u32 end_address = WriteCode(code, lower);
+    for (u32 i = 0; i < 32; ++i)
+      rGPR[i] = (0x9E3779B9 * (i + 1)) ^ (0x8000 << (i % 17));
+    RunUntil(end_address);
+
+    std::array<u32, 32> result;
+    for (u32 i = 0; i < 32; ++i)
+      result[i] = rGPR[i];
+    return result;
+  }
+
+private:
+  std::string m_profile_path;
+};
+}  // namespace
+
+TEST_F(Jit64IRTest, LoweredRunsMatchInstructionByInstructionCompilation)
+{
+  for (size_t i = 0; i < s_runs.size(); ++i)
+  {
+    const std::array<u32, 32> expected = Run(s_runs[i], false);
+
+    const u64 lowered_runs = GetLoweredRuns();
+    const std::array<u32, 32> result = Run(s_runs[i], true);
+    EXPECT_EQ(lowered_runs + 1, GetLoweredRuns()) << "run " << i;
+
+    for (u32 reg = 0; reg < 32; ++reg)
+      EXPECT_EQ(expected[reg], result[reg]) << "run " << i << ", r" << reg;
+  }
+}
+
+TEST_F(Jit64IRTest, RunsWithoutRedundantOperationsAreNotLowered)
+{
+  const u64 lowered_runs = GetLoweredRuns();
+  Run({XForm(31, 5, 3, 4, 266), DForm(14, 6, 5, 1), XForm(31, 7, 6, 3, 40)}, true);
+  EXPECT_EQ(lowered_runs, GetLoweredRuns());
+}
+
+class Jit64IRSpeedTest : public Jit64IRTest, public testing::WithParamInterface<bool>
+{
+};
+
+INSTANTIATE_TEST_CASE_P(Lowering, Jit64IRSpeedTest, testing::Bool());
+
+TEST_P(Jit64IRSpeedTest, RedundantArithmetic)
+{
+  const bool lower = GetParam();
+  const u32 end_address = WriteCode(s_loop, lower);
+  rGPR[3] = 0x10000;
+  rGPR[4] = 3;
+  rGPR[10] = 0;
+  rGPR[14] = 0;
+  rGPR[20] = 0;
+  rGPR[21] = 20000000;
+  RunUntil(end_address);
+  EXPECT_EQ(20000000u, rGPR[20]);
+  EXPECT_EQ(0u, rGPR[10]);
+
+  u32 address = CODE_ADDRESS;
+  const u8* code;
+  u32 code_size;
+  JitInterface::GetHostCode(&address, &code, &code_size);
+  printf("lowering: %s, host code of the loop: %u bytes\n", lower ? "on" : "off", code_size);
+}
@@ -0,0 +1,194 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/BitSet.h"
+#include "Common/CommonTypes.h"
+#include "Core/PowerPC/JitCommon/JitIR.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+
+using namespace JitIR;
+
+namespace
+{
+class CodeBuilder
+{
+public:
+  void Addi(u32 d, u32 a, s16 imm)
+  {
+    Emit((14 << 26) | (d << 21) | (a << 16) | u16(imm), a ? BitSet32{int(a)} : BitSet32{},
+        BitSet32{int(d)});
+  }
+  void Add(u32 d, u32 a, u32 b)
+  {
+    Emit((31 << 26) | (d << 21) | (a << 16) | (b << 11) | (266 << 1), BitSet32{int(a), int(b)},
+        BitSet32{int(d)});
+  }
+  void Mr(u32 a, u32 s)
+  {
+    Emit((31 << 26) | (s << 21) | (a << 16) | (s << 11) | (444 << 1), BitSet32{int(s)},
+        BitSet32{int(a)});
+  }
+  // A load, which the IR doesn't model.
+  void Lwz(u32 d, u32 a)
+  {
+    Emit((32 << 26) | (d << 21) | (a << 16), BitSet32{int(a)}, BitSet32{int(d)});
+  }
+
+  Block Build() const { return Block(m_ops.data(), static_cast<u32>(m_ops.size())); }
+  Block BuildRun(u32* num_translated) const
+  {
+    return Block::FromRun(m_ops.data(), static_cast<u32>(m_ops.size()), num_translated);
+  }
+
+private:
+  void Emit(u32 hex, BitSet32 regs_in, BitSet32 regs_out)
+  {
+    PPCAnalyst::CodeOp op{};
+    op.inst.hex = hex;
+    op.address = 0x80000000 + static_cast<u32>(m_ops.size()) * 4;
+    op.regsIn = regs_in;
+    op.regsOut = regs_out;
+    m_ops.push_back(op);
+  }
+
+  std::vector<PPCAnalyst::CodeOp> m_ops;
+};
+
+// Returns the value which is stored to the register, or nullptr if it isn't stored.
+const Instruction* GetStoredValue(const Block& block, u32 reg)
+{
+  const Instruction* value = nullptr;
+  for (const Instruction& instruction : block.GetInstructions())
+  {
+    if (!instruction.removed && instruction.opcode == Opcode::StoreGPR && instruction.imm == reg)
+      value = &block.GetInstructions()[instruction.a];
+  }
+  return value;
+}
+}  // namespace
+
+TEST(JitIR, FoldsConstants)
+{
+  CodeBuilder code;
+  code.Addi(3, 0, 5);
+  code.Addi(4, 3, 7);
+  Block block = code.Build();
+  block.Optimize();
+
+  // const 5, store r3, const 12, store r4, exit
+  EXPECT_EQ(5u, block.GetInstructionCount());
+  const Instruction* r4 = GetStoredValue(block, 4);
+  ASSERT_NE(nullptr, r4);
+  EXPECT_EQ(Opcode::Const, r4->opcode);
+  EXPECT_EQ(12u, r4->imm);
+}
+
+TEST(JitIR, ForwardsLoadsAndStores)
+{
+  CodeBuilder code;
+  code.Mr(4, 3);
+  code.Mr(5, 4);
+  code.Mr(3, 5);
+  Block block = code.Build();
+  block.Optimize();
+
+  // load r3, store r4, store r5, exit. Storing r3 back to itself is removed.
+  EXPECT_EQ(4u, block.GetInstructionCount());
+  EXPECT_EQ(nullptr, GetStoredValue(block, 3));
+  const Instruction* r5 = GetStoredValue(block, 5);
+  ASSERT_NE(nullptr, r5);
+  EXPECT_EQ(Opcode::LoadGPR, r5->opcode);
+  EXPECT_EQ(3u, r5->imm);
+}
+
+TEST(JitIR, EliminatesCommonSubexpressions)
+{
+  CodeBuilder code;
+  code.Add(5, 3, 4);
+  code.Add(6, 4, 3);
+  Block block = code.Build();
+  block.Optimize();
+
+  // load r3, load r4, add, store r5, store r6, exit
+  EXPECT_EQ(6u, block.GetInstructionCount());
+  EXPECT_EQ(GetStoredValue(block, 5), GetStoredValue(block, 6));
+}
+
+TEST(JitIR, EliminatesDeadStores)
+{
+  CodeBuilder code;
+  code.Addi(3, 3, 1);
+  code.Addi(3, 3, 1);
+  Block block = code.Build();
+  block.Optimize();
+
+  // load r3, const 1, add, add, store r3, exit
+  EXPECT_EQ(6u, block.GetInstructionCount());
+}
+
+TEST(JitIR, OpaqueInstructionsAreBarriers)
+{
+  CodeBuilder code;
+  code.Addi(3, 3, 1);
+  code.Lwz(4, 3);
+  code.Addi(3, 3, 1);
+  code.Mr(5, 4);
+  Block block = code.Build();
+  const size_t count = block.GetInstructionCount();
+  block.Optimize();
+
+  // The load may raise an exception, so the first store to r3 must be kept, and r4 must be loaded
+  // again after the load wrote it.
+  size_t stores = 0;
+  size_t loads_of_r4 = 0;
+  for (const Instruction& instruction : block.GetInstructions())
+  {
+    if (instruction.removed)
+      continue;
+    stores += instruction.opcode == Opcode::StoreGPR && instruction.imm == 3;
+    loads_of_r4 += instruction.opcode == Opcode::LoadGPR && instruction.imm == 4;
+  }
+  EXPECT_EQ(2u, stores);
+  EXPECT_EQ(1u, loads_of_r4);
+  EXPECT_LT(block.GetInstructionCount(), count);
+}
+
+TEST(JitIR, RunsEndAtInstructionsWhichArentModeled)
+{
+  CodeBuilder code;
+  code.Addi(3, 3, 1);
+  code.Add(4, 3, 3);
+  code.Lwz(5, 4);
+  code.Addi(3, 3, 1);
+  u32 num_translated;
+  const Block block = code.BuildRun(&num_translated);
+
+  EXPECT_EQ(2u, num_translated);
+  for (const Instruction& instruction : block.GetInstructions())
+    EXPECT_NE(Opcode::Opaque, instruction.opcode);
+}
+
+TEST(JitIR, FoldsInitialValues)
+{
+  CodeBuilder code;
+  code.Add(4, 3, 3);
+  code.Addi(3, 3, 1);
+  code.Add(5, 3, 3);
+  u32 num_translated;
+  Block block = code.BuildRun(&num_translated);
+  block.SetInitialValue(3, 5);
+  block.Optimize();
+
+  // const 10, store r4, const 6, store r3, const 12, store r5, exit
+  EXPECT_EQ(7u, block.GetInstructionCount());
+  EXPECT_EQ(0u, block.GetOperationCount());
+  const Instruction* r5 = GetStoredValue(block, 5);
+  ASSERT_NE(nullptr, r5);
+  EXPECT_EQ(Opcode::Const, r5->opcode);
+  EXPECT_EQ(12u, r5->imm);
+}
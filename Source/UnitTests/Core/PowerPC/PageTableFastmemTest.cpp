@@ -0,0 +1,281 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Common/Metrics.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
+#include "Core/HW/WriteTracker.h"
+#include "Core/MemTools.h"
+#include "Core/PowerPC/MMU.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+constexpr u32 CODE_ADDRESS = 0x00003000;
+// A 64 KiB page table, the smallest possible.
+constexpr u32 PAGE_TABLE_ADDRESS = 0x00100000;
+constexpr u32 PAGE_TABLE_HASH_MASK = 0x3ff;
+
+constexpr u32 NUM_PAGES = 16;
+// The loop below accesses each page of two segments, which the page table translates to these
+// physical addresses.
+constexpr u32 SEGMENT_1_ADDRESS = 0x10000000;
+constexpr u32 SEGMENT_2_ADDRESS = 0x20000000;
+constexpr u32 VSID_1 = 0x111;
+constexpr u32 VSID_2 = 0x222;
+constexpr u32 VSID_3 = 0x333;
+constexpr u32 PHYSICAL_ADDRESS_1 = 0x00200000;
+constexpr u32 PHYSICAL_ADDRESS_2 = 0x00300000;
+constexpr u32 PHYSICAL_ADDRESS_3 = 0x00400000;
+
+constexpr u32 PTE1_V = 0x80000000;
+constexpr u32 PTE2_R = 0x100;
+constexpr u32 PTE2_C = 0x80;
+constexpr u32 PTE2_PP_READ_WRITE = 0x2;
+
+u32 DForm(u32 opcode, u32 d, u32 a, u32 imm)
+{
+  return opcode << 26 | d << 21 | a << 16 | (imm & 0xFFFF);
+}
+
+// Increments the first word of NUM_PAGES pages starting at r3, and of as many pages starting at
+// r7. Finishes at the returned address.
+u32 WritePageLoop(u32 address)
+{
+  const std::vector<u32> code = {
+      DForm(32, 4, 3, 0),            // 0x00: lwz r4, 0(r3)
+      DForm(14, 4, 4, 1),            // 0x04: addi r4, r4, 1
+      DForm(36, 4, 3, 0),            // 0x08: stw r4, 0(r3)
+      DForm(32, 8, 7, 0),            // 0x0c: lwz r8, 0(r7)
+      DForm(14, 8, 8, 1),            // 0x10: addi r8, r8, 1
+      DForm(36, 8, 7, 0),            // 0x14: stw r8, 0(r7)
+      DForm(14, 3, 3, 0x1000),       // 0x18: addi r3, r3, 0x1000
+      DForm(14, 7, 7, 0x1000),       // 0x1c: addi r7, r7, 0x1000
+      DForm(14, 6, 6, 1),            // 0x20: addi r6, r6, 1
+      31 << 26 | 6 << 16 | 5 << 11,  // 0x24: cmpw r6, r5
+      DForm(16, 12, 0, -0x28),       // 0x28: blt 0x00
+      18 << 26,                      // 0x2c: b 0x2c
+  };
+  for (size_t i = 0; i < code.size(); ++i)
+    Memory::Write_U32(code[i], address + static_cast<u32>(i * 4));
+  return address + 0x2c;
+}
+
+u64 GetCounter(const std::string& name)
+{
+  u64 value = 0;
+  Common::Metrics::ForEachMetric([&](const Common::Metrics::Metric& metric) {
+    if (metric.GetName() == name)
+      value = static_cast<const Common::Metrics::Counter&>(metric).GetValue();
+  });
+  return value;
+}
+
+class PageTableFastmemTest : public testing::Test
+{
+protected:
+  void TearDown() override
+  {
+    if (!m_initialized)
+      return;
+    CoreTiming::Shutdown();
+    PowerPC::Shutdown();
+    WriteTracker::SetEnabled(false);
+    WriteTracker::SetExceptionHandlerInstalled(false);
+    EMM::UninstallExceptionHandler();
+    Memory::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    Core::UndeclareAsCPUThread();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  void Init(bool fastmem)
+  {
+    m_profile_path = File::CreateTempDir();
+    Core::DeclareAsCPUThread();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    SConfig::GetInstance().bMMU = true;
+    SConfig::GetInstance().bFastmem = fastmem;
+    Memory::Init();
+    EMM::InstallExceptionHandler();
+    WriteTracker::SetExceptionHandlerInstalled(true);
+    PowerPC::Init(PowerPC::CPUCore::JIT64);
+    CoreTiming::Init();
+    m_initialized = true;
+
+    for (u32 i = 0; i < NUM_PAGES; ++i)
+    {
+      const u32 offset = i * 0x1000;
+      AddPageTableEntry(VSID_1, SEGMENT_1_ADDRESS + offset, PHYSICAL_ADDRESS_1 + offset, 0);
+      AddPageTableEntry(VSID_2, SEGMENT_2_ADDRESS + offset, PHYSICAL_ADDRESS_2 + offset, 0);
+      AddPageTableEntry(VSID_3, SEGMENT_1_ADDRESS + offset, PHYSICAL_ADDRESS_3 + offset,
+                        PTE2_R | PTE2_C);
+    }
+    PowerPC::ppcState.spr[SPR_SDR] = PAGE_TABLE_ADDRESS;
+    PowerPC::SDRUpdated();
+    PowerPC::ppcState.SetSR(SEGMENT_1_ADDRESS >> 28, VSID_1);
+    PowerPC::ppcState.SetSR(SEGMENT_2_ADDRESS >> 28, VSID_2);
+
+    // Instructions are fetched in real mode, and data is translated through the page table.
+    MSR.Hex = 0;
+    MSR.DR = 1;
+    m_end_address = WritePageLoop(CODE_ADDRESS);
+  }
+
+  void RunLoop() const
+  {
+    rGPR[3] = SEGMENT_1_ADDRESS;
+    rGPR[5] = NUM_PAGES;
+    rGPR[6] = 0;
+    rGPR[7] = SEGMENT_2_ADDRESS;
+    PC = CODE_ADDRESS;
+    NPC = CODE_ADDRESS + 4;
+    for (int i = 0; i < 1000 && PC != m_end_address; ++i)
+      PowerPC::SingleStep();
+    ASSERT_EQ(m_end_address, PC);
+  }
+
+  static void AddPageTableEntry(u32 vsid, u32 effective_address, u32 physical_address,
+                                u32 pte2_bits)
+  {
+    const u32 page_index = (effective_address >> 12) & 0xffff;
+    const u32 pteg_address = PAGE_TABLE_ADDRESS | ((vsid ^ page_index) & PAGE_TABLE_HASH_MASK) << 6;
+    for (u32 i = 0; i < 8; ++i)
+    {
+      const u32 pte_address = pteg_address + i * 8;
+      if (Memory::Read_U32(pte_address) & PTE1_V)
+        continue;
+
+      Memory::Write_U32(PTE1_V | vsid << 7 | page_index >> 10, pte_address);
+      Memory::Write_U32(physical_address | pte2_bits | PTE2_PP_READ_WRITE, pte_address + 4);
+      return;
+    }
+    FAIL() << "PTEG full";
+  }
+
+  static u32 GetPTE2(u32 vsid, u32 effective_address)
+  {
+    const u32 page_index = (effective_address >> 12) & 0xffff;
+    const u32 pteg_address = PAGE_TABLE_ADDRESS | ((vsid ^ page_index) & PAGE_TABLE_HASH_MASK) << 6;
+    for (u32 i = 0; i < 8; ++i)
+    {
+      if (Memory::Read_U32(pteg_address + i * 8) == (PTE1_V | vsid << 7 | page_index >> 10))
+        return Memory::Read_U32(pteg_address + i * 8 + 4);
+    }
+    return 0;
+  }
+
+  static void ExpectCounters(u32 physical_address, u32 expected)
+  {
+    for (u32 i = 0; i < NUM_PAGES; ++i)
+      EXPECT_EQ(expected, Memory::Read_U32(physical_address + i * 0x1000)) << "page " << i;
+  }
+
+  static void InvalidateTLB()
+  {
+    for (auto& tlb : PowerPC::ppcState.tlb)
+      tlb.fill({});
+  }
+
+private:
+  std::string m_profile_path;
+  bool m_initialized = false;
+  u32 m_end_address = 0;
+};
+}  // namespace
+
+TEST_F(PageTableFastmemTest, MapsPagesAsTheyAreUsed)
+{
+  Init(true);
+  if (!Memory::CanMapPageTableEntries())
+    return;
+
+  const u64 backpatches = GetCounter("cpu.jit_backpatches");
+  const u64 faults = GetCounter("cpu.jit_page_table_faults");
+
+  // The first accesses to each page fault. The load takes the slow path once, which sets the R bit
+  // and maps the page read-only, and the store takes it once to set the C bit.
+  RunLoop();
+  ExpectCounters(PHYSICAL_ADDRESS_1, 1);
+  ExpectCounters(PHYSICAL_ADDRESS_2, 1);
+  for (u32 i = 0; i < NUM_PAGES; ++i)
+  {
+    EXPECT_EQ(PTE2_R | PTE2_C, GetPTE2(VSID_1, SEGMENT_1_ADDRESS + i * 0x1000) & (PTE2_R | PTE2_C));
+    EXPECT_EQ(PTE2_R | PTE2_C, GetPTE2(VSID_2, SEGMENT_2_ADDRESS + i * 0x1000) & (PTE2_R | PTE2_C));
+  }
+  EXPECT_EQ(4 * NUM_PAGES, GetCounter("cpu.jit_page_table_faults") - faults);
+
+  // All pages are mapped now.
+  RunLoop();
+  ExpectCounters(PHYSICAL_ADDRESS_1, 2);
+  ExpectCounters(PHYSICAL_ADDRESS_2, 2);
+  EXPECT_EQ(4 * NUM_PAGES, GetCounter("cpu.jit_page_table_faults") - faults);
+
+  // Changing a segment register only unmaps the pages of that segment. Their new entries have the
+  // R and C bits set, so they are mapped on the first fault.
+  PowerPC::ppcState.SetSR(SEGMENT_1_ADDRESS >> 28, VSID_3);
+  InvalidateTLB();
+  RunLoop();
+  ExpectCounters(PHYSICAL_ADDRESS_1, 2);
+  ExpectCounters(PHYSICAL_ADDRESS_2, 3);
+  ExpectCounters(PHYSICAL_ADDRESS_3, 1);
+  EXPECT_EQ(5 * NUM_PAGES, GetCounter("cpu.jit_page_table_faults") - faults);
+
+  // None of the accesses were sent to the slow path for good.
+  EXPECT_EQ(backpatches, GetCounter("cpu.jit_backpatches"));
+}
+
+TEST_F(PageTableFastmemTest, WriteTrackingSeesWritesToReadOnlyPages)
+{
+  Init(true);
+  WriteTracker::SetEnabled(true);
+  if (!Memory::CanMapPageTableEntries() || !WriteTracker::IsEnabled())
+    return;
+
+  // The loads map the pages read-only, and the stores make them writable.
+  const u64 stamp = WriteTracker::Protect(PHYSICAL_ADDRESS_1, NUM_PAGES * 0x1000);
+  ASSERT_NE(0u, stamp);
+  RunLoop();
+  ExpectCounters(PHYSICAL_ADDRESS_1, 1);
+  EXPECT_FALSE(WriteTracker::IsUnmodified(PHYSICAL_ADDRESS_1, NUM_PAGES * 0x1000, stamp));
+
+  // The pages are writable now, and protecting them again still catches the writes.
+  const u64 second_stamp = WriteTracker::Protect(PHYSICAL_ADDRESS_1, NUM_PAGES * 0x1000);
+  RunLoop();
+  ExpectCounters(PHYSICAL_ADDRESS_1, 2);
+  for (u32 i = 0; i < NUM_PAGES; ++i)
+    EXPECT_FALSE(WriteTracker::IsUnmodified(PHYSICAL_ADDRESS_1 + i * 0x1000, 4, second_stamp));
+}
+
+class PageTableFastmemSpeedTest : public PageTableFastmemTest,
+                                  public testing::WithParamInterface<bool>
+{
+};
+
+INSTANTIATE_TEST_CASE_P(FastmemAndSlowmem, PageTableFastmemSpeedTest, testing::Bool());
+
+TEST_P(PageTableFastmemSpeedTest, PageLoop)
+{
+  const bool fastmem = GetParam();
+  printf("fastmem: %s\n", fastmem ? "on" : "off");
+
+  Init(fastmem);
+  for (int i = 0; i < 200000; ++i)
+    RunLoop();
+}
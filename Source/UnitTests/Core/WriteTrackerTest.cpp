@@ -0,0 +1,223 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/HW/WriteTracker.h"
+#include "Core/MemTools.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+constexpr u32 TEXTURE_ADDRESS = 0x00100000;
+constexpr u32 TEXTURE_SIZE = 0x8000;
+
+// Tests return early where write tracking (or fastmem) is not supported.
+class WriteTrackerTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_profile_path = File::CreateTempDir();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    Memory::Init();
+    EMM::InstallExceptionHandler();
+    WriteTracker::SetExceptionHandlerInstalled(true);
+    WriteTracker::SetEnabled(true);
+  }
+
+  void TearDown() override
+  {
+    WriteTracker::SetEnabled(false);
+    WriteTracker::SetExceptionHandlerInstalled(false);
+    EMM::UninstallExceptionHandler();
+    Memory::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  std::string GetFilePath() const { return m_profile_path + "/file.bin"; }
+
+private:
+  std::string m_profile_path;
+};
+}  // namespace
+
+TEST_F(WriteTrackerTest, UnwrittenRangeIsUnmodified)
+{
+  if (!WriteTracker::IsEnabled())
+    return;
+
+  const u64 stamp = WriteTracker::Protect(TEXTURE_ADDRESS, TEXTURE_SIZE);
+  ASSERT_NE(0u, stamp);
+  EXPECT_TRUE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE, stamp));
+
+  // Reads, and writes to other pages, leave the range alone.
+  EXPECT_EQ(0u, Memory::Read_U32(TEXTURE_ADDRESS));
+  Memory::Write_U32(0x12345678, TEXTURE_ADDRESS + TEXTURE_SIZE + 0x10000);
+  EXPECT_TRUE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE, stamp));
+  // Mirrors of the same physical address share the tracking state.
+  EXPECT_TRUE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS | 0x80000000, TEXTURE_SIZE, stamp));
+}
+
+TEST_F(WriteTrackerTest, WriteIsDetected)
+{
+  if (!WriteTracker::IsEnabled())
+    return;
+
+  const u64 stamp = WriteTracker::Protect(TEXTURE_ADDRESS, TEXTURE_SIZE);
+  Memory::Write_U32(0x12345678, TEXTURE_ADDRESS + TEXTURE_SIZE - 4);
+  EXPECT_EQ(0x12345678u, Memory::Read_U32(TEXTURE_ADDRESS + TEXTURE_SIZE - 4));
+  EXPECT_FALSE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE, stamp));
+
+  // Protecting again gives a new stamp, but the old one stays invalid.
+  const u64 new_stamp = WriteTracker::Protect(TEXTURE_ADDRESS, TEXTURE_SIZE);
+  EXPECT_TRUE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE, new_stamp));
+  EXPECT_FALSE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE, stamp));
+}
+
+TEST_F(WriteTrackerTest, OverlappingRanges)
+{
+  if (!WriteTracker::IsEnabled())
+    return;
+
+  const u64 first = WriteTracker::Protect(TEXTURE_ADDRESS, TEXTURE_SIZE / 2);
+  const u64 second = WriteTracker::Protect(TEXTURE_ADDRESS, TEXTURE_SIZE);
+  EXPECT_TRUE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE / 2, first));
+  EXPECT_TRUE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE, second));
+  // The second half was not protected when the first stamp was taken.
+  EXPECT_FALSE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE, first));
+
+  Memory::Write_U8(1, TEXTURE_ADDRESS + TEXTURE_SIZE - 1);
+  EXPECT_TRUE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE / 2, first));
+  EXPECT_FALSE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE, second));
+}
+
+TEST_F(WriteTrackerTest, ExternalWrites)
+{
+  if (!WriteTracker::IsEnabled())
+    return;
+
+  const std::array<u8, 16> data{1, 2, 3, 4};
+
+  u64 stamp = WriteTracker::Protect(TEXTURE_ADDRESS, TEXTURE_SIZE);
+  Memory::CopyToEmu(TEXTURE_ADDRESS + 0x100, data.data(), data.size());
+  EXPECT_FALSE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE, stamp));
+
+  stamp = WriteTracker::Protect(TEXTURE_ADDRESS, TEXTURE_SIZE);
+  Memory::Memset(TEXTURE_ADDRESS, 0xFF, 4);
+  EXPECT_FALSE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE, stamp));
+
+  {
+    WriteTracker::ScopedExternalWrite external_write(TEXTURE_ADDRESS, TEXTURE_SIZE);
+    // The range cannot be protected while it is being written.
+    stamp = WriteTracker::Protect(TEXTURE_ADDRESS, TEXTURE_SIZE);
+    EXPECT_FALSE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE, stamp));
+  }
+
+  stamp = WriteTracker::Protect(TEXTURE_ADDRESS, TEXTURE_SIZE);
+  EXPECT_TRUE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE, stamp));
+}
+
+TEST_F(WriteTrackerTest, FileReadIntoTrackedRange)
+{
+  if (!WriteTracker::IsEnabled())
+    return;
+
+  std::vector<u8> data(TEXTURE_SIZE);
+  for (size_t i = 0; i < data.size(); i++)
+    data[i] = static_cast<u8>(i * 7);
+  ASSERT_TRUE(File::IOFile(GetFilePath(), "wb").WriteBytes(data.data(), data.size()));
+
+  // The read is large enough for the kernel to write to emulated memory directly, which fails
+  // instead of faulting if the pages are still protected.
+  const u64 stamp = WriteTracker::Protect(TEXTURE_ADDRESS, TEXTURE_SIZE);
+  {
+    File::IOFile file(GetFilePath(), "rb");
+    WriteTracker::ScopedExternalWrite external_write(TEXTURE_ADDRESS, TEXTURE_SIZE);
+    ASSERT_TRUE(file.ReadBytes(Memory::GetPointer(TEXTURE_ADDRESS), TEXTURE_SIZE));
+  }
+  EXPECT_FALSE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE, stamp));
+
+  std::vector<u8> read(TEXTURE_SIZE);
+  Memory::CopyFromEmu(read.data(), TEXTURE_ADDRESS, TEXTURE_SIZE);
+  EXPECT_EQ(data, read);
+}
+
+TEST_F(WriteTrackerTest, FastmemWriteIsDetected)
+{
+  if (!WriteTracker::IsEnabled() || !Memory::InitFastmemArena())
+    return;
+
+  const u64 stamp = WriteTracker::Protect(TEXTURE_ADDRESS, TEXTURE_SIZE);
+  *reinterpret_cast<volatile u32*>(Memory::physical_base + TEXTURE_ADDRESS + 8) = 0x12345678;
+  EXPECT_EQ(0x78563412u, Memory::Read_U32(TEXTURE_ADDRESS + 8));
+  EXPECT_FALSE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE, stamp));
+
+  Memory::ShutdownFastmemArena();
+}
+
+TEST_F(WriteTrackerTest, NewViewsAreProtected)
+{
+  if (!WriteTracker::IsEnabled() || !Memory::InitFastmemArena())
+    return;
+  if (!Memory::CanMapPageTableEntries())
+  {
+    Memory::ShutdownFastmemArena();
+    return;
+  }
+
+  constexpr u32 logical_address = 0x40000000;
+  const u64 stamp = WriteTracker::Protect(TEXTURE_ADDRESS, TEXTURE_SIZE);
+  Memory::MapPageTableEntry(logical_address, TEXTURE_ADDRESS + 0x1000, true);
+  EXPECT_TRUE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE, stamp));
+
+  *reinterpret_cast<volatile u32*>(Memory::logical_base + logical_address + 8) = 0x12345678;
+  EXPECT_EQ(0x78563412u, Memory::Read_U32(TEXTURE_ADDRESS + 0x1008));
+  EXPECT_FALSE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE, stamp));
+
+  Memory::ShutdownFastmemArena();
+}
+
+TEST_F(WriteTrackerTest, UntrackedFaultIsNotClaimed)
+{
+  if (!WriteTracker::IsEnabled())
+    return;
+
+  WriteTracker::Protect(TEXTURE_ADDRESS, TEXTURE_SIZE);
+  const auto tracked = reinterpret_cast<uintptr_t>(Memory::GetPointer(TEXTURE_ADDRESS));
+  const auto untracked =
+      reinterpret_cast<uintptr_t>(Memory::GetPointer(TEXTURE_ADDRESS + TEXTURE_SIZE));
+
+  // Another thread could have lifted the protection just before the fault was handled, so the
+  // access is retried once. If it faults again, the fault is left to the next handler.
+  EXPECT_TRUE(WriteTracker::HandleFault(untracked));
+  EXPECT_FALSE(WriteTracker::HandleFault(untracked));
+
+  EXPECT_TRUE(WriteTracker::HandleFault(tracked));
+  Memory::Write_U32(0x12345678, TEXTURE_ADDRESS);
+  EXPECT_EQ(0x12345678u, Memory::Read_U32(TEXTURE_ADDRESS));
+}
+
+TEST_F(WriteTrackerTest, Disabled)
+{
+  WriteTracker::SetEnabled(false);
+  const u64 stamp = WriteTracker::Protect(TEXTURE_ADDRESS, TEXTURE_SIZE);
+  EXPECT_EQ(0u, stamp);
+  EXPECT_FALSE(WriteTracker::IsUnmodified(TEXTURE_ADDRESS, TEXTURE_SIZE, stamp));
+  Memory::Write_U32(0x12345678, TEXTURE_ADDRESS);
+}
@@ -0,0 +1,139 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Image.h"
+#include "VideoCommon/CustomTexturePack.h"
+#include "VideoCommon/HiresTextures.h"
+
+namespace
+{
+constexpr char TEXTURE_NAME[] = "tex1_4x4_0123456789abcdef_5";
+constexpr char MIPMAP_NAME[] = "tex1_4x4_0123456789abcdef_5_mip1";
+constexpr char ARBITRARY_MIPMAP_NAME[] = "tex1_8x8_m_fedcba9876543210_14";
+
+std::vector<u8> MakeImage(u32 width, u32 height, u8 seed)
+{
+  std::vector<u8> image(width * height * 4);
+  for (size_t i = 0; i < image.size(); i++)
+    image[i] = static_cast<u8>(seed + i * 7);
+  return image;
+}
+
+class CustomTexturePackTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_directory = File::CreateTempDir();
+    m_pack_path = m_directory + "/textures.texpack";
+  }
+
+  void TearDown() override { File::DeleteDirRecursively(m_directory); }
+
+  void SaveImage(const std::string& filename, const std::vector<u8>& image, u32 width, u32 height)
+  {
+    File::CreateFullPath(m_directory + "/textures/");
+    ASSERT_TRUE(Common::SavePNG(m_directory + "/textures/" + filename, image.data(),
+                                Common::ImageByteFormat::RGBA, width, height));
+  }
+
+  std::string m_directory;
+  std::string m_pack_path;
+};
+}  // namespace
+
+TEST(HiresTextureNameTest, GetNameFromPath)
+{
+  std::string name;
+  bool has_arbitrary_mipmaps;
+  EXPECT_TRUE(HiresTexture::GetNameFromPath("a/b/tex1_4x4_0123456789abcdef_5_arb.png", &name,
+                                            &has_arbitrary_mipmaps));
+  EXPECT_EQ("tex1_4x4_0123456789abcdef_5", name);
+  EXPECT_TRUE(has_arbitrary_mipmaps);
+
+  EXPECT_TRUE(HiresTexture::GetNameFromPath("a/tex1_4x4_0123456789abcdef_5_mip2.dds", &name,
+                                            &has_arbitrary_mipmaps));
+  EXPECT_EQ("tex1_4x4_0123456789abcdef_5_mip2", name);
+  EXPECT_FALSE(has_arbitrary_mipmaps);
+  EXPECT_EQ(2u, HiresTexture::GetMipLevelFromName(name));
+
+  EXPECT_FALSE(HiresTexture::GetNameFromPath("a/readme.png", &name, &has_arbitrary_mipmaps));
+  EXPECT_EQ(0u, HiresTexture::GetMipLevelFromName("tex1_4x4_0123456789abcdef_5"));
+}
+
+TEST_F(CustomTexturePackTest, BuildAndLoad)
+{
+  const std::vector<u8> level0 = MakeImage(4, 4, 1);
+  const std::vector<u8> level1 = MakeImage(2, 2, 2);
+  const std::vector<u8> arbitrary = MakeImage(8, 8, 3);
+  SaveImage(std::string(TEXTURE_NAME) + ".png", level0, 4, 4);
+  SaveImage(std::string(MIPMAP_NAME) + ".png", level1, 2, 2);
+  SaveImage(std::string(ARBITRARY_MIPMAP_NAME) + "_arb.png", arbitrary, 8, 8);
+  SaveImage("not_a_texture.png", level0, 4, 4);
+
+  std::string error;
+  ASSERT_TRUE(CustomTexturePack::Build(m_directory + "/textures", m_pack_path, 3, &error))
+      << error;
+
+  const std::unique_ptr<CustomTexturePack> pack = CustomTexturePack::Open(m_pack_path);
+  ASSERT_TRUE(pack);
+  ASSERT_EQ(3u, pack->GetTextureCount());
+  EXPECT_FALSE(pack->FindTexture("tex1_4x4_0123456789abcdef_6"));
+
+  const std::optional<size_t> texture = pack->FindTexture(TEXTURE_NAME);
+  ASSERT_TRUE(texture);
+  EXPECT_EQ(TEXTURE_NAME, pack->GetTextureName(*texture));
+  EXPECT_FALSE(pack->HasArbitraryMipmaps(*texture));
+
+  std::vector<HiresTexture::Level> levels;
+  ASSERT_TRUE(pack->LoadLevels(*texture, &levels));
+  ASSERT_EQ(1u, levels.size());
+  EXPECT_EQ(AbstractTextureFormat::RGBA8, levels[0].format);
+  EXPECT_EQ(4u, levels[0].width);
+  EXPECT_EQ(4u, levels[0].height);
+  EXPECT_EQ(4u, levels[0].row_length);
+  EXPECT_EQ(level0, levels[0].data);
+
+  // Mipmaps from separate files are stored under their own names, and appended.
+  const std::optional<size_t> mipmap = pack->FindTexture(MIPMAP_NAME);
+  ASSERT_TRUE(mipmap);
+  ASSERT_TRUE(pack->LoadLevels(*mipmap, &levels));
+  ASSERT_EQ(2u, levels.size());
+  EXPECT_EQ(2u, levels[1].width);
+  EXPECT_EQ(level1, levels[1].data);
+
+  const std::optional<size_t> arbitrary_texture = pack->FindTexture(ARBITRARY_MIPMAP_NAME);
+  ASSERT_TRUE(arbitrary_texture);
+  EXPECT_TRUE(pack->HasArbitraryMipmaps(*arbitrary_texture));
+}
+
+TEST_F(CustomTexturePackTest, RejectsInvalidFiles)
+{
+  EXPECT_FALSE(CustomTexturePack::Open(m_pack_path));
+
+  File::IOFile file(m_pack_path, "wb");
+  const std::vector<u8> garbage = MakeImage(4, 4, 0);
+  ASSERT_TRUE(file.WriteBytes(garbage.data(), garbage.size()));
+  file.Close();
+  EXPECT_FALSE(CustomTexturePack::Open(m_pack_path));
+
+  // A valid pack cut off before its index.
+  std::string error;
+  SaveImage(std::string(TEXTURE_NAME) + ".png", MakeImage(4, 4, 1), 4, 4);
+  ASSERT_TRUE(CustomTexturePack::Build(m_directory + "/textures", m_pack_path, 3, &error));
+  File::IOFile pack_file(m_pack_path, "r+b");
+  ASSERT_TRUE(pack_file.Resize(pack_file.GetSize() - 1));
+  pack_file.Close();
+  EXPECT_FALSE(CustomTexturePack::Open(m_pack_path));
+}
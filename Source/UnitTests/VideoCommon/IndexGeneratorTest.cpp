@@ -0,0 +1,129 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/OpcodeDecoding.h"
+
+namespace
+{
+// No primitive uses more than 3 indices per vertex, plus a few for the last primitive.
+constexpr u32 MAX_VERTICES = 300;
+constexpr u32 MAX_INDICES = MAX_VERTICES * 3 + 8;
+
+// Marks the indices which were not written.
+constexpr u16 UNWRITTEN = 0xCDCD;
+
+constexpr int PRIMITIVES[] = {
+    OpcodeDecoder::GX_DRAW_QUADS,          OpcodeDecoder::GX_DRAW_QUADS_2,
+    OpcodeDecoder::GX_DRAW_TRIANGLES,      OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP,
+    OpcodeDecoder::GX_DRAW_TRIANGLE_FAN,   OpcodeDecoder::GX_DRAW_LINES,
+    OpcodeDecoder::GX_DRAW_LINE_STRIP,     OpcodeDecoder::GX_DRAW_POINTS,
+};
+
+std::vector<u16> GenerateIndices(bool primitive_restart, bool vectorized, int primitive,
+                                 u32 base_vertex, u32 num_vertices)
+{
+  std::vector<u16> indices(MAX_INDICES, UNWRITTEN);
+  IndexGenerator generator;
+  generator.Init(primitive_restart, vectorized);
+  generator.Start(indices.data());
+
+  // Start with a primitive which does not fill a block, so the indices are not aligned.
+  generator.AddIndices(OpcodeDecoder::GX_DRAW_POINTS, base_vertex);
+  generator.AddIndices(primitive, num_vertices);
+
+  const u32 length = generator.GetIndexLen();
+  for (u32 i = length; i < MAX_INDICES; ++i)
+    EXPECT_EQ(UNWRITTEN, indices[i]) << "Index " << i << " was written past the end";
+  indices.resize(length);
+  return indices;
+}
+
+void ExpectSameIndices(bool primitive_restart, u32 base_vertex)
+{
+  for (const int primitive : PRIMITIVES)
+  {
+    for (u32 num_vertices = 0; num_vertices <= MAX_VERTICES; ++num_vertices)
+    {
+      SCOPED_TRACE(testing::Message() << "primitive " << primitive << ", base vertex "
+                                      << base_vertex << ", " << num_vertices << " vertices");
+      EXPECT_EQ(GenerateIndices(primitive_restart, false, primitive, base_vertex, num_vertices),
+                GenerateIndices(primitive_restart, true, primitive, base_vertex, num_vertices));
+    }
+  }
+}
+}  // namespace
+
+TEST(IndexGenerator, VectorizedMatchesScalar)
+{
+  for (const u32 base_vertex : {0, 1, 3, 7})
+    ExpectSameIndices(false, base_vertex);
+}
+
+TEST(IndexGenerator, VectorizedMatchesScalarWithPrimitiveRestart)
+{
+  for (const u32 base_vertex : {0, 1, 3, 7})
+    ExpectSameIndices(true, base_vertex);
+}
+
+TEST(IndexGenerator, Quads)
+{
+  IndexGenerator generator;
+  generator.Init(false, true);
+  std::vector<u16> indices(MAX_INDICES, UNWRITTEN);
+  generator.Start(indices.data());
+
+  // Two quads, and a triangle for the 3 vertices which remain.
+  generator.AddIndices(OpcodeDecoder::GX_DRAW_QUADS, 11);
+  indices.resize(generator.GetIndexLen());
+  EXPECT_EQ((std::vector<u16>{0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7, 8, 9, 10}), indices);
+  EXPECT_EQ(11u, generator.GetNumVerts());
+}
+
+TEST(IndexGenerator, FanWithPrimitiveRestart)
+{
+  IndexGenerator generator;
+  generator.Init(true, true);
+  std::vector<u16> indices(MAX_INDICES, UNWRITTEN);
+  generator.Start(indices.data());
+
+  generator.AddIndices(OpcodeDecoder::GX_DRAW_TRIANGLE_FAN, 7);
+  indices.resize(generator.GetIndexLen());
+  EXPECT_EQ((std::vector<u16>{1, 2, 0, 3, 4, 0xFFFF, 4, 5, 0, 6, 0xFFFF}), indices);
+}
+
+class IndexGeneratorSpeedTest : public ::testing::TestWithParam<std::tuple<int, bool>>
+{
+};
+INSTANTIATE_TEST_CASE_P(PrimitivesAndGenerators, IndexGeneratorSpeedTest,
+                        ::testing::Combine(::testing::ValuesIn(PRIMITIVES),
+                                           ::testing::Bool()  // vectorized
+                                           ));
+
+TEST_P(IndexGeneratorSpeedTest, AddIndices)
+{
+  int primitive;
+  bool vectorized;
+  std::tie(primitive, vectorized) = GetParam();
+  printf("primitive: %d, vectorized: %d\n", primitive, vectorized);
+
+  // Fills the buffer with draws of a typical size, like a frame of a game does.
+  constexpr u32 NUM_DRAWS = 200;
+  constexpr u32 VERTICES_PER_DRAW = 96;
+  std::vector<u16> indices(NUM_DRAWS * (VERTICES_PER_DRAW * 3 + 8));
+  IndexGenerator generator;
+  generator.Init(true, vectorized);
+  for (int i = 0; i < 10000; ++i)
+  {
+    generator.Start(indices.data());
+    for (u32 draw = 0; draw < NUM_DRAWS; ++draw)
+      generator.AddIndices(primitive, VERTICES_PER_DRAW);
+  }
+}
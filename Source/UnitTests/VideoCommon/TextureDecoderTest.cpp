@@ -0,0 +1,179 @@
+// Copyright 2021 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/TextureDecoder.h"
+
+// The architecture-specific decoders must produce exactly the same output as the reference C
+// implementation in TextureDecoder_Generic.
+
+namespace
+{
+constexpr std::array<TLUTFormat, 3> s_tlut_formats = {TLUTFormat::IA8, TLUTFormat::RGB565,
+                                                      TLUTFormat::RGB5A3};
+
+void ExpectSameAsGeneric(const std::vector<u8>& src, int width, int height, TextureFormat format,
+                         const u8* tlut = nullptr, TLUTFormat tlutfmt = TLUTFormat::IA8)
+{
+  ASSERT_EQ(static_cast<size_t>(TexDecoder_GetTextureSizeInBytes(width, height, format)),
+            src.size());
+
+  std::vector<u32> expected(width * height, 0xDEADBEEF);
+  std::vector<u32> actual(width * height, 0xDEADBEEF);
+  _TexDecoder_DecodeImplGeneric(expected.data(), src.data(), width, height, format, tlut,
+                                tlutfmt);
+  _TexDecoder_DecodeImpl(actual.data(), src.data(), width, height, format, tlut, tlutfmt);
+
+  for (size_t i = 0; i < expected.size(); i++)
+  {
+    ASSERT_EQ(expected[i], actual[i])
+        << "format " << static_cast<int>(format) << ", tlut format " << static_cast<int>(tlutfmt)
+        << ", " << width << "x" << height << ", texel (" << i % width << ", " << i / width << ")";
+  }
+}
+
+// Fills a texture so that every possible value of each byte appears.
+std::vector<u8> AllBytes(size_t size)
+{
+  std::vector<u8> data(size);
+  for (size_t i = 0; i < size; i++)
+    data[i] = static_cast<u8>(i * 97 + i / 256);
+  return data;
+}
+
+// Fills a texture so that every possible 16-bit texel value appears (stored big-endian).
+std::vector<u8> AllHalfwords(size_t size)
+{
+  std::vector<u8> data(size);
+  for (size_t i = 0; i < size / 2; i++)
+  {
+    data[i * 2] = static_cast<u8>(i >> 8);
+    data[i * 2 + 1] = static_cast<u8>(i);
+  }
+  return data;
+}
+
+std::vector<u8> RandomBytes(size_t size, u32 seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> dist(0, 255);
+  std::vector<u8> data(size);
+  for (u8& byte : data)
+    byte = static_cast<u8>(dist(rng));
+  return data;
+}
+
+constexpr std::array<std::pair<int, int>, 4> s_sizes = {
+    {{8, 8}, {24, 16}, {64, 8}, {128, 128}}};
+}  // namespace
+
+TEST(TextureDecoder, IntensityFormats)
+{
+  for (TextureFormat format : {TextureFormat::I4, TextureFormat::I8, TextureFormat::IA4})
+  {
+    for (const auto& [width, height] : s_sizes)
+    {
+      const int size = TexDecoder_GetTextureSizeInBytes(width, height, format);
+      ExpectSameAsGeneric(AllBytes(size), width, height, format);
+      ExpectSameAsGeneric(RandomBytes(size, width * height), width, height, format);
+    }
+  }
+}
+
+TEST(TextureDecoder, SixteenBitFormatsExhaustive)
+{
+  // 256x256 texels of 16 bits each covers every possible texel value once.
+  for (TextureFormat format : {TextureFormat::IA8, TextureFormat::RGB565, TextureFormat::RGB5A3})
+  {
+    const int size = TexDecoder_GetTextureSizeInBytes(256, 256, format);
+    ASSERT_EQ(256 * 256 * 2, size);
+    ExpectSameAsGeneric(AllHalfwords(size), 256, 256, format);
+
+    for (const auto& [width, height] : s_sizes)
+    {
+      ExpectSameAsGeneric(RandomBytes(TexDecoder_GetTextureSizeInBytes(width, height, format),
+                                      width * height),
+                          width, height, format);
+    }
+  }
+}
+
+TEST(TextureDecoder, RGBA8)
+{
+  for (const auto& [width, height] : s_sizes)
+  {
+    const int size = TexDecoder_GetTextureSizeInBytes(width, height, TextureFormat::RGBA8);
+    ExpectSameAsGeneric(AllBytes(size), width, height, TextureFormat::RGBA8);
+    ExpectSameAsGeneric(RandomBytes(size, width * height), width, height, TextureFormat::RGBA8);
+  }
+}
+
+TEST(TextureDecoder, CMPR)
+{
+  for (const auto& [width, height] : s_sizes)
+  {
+    const int size = TexDecoder_GetTextureSizeInBytes(width, height, TextureFormat::CMPR);
+    ExpectSameAsGeneric(RandomBytes(size, width * height), width, height, TextureFormat::CMPR);
+  }
+
+  // Every combination of the high bytes of the two endpoint colors, which covers both the opaque
+  // (color1 > color2) and the transparent (color1 <= color2) palettes, including equal colors.
+  std::vector<u8> src =
+      RandomBytes(TexDecoder_GetTextureSizeInBytes(1024, 1024, TextureFormat::CMPR), 1);
+  ASSERT_EQ(0x10000u * 8, src.size());
+  for (size_t block = 0; block < 0x10000; block++)
+  {
+    src[block * 8] = static_cast<u8>(block >> 8);
+    src[block * 8 + 2] = static_cast<u8>(block);
+  }
+  ExpectSameAsGeneric(src, 1024, 1024, TextureFormat::CMPR);
+}
+
+TEST(TextureDecoder, PalettedFormatsExhaustive)
+{
+  // A 16x16 C8 texture uses each index exactly once, and cycling the TLUT contents through all
+  // 16-bit values checks every possible palette entry for each TLUT format.
+  const std::vector<u8> c8_src =
+      AllBytes(TexDecoder_GetTextureSizeInBytes(16, 16, TextureFormat::C8));
+  const std::vector<u8> c4_src =
+      AllBytes(TexDecoder_GetTextureSizeInBytes(16, 16, TextureFormat::C4));
+  const std::vector<u8> all_entries = AllHalfwords(0x10000 * 2);
+
+  for (TLUTFormat tlutfmt : s_tlut_formats)
+  {
+    for (size_t offset = 0; offset < all_entries.size(); offset += 256 * 2)
+    {
+      const u8* tlut = all_entries.data() + offset;
+      ExpectSameAsGeneric(c8_src, 16, 16, TextureFormat::C8, tlut, tlutfmt);
+    }
+    for (size_t offset = 0; offset < all_entries.size(); offset += 16 * 2)
+    {
+      const u8* tlut = all_entries.data() + offset;
+      ExpectSameAsGeneric(c4_src, 16, 16, TextureFormat::C4, tlut, tlutfmt);
+    }
+  }
+}
+
+TEST(TextureDecoder, PalettedFormats)
+{
+  const std::vector<u8> tlut = RandomBytes(0x4000 * 2, 2);
+  for (TLUTFormat tlutfmt : s_tlut_formats)
+  {
+    for (TextureFormat format : {TextureFormat::C4, TextureFormat::C8, TextureFormat::C14X2})
+    {
+      for (const auto& [width, height] : s_sizes)
+      {
+        const int size = TexDecoder_GetTextureSizeInBytes(width, height, format);
+        ExpectSameAsGeneric(RandomBytes(size, width * height), width, height, format, tlut.data(),
+                            tlutfmt);
+      }
+    }
+  }
+}
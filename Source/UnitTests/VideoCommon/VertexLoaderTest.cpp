@@ -7,9 +7,11 @@
 #include <tuple>
 #include <type_traits>
 #include <unordered_set>
+#include <vector>
 
 #include <gtest/gtest.h>  // NOLINT
 
+#include "Common/BitSet.h"
 #include "Common/BitUtils.h"
 #include "Common/Common.h"
 #include "VideoCommon/CPMemory.h"
@@ -245,6 +247,48 @@ TEST_F(VertexLoaderTest, PositionIndex16FloatXY)
   ExpectOut(2);
 }
 
+TEST_F(VertexLoaderTest, ArrayIndices)
+{
+  m_vtx_desc.PosMatIdx = 1;
+  m_vtx_desc.Position = INDEX16;
+  m_vtx_desc.Normal = INDEX8;
+  m_vtx_desc.Color0 = DIRECT;
+  m_vtx_desc.Tex0Coord = INDEX8;
+  m_vtx_attr.g0.PosElements = 1;  // XYZ
+  m_vtx_attr.g0.PosFormat = FORMAT_FLOAT;
+  m_vtx_attr.g0.NormalElements = 1;  // NBT
+  m_vtx_attr.g0.NormalFormat = FORMAT_FLOAT;
+  m_vtx_attr.g0.NormalIndex3 = 1;
+  m_vtx_attr.g0.Color0Comp = FORMAT_32B_8888;
+  m_vtx_attr.g0.Tex0CoordElements = 1;  // ST
+  m_vtx_attr.g0.Tex0CoordFormat = FORMAT_SHORT;
+  m_loader = VertexLoaderBase::CreateVertexLoader(m_vtx_desc, m_vtx_attr);
+  ASSERT_EQ(1 + 2 + 3 + 4 + 1, m_loader->m_VertexSize);
+
+  const auto indices = m_loader->GetArrayIndices();
+  ASSERT_TRUE(indices.has_value());
+  ASSERT_EQ(3u, indices->size());
+
+  EXPECT_EQ(ARRAY_POSITION, (*indices)[0].array);
+  EXPECT_EQ(1u, (*indices)[0].offset);
+  EXPECT_EQ(2u, (*indices)[0].index_size);
+  EXPECT_EQ(1u, (*indices)[0].num_indices);
+  EXPECT_EQ(3 * sizeof(float), (*indices)[0].element_size);
+
+  // The binormal and tangent are read at an offset from their own indices.
+  EXPECT_EQ(ARRAY_NORMAL, (*indices)[1].array);
+  EXPECT_EQ(3u, (*indices)[1].offset);
+  EXPECT_EQ(1u, (*indices)[1].index_size);
+  EXPECT_EQ(3u, (*indices)[1].num_indices);
+  EXPECT_EQ(9 * sizeof(float), (*indices)[1].element_size);
+
+  EXPECT_EQ(ARRAY_TEXCOORD0, (*indices)[2].array);
+  EXPECT_EQ(10u, (*indices)[2].offset);
+  EXPECT_EQ(1u, (*indices)[2].index_size);
+  EXPECT_EQ(1u, (*indices)[2].num_indices);
+  EXPECT_EQ(2 * sizeof(s16), (*indices)[2].element_size);
+}
+
 class VertexLoaderSpeedTest : public VertexLoaderTest,
                               public ::testing::WithParamInterface<std::tuple<int, int>>
 {
@@ -354,3 +398,66 @@ TEST_F(VertexLoaderTest, LargeFloatVertexSpeed)
   for (int i = 0; i < 100; ++i)
     RunVertices(100000);
 }
+
+class VertexLoaderManagerTest : public VertexLoaderTest
+{
+protected:
+  void TearDown() override { VertexLoaderManager::Clear(); }
+
+  // Looks up the loader for the group like the preprocessing thread does.
+  VertexLoaderBase* RefreshLoader(int vtx_attr_group)
+  {
+    g_preprocess_cp_state.attr_dirty[vtx_attr_group] = true;
+    VertexLoaderManager::RunVertices(vtx_attr_group, 0, 1, m_src, true);
+    return g_preprocess_cp_state.vertex_loaders[vtx_attr_group];
+  }
+};
+
+TEST_F(VertexLoaderManagerTest, LoaderLookup)
+{
+  g_preprocess_cp_state.vtx_desc.Hex = 0;
+  g_preprocess_cp_state.vtx_desc.Position = DIRECT;
+
+  // Enough distinct formats to grow the loader table a few times.
+  std::vector<VertexLoaderBase*> loaders;
+  for (u32 i = 0; i < 1024; i++)
+  {
+    g_preprocess_cp_state.vtx_attr[0].g0.PosFrac = i & 31;
+    g_preprocess_cp_state.vtx_attr[0].g1.Tex1Frac = i >> 5;
+    loaders.push_back(RefreshLoader(0));
+    ASSERT_NE(nullptr, loaders.back());
+  }
+
+  const std::unordered_set<VertexLoaderBase*> unique_loaders(loaders.begin(), loaders.end());
+  EXPECT_EQ(loaders.size(), unique_loaders.size());
+
+  for (u32 i = 0; i < 1024; i++)
+  {
+    g_preprocess_cp_state.vtx_attr[0].g0.PosFrac = i & 31;
+    g_preprocess_cp_state.vtx_attr[0].g1.Tex1Frac = i >> 5;
+    EXPECT_EQ(loaders[i], RefreshLoader(0));
+  }
+}
+
+TEST_F(VertexLoaderManagerTest, LoaderLookupSpeed)
+{
+  g_preprocess_cp_state.vtx_desc.Hex = 0;
+  g_preprocess_cp_state.vtx_desc.Position = INDEX16;
+  g_preprocess_cp_state.vtx_desc.Normal = INDEX16;
+  g_preprocess_cp_state.vtx_desc.Tex0Coord = INDEX16;
+  for (int i = 0; i < 8; i++)
+  {
+    g_preprocess_cp_state.vtx_attr[i].g0.Hex = 0;
+    g_preprocess_cp_state.vtx_attr[i].g0.PosElements = 1;  // XYZ
+    g_preprocess_cp_state.vtx_attr[i].g0.PosFormat = FORMAT_SHORT;
+    g_preprocess_cp_state.vtx_attr[i].g0.PosFrac = i;
+  }
+
+  // Games switch between vertex formats, and so dirty the loaders, all the time.
+  for (int i = 0; i < 1000000; ++i)
+  {
+    g_preprocess_cp_state.attr_dirty = BitSet32::AllTrue(8);
+    for (int group = 0; group < 8; group++)
+      VertexLoaderManager::RunVertices(group, 0, 1, m_src, true);
+  }
+}